@@ -0,0 +1,91 @@
+// Per-file cost of core::classifyContent on representative sniff blocks.
+// Usage: repaddu_bench_content_classifier [iterations]
+
+#include "repaddu/core_binary.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+    {
+    struct Sample
+        {
+        std::string name;
+        std::string head;
+        };
+
+    std::vector<Sample> makeSamples()
+        {
+        const std::size_t size = repaddu::core::kSniffBytes;
+        std::vector<Sample> samples;
+
+        std::string ascii;
+        while (ascii.size() < size)
+            {
+            ascii += "    for (std::size_t index = 0; index < count; ++index) { total += values[index]; }\n";
+            }
+        ascii.resize(size);
+        samples.push_back({ "ascii-source", ascii });
+
+        std::string utf8;
+        while (utf8.size() < size)
+            {
+            utf8 += "// Grüße, naïve café — 日本語のコメント\nint value = 42;\n";
+            }
+        utf8.resize(size - 8);
+        samples.push_back({ "utf8-mixed", utf8 });
+
+        std::string utf16;
+        for (std::size_t index = 0; utf16.size() < size; ++index)
+            {
+            utf16.push_back(ascii[index]);
+            utf16.push_back('\0');
+            }
+        samples.push_back({ "utf16le-no-bom", utf16 });
+
+        std::string binary(size, '\0');
+        std::uint32_t state = 2463534242u;
+        for (char& byte : binary)
+            {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            byte = static_cast<char>(state);
+            }
+        samples.push_back({ "random-binary", binary });
+
+        std::string elf = binary;
+        elf.replace(0, 4, "\x7f" "ELF");
+        samples.push_back({ "elf-magic", elf });
+        return samples;
+        }
+    }
+
+int main(int argc, char** argv)
+    {
+    const long parsed = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 0;
+    const std::size_t iterations = parsed > 0 ? static_cast<std::size_t>(parsed) : 200000;
+
+    std::size_t sink = 0;
+    for (const Sample& sample : makeSamples())
+        {
+        const auto started = std::chrono::steady_clock::now();
+        for (std::size_t iteration = 0; iteration < iterations; ++iteration)
+            {
+            const repaddu::core::ContentVerdict verdict = repaddu::core::classifyContent(sample.head);
+            sink += static_cast<std::size_t>(verdict.contentClass);
+            }
+        const double elapsedNs = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - started).count();
+        const double perFile = elapsedNs / static_cast<double>(iterations);
+        const repaddu::core::ContentVerdict verdict = repaddu::core::classifyContent(sample.head);
+        std::cout << sample.name << ": " << perFile << " ns/file, "
+            << (static_cast<double>(sample.head.size()) / perFile) << " bytes/ns, verdict="
+            << repaddu::core::contentClassLabel(verdict.contentClass) << "\n";
+        }
+    return sink == 0 ? 0 : 0;
+    }
@@ -0,0 +1,174 @@
+// Throughput of the BPE tokenizer against the bytes/4 heuristic on
+// generated C++-like source.
+// Usage: repaddu_bench_tokenizer [vocab.tiktoken] [megabytes]
+// Without a vocabulary, one is derived from the sample itself: every byte,
+// then every prefix of the 20000 most frequent pre-tokenizer pieces.
+
+#include "repaddu/analysis_bpe_tokenizer.h"
+#include "repaddu/analysis_tokens.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+    {
+    std::string makeSample(std::size_t size)
+        {
+        static const char* const names[] = { "index", "count", "values", "buffer", "result", "options", "files",
+            "writer", "offset", "length", "tokenCount", "relativePath" };
+        std::string sample;
+        std::uint32_t state = 2463534242u;
+        auto next = [&]()
+            {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+            };
+        while (sample.size() < size)
+            {
+            const std::string a = names[next() % 12];
+            const std::string b = names[next() % 12];
+            sample += "    for (std::size_t " + a + " = 0; " + a + " < " + b + ".size(); ++" + a + ")\n";
+            sample += "        {\n";
+            sample += "        total += " + b + "[" + a + "] * " + std::to_string(next() % 100000) + "; // " + a
+                + " of " + b + "\n";
+            sample += "        }\n";
+            }
+        sample.resize(size);
+        return sample;
+        }
+
+    std::string encodeBase64(std::string_view bytes)
+        {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        std::size_t index = 0;
+        for (; index + 2 < bytes.size(); index += 3)
+            {
+            const std::uint32_t value = (static_cast<unsigned char>(bytes[index]) << 16)
+                | (static_cast<unsigned char>(bytes[index + 1]) << 8) | static_cast<unsigned char>(bytes[index + 2]);
+            out += alphabet[(value >> 18) & 63];
+            out += alphabet[(value >> 12) & 63];
+            out += alphabet[(value >> 6) & 63];
+            out += alphabet[value & 63];
+            }
+        if (index + 1 == bytes.size())
+            {
+            const std::uint32_t value = static_cast<unsigned char>(bytes[index]) << 16;
+            out += alphabet[(value >> 18) & 63];
+            out += alphabet[(value >> 12) & 63];
+            out += "==";
+            }
+        else if (index + 2 == bytes.size())
+            {
+            const std::uint32_t value = (static_cast<unsigned char>(bytes[index]) << 16)
+                | (static_cast<unsigned char>(bytes[index + 1]) << 8);
+            out += alphabet[(value >> 18) & 63];
+            out += alphabet[(value >> 12) & 63];
+            out += alphabet[(value >> 6) & 63];
+            out += '=';
+            }
+        return out;
+        }
+
+    std::filesystem::path writeSampleVocabulary(const std::string& sample)
+        {
+        std::unordered_map<std::string_view, std::size_t> frequency;
+        for (std::string_view piece : repaddu::analysis::BpeTokenizer::splitPieces(sample))
+            {
+            ++frequency[piece];
+            }
+        std::vector<std::pair<std::string_view, std::size_t>> ordered(frequency.begin(), frequency.end());
+        std::sort(ordered.begin(), ordered.end(),
+            [](const auto& lhs, const auto& rhs)
+            {
+            return lhs.second > rhs.second;
+            });
+        ordered.resize(std::min<std::size_t>(ordered.size(), 20000));
+
+        std::vector<std::string> tokens;
+        std::unordered_map<std::string, bool> seen;
+        for (int byte = 0; byte < 256; ++byte)
+            {
+            tokens.emplace_back(1, static_cast<char>(byte));
+            seen[tokens.back()] = true;
+            }
+        // Shorter prefixes rank first so every piece can be merged up to.
+        std::vector<std::string> prefixes;
+        for (const auto& entry : ordered)
+            {
+            for (std::size_t length = 2; length <= entry.first.size(); ++length)
+                {
+                std::string prefix(entry.first.substr(0, length));
+                if (seen.emplace(prefix, true).second)
+                    {
+                    prefixes.push_back(std::move(prefix));
+                    }
+                }
+            }
+        std::stable_sort(prefixes.begin(), prefixes.end(),
+            [](const std::string& lhs, const std::string& rhs)
+            {
+            return lhs.size() < rhs.size();
+            });
+        tokens.insert(tokens.end(), prefixes.begin(), prefixes.end());
+
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "repaddu_bench_vocab.tiktoken";
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        for (std::size_t rank = 0; rank < tokens.size(); ++rank)
+            {
+            stream << encodeBase64(tokens[rank]) << ' ' << rank << '\n';
+            }
+        return path;
+        }
+
+    template <typename Count>
+    void report(const char* name, const std::string& sample, Count count)
+        {
+        const auto started = std::chrono::steady_clock::now();
+        const std::uintmax_t tokens = count(sample);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::cout << name << ": " << (static_cast<double>(sample.size()) / 1e6 / seconds) << " MB/s, " << tokens
+            << " tokens, " << (static_cast<double>(sample.size()) / static_cast<double>(tokens)) << " bytes/token\n";
+        }
+    }
+
+int main(int argc, char** argv)
+    {
+    const long parsed = argc > 2 ? std::strtol(argv[2], nullptr, 10) : 0;
+    const std::size_t megabytes = parsed > 0 ? static_cast<std::size_t>(parsed) : 32;
+    const std::string sample = makeSample(megabytes * 1024 * 1024);
+
+    const std::filesystem::path vocab = argc > 1 ? std::filesystem::path(argv[1]) : writeSampleVocabulary(sample);
+    repaddu::analysis::BpeTokenizer tokenizer;
+    const repaddu::core::RunResult loaded = tokenizer.load(vocab);
+    if (loaded.code != repaddu::core::ExitCode::success)
+        {
+        std::cerr << loaded.message << "\n";
+        return 1;
+        }
+    std::cout << "vocabulary: " << tokenizer.vocabularySize() << " tokens from " << vocab.string() << "\n";
+
+    report("heuristic", sample, [](const std::string& text)
+        {
+        return repaddu::analysis::TokenEstimator::estimateTokensFromSize(text.size());
+        });
+    // The first pass fills the merge cache; the second shows the steady state.
+    report("bpe-cold", sample, [&](const std::string& text)
+        {
+        return tokenizer.countTokens(text);
+        });
+    report("bpe-warm", sample, [&](const std::string& text)
+        {
+        return tokenizer.countTokens(text);
+        });
+    return 0;
+    }
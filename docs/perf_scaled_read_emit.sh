@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# The read/emit profile on fixtures/sample_repo scaled up: COPIES copies of
+# the fixture, with every text file grown to at least BODY_KB so bodies
+# take the direct-write path instead of the buffer.
+
+BIN=${1:-build/repaddu}
+COPIES=${2:-200}
+BODY_KB=${3:-256}
+LOOPS=${4:-5}
+READ_INPUT=${5:-fixtures/sample_repo}
+WORK=${WORK:-/tmp/repaddu_perf_scaled}
+
+rm -rf "${WORK}"
+mkdir -p "${WORK}/in" "${WORK}/out"
+for i in $(seq 1 "${COPIES}"); do
+  cp -r "${READ_INPUT}" "${WORK}/in/copy_${i}"
+done
+find "${WORK}/in" -type f ! -name '*.bin' | while read -r file; do
+  while [ "$(stat -c %s "${file}")" -lt $((BODY_KB * 1024)) ]; do
+    cat "${file}" "${file}" > "${file}.tmp" && mv "${file}.tmp" "${file}"
+  done
+done
+
+echo "Scaled read/emit: bin=${BIN} copies=${COPIES} body_kb=${BODY_KB} loops=${LOOPS} bytes=$(du -sb "${WORK}/in" | cut -f1)"
+
+/usr/bin/time -f "read_emit_scaled_${LOOPS}x_seconds=%e" bash -lc "for i in \$(seq 1 ${LOOPS}); do ${BIN} --input ${WORK}/in --output ${WORK}/out --group-by directory --group-depth 2 --max-bytes 200000000 >/dev/null 2>&1; done" 2>&1 | tail -n 1
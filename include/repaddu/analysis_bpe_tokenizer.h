@@ -0,0 +1,60 @@
+#ifndef REPADDU_ANALYSIS_BPE_TOKENIZER_H
+#define REPADDU_ANALYSIS_BPE_TOKENIZER_H
+
+#include "repaddu/core_types.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace repaddu::analysis
+    {
+    // Byte-pair encoding token counter over a tiktoken-style vocabulary file
+    // (one "<base64 token> <rank>" pair per line, as in cl100k_base.tiktoken).
+    // Text is split by a hand-written scanner that follows the cl100k
+    // pre-tokenizer pattern, classing every non-ASCII byte as a letter; each
+    // piece is then merged lowest rank first. Only counts are produced.
+    class BpeTokenizer
+        {
+        public:
+            BpeTokenizer() = default;
+            // Ranks are keyed by views into the tokenizer's own storage.
+            BpeTokenizer(const BpeTokenizer&) = delete;
+            BpeTokenizer& operator=(const BpeTokenizer&) = delete;
+
+            core::RunResult load(const std::filesystem::path& path);
+
+            // Safe to call from several threads; each keeps its own cache of
+            // merged pieces.
+            std::uintmax_t countTokens(std::string_view text) const;
+
+            // FNV-1a of the vocabulary file, so counts can be keyed on it.
+            std::uint64_t vocabularyHash() const
+                {
+                return vocabularyHash_;
+                }
+
+            std::size_t vocabularySize() const
+                {
+                return ranks_.size();
+                }
+
+            // The pre-tokenizer pieces of text, in order.
+            static std::vector<std::string_view> splitPieces(std::string_view text);
+
+        private:
+            std::uintmax_t countPiece(std::string_view piece) const;
+            std::uintmax_t mergePiece(std::string_view piece) const;
+            std::uint32_t rankOf(std::string_view bytes) const;
+
+            std::string arena_;
+            std::unordered_map<std::string_view, std::uint32_t> ranks_;
+            std::uint64_t vocabularyHash_ = 0;
+            std::uint64_t instanceId_ = 0;
+        };
+    }
+
+#endif // REPADDU_ANALYSIS_BPE_TOKENIZER_H
@@ -1,17 +1,44 @@
 #ifndef REPADDU_ANALYSIS_TOKENS_H
 #define REPADDU_ANALYSIS_TOKENS_H
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <cstdint>
 
 namespace repaddu::analysis
     {
+    class BpeTokenizer;
+
     class TokenEstimator
         {
         public:
-            // Heuristic-based estimation: ~4 chars per token for English/Code
-            // This is a common baseline used when a real tokenizer isn't linked.
-            static std::uintmax_t estimateTokens(const std::string& content);
+            // Counts with the tokenizer in use, if any. Otherwise falls back to
+            // a heuristic: ~4 chars per token for English/Code.
+            static std::uintmax_t estimateTokens(std::string_view content);
+            // The heuristic alone, from a byte count.
+            static std::uintmax_t estimateTokensFromSize(std::uintmax_t sizeBytes);
+
+            // Makes estimateTokens count with tokenizer; nullptr restores the
+            // heuristic. Not synchronized: call before any counting starts.
+            static void useTokenizer(std::shared_ptr<const BpeTokenizer> tokenizer);
+
+            // Names the counting method in use; cached token counts are keyed on it.
+            static std::string tokenizerId();
+        };
+
+    // Counts tokens of content that arrives in pieces. The heuristic counts
+    // the total size; a tokenizer counts each piece on its own, so a token
+    // that spans two pieces is counted twice.
+    class TokenCounter
+        {
+        public:
+            void add(std::string_view content);
+            std::uintmax_t total() const;
+
+        private:
+            std::uintmax_t bytes_ = 0;
+            std::uintmax_t tokens_ = 0;
         };
     }
 
@@ -1,6 +1,7 @@
 #ifndef REPADDU_APP_ANALYSIS_BACKEND_H
 #define REPADDU_APP_ANALYSIS_BACKEND_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 
 #include <cstddef>
@@ -19,7 +20,7 @@ namespace repaddu::app
             virtual ~AnalysisBackend() = default;
 
             virtual core::RunResult populateGraph(const core::CliOptions& options,
-                const std::vector<core::FileEntry>& files,
+                const core::FileTable& files,
                 const std::vector<std::size_t>& includedIndices,
                 analysis::AnalysisGraph& graph) = 0;
         };
@@ -28,7 +29,7 @@ namespace repaddu::app
         {
         public:
             core::RunResult populateGraph(const core::CliOptions& options,
-                const std::vector<core::FileEntry>& files,
+                const core::FileTable& files,
                 const std::vector<std::size_t>& includedIndices,
                 analysis::AnalysisGraph& graph) override;
         };
@@ -1,6 +1,7 @@
 #ifndef REPADDU_APP_ANALYZE_H
 #define REPADDU_APP_ANALYZE_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 
 #include <string>
@@ -11,12 +12,12 @@ namespace repaddu::app
     class AnalysisBackend;
 
     core::RunResult buildAnalyzeOnlyReport(const core::CliOptions& effectiveOptions,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<std::size_t>& includedIndices,
         std::string& outReport);
 
     core::RunResult buildAnalyzeOnlyReport(const core::CliOptions& effectiveOptions,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<std::size_t>& includedIndices,
         AnalysisBackend& backend,
         std::string& outReport);
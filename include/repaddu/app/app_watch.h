@@ -0,0 +1,55 @@
+#ifndef REPADDU_APP_APP_WATCH_H
+#define REPADDU_APP_APP_WATCH_H
+
+#include "repaddu/core_types.h"
+#include "repaddu/format_writer.h"
+#include "repaddu/io_traversal.h"
+#include "repaddu/io_watch.h"
+#include "repaddu/ui_interface.h"
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace repaddu::app
+    {
+    struct WatchUpdate
+        {
+        bool rescanRequired = false; // Membership may have changed.
+        bool regroupRequired = false; // A new size can move files between chunks.
+        std::size_t filesChanged = 0; // Entries updated in place.
+        };
+
+    // Row of every listed file by relative path. Built after each scan and
+    // shared by the change batches until the next one.
+    using WatchFileIndex = std::unordered_map<std::string, std::size_t>;
+
+    WatchFileIndex indexWatchedFiles(const io::TraversalResult& traversal);
+
+    // Applies coalesced change events to traversal in place. Rewritten files
+    // get their size refreshed and their binary state reset, and are
+    // invalidated in cache; anything that can change which files are listed
+    // (creations, deletions, renames, ignore file edits, lost events) requests
+    // a rescan instead. A size change that can alter grouping (--group-by
+    // size, crossing --max-file-size) requests a regroup.
+    // Events under the output directory are dropped.
+    WatchUpdate applyWatchChanges(const core::CliOptions& options,
+        const std::vector<io::WatchChange>& changes,
+        io::TraversalResult& traversal,
+        const WatchFileIndex& fileIndices,
+        format::OutputCache& cache);
+
+    // Renders outputs for a traversal; the cache persists across calls.
+    // regroup is false when only file contents changed since the last call,
+    // so grouping, chunks and the tree listing from that call still hold.
+    using EmitOutputsFunction = std::function<core::RunResult(io::TraversalResult&, format::OutputCache&, bool regroup)>;
+
+    // Initial traversal and render, then re-renders on every change batch until
+    // an error occurs. Does not return on success.
+    core::RunResult runWatch(const core::CliOptions& options,
+        ui::UserInterface& ui,
+        const EmitOutputsFunction& emitOutputs);
+    }
+
+#endif // REPADDU_APP_APP_WATCH_H
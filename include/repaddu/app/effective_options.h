@@ -1,6 +1,7 @@
 #ifndef REPADDU_APP_EFFECTIVE_OPTIONS_H
 #define REPADDU_APP_EFFECTIVE_OPTIONS_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 
 #include <vector>
@@ -8,7 +9,7 @@
 namespace repaddu::app
     {
     core::CliOptions buildEffectiveOptions(const core::CliOptions& requestedOptions,
-        const std::vector<core::FileEntry>& files);
+        const core::FileTable& files);
     }
 
 #endif // REPADDU_APP_EFFECTIVE_OPTIONS_H
@@ -4,6 +4,12 @@
 #include "repaddu/core_types.h"
 #include "repaddu/io_traversal.h"
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace repaddu::app
     {
     class RepositoryTraversalService
@@ -21,6 +27,31 @@ namespace repaddu::app
             core::RunResult traverse(const core::CliOptions& options,
                 io::TraversalResult& traversal) override;
         };
+
+    // Lists tracked files straight from .git/index instead of walking the
+    // working tree. Untracked files are added by a directory walk only when
+    // options.includeUntracked is set; without a readable index the service
+    // falls back to DefaultRepositoryTraversalService.
+    class GitIndexTraversalService : public RepositoryTraversalService
+        {
+        public:
+            core::RunResult traverse(const core::CliOptions& options,
+                io::TraversalResult& traversal) override;
+        };
+
+    struct GitIndexEntry
+        {
+        std::string path; // Relative to the work tree, '/' separated.
+        std::uint32_t mode = 0;
+        std::uint32_t sizeBytes = 0; // Truncated to 32 bits by git.
+        std::int64_t mtimeNs = 0;
+        };
+
+    // Parses index versions 2-4 (including v4 path prefix compression). Only
+    // stage-0 / first-stage entries that are present in the work tree are kept.
+    core::RunResult parseGitIndex(std::string_view data, std::vector<GitIndexEntry>& outEntries);
+
+    std::unique_ptr<RepositoryTraversalService> makeTraversalService(const core::CliOptions& options);
     }
 
 #endif // REPADDU_APP_FS_SERVICES_H
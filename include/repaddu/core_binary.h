@@ -0,0 +1,67 @@
+#ifndef REPADDU_CORE_BINARY_H
+#define REPADDU_CORE_BINARY_H
+
+#include "repaddu/core_types.h"
+
+#include <cstddef>
+#include <string_view>
+
+namespace repaddu::core
+    {
+    // Number of leading bytes inspected by the binary heuristics.
+    inline constexpr std::size_t kSniffBytes = 4096;
+
+    enum class ContentClass
+        {
+        textUtf8,   // ASCII or valid UTF-8 (a UTF-8 BOM is allowed).
+        textLegacy, // Printable 8-bit text that is not valid UTF-8 (Latin-1, CP1252, ...).
+        textUtf16le,
+        textUtf16be,
+        textUtf32le,
+        textUtf32be,
+        binary
+        };
+
+    enum class BinaryKind
+        {
+        none,
+        executable,
+        image,
+        archive,
+        nulBytes,     // NUL bytes that do not follow a UTF-16 pattern.
+        controlBytes  // Too many C0 control bytes for text.
+        };
+
+    struct ContentVerdict
+        {
+        ContentClass contentClass = ContentClass::textUtf8;
+        BinaryKind binaryKind = BinaryKind::none;
+        // Name of the matched magic signature or byte-order mark, if any.
+        std::string_view signature;
+
+        // Only UTF-8 and legacy 8-bit text can be embedded in the outputs
+        // as-is; UTF-16/32 text is reported as such but kept out like binaries.
+        bool embeddable() const
+            {
+            return contentClass == ContentClass::textUtf8 || contentClass == ContentClass::textLegacy;
+            }
+        };
+
+    // Classifies a leading block in one pass: byte-order marks, a magic
+    // signature looked up by first byte, then one vectorized scan (AVX2 or
+    // SSE2 where available, scalar otherwise) that counts NUL bytes per byte
+    // parity and control bytes and validates UTF-8.
+    ContentVerdict classifyContent(std::string_view head);
+
+    const char* contentClassLabel(ContentClass contentClass);
+    const char* binaryKindLabel(BinaryKind kind);
+
+    // True when the head is not embeddable text.
+    bool looksBinaryHead(std::string_view head);
+
+    // Resolves an unknown state from the first kSniffBytes of content and
+    // returns the (possibly already known) verdict.
+    BinaryState resolveBinaryState(BinaryState state, std::string_view content);
+    }
+
+#endif // REPADDU_CORE_BINARY_H
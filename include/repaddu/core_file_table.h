@@ -0,0 +1,177 @@
+#ifndef REPADDU_CORE_FILE_TABLE_H
+#define REPADDU_CORE_FILE_TABLE_H
+
+#include "repaddu/core_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace repaddu::core
+    {
+    // Columnar list of the files found by a traversal. A row is a directory id
+    // (interned, '/' separated, "" for the root), an offset into one shared
+    // name arena, an interned lowercased extension id, the size, the token
+    // count and one byte of class/binary bits; absolute paths are rebuilt from
+    // root() on demand. Rows are addressed by index like the vector it replaces.
+    class FileTable
+        {
+        public:
+            FileTable() = default;
+            explicit FileTable(std::filesystem::path root);
+
+            const std::filesystem::path& root() const
+                {
+                return root_;
+                }
+            void setRoot(std::filesystem::path root);
+
+            std::size_t size() const
+                {
+                return sizes_.size();
+                }
+            bool empty() const
+                {
+                return sizes_.empty();
+                }
+            void reserve(std::size_t rowCount);
+            // Drops every row and interned string; the root is kept.
+            void clear();
+
+            // relativePath is '/' separated. The extension and file class are
+            // derived from the name; the binary state starts unknown.
+            std::size_t add(std::string_view relativePath, std::uintmax_t sizeBytes);
+
+            // Appends every row of other, re-interning its strings; other's root is ignored.
+            void append(const FileTable& other);
+
+            std::string_view directory(std::size_t index) const
+                {
+                return directories_[directoryIds_[index]];
+                }
+            std::string_view name(std::size_t index) const
+                {
+                return std::string_view(names_).substr(nameOffsets_[index], nameLengths_[index]);
+                }
+            std::uint32_t directoryId(std::size_t index) const
+                {
+                return directoryIds_[index];
+                }
+            std::uint32_t extensionId(std::size_t index) const
+                {
+                return extensionIds_[index];
+                }
+            // Lowercased, including the dot; empty when the name has none.
+            std::string_view extension(std::size_t index) const
+                {
+                return extensions_[extensionIds_[index]];
+                }
+            std::uintmax_t sizeBytes(std::size_t index) const
+                {
+                return sizes_[index];
+                }
+            std::uintmax_t tokenCount(std::size_t index) const
+                {
+                return tokenCounts_[index];
+                }
+            FileClass fileClass(std::size_t index) const
+                {
+                return static_cast<FileClass>(flags_[index] & kClassMask);
+                }
+            BinaryState binaryState(std::size_t index) const
+                {
+                return static_cast<BinaryState>((flags_[index] >> kBinaryShift) & kBinaryMask);
+                }
+
+            // '/' separated; allocates, so hot loops should prefer appendRelativePath.
+            std::string relativePath(std::size_t index) const;
+            void appendRelativePath(std::size_t index, std::string& out) const;
+            std::filesystem::path absolutePath(std::size_t index) const;
+
+            void setSizeBytes(std::size_t index, std::uintmax_t sizeBytes);
+            void setTokenCount(std::size_t index, std::uintmax_t tokenCount);
+            void setBinaryState(std::size_t index, BinaryState state);
+
+            // Byte-wise order of relativePath, computed without building it.
+            // Once the table is sorted this is a comparison of row indices, so
+            // later sorts (grouping, chunking) reuse the order the sort computed.
+            bool pathLess(std::size_t lhs, std::size_t rhs) const;
+            // Reorders every column so rows are in pathLess order.
+            void sortByPath();
+            // True when rows are known to be in path order; add() and append()
+            // clear it, removeIf() and the setters keep it.
+            bool sortedByPath() const
+                {
+                return sortedByPath_;
+                }
+            // Replaces the rows with those of runs, each already sorted by path,
+            // merged in path order. Runs are keyed once and merged in up to
+            // threadCount independent segments. The root is kept.
+            void mergeSortedRuns(const std::vector<FileTable>& runs, std::size_t threadCount);
+
+            // Linear scan; meant for tests and one-off lookups.
+            std::optional<std::size_t> find(std::string_view relativePath) const;
+
+            // Removes the rows for which remove(index) is true, keeping the
+            // order of the others. Interned strings are not reclaimed.
+            template <typename Predicate>
+            std::size_t removeIf(Predicate remove)
+                {
+                std::size_t kept = 0;
+                const std::size_t rowCount = size();
+                for (std::size_t index = 0; index < rowCount; ++index)
+                    {
+                    if (remove(index))
+                        {
+                        continue;
+                        }
+                    if (kept != index)
+                        {
+                        moveRow(index, kept);
+                        }
+                    ++kept;
+                    }
+                resizeRows(kept);
+                return rowCount - kept;
+                }
+
+            // Approximate heap bytes held by the columns, arenas and intern tables.
+            std::size_t memoryBytes() const;
+
+        private:
+            static constexpr std::uint8_t kClassMask = 0x3;
+            static constexpr int kBinaryShift = 2;
+            static constexpr std::uint8_t kBinaryMask = 0x3;
+
+            std::uint32_t internDirectory(std::string_view directory);
+            std::uint32_t internExtension(std::string_view extensionLower);
+            void addRow(std::uint32_t directoryId, std::string_view name, std::uint32_t extensionId,
+                std::uintmax_t sizeBytes, std::uintmax_t tokenCount, std::uint8_t flags);
+            void moveRow(std::size_t from, std::size_t to);
+            void resizeRows(std::size_t rowCount);
+
+            std::filesystem::path root_;
+            bool sortedByPath_ = true;
+
+            std::vector<std::uint32_t> directoryIds_;
+            std::vector<std::uint32_t> nameOffsets_;
+            std::vector<std::uint16_t> nameLengths_;
+            std::vector<std::uint32_t> extensionIds_;
+            std::vector<std::uint64_t> sizes_;
+            std::vector<std::uint64_t> tokenCounts_;
+            std::vector<std::uint8_t> flags_;
+
+            std::string names_;
+            std::vector<std::string> directories_;
+            std::unordered_map<std::string, std::uint32_t> directoryLookup_;
+            std::vector<std::string> extensions_;
+            std::unordered_map<std::string, std::uint32_t> extensionLookup_;
+        };
+    }
+
+#endif // REPADDU_CORE_FILE_TABLE_H
@@ -41,11 +41,33 @@ namespace repaddu::core
         other
         };
 
+    // Binary classification is deferred until a file survives the extension,
+    // size and class filters; traversal leaves every entry unknown.
+    enum class BinaryState
+        {
+        unknown,
+        text,
+        binary
+        };
+
+    enum class TraversalBackend
+        {
+        standard,
+        native
+        };
+
+    enum class TraversalSource
+        {
+        walk,
+        gitIndex
+        };
+
     enum class OutputFormat
         {
         markdown,
         jsonl,
-        html
+        html,
+        pack
         };
 
     struct CliOptions
@@ -93,18 +115,21 @@ namespace repaddu::core
         bool dryRun = false;
         bool generateConfig = false;
         std::filesystem::path configPath = ".repaddu.json";
+        bool useIgnoreFiles = true;
         bool parallelTraversal = true;
-        };
-
-    struct FileEntry
-        {
-        std::filesystem::path absolutePath;
-        std::filesystem::path relativePath;
-        std::string extensionLower;
-        std::uintmax_t sizeBytes = 0;
-        std::uintmax_t tokenCount = 0;
-        bool isBinary = false;
-        FileClass fileClass = FileClass::other;
+        TraversalBackend traversalBackend = TraversalBackend::standard;
+        std::filesystem::path traversalCachePath;
+        TraversalSource traversalSource = TraversalSource::walk;
+        bool includeUntracked = false;
+        bool watch = false;
+        int watchDebounceMs = 50;
+        std::uintmax_t contentCacheMb = 64;
+        bool contentCacheStats = false;
+        std::filesystem::path contentStorePath;
+        std::uintmax_t streamThresholdMb = 64;
+        bool preallocateOutputs = false;
+        std::uintmax_t jsonlShardBytes = 0;
+        std::filesystem::path tokenizerPath;
         };
 
     struct Group
@@ -1,6 +1,7 @@
 #ifndef REPADDU_FORMAT_ANALYSIS_TAGS_REPORT_H
 #define REPADDU_FORMAT_ANALYSIS_TAGS_REPORT_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 
 #include <string>
@@ -9,7 +10,7 @@
 namespace repaddu::format
     {
     std::string renderTagSummaryReport(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<std::size_t>& includedIndices);
     }
 
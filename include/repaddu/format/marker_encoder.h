@@ -0,0 +1,256 @@
+#ifndef REPADDU_FORMAT_MARKER_ENCODER_H
+#define REPADDU_FORMAT_MARKER_ENCODER_H
+
+#include "repaddu/core_file_table.h"
+#include "repaddu/core_types.h"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace repaddu::format
+    {
+    // The row fields a marker block prints. The path is kept as the two
+    // halves a FileTable row stores so no joined string is built; files
+    // outside the table (build files, CMake lists) leave directory empty.
+    struct MarkerFile
+        {
+        std::string_view directory; // '/' separated, empty at the root.
+        std::string_view name;      // Whatever follows directory + '/'.
+        std::uintmax_t sizeBytes = 0;
+        std::uintmax_t tokenCount = 0;
+        core::FileClass fileClass = core::FileClass::other;
+        };
+
+    inline MarkerFile markerFileOf(const core::FileTable& files, std::size_t index, std::uintmax_t tokenCount)
+        {
+        return { files.directory(index), files.name(index), files.sizeBytes(index), tokenCount, files.fileClass(index) };
+        }
+
+    namespace marker_detail
+        {
+        // The fixed text around the fields of one marker header.
+        struct Layout
+            {
+            std::string_view prefix;
+            bool escapeQuotes;
+            std::string_view bytesLabel;
+            std::string_view tokensLabel;
+            std::string_view classLabel;
+            std::string_view suffix;
+            };
+
+        constexpr Layout kFenced{ "```repaddu-file\npath: ", false, "\nbytes: ", "\ntokens: ", "\nclass: ", "\n```\n" };
+        constexpr Layout kSentinel{ "@@@ REPADDU FILE BEGIN path=\"", true, "\" bytes=", " tokens=", " class=", " @@@\n" };
+        constexpr Layout kFrontmatter{ "---\npath: ", false, "\nbytes: ", "\ntokens: ", "\nclass: ", "\n---\n" };
+
+        constexpr std::string_view classLabel(core::FileClass value)
+            {
+            switch (value)
+                {
+                case core::FileClass::header:
+                    return "header";
+                case core::FileClass::source:
+                    return "source";
+                case core::FileClass::other:
+                    return "other";
+                }
+            return "other";
+            }
+
+        constexpr std::size_t decimalDigits(std::uintmax_t value)
+            {
+            std::size_t digits = 1;
+            while (value >= 10)
+                {
+                value /= 10;
+                ++digits;
+                }
+            return digits;
+            }
+
+        inline std::size_t quoteCount(std::string_view text)
+            {
+            std::size_t count = 0;
+            for (const char ch : text)
+                {
+                count += ch == '"' ? 1 : 0;
+                }
+            return count;
+            }
+
+        inline std::uintmax_t pathBytes(const MarkerFile& file, bool escapeQuotes)
+            {
+            std::uintmax_t bytes = file.name.size();
+            if (!file.directory.empty())
+                {
+                bytes += file.directory.size() + 1;
+                }
+            if (escapeQuotes)
+                {
+                bytes += quoteCount(file.directory) + quoteCount(file.name);
+                }
+            return bytes;
+            }
+
+        inline std::uintmax_t layoutBytes(const Layout& layout, const MarkerFile& file)
+            {
+            return layout.prefix.size() + pathBytes(file, layout.escapeQuotes) + layout.bytesLabel.size()
+                + decimalDigits(file.sizeBytes) + layout.tokensLabel.size() + decimalDigits(file.tokenCount)
+                + layout.classLabel.size() + classLabel(file.fileClass).size() + layout.suffix.size();
+            }
+
+        // Everything after the path, formatted into one stack buffer so it
+        // reaches the sink as a single write.
+        class FieldBuffer
+            {
+            public:
+                void append(std::string_view text)
+                    {
+                    for (const char ch : text)
+                        {
+                        data_[size_++] = ch;
+                        }
+                    }
+
+                void appendNumber(std::uintmax_t value)
+                    {
+                    const std::to_chars_result result = std::to_chars(data_ + size_, data_ + sizeof(data_), value);
+                    size_ = static_cast<std::size_t>(result.ptr - data_);
+                    }
+
+                std::string_view view() const
+                    {
+                    return std::string_view(data_, size_);
+                    }
+
+            private:
+                // Longest labels and suffix plus two 20-digit numbers.
+                char data_[96];
+                std::size_t size_ = 0;
+            };
+
+        template <typename Sink>
+        void writeEscaped(Sink& sink, std::string_view text)
+            {
+            std::size_t start = 0;
+            for (std::size_t quote = text.find('"'); quote != std::string_view::npos; quote = text.find('"', start))
+                {
+                sink.write(text.substr(start, quote - start));
+                sink.write("\\\"");
+                start = quote + 1;
+                }
+            sink.write(text.substr(start));
+            }
+
+        template <typename Sink>
+        void writeLayout(Sink& sink, const Layout& layout, const MarkerFile& file)
+            {
+            sink.write(layout.prefix);
+            if (!file.directory.empty())
+                {
+                if (layout.escapeQuotes)
+                    {
+                    writeEscaped(sink, file.directory);
+                    }
+                else
+                    {
+                    sink.write(file.directory);
+                    }
+                sink.write("/");
+                }
+            if (layout.escapeQuotes)
+                {
+                writeEscaped(sink, file.name);
+                }
+            else
+                {
+                sink.write(file.name);
+                }
+
+            FieldBuffer fields;
+            fields.append(layout.bytesLabel);
+            fields.appendNumber(file.sizeBytes);
+            fields.append(layout.tokensLabel);
+            fields.appendNumber(file.tokenCount);
+            fields.append(layout.classLabel);
+            fields.append(classLabel(file.fileClass));
+            fields.append(layout.suffix);
+            sink.write(fields.view());
+            }
+        }
+
+    // Marker block encoding for one marker mode and frontmatter setting.
+    // Sizes are computed from the field lengths without formatting
+    // anything, and writing formats numbers with to_chars into stack
+    // buffers; neither allocates. Sink is anything with write(string_view).
+    template <core::MarkerMode Mode, bool Frontmatter>
+    struct MarkerEncoder
+        {
+        static constexpr const marker_detail::Layout& layout()
+            {
+            return Mode == core::MarkerMode::fenced ? marker_detail::kFenced : marker_detail::kSentinel;
+            }
+
+        static constexpr std::string_view footer()
+            {
+            return Mode == core::MarkerMode::fenced ? std::string_view("```\n") : std::string_view("@@@ REPADDU FILE END @@@\n");
+            }
+
+        static std::uintmax_t headerBytes(const MarkerFile& file)
+            {
+            std::uintmax_t bytes = marker_detail::layoutBytes(layout(), file);
+            if constexpr (Frontmatter)
+                {
+                bytes += marker_detail::layoutBytes(marker_detail::kFrontmatter, file);
+                }
+            return bytes;
+            }
+
+        // closeLine adds the newline a body without a trailing one needs.
+        static constexpr std::uintmax_t footerBytes(bool closeLine)
+            {
+            return footer().size() + (closeLine ? 1 : 0);
+            }
+
+        static std::uintmax_t blockBytes(const MarkerFile& file, std::uintmax_t contentBytes, bool closeLine)
+            {
+            return headerBytes(file) + contentBytes + footerBytes(closeLine);
+            }
+
+        template <typename Sink>
+        static void writeHeader(Sink& sink, const MarkerFile& file)
+            {
+            marker_detail::writeLayout(sink, layout(), file);
+            if constexpr (Frontmatter)
+                {
+                marker_detail::writeLayout(sink, marker_detail::kFrontmatter, file);
+                }
+            }
+
+        template <typename Sink>
+        static void writeFooter(Sink& sink, bool closeLine)
+            {
+            sink.write(closeLine ? (Mode == core::MarkerMode::fenced ? std::string_view("\n```\n")
+                                                                      : std::string_view("\n@@@ REPADDU FILE END @@@\n"))
+                                 : footer());
+            }
+        };
+
+    // Calls visitor with the MarkerEncoder for a runtime mode and setting,
+    // so per-file loops can branch once outside the loop.
+    template <typename Visitor>
+    decltype(auto) visitMarkerEncoder(core::MarkerMode mode, bool frontmatter, Visitor&& visitor)
+        {
+        if (mode == core::MarkerMode::fenced)
+            {
+            return frontmatter ? visitor(MarkerEncoder<core::MarkerMode::fenced, true>{})
+                               : visitor(MarkerEncoder<core::MarkerMode::fenced, false>{});
+            }
+        return frontmatter ? visitor(MarkerEncoder<core::MarkerMode::sentinel, true>{})
+                           : visitor(MarkerEncoder<core::MarkerMode::sentinel, false>{});
+        }
+    }
+
+#endif // REPADDU_FORMAT_MARKER_ENCODER_H
@@ -0,0 +1,88 @@
+#ifndef REPADDU_FORMAT_PACK_READER_H
+#define REPADDU_FORMAT_PACK_READER_H
+
+#include "repaddu/core_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace repaddu::format
+    {
+    // Layout of a pack (--format pack), one file in little-endian byte
+    // order, written front to back in a single pass:
+    //   PackHeader
+    //   PackRecord[entryCount]  sorted by path, byte-wise
+    //   path bytes              pathsBytes, in record order, unterminated
+    //   content bytes           contentBytes, in record order
+    // Offsets in a record are relative to the start of their region.
+    constexpr char kPackFileMagic[8] = { 'R', 'P', 'D', 'U', 'P', 'A', 'C', 'K' };
+    constexpr std::uint32_t kPackFileVersion = 1;
+
+    struct PackHeader
+        {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t recordBytes; // sizeof(PackRecord), for readers of later versions.
+        std::uint64_t entryCount;
+        std::uint64_t pathsOffset;
+        std::uint64_t pathsBytes;
+        std::uint64_t contentOffset;
+        std::uint64_t contentBytes;
+        std::uint64_t reserved;
+        };
+    static_assert(sizeof(PackHeader) == 64, "pack headers are stored as raw bytes");
+
+    struct PackRecord
+        {
+        std::uint64_t pathOffset;
+        std::uint64_t contentOffset;
+        std::uint64_t contentBytes;  // After redaction, as written.
+        std::uint64_t tokenCount;
+        std::uint32_t pathBytes;
+        std::uint32_t fileClass;     // core::FileClass.
+        };
+    static_assert(sizeof(PackRecord) == 40, "pack records are stored as raw bytes");
+
+    // One file of a pack; both views point into the reader's mapping.
+    struct PackEntry
+        {
+        std::string_view path;
+        std::string_view content;
+        std::uint64_t tokenCount = 0;
+        core::FileClass fileClass = core::FileClass::other;
+        };
+
+    // Maps a pack read-only and looks files up by binary search over the
+    // records in place. open() validates the header and every record, so
+    // entry() and find() never read outside the file.
+    class PackReader
+        {
+        public:
+            core::RunResult open(const std::filesystem::path& path);
+
+            std::size_t size() const
+                {
+                return count_;
+                }
+
+            // The entry at index in path order; index must be below size().
+            PackEntry entry(std::size_t index) const;
+            // O(log n) lookup of a '/' separated path relative to the input root.
+            std::optional<PackEntry> find(std::string_view path) const;
+
+        private:
+            std::string_view pathOf(std::size_t index) const;
+
+            std::shared_ptr<const void> storage_;
+            const PackRecord* records_ = nullptr;
+            std::size_t count_ = 0;
+            std::string_view paths_;
+            std::string_view content_;
+        };
+    }
+
+#endif // REPADDU_FORMAT_PACK_READER_H
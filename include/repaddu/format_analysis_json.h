@@ -1,6 +1,7 @@
 #ifndef REPADDU_FORMAT_ANALYSIS_JSON_H
 #define REPADDU_FORMAT_ANALYSIS_JSON_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 #include <string>
 #include <vector>
@@ -14,7 +15,7 @@ namespace repaddu::analysis
 namespace repaddu::format
     {
     std::string renderAnalysisJson(const core::CliOptions& options,
-                                   const std::vector<core::FileEntry>& allFiles,
+                                   const core::FileTable& allFiles,
                                    const std::vector<std::size_t>& includedIndices,
                                    const analysis::AnalysisGraph* graph = nullptr,
                                    const analysis::AnalysisViewOptions* viewOptions = nullptr);
@@ -1,6 +1,7 @@
 #ifndef REPADDU_FORMAT_ANALYSIS_REPORT_H
 #define REPADDU_FORMAT_ANALYSIS_REPORT_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 #include <string>
 #include <vector>
@@ -14,11 +15,11 @@ namespace repaddu::analysis
 namespace repaddu::format
     {
     std::string renderAnalysisReport(const core::CliOptions& options,
-                                     const std::vector<core::FileEntry>& allFiles,
+                                     const core::FileTable& allFiles,
                                      const std::vector<std::size_t>& includedIndices);
 
     std::string renderAnalysisReportWithViews(const core::CliOptions& options,
-                                              const std::vector<core::FileEntry>& allFiles,
+                                              const core::FileTable& allFiles,
                                               const std::vector<std::size_t>& includedIndices,
                                               const analysis::AnalysisGraph& graph,
                                               const analysis::AnalysisViewOptions& viewOptions);
@@ -1,6 +1,7 @@
 #ifndef REPADDU_FORMAT_LANGUAGE_REPORT_H
 #define REPADDU_FORMAT_LANGUAGE_REPORT_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 
 #include <string>
@@ -9,7 +10,12 @@
 namespace repaddu::format
     {
     std::string renderLanguageReport(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files);
+        const core::FileTable& files);
+
+    // Counts only the rows listed in indices.
+    std::string renderLanguageReport(const core::CliOptions& options,
+        const core::FileTable& files,
+        const std::vector<std::size_t>& indices);
     }
 
 #endif // REPADDU_FORMAT_LANGUAGE_REPORT_H
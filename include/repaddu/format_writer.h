@@ -1,20 +1,67 @@
 #ifndef REPADDU_FORMAT_WRITER_H
 #define REPADDU_FORMAT_WRITER_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace repaddu::format
     {
+    // State kept between writeOutputs calls of a long-lived session (watch
+    // mode). Files are measured once and outputs whose inputs are unchanged
+    // are not rewritten. Only the markdown format is written incrementally.
+    struct OutputCache
+        {
+        struct FileMeasure
+            {
+            std::uintmax_t tokenCount = 0;
+            std::uintmax_t blockBytes = 0;
+            bool binary = false; // Sniffed as binary and left out of the parts.
+            };
+
+        struct WrittenOutput
+            {
+            std::uint64_t signature = 0;
+            std::uintmax_t bytes = 0;
+            };
+
+        std::string optionsKey;
+        std::unordered_map<std::string, FileMeasure> measures; // Keyed by relative path.
+        std::unordered_map<std::string, std::uint64_t> generations; // Bumped by invalidate().
+        std::unordered_map<std::string, WrittenOutput> outputs; // Keyed by output file name.
+        std::size_t outputsWritten = 0; // Counters of the last writeOutputs call.
+        std::size_t outputsSkipped = 0;
+
+        // Marks relativePath ('/' separated) as changed on disk.
+        void invalidate(const std::string& relativePath);
+        };
+
+    // Reports (0, total, "") once the amount of work is known, then
+    // (done, total, filename) as outputs are written. A step is one output
+    // file, except that the single-pass writer counts each chunk as one
+    // step since it only learns how many parts a chunk needs while writing
+    // it. Calls never overlap, but may come from any thread.
+    using ProgressCallback = std::function<void(std::size_t done, std::size_t total, const std::string& filename)>;
+
+    // True for --output -: markdown outputs are planned, then streamed to
+    // standard output as one POSIX ustar archive instead of written to a
+    // directory.
+    bool writesToStandardOutput(const core::CliOptions& options);
+
     core::RunResult writeOutputs(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<core::OutputChunk>& chunks,
         const std::string& treeListing,
         const std::vector<std::filesystem::path>& cmakeLists,
-        const std::vector<std::filesystem::path>& buildFiles);
+        const std::vector<std::filesystem::path>& buildFiles,
+        OutputCache* cache = nullptr,
+        const ProgressCallback& progress = {});
     }
 
 #endif // REPADDU_FORMAT_WRITER_H
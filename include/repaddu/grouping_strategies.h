@@ -1,6 +1,7 @@
 #ifndef REPADDU_GROUPING_STRATEGIES_H
 #define REPADDU_GROUPING_STRATEGIES_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 #include "repaddu/grouping_component_map.h"
 
@@ -16,12 +17,12 @@ namespace repaddu::grouping
         };
 
     GroupingResult filterAndGroupFiles(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const ComponentMap* componentMap,
         core::RunResult& outResult);
 
     std::vector<core::OutputChunk> chunkGroups(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<core::Group>& groups,
         core::RunResult& outResult);
     }
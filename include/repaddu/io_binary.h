@@ -1,11 +1,25 @@
 #ifndef REPADDU_IO_BINARY_H
 #define REPADDU_IO_BINARY_H
 
+#include "repaddu/core_binary.h"
+#include "repaddu/core_file_table.h"
+#include "repaddu/core_types.h"
+
+#include <cstddef>
 #include <filesystem>
+#include <vector>
 
 namespace repaddu::io
     {
+    // Classifies the first core::kSniffBytes of a file; unreadable files
+    // count as empty text.
+    core::ContentVerdict classifyFile(const std::filesystem::path& filePath);
+
     bool looksBinary(const std::filesystem::path& filePath);
+
+    // Sniffs row index of files for every index whose binary state is still unknown.
+    // Only report modes need this; the writers classify during their own read.
+    void resolveBinaryStates(core::FileTable& files, const std::vector<std::size_t>& indices);
     }
 
 #endif // REPADDU_IO_BINARY_H
@@ -0,0 +1,91 @@
+#ifndef REPADDU_IO_IGNORE_H
+#define REPADDU_IO_IGNORE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace repaddu::io
+    {
+    // Patterns of a single .gitignore-style file, compiled once. Plain names
+    // ("build"), extension globs ("*.o") and anchored literal paths ("/dist")
+    // are indexed in hash tables; only the remaining wildcard patterns are
+    // evaluated with the glob matcher.
+    class IgnoreRules
+        {
+        public:
+            enum class Verdict
+                {
+                none,
+                ignored,
+                included
+                };
+
+            static IgnoreRules compile(std::string_view text);
+
+            bool empty() const
+                {
+                return patterns_.empty();
+                }
+
+            // relativePath is relative to the directory holding the ignore file and
+            // uses '/' separators; the last pattern that matches decides.
+            Verdict match(std::string_view relativePath, bool isDirectory) const;
+
+        private:
+            struct Pattern
+                {
+                std::string glob;
+                bool negated = false;
+                bool directoryOnly = false;
+                bool matchesBasename = true;
+                };
+
+            using IndexBucket = std::unordered_map<std::string, std::vector<std::uint32_t>>;
+
+            void addPattern(Pattern pattern);
+            long lastMatchIn(const IndexBucket& bucket, const std::string& key, bool isDirectory, long best) const;
+
+            std::vector<Pattern> patterns_;
+            IndexBucket basenameLiterals_;
+            IndexBucket basenameSuffixes_;
+            std::vector<std::size_t> suffixLengths_;
+            IndexBucket pathLiterals_;
+            std::vector<std::uint32_t> globPatterns_;
+        };
+
+    // One directory level of ignore rules chained to its parent level. Levels are
+    // immutable and shared between traversal tasks of sibling directories.
+    struct IgnoreLevel
+        {
+        std::shared_ptr<const IgnoreLevel> parent;
+        std::string baseDirectory; // Relative to the input root, "" for the root.
+        std::vector<IgnoreRules> rules; // Lowest priority first.
+        };
+
+    using IgnoreLevelPtr = std::shared_ptr<const IgnoreLevel>;
+
+    // File names consulted in every directory, lowest priority first.
+    const std::vector<std::string>& ignoreFileNames();
+
+    // Returns a level for relativeDirectory built from the given ignore file
+    // contents (lowest priority first), or parent unchanged when all are empty.
+    IgnoreLevelPtr extendIgnoreLevel(const IgnoreLevelPtr& parent,
+        const std::string& relativeDirectory,
+        const std::vector<std::string>& fileContents);
+
+    // Reads the ignore files of absoluteDirectory (and .git/info/exclude for the
+    // root) and extends parent with them.
+    IgnoreLevelPtr loadIgnoreLevel(const IgnoreLevelPtr& parent,
+        const std::filesystem::path& absoluteDirectory,
+        const std::string& relativeDirectory);
+
+    // relativePath is relative to the input root with '/' separators.
+    bool isIgnored(const IgnoreLevel* level, std::string_view relativePath, bool isDirectory);
+    }
+
+#endif // REPADDU_IO_IGNORE_H
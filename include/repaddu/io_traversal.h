@@ -1,6 +1,7 @@
 #ifndef REPADDU_IO_TRAVERSAL_H
 #define REPADDU_IO_TRAVERSAL_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 
 #include <filesystem>
@@ -10,7 +11,7 @@ namespace repaddu::io
     {
     struct TraversalResult
         {
-        std::vector<core::FileEntry> files;
+        core::FileTable files; // Rooted at options.inputPath.
         std::vector<std::filesystem::path> directories;
         std::vector<std::filesystem::path> cmakeLists;
         std::vector<std::filesystem::path> buildFiles;
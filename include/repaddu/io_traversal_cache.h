@@ -0,0 +1,62 @@
+#ifndef REPADDU_IO_TRAVERSAL_CACHE_H
+#define REPADDU_IO_TRAVERSAL_CACHE_H
+
+#include "repaddu/core_types.h"
+#include "repaddu/io_traversal.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace repaddu::io
+    {
+    struct SnapshotSubdirectory
+        {
+        std::string name;
+        bool descend = true;
+        };
+
+    // Filtered listing of one directory. A zero mtime marks a directory that was
+    // modified too recently to be trusted and must be re-listed next time.
+    // Only the listing is reused: files are stat'ed for their size on every
+    // run, so the snapshot keeps their names alone.
+    struct SnapshotDirectory
+        {
+        std::int64_t mtimeNs = 0;
+        std::uint64_t inode = 0;
+        std::vector<SnapshotSubdirectory> subdirectories;
+        std::vector<std::string> files; // Regular file names, sorted.
+        };
+
+    struct TraversalSnapshot
+        {
+        // Options that change the filtered listing; a mismatch invalidates the snapshot.
+        std::string fingerprint;
+        std::unordered_map<std::string, SnapshotDirectory> directories; // Keyed by relative path, "" is the root.
+        };
+
+    struct IncrementalTraversalStats
+        {
+        std::size_t directoriesListed = 0;
+        std::size_t directoriesReused = 0;
+        };
+
+    std::string traversalSnapshotFingerprint(const core::CliOptions& options);
+
+    // A missing snapshot file is not an error; outSnapshot is left empty.
+    core::RunResult loadTraversalSnapshot(const std::filesystem::path& path, TraversalSnapshot& outSnapshot);
+    core::RunResult saveTraversalSnapshot(const std::filesystem::path& path, const TraversalSnapshot& snapshot);
+
+    // Walks the tree re-listing only directories whose mtime/inode changed since
+    // `previous`. Files are stat'ed but not sniffed; binary classification is
+    // deferred to the writers.
+    core::RunResult traverseRepositoryIncremental(const core::CliOptions& options,
+        const TraversalSnapshot& previous,
+        TraversalResult& outResult,
+        TraversalSnapshot& outSnapshot,
+        IncrementalTraversalStats* outStats = nullptr);
+    }
+
+#endif // REPADDU_IO_TRAVERSAL_CACHE_H
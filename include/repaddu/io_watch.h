@@ -0,0 +1,52 @@
+#ifndef REPADDU_IO_WATCH_H
+#define REPADDU_IO_WATCH_H
+
+#include "repaddu/core_types.h"
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace repaddu::io
+    {
+    struct WatchChange
+        {
+        std::string relativePath; // '/' separated; empty together with `overflow`.
+        bool structural = false; // Created, deleted or renamed rather than rewritten.
+        bool isDirectory = false;
+        bool overflow = false; // Events were lost; the caller must rescan everything.
+        };
+
+    // inotify based watcher over the directories of a traversal. Watches are
+    // per directory (inotify is not recursive), so callers add every directory
+    // they traversed and any directory that appears later.
+    class DirectoryWatcher
+        {
+        public:
+            DirectoryWatcher() = default;
+            ~DirectoryWatcher();
+            DirectoryWatcher(const DirectoryWatcher&) = delete;
+            DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+            static bool available();
+
+            core::RunResult open(const std::filesystem::path& root);
+
+            // relativeDirectory is '/' separated, "" for the root. Adding a
+            // directory twice is harmless.
+            bool addDirectory(const std::string& relativeDirectory);
+
+            // Blocks up to timeoutMs (negative waits forever) for a first event,
+            // then keeps collecting until debounceMs pass without a new one.
+            // Changes are coalesced per path; an empty result means timeout.
+            core::RunResult waitForChanges(int timeoutMs, int debounceMs, std::vector<WatchChange>& outChanges);
+
+        private:
+            int fd_ = -1;
+            std::filesystem::path root_;
+            std::unordered_map<int, std::string> directories_;
+        };
+    }
+
+#endif // REPADDU_IO_WATCH_H
@@ -1,6 +1,7 @@
 #ifndef REPADDU_LANGUAGE_PROFILES_H
 #define REPADDU_LANGUAGE_PROFILES_H
 
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 
 #include <string>
@@ -33,7 +34,7 @@ namespace repaddu::core
 
     const LanguageProfile* findLanguageProfile(std::string_view id);
     const BuildSystemProfile* findBuildSystemProfile(std::string_view id);
-    DetectionResult detectLanguageAndBuildSystem(const std::vector<FileEntry>& files);
+    DetectionResult detectLanguageAndBuildSystem(const FileTable& files);
     std::vector<std::string> resolveBuildFileNames(const CliOptions& options);
     }
 
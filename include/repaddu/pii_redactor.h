@@ -1,7 +1,9 @@
 #ifndef REPADDU_PII_REDACTOR_H
 #define REPADDU_PII_REDACTOR_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <regex>
 
@@ -13,7 +15,25 @@ namespace repaddu::security
             PiiRedactor();
             
             // Returns a redacted version of the input string
-            std::string redact(const std::string& input, const std::string& filePath = "");
+            std::string redact(const std::string& input, const std::string& filePath = "") const;
+
+            // Writes the redacted input to output and returns true when any
+            // pattern matched; otherwise leaves output untouched, so clean
+            // input never has to be copied. Safe to call from several threads.
+            // Each match is logged as a warning unless logMatches is false.
+            bool redactInto(std::string_view input,
+                std::string& output,
+                const std::string& filePath = "",
+                bool logMatches = true) const;
+
+            // Hash of the patterns and replacements; changes whenever the
+            // rules would redact differently, so cached results can be keyed on it.
+            std::uint64_t ruleSetHash() const { return ruleSetHash_; }
+
+            // Returns the largest cut at or before preferred that no match
+            // starting within lookBehind bytes of it crosses, so input[0, cut)
+            // can be redacted without the rest.
+            std::size_t safeSplit(std::string_view input, std::size_t preferred, std::size_t lookBehind) const;
 
         private:
             struct Pattern
@@ -23,7 +43,38 @@ namespace repaddu::security
                 std::string name;
                 };
 
+            void addPattern(const char* source, std::string replacement, std::string name);
+
             std::vector<Pattern> patterns_;
+            std::uint64_t ruleSetHash_ = 14695981039346656037ULL;
+        };
+
+    // Redacts input that arrives in windows. The last overlapBytes of what
+    // has been fed are held back, so a match spanning a window boundary is
+    // redacted as a whole; only matches longer than the overlap can be split.
+    class StreamingRedactor
+        {
+        public:
+            static constexpr std::size_t kDefaultOverlapBytes = 4096;
+
+            StreamingRedactor(const PiiRedactor& redactor,
+                std::string filePath,
+                std::size_t overlapBytes = kDefaultOverlapBytes,
+                bool logMatches = true);
+
+            // Appends to out the redacted text that later input can no longer change.
+            void feed(std::string_view window, std::string& out);
+            // Appends the rest.
+            void finish(std::string& out);
+
+        private:
+            void emit(std::size_t length, std::string& out);
+
+            const PiiRedactor& redactor_;
+            std::string filePath_;
+            std::size_t overlapBytes_;
+            bool logMatches_;
+            std::string pending_;
         };
     }
 
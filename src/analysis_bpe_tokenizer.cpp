@@ -0,0 +1,399 @@
+#include "repaddu/analysis_bpe_tokenizer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace repaddu::analysis
+    {
+    namespace
+        {
+        constexpr std::uint32_t kNoRank = std::numeric_limits<std::uint32_t>::max();
+
+        // Longer pieces (runs of one character class) are merged in segments
+        // of this size; merging is quadratic in the piece length.
+        constexpr std::size_t kMaxPieceBytes = 256;
+
+        // Merged pieces cached per thread before the cache starts over.
+        constexpr std::size_t kMergeCacheEntries = 1 << 16;
+
+        enum ByteClass : std::uint8_t
+            {
+            kOther = 0,
+            kLetter = 1,
+            kDigit = 2,
+            kSpace = 4,
+            kNewline = 8
+            };
+
+        constexpr std::array<std::uint8_t, 256> makeByteClasses()
+            {
+            std::array<std::uint8_t, 256> classes{};
+            for (int byte = 0; byte < 256; ++byte)
+                {
+                if ((byte >= 'A' && byte <= 'Z') || (byte >= 'a' && byte <= 'z') || byte >= 0x80)
+                    {
+                    classes[byte] = kLetter;
+                    }
+                else if (byte >= '0' && byte <= '9')
+                    {
+                    classes[byte] = kDigit;
+                    }
+                }
+            classes[' '] = kSpace;
+            classes['\t'] = kSpace;
+            classes['\v'] = kSpace;
+            classes['\f'] = kSpace;
+            classes['\r'] = kSpace | kNewline;
+            classes['\n'] = kSpace | kNewline;
+            return classes;
+            }
+
+        constexpr std::array<std::uint8_t, 256> kByteClasses = makeByteClasses();
+
+        std::uint8_t classOf(char byte)
+            {
+            return kByteClasses[static_cast<unsigned char>(byte)];
+            }
+
+        char lowerAscii(char byte)
+            {
+            return (byte >= 'A' && byte <= 'Z') ? static_cast<char>(byte - 'A' + 'a') : byte;
+            }
+
+        // End of the piece starting at pos, trying the alternatives of
+        //   's|'t|'re|'ve|'m|'ll|'d (any case) | [^\r\n\p{L}\p{N}]?\p{L}+ | \p{N}{1,3}
+        //   | ' '?[^\s\p{L}\p{N}]+[\r\n]* | \s*[\r\n]+ | \s+(?!\S) | \s+
+        // in order, as the cl100k pattern does.
+        std::size_t pieceEnd(std::string_view text, std::size_t pos)
+            {
+            const std::size_t size = text.size();
+            const char first = text[pos];
+
+            if (first == '\'' && pos + 1 < size)
+                {
+                const char next = lowerAscii(text[pos + 1]);
+                if (next == 's' || next == 't' || next == 'm' || next == 'd')
+                    {
+                    return pos + 2;
+                    }
+                if (pos + 2 < size)
+                    {
+                    const char after = lowerAscii(text[pos + 2]);
+                    if ((next == 'r' && after == 'e') || (next == 'v' && after == 'e') || (next == 'l' && after == 'l'))
+                        {
+                        return pos + 3;
+                        }
+                    }
+                }
+
+            std::size_t end = pos;
+            if ((classOf(first) & (kLetter | kDigit | kNewline)) == 0 && pos + 1 < size
+                && (classOf(text[pos + 1]) & kLetter) != 0)
+                {
+                ++end;
+                }
+            if ((classOf(text[end]) & kLetter) != 0)
+                {
+                while (end < size && (classOf(text[end]) & kLetter) != 0)
+                    {
+                    ++end;
+                    }
+                return end;
+                }
+
+            if ((classOf(first) & kDigit) != 0)
+                {
+                end = pos;
+                while (end < size && end < pos + 3 && (classOf(text[end]) & kDigit) != 0)
+                    {
+                    ++end;
+                    }
+                return end;
+                }
+
+            end = pos;
+            if (first == ' ' && pos + 1 < size && classOf(text[pos + 1]) == kOther)
+                {
+                ++end;
+                }
+            if (classOf(text[end]) == kOther)
+                {
+                while (end < size && classOf(text[end]) == kOther)
+                    {
+                    ++end;
+                    }
+                while (end < size && (classOf(text[end]) & kNewline) != 0)
+                    {
+                    ++end;
+                    }
+                return end;
+                }
+
+            // Whitespace: up to the last line break in the run, else the run
+            // minus the space that the next piece takes as its prefix.
+            end = pos;
+            std::size_t lastNewline = std::string_view::npos;
+            while (end < size && (classOf(text[end]) & kSpace) != 0)
+                {
+                if ((classOf(text[end]) & kNewline) != 0)
+                    {
+                    lastNewline = end;
+                    }
+                ++end;
+                }
+            if (lastNewline != std::string_view::npos)
+                {
+                return lastNewline + 1;
+                }
+            if (end == size || end - pos == 1)
+                {
+                return end;
+                }
+            return end - 1;
+            }
+
+        bool decodeBase64(std::string_view text, std::string& out)
+            {
+            std::uint32_t buffer = 0;
+            int bits = 0;
+            for (const char ch : text)
+                {
+                int value = 0;
+                if (ch >= 'A' && ch <= 'Z')
+                    {
+                    value = ch - 'A';
+                    }
+                else if (ch >= 'a' && ch <= 'z')
+                    {
+                    value = ch - 'a' + 26;
+                    }
+                else if (ch >= '0' && ch <= '9')
+                    {
+                    value = ch - '0' + 52;
+                    }
+                else if (ch == '+')
+                    {
+                    value = 62;
+                    }
+                else if (ch == '/')
+                    {
+                    value = 63;
+                    }
+                else if (ch == '=')
+                    {
+                    break;
+                    }
+                else
+                    {
+                    return false;
+                    }
+                buffer = (buffer << 6) | static_cast<std::uint32_t>(value);
+                bits += 6;
+                if (bits >= 8)
+                    {
+                    bits -= 8;
+                    out.push_back(static_cast<char>((buffer >> bits) & 0xFF));
+                    }
+                }
+            return true;
+            }
+
+        struct MergeCache
+            {
+            std::uint64_t owner = 0;
+            std::unordered_map<std::string, std::uintmax_t> counts;
+            };
+
+        std::atomic<std::uint64_t> nextInstanceId{ 1 };
+        }
+
+    core::RunResult BpeTokenizer::load(const std::filesystem::path& path)
+        {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+            {
+            return { core::ExitCode::io_failure, "Failed to open tokenizer vocabulary: " + path.string() };
+            }
+        std::ostringstream buffer;
+        buffer << stream.rdbuf();
+        const std::string data = buffer.str();
+
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (const char ch : data)
+            {
+            hash ^= static_cast<unsigned char>(ch);
+            hash *= 1099511628211ULL;
+            }
+
+        // Decode everything into one arena first; the rank map keys are
+        // views into it, so it must not grow once they exist.
+        struct Entry
+            {
+            std::size_t offset;
+            std::size_t length;
+            std::uint32_t rank;
+            };
+        std::string arena;
+        std::vector<Entry> entries;
+        std::size_t lineNumber = 0;
+        std::size_t lineStart = 0;
+        while (lineStart < data.size())
+            {
+            std::size_t lineEnd = data.find('\n', lineStart);
+            if (lineEnd == std::string::npos)
+                {
+                lineEnd = data.size();
+                }
+            std::string_view line(data.data() + lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r')
+                {
+                line.remove_suffix(1);
+                }
+            if (line.empty())
+                {
+                continue;
+                }
+
+            const std::size_t space = line.find(' ');
+            const std::size_t offset = arena.size();
+            std::uint64_t rank = 0;
+            bool valid = space != std::string_view::npos && space > 0 && space + 1 < line.size()
+                && decodeBase64(line.substr(0, space), arena) && arena.size() > offset;
+            for (std::size_t index = space + 1; valid && index < line.size(); ++index)
+                {
+                const char ch = line[index];
+                valid = ch >= '0' && ch <= '9';
+                rank = rank * 10 + static_cast<std::uint64_t>(ch - '0');
+                valid = valid && rank < kNoRank;
+                }
+            if (!valid)
+                {
+                return { core::ExitCode::invalid_usage, "Tokenizer vocabulary line " + std::to_string(lineNumber)
+                    + " is not \"<base64 token> <rank>\": " + path.string() };
+                }
+            entries.push_back({ offset, arena.size() - offset, static_cast<std::uint32_t>(rank) });
+            }
+        if (entries.empty())
+            {
+            return { core::ExitCode::invalid_usage, "Tokenizer vocabulary is empty: " + path.string() };
+            }
+
+        arena_ = std::move(arena);
+        ranks_.clear();
+        ranks_.reserve(entries.size());
+        for (const Entry& entry : entries)
+            {
+            ranks_.emplace(std::string_view(arena_.data() + entry.offset, entry.length), entry.rank);
+            }
+        vocabularyHash_ = hash;
+        instanceId_ = nextInstanceId.fetch_add(1);
+        return { core::ExitCode::success, "" };
+        }
+
+    std::vector<std::string_view> BpeTokenizer::splitPieces(std::string_view text)
+        {
+        std::vector<std::string_view> pieces;
+        for (std::size_t pos = 0; pos < text.size();)
+            {
+            const std::size_t end = pieceEnd(text, pos);
+            pieces.push_back(text.substr(pos, end - pos));
+            pos = end;
+            }
+        return pieces;
+        }
+
+    std::uintmax_t BpeTokenizer::countTokens(std::string_view text) const
+        {
+        std::uintmax_t total = 0;
+        for (std::size_t pos = 0; pos < text.size();)
+            {
+            const std::size_t end = pieceEnd(text, pos);
+            for (std::size_t segment = pos; segment < end; segment += kMaxPieceBytes)
+                {
+                total += countPiece(text.substr(segment, std::min(kMaxPieceBytes, end - segment)));
+                }
+            pos = end;
+            }
+        return total;
+        }
+
+    std::uint32_t BpeTokenizer::rankOf(std::string_view bytes) const
+        {
+        const auto it = ranks_.find(bytes);
+        return it == ranks_.end() ? kNoRank : it->second;
+        }
+
+    std::uintmax_t BpeTokenizer::countPiece(std::string_view piece) const
+        {
+        if (piece.size() == 1 || ranks_.count(piece) != 0)
+            {
+            return 1;
+            }
+
+        thread_local MergeCache cache;
+        if (cache.owner != instanceId_ || cache.counts.size() >= kMergeCacheEntries)
+            {
+            cache.owner = instanceId_;
+            cache.counts.clear();
+            }
+        std::string key(piece);
+        const auto it = cache.counts.find(key);
+        if (it != cache.counts.end())
+            {
+            return it->second;
+            }
+        const std::uintmax_t count = mergePiece(piece);
+        cache.counts.emplace(std::move(key), count);
+        return count;
+        }
+
+    std::uintmax_t BpeTokenizer::mergePiece(std::string_view piece) const
+        {
+        // As tiktoken's byte_pair_merge: parts[i] starts a part, and rank[i]
+        // is the rank of joining parts i and i + 1.
+        thread_local std::vector<std::size_t> starts;
+        thread_local std::vector<std::uint32_t> ranks;
+        starts.clear();
+        ranks.clear();
+        for (std::size_t index = 0; index <= piece.size(); ++index)
+            {
+            starts.push_back(index);
+            }
+        auto pairRank = [&](std::size_t part)
+            {
+            if (part + 2 >= starts.size())
+                {
+                return kNoRank;
+                }
+            return rankOf(piece.substr(starts[part], starts[part + 2] - starts[part]));
+            };
+        for (std::size_t part = 0; part < starts.size(); ++part)
+            {
+            ranks.push_back(pairRank(part));
+            }
+
+        while (starts.size() > 2)
+            {
+            const auto lowest = std::min_element(ranks.begin(), ranks.end());
+            if (*lowest == kNoRank)
+                {
+                break;
+                }
+            const std::size_t part = static_cast<std::size_t>(lowest - ranks.begin());
+            starts.erase(starts.begin() + static_cast<std::ptrdiff_t>(part) + 1);
+            ranks.erase(ranks.begin() + static_cast<std::ptrdiff_t>(part) + 1);
+            ranks[part] = pairRank(part);
+            if (part > 0)
+                {
+                ranks[part - 1] = pairRank(part - 1);
+                }
+            }
+        return starts.size() - 1;
+        }
+    }
@@ -1,19 +1,40 @@
 #include "repaddu/analysis_tokens.h"
 
+#include "repaddu/analysis_bpe_tokenizer.h"
+
 #include <cmath>
+#include <cstdio>
 
 namespace repaddu::analysis
     {
-    std::uintmax_t TokenEstimator::estimateTokens(const std::string& content)
+    namespace
+        {
+        std::shared_ptr<const BpeTokenizer>& activeTokenizer()
+            {
+            static std::shared_ptr<const BpeTokenizer> tokenizer;
+            return tokenizer;
+            }
+        }
+
+    std::uintmax_t TokenEstimator::estimateTokens(std::string_view content)
+        {
+        if (const BpeTokenizer* tokenizer = activeTokenizer().get())
+            {
+            return tokenizer->countTokens(content);
+            }
+        return estimateTokensFromSize(content.size());
+        }
+
+    std::uintmax_t TokenEstimator::estimateTokensFromSize(std::uintmax_t sizeBytes)
         {
-        if (content.empty())
+        if (sizeBytes == 0)
             {
             return 0;
             }
 
         // Standard heuristic: 1 token ~= 4 characters for code/text.
         // We use double to avoid integer truncation before the final cast.
-        double estimated = static_cast<double>(content.size()) / 4.0;
+        double estimated = static_cast<double>(sizeBytes) / 4.0;
         
         // Ensure at least 1 token if content is not empty
         if (estimated < 1.0)
@@ -23,4 +44,35 @@ namespace repaddu::analysis
             
         return static_cast<std::uintmax_t>(std::ceil(estimated));
         }
+
+    void TokenEstimator::useTokenizer(std::shared_ptr<const BpeTokenizer> tokenizer)
+        {
+        activeTokenizer() = std::move(tokenizer);
+        }
+
+    std::string TokenEstimator::tokenizerId()
+        {
+        const BpeTokenizer* tokenizer = activeTokenizer().get();
+        if (!tokenizer)
+            {
+            return "chars4-v1";
+            }
+        char hash[17];
+        std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(tokenizer->vocabularyHash()));
+        return std::string("bpe-") + hash;
+        }
+
+    void TokenCounter::add(std::string_view content)
+        {
+        bytes_ += static_cast<std::uintmax_t>(content.size());
+        if (const BpeTokenizer* tokenizer = activeTokenizer().get())
+            {
+            tokens_ += tokenizer->countTokens(content);
+            }
+        }
+
+    std::uintmax_t TokenCounter::total() const
+        {
+        return activeTokenizer() ? tokens_ : TokenEstimator::estimateTokensFromSize(bytes_);
+        }
     }
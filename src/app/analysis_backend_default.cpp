@@ -5,7 +5,7 @@
 namespace repaddu::app
     {
     core::RunResult DefaultAnalysisBackend::populateGraph(const core::CliOptions&,
-        const std::vector<core::FileEntry>&,
+        const core::FileTable&,
         const std::vector<std::size_t>&,
         analysis::AnalysisGraph&)
         {
@@ -10,7 +10,7 @@
 namespace repaddu::app
     {
     core::RunResult buildAnalyzeOnlyReport(const core::CliOptions& effectiveOptions,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<std::size_t>& includedIndices,
         std::string& outReport)
         {
@@ -19,7 +19,7 @@ namespace repaddu::app
         }
 
     core::RunResult buildAnalyzeOnlyReport(const core::CliOptions& effectiveOptions,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<std::size_t>& includedIndices,
         AnalysisBackend& backend,
         std::string& outReport)
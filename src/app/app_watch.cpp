@@ -0,0 +1,323 @@
+#include "repaddu/app/app_watch.h"
+
+#include "repaddu/app/fs_services.h"
+#include "repaddu/io_ignore.h"
+#include "repaddu/io_traversal_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace repaddu::app
+    {
+    namespace
+        {
+        bool hasPrefixDirectory(const std::string& path, const std::string& directory)
+            {
+            return path == directory
+                || (path.size() > directory.size() && path.compare(0, directory.size(), directory) == 0
+                    && path[directory.size()] == '/');
+            }
+
+        bool isHiddenPath(const std::string& path)
+            {
+            std::size_t start = 0;
+            while (start < path.size())
+                {
+                if (path[start] == '.')
+                    {
+                    return true;
+                    }
+                const std::size_t slash = path.find('/', start);
+                if (slash == std::string::npos)
+                    {
+                    break;
+                    }
+                start = slash + 1;
+                }
+            return false;
+            }
+
+        // Output directory relative to the input root, or "" when it lies outside.
+        std::string outputPrefix(const core::CliOptions& options)
+            {
+            std::error_code errorCode;
+            const std::filesystem::path input = std::filesystem::weakly_canonical(options.inputPath, errorCode);
+            const std::filesystem::path output = std::filesystem::weakly_canonical(options.outputPath, errorCode);
+            const std::string relative = output.lexically_relative(input).generic_string();
+            if (relative.empty() || relative == "." || relative.rfind("..", 0) == 0)
+                {
+                return {};
+                }
+            return relative;
+            }
+
+        // Loads the ignore files from the root down to the parent of relativePath;
+        // a new file that is ignored there cannot change the listing.
+        bool ignoredByRules(const core::CliOptions& options, const std::string& relativePath, bool isDirectory)
+            {
+            if (!options.useIgnoreFiles)
+                {
+                return false;
+                }
+            io::IgnoreLevelPtr level = io::loadIgnoreLevel(nullptr, options.inputPath, "");
+            for (std::size_t slash = relativePath.find('/'); slash != std::string::npos;
+                slash = relativePath.find('/', slash + 1))
+                {
+                const std::string directory = relativePath.substr(0, slash);
+                if (io::isIgnored(level.get(), directory, true))
+                    {
+                    return true;
+                    }
+                level = io::loadIgnoreLevel(level, options.inputPath / directory, directory);
+                }
+            return io::isIgnored(level.get(), relativePath, isDirectory);
+            }
+
+        void invalidateDirectory(format::OutputCache& cache, const std::string& directory)
+            {
+            std::vector<std::string> affected;
+            for (const auto& measure : cache.measures)
+                {
+                if (hasPrefixDirectory(measure.first, directory))
+                    {
+                    affected.push_back(measure.first);
+                    }
+                }
+            for (const std::string& path : affected)
+                {
+                cache.invalidate(path);
+                }
+            }
+        }
+
+    WatchFileIndex indexWatchedFiles(const io::TraversalResult& traversal)
+        {
+        WatchFileIndex fileIndices;
+        fileIndices.reserve(traversal.files.size());
+        for (std::size_t index = 0; index < traversal.files.size(); ++index)
+            {
+            fileIndices.emplace(traversal.files.relativePath(index), index);
+            }
+        return fileIndices;
+        }
+
+    WatchUpdate applyWatchChanges(const core::CliOptions& options,
+        const std::vector<io::WatchChange>& changes,
+        io::TraversalResult& traversal,
+        const WatchFileIndex& fileIndices,
+        format::OutputCache& cache)
+        {
+        WatchUpdate update;
+        const std::string excludedPrefix = outputPrefix(options);
+
+        for (const io::WatchChange& change : changes)
+            {
+            if (change.overflow)
+                {
+                cache.measures.clear();
+                update.rescanRequired = true;
+                continue;
+                }
+
+            const std::string& relative = change.relativePath;
+            if (relative.empty() || hasPrefixDirectory(relative, ".git")
+                || (!excludedPrefix.empty() && hasPrefixDirectory(relative, excludedPrefix)))
+                {
+                continue;
+                }
+
+            const std::size_t slash = relative.rfind('/');
+            const std::string name = slash == std::string::npos ? relative : relative.substr(slash + 1);
+            const auto& ignoreNames = io::ignoreFileNames();
+            if (options.useIgnoreFiles && std::find(ignoreNames.begin(), ignoreNames.end(), name) != ignoreNames.end())
+                {
+                update.rescanRequired = true;
+                continue;
+                }
+            if (!options.includeHidden && isHiddenPath(relative))
+                {
+                continue;
+                }
+
+            if (change.isDirectory)
+                {
+                if (change.structural)
+                    {
+                    invalidateDirectory(cache, relative);
+                    update.rescanRequired = true;
+                    }
+                continue;
+                }
+
+            cache.invalidate(relative);
+
+            const std::filesystem::path absolutePath = options.inputPath / relative;
+            std::error_code errorCode;
+            const std::filesystem::file_status status = options.followSymlinks
+                ? std::filesystem::status(absolutePath, errorCode)
+                : std::filesystem::symlink_status(absolutePath, errorCode);
+            const bool isRegular = !errorCode && std::filesystem::is_regular_file(status);
+
+            auto known = fileIndices.find(relative);
+            if (known == fileIndices.end())
+                {
+                const bool exists = !errorCode && std::filesystem::exists(status);
+                if (exists && !ignoredByRules(options, relative, std::filesystem::is_directory(status)))
+                    {
+                    update.rescanRequired = true;
+                    }
+                continue;
+                }
+
+            if (!isRegular)
+                {
+                update.rescanRequired = true;
+                continue;
+                }
+
+            const std::uintmax_t sizeBytes = std::filesystem::file_size(absolutePath, errorCode);
+            if (errorCode)
+                {
+                update.rescanRequired = true;
+                continue;
+                }
+            const std::uintmax_t previousBytes = traversal.files.sizeBytes(known->second);
+            if (sizeBytes != previousBytes
+                && (options.groupBy == core::GroupingMode::size
+                    || (!options.forceLargeFiles && (sizeBytes > options.maxFileSize) != (previousBytes > options.maxFileSize))))
+                {
+                update.regroupRequired = true;
+                }
+            traversal.files.setSizeBytes(known->second, sizeBytes);
+            traversal.files.setBinaryState(known->second, core::BinaryState::unknown);
+            ++update.filesChanged;
+            }
+        return update;
+        }
+
+    core::RunResult runWatch(const core::CliOptions& options,
+        ui::UserInterface& ui,
+        const EmitOutputsFunction& emitOutputs)
+        {
+        if (!io::DirectoryWatcher::available())
+            {
+            return { core::ExitCode::invalid_usage, "--watch is only supported on Linux." };
+            }
+
+        io::DirectoryWatcher watcher;
+        core::RunResult openResult = watcher.open(options.inputPath);
+        if (openResult.code != core::ExitCode::success)
+            {
+            return openResult;
+            }
+
+        // Rescans reuse an in-memory snapshot so only directories whose mtime
+        // moved are listed again.
+        const bool useSnapshot = options.traversalSource == core::TraversalSource::walk;
+        const std::unique_ptr<RepositoryTraversalService> service = makeTraversalService(options);
+        io::TraversalSnapshot snapshot;
+        io::TraversalResult traversal;
+        WatchFileIndex fileIndices;
+        auto rescan = [&]() -> core::RunResult
+            {
+            core::RunResult result;
+            if (!useSnapshot)
+                {
+                result = service->traverse(options, traversal);
+                }
+            else
+                {
+                io::TraversalSnapshot next;
+                result = io::traverseRepositoryIncremental(options, snapshot, traversal, next);
+                if (result.code == core::ExitCode::success)
+                    {
+                    snapshot = std::move(next);
+                    }
+                }
+            fileIndices = result.code == core::ExitCode::success ? indexWatchedFiles(traversal) : WatchFileIndex();
+            return result;
+            };
+
+        const std::string excludedPrefix = outputPrefix(options);
+        auto watchDirectories = [&]()
+            {
+            watcher.addDirectory("");
+            for (const std::filesystem::path& directory : traversal.directories)
+                {
+                const std::string relative = directory.generic_string();
+                if (excludedPrefix.empty() || !hasPrefixDirectory(relative, excludedPrefix))
+                    {
+                    watcher.addDirectory(relative);
+                    }
+                }
+            };
+
+        ui.startProgress("Scanning repository", 0);
+        core::RunResult traversalResult = rescan();
+        ui.endProgress();
+        if (traversalResult.code != core::ExitCode::success)
+            {
+            return traversalResult;
+            }
+        watchDirectories();
+
+        format::OutputCache cache;
+        core::RunResult emitResult = emitOutputs(traversal, cache, true);
+        if (emitResult.code != core::ExitCode::success)
+            {
+            return emitResult;
+            }
+        ui.logInfo("Watching " + std::to_string(traversal.directories.size() + 1) + " directories for changes.");
+
+        std::vector<io::WatchChange> changes;
+        while (true)
+            {
+            core::RunResult waitResult = watcher.waitForChanges(-1, options.watchDebounceMs, changes);
+            if (waitResult.code != core::ExitCode::success)
+                {
+                return waitResult;
+                }
+            if (changes.empty())
+                {
+                continue;
+                }
+
+            const auto started = std::chrono::steady_clock::now();
+            const WatchUpdate update = applyWatchChanges(options, changes, traversal, fileIndices, cache);
+            if (update.rescanRequired)
+                {
+                traversalResult = rescan();
+                if (traversalResult.code != core::ExitCode::success)
+                    {
+                    return traversalResult;
+                    }
+                watchDirectories();
+                }
+            else if (update.filesChanged == 0)
+                {
+                continue;
+                }
+
+            emitResult = emitOutputs(traversal, cache, update.rescanRequired || update.regroupRequired);
+            if (emitResult.code == core::ExitCode::io_failure)
+                {
+                return emitResult;
+                }
+            if (emitResult.code != core::ExitCode::success)
+                {
+                // Constraint violations (for example --max-bytes) may be fixed by
+                // the next edit, so keep watching.
+                ui.logWarning(emitResult.message);
+                continue;
+                }
+
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - started);
+            ui.logInfo("Rewrote " + std::to_string(cache.outputsWritten) + " output(s), kept "
+                + std::to_string(cache.outputsSkipped) + " in " + std::to_string(elapsed.count()) + " ms.");
+            }
+        }
+    }
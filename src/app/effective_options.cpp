@@ -5,7 +5,7 @@
 namespace repaddu::app
     {
     core::CliOptions buildEffectiveOptions(const core::CliOptions& requestedOptions,
-        const std::vector<core::FileEntry>& files)
+        const core::FileTable& files)
         {
         core::CliOptions effectiveOptions = requestedOptions;
         if (effectiveOptions.language.empty() || effectiveOptions.buildSystem.empty())
@@ -1,12 +1,515 @@
 #include "repaddu/app/fs_services.h"
 
-#include "repaddu/io_traversal.h"
+#include "repaddu/io_traversal_cache.h"
+#include "repaddu/language_profiles.h"
+#include "repaddu/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
 
 namespace repaddu::app
     {
+    namespace
+        {
+        constexpr std::size_t kIndexHeaderBytes = 12;
+        constexpr std::size_t kIndexChecksumBytes = 20;
+        // ctime, mtime (8 bytes each), then dev, ino, mode, uid, gid, size,
+        // a 20 byte object id and the 16 bit flags.
+        constexpr std::size_t kIndexEntryFixedBytes = 62;
+        constexpr std::uint16_t kFlagExtended = 0x4000;
+        constexpr std::uint16_t kFlagNameMask = 0x0fff;
+        constexpr std::uint16_t kExtendedFlagSkipWorktree = 0x4000;
+
+        constexpr std::uint32_t kModeTypeMask = 0170000;
+        constexpr std::uint32_t kModeRegular = 0100000;
+        constexpr std::uint32_t kModeSymlink = 0120000;
+
+        core::RunResult traverseWithSnapshot(const core::CliOptions& options, io::TraversalResult& traversal)
+            {
+            io::TraversalSnapshot previous;
+            const core::RunResult loadResult = io::loadTraversalSnapshot(options.traversalCachePath, previous);
+            if (loadResult.code != core::ExitCode::success)
+                {
+                LogWarn(loadResult.message + " Falling back to a full traversal.");
+                previous = io::TraversalSnapshot{};
+                }
+
+            io::TraversalSnapshot next;
+            io::IncrementalTraversalStats stats;
+            const core::RunResult traversalResult = io::traverseRepositoryIncremental(options, previous, traversal, next, &stats);
+            if (traversalResult.code != core::ExitCode::success)
+                {
+                return traversalResult;
+                }
+
+            LogInfo("Traversal cache: listed " + std::to_string(stats.directoriesListed)
+                + " directories, reused " + std::to_string(stats.directoriesReused) + " listings.");
+
+            const core::RunResult saveResult = io::saveTraversalSnapshot(options.traversalCachePath, next);
+            if (saveResult.code != core::ExitCode::success)
+                {
+                LogWarn(saveResult.message);
+                }
+            return traversalResult;
+            }
+
+        std::uint32_t readBigEndian32(const char* data)
+            {
+            const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+            return (static_cast<std::uint32_t>(bytes[0]) << 24) | (static_cast<std::uint32_t>(bytes[1]) << 16)
+                | (static_cast<std::uint32_t>(bytes[2]) << 8) | static_cast<std::uint32_t>(bytes[3]);
+            }
+
+        std::uint16_t readBigEndian16(const char* data)
+            {
+            const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+            return static_cast<std::uint16_t>((bytes[0] << 8) | bytes[1]);
+            }
+
+        // Offset encoding used by index v4 for the number of bytes to strip
+        // from the previous path.
+        bool readPrefixVarint(std::string_view data, std::size_t& offset, std::size_t& outValue)
+            {
+            if (offset >= data.size())
+                {
+                return false;
+                }
+            unsigned char byte = static_cast<unsigned char>(data[offset++]);
+            std::size_t value = byte & 0x7f;
+            while (byte & 0x80)
+                {
+                if (offset >= data.size())
+                    {
+                    return false;
+                    }
+                byte = static_cast<unsigned char>(data[offset++]);
+                value = ((value + 1) << 7) | (byte & 0x7f);
+                }
+            outValue = value;
+            return true;
+            }
+
+        bool readTextFile(const std::filesystem::path& path, std::string& outContent)
+            {
+            std::ifstream stream(path, std::ios::binary);
+            if (!stream)
+                {
+                return false;
+                }
+            std::ostringstream buffer;
+            buffer << stream.rdbuf();
+            outContent = buffer.str();
+            return true;
+            }
+
+        // Resolves ".git" both as a directory and as a "gitdir: <path>" file
+        // (worktrees and submodules).
+        std::filesystem::path resolveIndexPath(const std::filesystem::path& workTree)
+            {
+            const std::filesystem::path dotGit = workTree / ".git";
+            std::error_code errorCode;
+            if (std::filesystem::is_directory(dotGit, errorCode))
+                {
+                return dotGit / "index";
+                }
+
+            std::string content;
+            if (!readTextFile(dotGit, content) || content.rfind("gitdir:", 0) != 0)
+                {
+                return {};
+                }
+            std::string target = content.substr(7);
+            const std::size_t first = target.find_first_not_of(" \t");
+            const std::size_t last = target.find_last_not_of(" \t\r\n");
+            if (first == std::string::npos)
+                {
+                return {};
+                }
+            std::filesystem::path gitDir = target.substr(first, last - first + 1);
+            if (gitDir.is_relative())
+                {
+                gitDir = workTree / gitDir;
+                }
+            return gitDir / "index";
+            }
+
+        bool isHiddenPath(std::string_view path)
+            {
+            std::size_t start = 0;
+            while (start < path.size())
+                {
+                if (path[start] == '.')
+                    {
+                    return true;
+                    }
+                const std::size_t slash = path.find('/', start);
+                if (slash == std::string_view::npos)
+                    {
+                    break;
+                    }
+                start = slash + 1;
+                }
+            return false;
+            }
+
+        // The order sortTraversalResult gives a walked tree; native() is a
+        // reference, so comparisons do not allocate.
+        void sortPaths(std::vector<std::filesystem::path>& paths)
+            {
+            std::sort(paths.begin(), paths.end(),
+                [](const std::filesystem::path& a, const std::filesystem::path& b)
+                {
+                return a.native() < b.native();
+                });
+            }
+
+        // Fills sizes from the work tree and drops entries whose file has
+        // disappeared since it was staged.
+        void statTrackedFiles(const core::CliOptions& options, core::FileTable& files)
+            {
+            std::vector<char> missing(files.size(), 0);
+            auto statRange = [&](std::size_t begin, std::size_t end)
+                {
+                for (std::size_t index = begin; index < end; ++index)
+                    {
+                    const std::filesystem::path absolutePath = files.absolutePath(index);
+                    std::error_code errorCode;
+                    const std::filesystem::file_status status = options.followSymlinks
+                        ? std::filesystem::status(absolutePath, errorCode)
+                        : std::filesystem::symlink_status(absolutePath, errorCode);
+                    if (errorCode || !std::filesystem::is_regular_file(status))
+                        {
+                        missing[index] = 1;
+                        continue;
+                        }
+                    const std::uintmax_t sizeBytes = std::filesystem::file_size(absolutePath, errorCode);
+                    if (errorCode)
+                        {
+                        missing[index] = 1;
+                        continue;
+                        }
+                    files.setSizeBytes(index, sizeBytes);
+                    }
+                };
+
+            std::size_t threadCount = 1;
+            if (options.parallelTraversal)
+                {
+                const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+                threadCount = std::max<std::size_t>(1, hardwareThreads == 0 ? 1 : hardwareThreads);
+                }
+            threadCount = std::min(threadCount, std::max<std::size_t>(1, files.size() / 64));
+
+            if (threadCount == 1)
+                {
+                statRange(0, files.size());
+                }
+            else
+                {
+                std::vector<std::thread> workers;
+                workers.reserve(threadCount);
+                const std::size_t stride = (files.size() + threadCount - 1) / threadCount;
+                for (std::size_t begin = 0; begin < files.size(); begin += stride)
+                    {
+                    workers.emplace_back(statRange, begin, std::min(files.size(), begin + stride));
+                    }
+                for (auto& worker : workers)
+                    {
+                    worker.join();
+                    }
+                }
+
+            files.removeIf([&](std::size_t index)
+                {
+                return missing[index] != 0;
+                });
+            }
+
+        void buildTraversal(const core::CliOptions& options,
+            const std::vector<GitIndexEntry>& entries,
+            io::TraversalResult& traversal)
+            {
+            std::vector<std::string> buildFileNamesLower;
+            for (const std::string& name : core::resolveBuildFileNames(options))
+                {
+                buildFileNamesLower.push_back(core::toLowerCopy(name));
+                }
+
+            traversal.files.reserve(entries.size());
+            for (const GitIndexEntry& entry : entries)
+                {
+                const std::uint32_t type = entry.mode & kModeTypeMask;
+                if (type != kModeRegular && !(type == kModeSymlink && options.followSymlinks))
+                    {
+                    continue; // Gitlinks, sparse directories and unfollowed symlinks.
+                    }
+                if (!options.includeHidden && isHiddenPath(entry.path))
+                    {
+                    continue;
+                    }
+
+                traversal.files.add(entry.path, entry.sizeBytes);
+                }
+
+            statTrackedFiles(options, traversal.files);
+
+            // Every ancestor of a file's directory is a directory too; each
+            // interned directory is expanded once per file that uses it.
+            std::unordered_set<std::string> directories;
+            for (std::size_t index = 0; index < traversal.files.size(); ++index)
+                {
+                const std::string_view directory = traversal.files.directory(index);
+                if (!directory.empty() && directories.count(std::string(directory)) == 0)
+                    {
+                    for (std::size_t slash = directory.find('/'); slash != std::string_view::npos;
+                        slash = directory.find('/', slash + 1))
+                        {
+                        directories.emplace(directory.substr(0, slash));
+                        }
+                    directories.emplace(directory);
+                    }
+
+                const std::string filenameLower = core::toLowerCopy(traversal.files.name(index));
+                if (filenameLower == "cmakelists.txt")
+                    {
+                    traversal.cmakeLists.push_back(traversal.files.relativePath(index));
+                    }
+                if (std::find(buildFileNamesLower.begin(), buildFileNamesLower.end(), filenameLower)
+                    != buildFileNamesLower.end())
+                    {
+                    traversal.buildFiles.push_back(traversal.files.relativePath(index));
+                    }
+                }
+            traversal.directories.assign(directories.begin(), directories.end());
+            }
+
+        // Adds walked files that the index does not track.
+        void mergeUntracked(io::TraversalResult& traversal, io::TraversalResult& walked)
+            {
+            std::unordered_set<std::string> tracked;
+            tracked.reserve(traversal.files.size());
+            for (std::size_t index = 0; index < traversal.files.size(); ++index)
+                {
+                tracked.insert(traversal.files.relativePath(index));
+                }
+            std::unordered_set<std::string> knownDirectories;
+            for (const std::filesystem::path& directory : traversal.directories)
+                {
+                knownDirectories.insert(directory.generic_string());
+                }
+
+            for (std::size_t index = 0; index < walked.files.size(); ++index)
+                {
+                const std::string relative = walked.files.relativePath(index);
+                if (tracked.count(relative) == 0)
+                    {
+                    traversal.files.add(relative, walked.files.sizeBytes(index));
+                    }
+                }
+            for (std::filesystem::path& directory : walked.directories)
+                {
+                if (knownDirectories.insert(directory.generic_string()).second)
+                    {
+                    traversal.directories.push_back(std::move(directory));
+                    }
+                }
+            auto mergePaths = [&](std::vector<std::filesystem::path>& target, std::vector<std::filesystem::path>& source)
+                {
+                std::unordered_set<std::string> known;
+                for (const std::filesystem::path& path : target)
+                    {
+                    known.insert(path.generic_string());
+                    }
+                for (std::filesystem::path& path : source)
+                    {
+                    if (known.insert(path.generic_string()).second)
+                        {
+                        target.push_back(std::move(path));
+                        }
+                    }
+                };
+            mergePaths(traversal.cmakeLists, walked.cmakeLists);
+            mergePaths(traversal.buildFiles, walked.buildFiles);
+            }
+        }
+
     core::RunResult DefaultRepositoryTraversalService::traverse(const core::CliOptions& options,
         io::TraversalResult& traversal)
         {
+        if (!options.traversalCachePath.empty())
+            {
+            return traverseWithSnapshot(options, traversal);
+            }
         return io::traverseRepository(options, traversal);
         }
+
+    core::RunResult parseGitIndex(std::string_view data, std::vector<GitIndexEntry>& outEntries)
+        {
+        outEntries.clear();
+        const core::RunResult corrupt{ core::ExitCode::io_failure, "Git index is corrupt." };
+        if (data.size() < kIndexHeaderBytes + kIndexChecksumBytes || data.substr(0, 4) != "DIRC")
+            {
+            return corrupt;
+            }
+        const std::uint32_t version = readBigEndian32(data.data() + 4);
+        if (version < 2 || version > 4)
+            {
+            return { core::ExitCode::io_failure, "Unsupported git index version " + std::to_string(version) + "." };
+            }
+        const std::uint32_t count = readBigEndian32(data.data() + 8);
+        const std::size_t end = data.size() - kIndexChecksumBytes;
+
+        outEntries.reserve(count);
+        std::string previousPath;
+        std::size_t offset = kIndexHeaderBytes;
+        for (std::uint32_t index = 0; index < count; ++index)
+            {
+            const std::size_t entryStart = offset;
+            if (end - offset < kIndexEntryFixedBytes)
+                {
+                return corrupt;
+                }
+            const char* fixed = data.data() + offset;
+            GitIndexEntry entry;
+            entry.mtimeNs = static_cast<std::int64_t>(readBigEndian32(fixed + 8)) * 1'000'000'000
+                + readBigEndian32(fixed + 12);
+            entry.mode = readBigEndian32(fixed + 24);
+            entry.sizeBytes = readBigEndian32(fixed + 36);
+            const std::uint16_t flags = readBigEndian16(fixed + 60);
+            offset += kIndexEntryFixedBytes;
+
+            std::uint16_t extendedFlags = 0;
+            if (version >= 3 && (flags & kFlagExtended) != 0)
+                {
+                if (end - offset < 2)
+                    {
+                    return corrupt;
+                    }
+                extendedFlags = readBigEndian16(data.data() + offset);
+                offset += 2;
+                }
+
+            if (version == 4)
+                {
+                std::size_t strip = 0;
+                if (!readPrefixVarint(data, offset, strip) || strip > previousPath.size())
+                    {
+                    return corrupt;
+                    }
+                const std::size_t nameEnd = data.find('\0', offset);
+                if (nameEnd == std::string_view::npos || nameEnd >= end)
+                    {
+                    return corrupt;
+                    }
+                previousPath.resize(previousPath.size() - strip);
+                previousPath.append(data.data() + offset, nameEnd - offset);
+                offset = nameEnd + 1;
+                }
+            else
+                {
+                const std::size_t nameEnd = data.find('\0', offset);
+                if (nameEnd == std::string_view::npos || nameEnd >= end)
+                    {
+                    return corrupt;
+                    }
+                const std::size_t nameLength = flags & kFlagNameMask;
+                if (nameLength != kFlagNameMask && nameLength != nameEnd - offset)
+                    {
+                    return corrupt;
+                    }
+                previousPath.assign(data.data() + offset, nameEnd - offset);
+                // Entries are NUL padded to a multiple of eight bytes.
+                offset = entryStart + ((nameEnd - entryStart + 8) & ~static_cast<std::size_t>(7));
+                if (offset > end)
+                    {
+                    return corrupt;
+                    }
+                }
+
+            if ((extendedFlags & kExtendedFlagSkipWorktree) != 0)
+                {
+                continue; // Not checked out (sparse checkout).
+                }
+            if (!outEntries.empty() && outEntries.back().path == previousPath)
+                {
+                continue; // Further merge stages of a conflicted path.
+                }
+            entry.path = previousPath;
+            outEntries.push_back(std::move(entry));
+            }
+
+        // A split index keeps part of its entries in a shared file that is not
+        // read here, so the listing would be incomplete.
+        while (end - offset >= 8)
+            {
+            const std::string_view signature = data.substr(offset, 4);
+            const std::uint32_t size = readBigEndian32(data.data() + offset + 4);
+            if (signature == "link")
+                {
+                return { core::ExitCode::io_failure, "Split git indexes are not supported." };
+                }
+            if (end - offset - 8 < size)
+                {
+                return corrupt;
+                }
+            offset += 8 + static_cast<std::size_t>(size);
+            }
+        return { core::ExitCode::success, "" };
+        }
+
+    core::RunResult GitIndexTraversalService::traverse(const core::CliOptions& options,
+        io::TraversalResult& traversal)
+        {
+        traversal = io::TraversalResult{};
+        traversal.files.setRoot(options.inputPath);
+        DefaultRepositoryTraversalService fallback;
+
+        const std::filesystem::path indexPath = resolveIndexPath(options.inputPath);
+        std::string data;
+        if (indexPath.empty() || !readTextFile(indexPath, data))
+            {
+            LogWarn("No git index found under " + options.inputPath.string() + "; walking the directory tree.");
+            return fallback.traverse(options, traversal);
+            }
+
+        std::vector<GitIndexEntry> entries;
+        const core::RunResult parseResult = parseGitIndex(data, entries);
+        if (parseResult.code != core::ExitCode::success)
+            {
+            LogWarn(parseResult.message + " Walking the directory tree.");
+            return fallback.traverse(options, traversal);
+            }
+
+        buildTraversal(options, entries, traversal);
+
+        if (options.includeUntracked)
+            {
+            io::TraversalResult walked;
+            const core::RunResult walkResult = fallback.traverse(options, walked);
+            if (walkResult.code != core::ExitCode::success)
+                {
+                return walkResult;
+                }
+            mergeUntracked(traversal, walked);
+            }
+
+        traversal.files.sortByPath();
+        sortPaths(traversal.directories);
+        sortPaths(traversal.cmakeLists);
+        sortPaths(traversal.buildFiles);
+        return { core::ExitCode::success, "" };
+        }
+
+    std::unique_ptr<RepositoryTraversalService> makeTraversalService(const core::CliOptions& options)
+        {
+        if (options.traversalSource == core::TraversalSource::gitIndex)
+            {
+            return std::make_unique<GitIndexTraversalService>();
+            }
+        return std::make_unique<DefaultRepositoryTraversalService>();
+        }
     }
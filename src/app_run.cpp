@@ -1,6 +1,9 @@
 #include "repaddu/app_run.h"
 
+#include "repaddu/analysis_bpe_tokenizer.h"
+#include "repaddu/analysis_tokens.h"
 #include "repaddu/app_analyze.h"
+#include "repaddu/app/app_watch.h"
 #include "repaddu/app/effective_options.h"
 #include "repaddu/app/fs_services.h"
 #include "repaddu/config_generator.h"
@@ -9,94 +12,202 @@
 #include "repaddu/format_writer.h"
 #include "repaddu/grouping_component_map.h"
 #include "repaddu/grouping_strategies.h"
+#include "repaddu/io_binary.h"
 
 #include <iostream>
+#include <memory>
+#include <numeric>
 
 namespace repaddu::app
     {
-    core::RunResult run(const core::CliOptions& options, ui::UserInterface& ui)
+    namespace
         {
-        if (options.generateConfig)
+        // What writeOutputs needs beyond the traversal. Under --watch it is
+        // kept between change batches and rebuilt only when files are added,
+        // removed or resized across a grouping boundary.
+        struct PreparedOutputs
             {
-            core::RunResult result = config::generateDefaultConfig(options.configPath);
-            ui.logInfo(result.message);
-            return result;
-            }
-
-        io::TraversalResult traversal;
-        DefaultRepositoryTraversalService traversalService;
-        ui.startProgress("Scanning repository", 0);
-        core::RunResult traversalResult = traversalService.traverse(options, traversal);
-        ui.endProgress();
-
-        if (traversalResult.code != core::ExitCode::success)
+            bool valid = false;
+            core::CliOptions effectiveOptions;
+            std::vector<core::OutputChunk> chunks;
+            std::string treeListing;
+            };
+
+        core::RunResult groupTraversal(const core::CliOptions& effectiveOptions,
+            const io::TraversalResult& traversal,
+            ui::UserInterface& ui,
+            grouping::GroupingResult& outGrouped)
             {
-            return traversalResult;
+            grouping::ComponentMap componentMap;
+            const grouping::ComponentMap* componentMapPtr = nullptr;
+            if (effectiveOptions.groupBy == core::GroupingMode::component)
+                {
+                core::RunResult mapResult = grouping::loadComponentMap(effectiveOptions.componentMapPath, componentMap);
+                if (mapResult.code != core::ExitCode::success)
+                    {
+                    return mapResult;
+                    }
+                componentMapPtr = &componentMap;
+                }
+
+            core::RunResult groupingResult;
+            ui.startProgress("Grouping files", 0);
+            outGrouped = grouping::filterAndGroupFiles(effectiveOptions, traversal.files, componentMapPtr, groupingResult);
+            ui.endProgress();
+            return groupingResult;
             }
 
-        if (options.scanLanguages)
+        core::RunResult prepareOutputs(const core::CliOptions& options,
+            const io::TraversalResult& traversal,
+            ui::UserInterface& ui,
+            PreparedOutputs& outPrepared)
             {
-            const std::string report = format::renderLanguageReport(options, traversal.files);
-            std::cout << report;
+            outPrepared.valid = false;
+            outPrepared.effectiveOptions = buildEffectiveOptions(options, traversal.files);
+
+            grouping::GroupingResult grouped;
+            core::RunResult groupingResult = groupTraversal(outPrepared.effectiveOptions, traversal, ui, grouped);
+            if (groupingResult.code != core::ExitCode::success)
+                {
+                return groupingResult;
+                }
+
+            core::RunResult chunkResult;
+            outPrepared.chunks = grouping::chunkGroups(outPrepared.effectiveOptions, traversal.files, grouped.groups, chunkResult);
+            if (chunkResult.code != core::ExitCode::success)
+                {
+                return chunkResult;
+                }
+
+            std::vector<std::filesystem::path> treeFiles;
+            treeFiles.reserve(traversal.files.size());
+            for (std::size_t index = 0; index < traversal.files.size(); ++index)
+                {
+                treeFiles.emplace_back(traversal.files.relativePath(index));
+                }
+            outPrepared.treeListing = format::renderTree(traversal.directories, treeFiles);
+            outPrepared.valid = true;
             return { core::ExitCode::success, "" };
             }
 
-        const core::CliOptions effectiveOptions = buildEffectiveOptions(options, traversal.files);
-
-        grouping::ComponentMap componentMap;
-        const grouping::ComponentMap* componentMapPtr = nullptr;
-        if (effectiveOptions.groupBy == core::GroupingMode::component)
+        core::RunResult renderTraversal(const core::CliOptions& options,
+            io::TraversalResult& traversal,
+            ui::UserInterface& ui,
+            format::OutputCache* cache,
+            PreparedOutputs* prepared)
             {
-            core::RunResult mapResult = grouping::loadComponentMap(effectiveOptions.componentMapPath, componentMap);
-            if (mapResult.code != core::ExitCode::success)
+            if (options.scanLanguages)
                 {
-                return mapResult;
+                if (!options.includeBinaries)
+                    {
+                    std::vector<std::size_t> allIndices(traversal.files.size());
+                    std::iota(allIndices.begin(), allIndices.end(), std::size_t{ 0 });
+                    io::resolveBinaryStates(traversal.files, allIndices);
+                    }
+                const std::string report = format::renderLanguageReport(options, traversal.files);
+                std::cout << report;
+                return { core::ExitCode::success, "" };
                 }
-            componentMapPtr = &componentMap;
-            }
 
-        core::RunResult groupingResult;
-        ui.startProgress("Grouping files", 0);
-        grouping::GroupingResult grouped = grouping::filterAndGroupFiles(effectiveOptions, traversal.files, componentMapPtr, groupingResult);
-        ui.endProgress();
+            if (options.analyzeOnly)
+                {
+                const core::CliOptions effectiveOptions = buildEffectiveOptions(options, traversal.files);
+                grouping::GroupingResult grouped;
+                core::RunResult groupingResult = groupTraversal(effectiveOptions, traversal, ui, grouped);
+                if (groupingResult.code != core::ExitCode::success)
+                    {
+                    return groupingResult;
+                    }
+                // Nothing reads the content here, so sniff the survivors directly.
+                io::resolveBinaryStates(traversal.files, grouped.includedIndices);
+                if (!effectiveOptions.includeBinaries)
+                    {
+                    std::erase_if(grouped.includedIndices, [&](std::size_t index)
+                        {
+                        return traversal.files.binaryState(index) == core::BinaryState::binary;
+                        });
+                    }
+                std::string report;
+                const core::RunResult analyzeResult = buildAnalyzeOnlyReport(effectiveOptions, traversal.files, grouped.includedIndices, report);
+                if (analyzeResult.code != core::ExitCode::success)
+                    {
+                    return analyzeResult;
+                    }
+                std::cout << report;
+                return { core::ExitCode::success, "" };
+                }
+
+            PreparedOutputs local;
+            PreparedOutputs& outputs = prepared ? *prepared : local;
+            if (!outputs.valid)
+                {
+                core::RunResult prepareResult = prepareOutputs(options, traversal, ui, outputs);
+                if (prepareResult.code != core::ExitCode::success)
+                    {
+                    return prepareResult;
+                    }
+                }
+
+            // The writer reports its total once it has planned the outputs.
+            const format::ProgressCallback progress = [&ui](std::size_t done, std::size_t total, const std::string& filename)
+                {
+                if (done == 0)
+                    {
+                    ui.startProgress("Writing outputs", static_cast<int>(total));
+                    return;
+                    }
+                ui.updateProgress(static_cast<int>(done), filename);
+                };
+            core::RunResult writeResult = format::writeOutputs(outputs.effectiveOptions, traversal.files, outputs.chunks, outputs.treeListing, traversal.cmakeLists, traversal.buildFiles, cache, progress);
+            ui.endProgress();
+
+            return writeResult;
+            }
+        }
 
-        if (groupingResult.code != core::ExitCode::success)
+    core::RunResult run(const core::CliOptions& options, ui::UserInterface& ui)
+        {
+        if (options.generateConfig)
             {
-            return groupingResult;
+            core::RunResult result = config::generateDefaultConfig(options.configPath);
+            ui.logInfo(result.message);
+            return result;
             }
 
-        if (options.analyzeOnly)
+        std::shared_ptr<analysis::BpeTokenizer> tokenizer;
+        if (!options.tokenizerPath.empty())
             {
-            std::string report;
-            const core::RunResult analyzeResult = buildAnalyzeOnlyReport(effectiveOptions, traversal.files, grouped.includedIndices, report);
-            if (analyzeResult.code != core::ExitCode::success)
+            tokenizer = std::make_shared<analysis::BpeTokenizer>();
+            core::RunResult loadResult = tokenizer->load(options.tokenizerPath);
+            if (loadResult.code != core::ExitCode::success)
                 {
-                return analyzeResult;
+                return loadResult;
                 }
-            std::cout << report;
-            return { core::ExitCode::success, "" };
             }
+        analysis::TokenEstimator::useTokenizer(std::move(tokenizer));
 
-        core::RunResult chunkResult;
-        std::vector<core::OutputChunk> chunks = grouping::chunkGroups(effectiveOptions, traversal.files, grouped.groups, chunkResult);
-        if (chunkResult.code != core::ExitCode::success)
+        if (options.watch)
             {
-            return chunkResult;
+            PreparedOutputs prepared;
+            return runWatch(options, ui,
+                [&](io::TraversalResult& traversal, format::OutputCache& cache, bool regroup)
+                {
+                prepared.valid = prepared.valid && !regroup;
+                return renderTraversal(options, traversal, ui, &cache, &prepared);
+                });
             }
 
-        std::vector<std::filesystem::path> treeFiles;
-        treeFiles.reserve(traversal.files.size());
-        for (const auto& entry : traversal.files)
+        io::TraversalResult traversal;
+        const std::unique_ptr<RepositoryTraversalService> traversalService = makeTraversalService(options);
+        ui.startProgress("Scanning repository", 0);
+        core::RunResult traversalResult = traversalService->traverse(options, traversal);
+        ui.endProgress();
+
+        if (traversalResult.code != core::ExitCode::success)
             {
-            treeFiles.push_back(entry.relativePath);
+            return traversalResult;
             }
 
-        const std::string treeListing = format::renderTree(traversal.directories, treeFiles);
-
-        ui.startProgress("Writing outputs", static_cast<int>(chunks.size()));
-        core::RunResult writeResult = format::writeOutputs(effectiveOptions, traversal.files, chunks, treeListing, traversal.cmakeLists, traversal.buildFiles);
-        ui.endProgress();
-
-        return writeResult;
+        return renderTraversal(options, traversal, ui, nullptr, nullptr);
         }
     }
@@ -137,6 +137,10 @@ namespace repaddu::cli
                 {
                 options.includeHidden = true;
                 }
+            else if (arg == "--no-ignore-files")
+                {
+                options.useIgnoreFiles = false;
+                }
             else if (arg == "--follow-symlinks")
                 {
                 options.followSymlinks = true;
@@ -149,6 +153,145 @@ namespace repaddu::cli
                 {
                 options.parallelTraversal = true;
                 }
+            else if (arg == "--traversal-backend")
+                {
+                std::string value;
+                if (!requireValue(value))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--traversal-backend requires a value." }, "" };
+                    }
+                if (value == "std")
+                    {
+                    options.traversalBackend = core::TraversalBackend::standard;
+                    }
+                else if (value == "native")
+                    {
+                    options.traversalBackend = core::TraversalBackend::native;
+                    }
+                else
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--traversal-backend must be one of: std, native." }, "" };
+                    }
+                }
+            else if (arg == "--traversal-cache")
+                {
+                std::string value;
+                if (!requireValue(value))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--traversal-cache requires a value." }, "" };
+                    }
+                options.traversalCachePath = value;
+                }
+            else if (arg == "--traversal-source")
+                {
+                std::string value;
+                if (!requireValue(value))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--traversal-source requires a value." }, "" };
+                    }
+                if (value == "walk")
+                    {
+                    options.traversalSource = core::TraversalSource::walk;
+                    }
+                else if (value == "git-index")
+                    {
+                    options.traversalSource = core::TraversalSource::gitIndex;
+                    }
+                else
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--traversal-source must be one of: walk, git-index." }, "" };
+                    }
+                }
+            else if (arg == "--include-untracked")
+                {
+                options.includeUntracked = true;
+                }
+            else if (arg == "--watch")
+                {
+                options.watch = true;
+                }
+            else if (arg == "--watch-debounce-ms")
+                {
+                std::string value;
+                if (!requireValue(value))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--watch-debounce-ms requires a value." }, "" };
+                    }
+                int parsed = 0;
+                if (!detail::parseInt(value, parsed) || parsed < 0)
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--watch-debounce-ms must be a non-negative integer." }, "" };
+                    }
+                options.watchDebounceMs = parsed;
+                }
+            else if (arg == "--content-cache-mb")
+                {
+                std::string value;
+                if (!requireValue(value))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--content-cache-mb requires a value." }, "" };
+                    }
+                std::uintmax_t parsed = 0;
+                if (!detail::parseUInt64(value, parsed))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--content-cache-mb must be a non-negative integer." }, "" };
+                    }
+                options.contentCacheMb = parsed;
+                }
+            else if (arg == "--content-cache-stats")
+                {
+                options.contentCacheStats = true;
+                }
+            else if (arg == "--preallocate-outputs")
+                {
+                options.preallocateOutputs = true;
+                }
+            else if (arg == "--content-store")
+                {
+                std::string value;
+                if (!requireValue(value))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--content-store requires a value." }, "" };
+                    }
+                options.contentStorePath = value;
+                }
+            else if (arg == "--tokenizer")
+                {
+                std::string value;
+                if (!requireValue(value))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--tokenizer requires a value." }, "" };
+                    }
+                options.tokenizerPath = value;
+                }
+            else if (arg == "--stream-threshold-mb")
+                {
+                std::string value;
+                if (!requireValue(value))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--stream-threshold-mb requires a value." }, "" };
+                    }
+                std::uintmax_t parsed = 0;
+                if (!detail::parseUInt64(value, parsed))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--stream-threshold-mb must be a non-negative integer." }, "" };
+                    }
+                options.streamThresholdMb = parsed;
+                }
+            else if (arg == "--jsonl-shard-bytes")
+                {
+                std::string value;
+                if (!requireValue(value))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--jsonl-shard-bytes requires a value." }, "" };
+                    }
+                std::uintmax_t parsed = 0;
+                if (!detail::parseUInt64(value, parsed))
+                    {
+                    return { options, { core::ExitCode::invalid_usage, "--jsonl-shard-bytes must be a non-negative integer." }, "" };
+                    }
+                options.jsonlShardBytes = parsed;
+                }
             else if (arg == "--include-binaries")
                 {
                 options.includeBinaries = true;
@@ -386,9 +529,13 @@ namespace repaddu::cli
                     {
                     options.format = core::OutputFormat::html;
                     }
+                else if (value == "pack")
+                    {
+                    options.format = core::OutputFormat::pack;
+                    }
                 else
                     {
-                    return { options, { core::ExitCode::invalid_usage, "--format must be one of: markdown, jsonl, html." }, "" };
+                    return { options, { core::ExitCode::invalid_usage, "--format must be one of: markdown, jsonl, html, pack." }, "" };
                     }
                 }
             else
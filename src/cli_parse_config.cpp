@@ -85,6 +85,7 @@ namespace repaddu::cli
             getBool("include_headers", opt.includeHeaders);
             getBool("include_sources", opt.includeSources);
             getBool("include_hidden", opt.includeHidden);
+            getBool("use_ignore_files", opt.useIgnoreFiles);
             getBool("include_binaries", opt.includeBinaries);
             getBool("follow_symlinks", opt.followSymlinks);
             getBool("headers_first", opt.headersFirst);
@@ -106,6 +107,17 @@ namespace repaddu::cli
             getBool("isolate_docs", opt.isolateDocs);
             getBool("dry_run", opt.dryRun);
             getBool("parallel_traversal", opt.parallelTraversal);
+            getPath("traversal_cache", opt.traversalCachePath);
+            getBool("include_untracked", opt.includeUntracked);
+            getBool("watch", opt.watch);
+            getInt("watch_debounce_ms", opt.watchDebounceMs);
+            getUInt64("content_cache_mb", opt.contentCacheMb);
+            getBool("content_cache_stats", opt.contentCacheStats);
+            getPath("content_store", opt.contentStorePath);
+            getUInt64("stream_threshold_mb", opt.streamThresholdMb);
+            getBool("preallocate_outputs", opt.preallocateOutputs);
+            getUInt64("jsonl_shard_bytes", opt.jsonlShardBytes);
+            getPath("tokenizer", opt.tokenizerPath);
             getStringArray("extensions", opt.extensions);
             getStringArray("exclude_extensions", opt.excludeExtensions);
 
@@ -121,6 +133,17 @@ namespace repaddu::cli
             if (value == "markdown") opt.format = core::OutputFormat::markdown;
             else if (value == "jsonl") opt.format = core::OutputFormat::jsonl;
             else if (value == "html") opt.format = core::OutputFormat::html;
+            else if (value == "pack") opt.format = core::OutputFormat::pack;
+
+            value.clear();
+            getString("traversal_backend", value);
+            if (value == "std") opt.traversalBackend = core::TraversalBackend::standard;
+            else if (value == "native") opt.traversalBackend = core::TraversalBackend::native;
+
+            value.clear();
+            getString("traversal_source", value);
+            if (value == "walk") opt.traversalSource = core::TraversalSource::walk;
+            else if (value == "git-index") opt.traversalSource = core::TraversalSource::gitIndex;
 
             value.clear();
             getString("markers", value);
@@ -12,7 +12,7 @@ namespace repaddu::cli
         out << "  repaddu [options] --input <path> --output <path>\n\n";
         out << "Options:\n";
         out << "  -i, --input <path>          Input repository/folder path.\n";
-        out << "  -o, --output <path>         Output directory.\n";
+        out << "  -o, --output <path>         Output directory, or - for a tar stream on stdout.\n";
         out << "  --max-files <count>         Maximum number of output files. Default: 0.\n";
         out << "  --max-bytes <bytes>         Maximum bytes per output file. Default: 0.\n";
         out << "  --number-width <n>          Width of numeric prefix. Default: 3.\n";
@@ -21,9 +21,23 @@ namespace repaddu::cli
         out << "  --extensions <csv>          Override include list with explicit extensions.\n";
         out << "  --exclude-extensions <csv>  Exclude these extensions after includes.\n";
         out << "  --include-hidden            Include hidden files/directories.\n";
+        out << "  --no-ignore-files           Do not apply .gitignore/.repadduignore rules.\n";
         out << "  --follow-symlinks           Follow directory symlinks.\n";
-        out << "  --single-thread             Force single-threaded traversal.\n";
+        out << "  --single-thread             Force single-threaded traversal, preparation and writing.\n";
         out << "  --parallel-traversal        Enable parallel traversal (default).\n";
+        out << "  --traversal-backend <id>    std|native. native uses getdents64 on Linux. Default: std.\n";
+        out << "  --traversal-cache <path>    Reuse a traversal snapshot; re-list only changed directories.\n";
+        out << "  --traversal-source <id>     walk|git-index. git-index lists tracked files from .git/index.\n";
+        out << "  --include-untracked         With git-index, also walk the tree for untracked files.\n";
+        out << "  --watch                     Keep running and re-render outputs affected by file changes.\n";
+        out << "  --watch-debounce-ms <n>     Quiet period that coalesces change events. Default: 50.\n";
+        out << "  --content-cache-mb <n>      Memory budget for file contents kept between passes. Default: 64.\n";
+        out << "  --content-cache-stats       Log content cache hits, misses and evictions after writing.\n";
+        out << "  --content-store <dir>       Keep redacted content and token counts across runs in <dir>.\n";
+        out << "  --stream-threshold-mb <n>   Stream files larger than this in 1 MiB windows. 0 disables. Default: 64.\n";
+        out << "  --preallocate-outputs       Plan every output first, then fill preallocated mapped files.\n";
+        out << "  --jsonl-shard-bytes <n>     Split JSONL into dataset-NNNNN.jsonl shards of about <n> bytes. 0 disables.\n";
+        out << "  --tokenizer <file>          Count tokens with a tiktoken BPE vocabulary instead of bytes/4.\n";
         out << "  --include-binaries          Include binary files.\n";
         out << "  --max-file-size <bytes>     Skip files larger than this (default 1MB).\n";
         out << "  --force-large               Include large files despite size check.\n";
@@ -40,7 +54,7 @@ namespace repaddu::cli
         out << "  --dry-run                   Simulate execution without writing files.\n";
         out << "  --init                      Generate a default config file (JSON or YAML by --config extension).\n";
         out << "  --config <path>             Config path to load and/or generate. Default: .repaddu.json (auto-load also checks .repaddu.yaml/.repaddu.yml).\n";
-        out << "  --format <fmt>              markdown|jsonl|html. Default: markdown.\n";
+        out << "  --format <fmt>              markdown|jsonl|html|pack. Default: markdown.\n";
         out << "  --group-by <mode>           directory|component|type|size. Default: directory.\n";
         out << "  --group-depth <n>           Depth for directory grouping. Default: 1.\n";
         out << "  --component-map <path>      JSON component mapping file for component grouping.\n";
@@ -24,6 +24,14 @@ namespace repaddu::cli::detail
             {
             return { core::ExitCode::invalid_usage, "--output is required unless --scan-languages, --analyze-only, or --init is used." };
             }
+        if (options.watch && (options.scanLanguages || options.analyzeOnly || options.dryRun))
+            {
+            return { core::ExitCode::invalid_usage, "--watch cannot be combined with --scan-languages, --analyze-only, or --dry-run." };
+            }
+        if (options.outputPath == "-" && (options.watch || options.format != core::OutputFormat::markdown))
+            {
+            return { core::ExitCode::invalid_usage, "--output - requires --format markdown and cannot be combined with --watch." };
+            }
         if (options.groupBy == core::GroupingMode::component && options.componentMapPath.empty())
             {
             return { core::ExitCode::invalid_usage, "--group-by component requires --component-map." };
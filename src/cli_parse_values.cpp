@@ -40,6 +40,12 @@ namespace repaddu::cli::detail
 
     bool parseUInt64(const std::string& value, std::uintmax_t& outValue)
         {
+        // std::stoull accepts "-4" and wraps it around.
+        const std::size_t first = value.find_first_not_of(" \t");
+        if (first != std::string::npos && value[first] == '-')
+            {
+            return false;
+            }
         try
             {
             std::size_t pos = 0;
@@ -0,0 +1,450 @@
+#include "repaddu/core_binary.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REPADDU_CLASSIFY_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define REPADDU_CLASSIFY_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace repaddu::core
+    {
+    namespace
+        {
+        struct MagicSignature
+            {
+            std::array<std::uint8_t, 8> bytes;
+            std::size_t length;
+            const char* name;
+            BinaryKind kind;
+            // Two printable ASCII bytes ("MZ", "BM") also start ordinary text,
+            // so these only count when the scan finds NUL bytes as well.
+            bool weak;
+            };
+
+        // Sorted by first byte; kFirstByteStart indexes into it.
+        constexpr std::array<MagicSignature, 17> kSignatures =
+            { {
+            { { 0x00, 0x00, 0x01, 0x00 }, 4, "ICO Icon", BinaryKind::image, false },
+            { { 0x00, 0x61, 0x73, 0x6d }, 4, "WebAssembly Module", BinaryKind::executable, false },
+            { { 0x1f, 0x8b }, 2, "GZIP Archive", BinaryKind::archive, false },
+            { { 0x28, 0xb5, 0x2f, 0xfd }, 4, "Zstandard Archive", BinaryKind::archive, false },
+            { { 0x37, 0x7a, 0xbc, 0xaf, 0x27, 0x1c }, 6, "7-Zip Archive", BinaryKind::archive, false },
+            { { 0x42, 0x4d }, 2, "BMP Image", BinaryKind::image, true },
+            { { 0x47, 0x49, 0x46, 0x38 }, 4, "GIF Image", BinaryKind::image, false },
+            { { 0x4d, 0x5a }, 2, "PE Executable (Windows)", BinaryKind::executable, true },
+            { { 0x50, 0x4b, 0x03, 0x04 }, 4, "ZIP Archive", BinaryKind::archive, false },
+            { { 0x7f, 0x45, 0x4c, 0x46 }, 4, "ELF Executable", BinaryKind::executable, false },
+            { { 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a }, 8, "PNG Image", BinaryKind::image, false },
+            { { 0xca, 0xfe, 0xba, 0xbe }, 4, "Java Class / Mach-O Fat", BinaryKind::executable, false },
+            { { 0xcf, 0xfa, 0xed, 0xfe }, 4, "Mach-O (Mac 64, LE)", BinaryKind::executable, false },
+            { { 0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00 }, 6, "XZ Archive", BinaryKind::archive, false },
+            { { 0xfe, 0xed, 0xfa, 0xcf }, 4, "Mach-O (Mac 64)", BinaryKind::executable, false },
+            { { 0xfe, 0xed, 0xfa, 0xce }, 4, "Mach-O (Mac 32)", BinaryKind::executable, false },
+            { { 0xff, 0xd8, 0xff }, 3, "JPEG Image", BinaryKind::image, false }
+            } };
+
+        constexpr std::array<std::uint8_t, 257> buildFirstByteStart()
+            {
+            std::array<std::uint8_t, 257> start{};
+            std::size_t signature = 0;
+            for (std::size_t byte = 0; byte <= 256; ++byte)
+                {
+                while (signature < kSignatures.size() && kSignatures[signature].bytes[0] < byte)
+                    {
+                    ++signature;
+                    }
+                start[byte] = static_cast<std::uint8_t>(signature);
+                }
+            return start;
+            }
+
+        constexpr bool signaturesSorted()
+            {
+            for (std::size_t index = 1; index < kSignatures.size(); ++index)
+                {
+                if (kSignatures[index - 1].bytes[0] > kSignatures[index].bytes[0])
+                    {
+                    return false;
+                    }
+                }
+            return true;
+            }
+        static_assert(signaturesSorted(), "kSignatures must be sorted by first byte");
+
+        // kSignatures[kFirstByteStart[b] .. kFirstByteStart[b + 1]) start with byte b.
+        constexpr std::array<std::uint8_t, 257> kFirstByteStart = buildFirstByteStart();
+
+        const MagicSignature* findSignature(const std::uint8_t* data, std::size_t size)
+            {
+            const std::uint8_t first = data[0];
+            for (std::size_t index = kFirstByteStart[first]; index < kFirstByteStart[first + 1u]; ++index)
+                {
+                const MagicSignature& signature = kSignatures[index];
+                if (size >= signature.length
+                    && std::equal(signature.bytes.begin(), signature.bytes.begin() + signature.length, data))
+                    {
+                    return &signature;
+                    }
+                }
+            return nullptr;
+            }
+
+        // Incremental UTF-8 validator; state carries across blocks so a
+        // sequence may straddle a vector boundary.
+        struct Utf8State
+            {
+            int need = 0;
+            std::uint8_t lower = 0x80;
+            std::uint8_t upper = 0xbf;
+            bool valid = true;
+            };
+
+        inline void utf8Step(Utf8State& state, std::uint8_t byte)
+            {
+            if (state.need == 0)
+                {
+                if (byte < 0x80)
+                    {
+                    return;
+                    }
+                if (byte >= 0xc2 && byte <= 0xdf)
+                    {
+                    state.need = 1;
+                    }
+                else if (byte >= 0xe0 && byte <= 0xef)
+                    {
+                    state.need = 2;
+                    state.lower = byte == 0xe0 ? 0xa0 : 0x80; // Overlong.
+                    state.upper = byte == 0xed ? 0x9f : 0xbf; // Surrogates.
+                    }
+                else if (byte >= 0xf0 && byte <= 0xf4)
+                    {
+                    state.need = 3;
+                    state.lower = byte == 0xf0 ? 0x90 : 0x80; // Overlong.
+                    state.upper = byte == 0xf4 ? 0x8f : 0xbf; // Above U+10FFFF.
+                    }
+                else
+                    {
+                    state.valid = false;
+                    }
+                return;
+                }
+            if (byte < state.lower || byte > state.upper)
+                {
+                state.valid = false;
+                return;
+                }
+            state.lower = 0x80;
+            state.upper = 0xbf;
+            --state.need;
+            }
+
+        struct ScanCounts
+            {
+            std::size_t nulEven = 0;
+            std::size_t nulOdd = 0;
+            std::size_t control = 0;
+            Utf8State utf8;
+            };
+
+        // C0 controls other than \t \n \v \f \r and ESC, plus DEL. NUL is counted apart.
+        inline bool isControl(std::uint8_t byte)
+            {
+            return (byte != 0 && byte < 0x20 && (byte < 0x09 || byte > 0x0d) && byte != 0x1b) || byte == 0x7f;
+            }
+
+        void validateUtf8(const std::uint8_t* data, std::size_t length, Utf8State& state)
+            {
+            // Work on a local copy so the state stays in registers.
+            Utf8State local = state;
+            for (std::size_t index = 0; index < length && local.valid; ++index)
+                {
+                utf8Step(local, data[index]);
+                }
+            state = local;
+            }
+
+        // position is the offset of data[0] from the start of the head, for parity.
+        void scanScalar(const std::uint8_t* data, std::size_t length, std::size_t position, ScanCounts& counts)
+            {
+            for (std::size_t index = 0; index < length; ++index)
+                {
+                const std::uint8_t byte = data[index];
+                if (byte == 0)
+                    {
+                    ((position + index) & 1u) ? ++counts.nulOdd : ++counts.nulEven;
+                    }
+                else if (isControl(byte))
+                    {
+                    ++counts.control;
+                    }
+                }
+            validateUtf8(data, length, counts.utf8);
+            }
+
+#ifdef REPADDU_CLASSIFY_SSE2
+        // Returns the number of bytes consumed (a multiple of 16).
+        std::size_t scanSse2(const std::uint8_t* data, std::size_t length, ScanCounts& counts)
+            {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i maxControl = _mm_set1_epi8(0x1f);
+            const __m128i whitespaceFirst = _mm_set1_epi8(0x09);
+            const __m128i whitespaceSpan = _mm_set1_epi8(0x04);
+            const __m128i escape = _mm_set1_epi8(0x1b);
+            const __m128i del = _mm_set1_epi8(0x7f);
+
+            std::size_t offset = 0;
+            for (; offset + 16 <= length; offset += 16)
+                {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+                const unsigned nul = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, zero)));
+                // Unsigned "x <= k" is min(x, k) == x; 9..13 is checked as (x - 9) <= 4.
+                const unsigned low = static_cast<unsigned>(_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(_mm_min_epu8(block, maxControl), block)));
+                const __m128i shifted = _mm_sub_epi8(block, whitespaceFirst);
+                const unsigned whitespace = static_cast<unsigned>(_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(_mm_min_epu8(shifted, whitespaceSpan), shifted)));
+                const unsigned allowed = whitespace
+                    | static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, escape)));
+                const unsigned control = (low & ~allowed & ~nul)
+                    | static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, del)));
+                const unsigned high = static_cast<unsigned>(_mm_movemask_epi8(block));
+
+                counts.nulEven += static_cast<std::size_t>(std::popcount(nul & 0x5555u));
+                counts.nulOdd += static_cast<std::size_t>(std::popcount(nul & 0xaaaau));
+                counts.control += static_cast<std::size_t>(std::popcount(control));
+                if ((high != 0 || counts.utf8.need != 0) && counts.utf8.valid)
+                    {
+                    validateUtf8(data + offset, 16, counts.utf8);
+                    }
+                }
+            return offset;
+            }
+#endif
+
+#ifdef REPADDU_CLASSIFY_AVX2
+        __attribute__((target("avx2")))
+        std::size_t scanAvx2(const std::uint8_t* data, std::size_t length, ScanCounts& counts)
+            {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i maxControl = _mm256_set1_epi8(0x1f);
+            const __m256i whitespaceFirst = _mm256_set1_epi8(0x09);
+            const __m256i whitespaceSpan = _mm256_set1_epi8(0x04);
+            const __m256i escape = _mm256_set1_epi8(0x1b);
+            const __m256i del = _mm256_set1_epi8(0x7f);
+
+            std::size_t offset = 0;
+            for (; offset + 32 <= length; offset += 32)
+                {
+                const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+                const std::uint32_t nul = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, zero)));
+                const std::uint32_t low = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(_mm256_min_epu8(block, maxControl), block)));
+                const __m256i shifted = _mm256_sub_epi8(block, whitespaceFirst);
+                const std::uint32_t whitespace = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, whitespaceSpan), shifted)));
+                const std::uint32_t allowed = whitespace
+                    | static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, escape)));
+                const std::uint32_t control = (low & ~allowed & ~nul)
+                    | static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, del)));
+                const std::uint32_t high = static_cast<std::uint32_t>(_mm256_movemask_epi8(block));
+
+                counts.nulEven += static_cast<std::size_t>(std::popcount(nul & 0x55555555u));
+                counts.nulOdd += static_cast<std::size_t>(std::popcount(nul & 0xaaaaaaaau));
+                counts.control += static_cast<std::size_t>(std::popcount(control));
+                if ((high != 0 || counts.utf8.need != 0) && counts.utf8.valid)
+                    {
+                    validateUtf8(data + offset, 32, counts.utf8);
+                    }
+                }
+            return offset;
+            }
+
+        bool avx2Available()
+            {
+            static const bool available = __builtin_cpu_supports("avx2");
+            return available;
+            }
+#endif
+
+        ScanCounts scan(const std::uint8_t* data, std::size_t length)
+            {
+            ScanCounts counts;
+            std::size_t consumed = 0;
+#ifdef REPADDU_CLASSIFY_AVX2
+            if (avx2Available())
+                {
+                consumed = scanAvx2(data, length, counts);
+                }
+#endif
+#ifdef REPADDU_CLASSIFY_SSE2
+            consumed += scanSse2(data + consumed, length - consumed, counts);
+#endif
+            // Vector blocks have even lengths, so parity restarts cleanly here.
+            scanScalar(data + consumed, length - consumed, consumed, counts);
+            return counts;
+            }
+
+        ContentVerdict textVerdict(ContentClass contentClass, std::string_view signature)
+            {
+            ContentVerdict verdict;
+            verdict.contentClass = contentClass;
+            verdict.signature = signature;
+            return verdict;
+            }
+
+        ContentVerdict binaryVerdict(BinaryKind kind, std::string_view signature)
+            {
+            ContentVerdict verdict;
+            verdict.contentClass = ContentClass::binary;
+            verdict.binaryKind = kind;
+            verdict.signature = signature;
+            return verdict;
+            }
+
+        bool startsWith(const std::uint8_t* data, std::size_t size, std::initializer_list<std::uint8_t> prefix)
+            {
+            return size >= prefix.size() && std::equal(prefix.begin(), prefix.end(), data);
+            }
+        }
+
+    ContentVerdict classifyContent(std::string_view head)
+        {
+        if (head.empty())
+            {
+            return {};
+            }
+        const auto* data = reinterpret_cast<const std::uint8_t*>(head.data());
+        const std::size_t size = head.size();
+
+        // UTF-32 marks first: FF FE 00 00 also starts with the UTF-16LE mark.
+        if (startsWith(data, size, { 0xff, 0xfe, 0x00, 0x00 }))
+            {
+            return textVerdict(ContentClass::textUtf32le, "UTF-32LE BOM");
+            }
+        if (startsWith(data, size, { 0x00, 0x00, 0xfe, 0xff }))
+            {
+            return textVerdict(ContentClass::textUtf32be, "UTF-32BE BOM");
+            }
+        if (startsWith(data, size, { 0xff, 0xfe }))
+            {
+            return textVerdict(ContentClass::textUtf16le, "UTF-16LE BOM");
+            }
+        if (startsWith(data, size, { 0xfe, 0xff }))
+            {
+            return textVerdict(ContentClass::textUtf16be, "UTF-16BE BOM");
+            }
+
+        std::size_t start = 0;
+        std::string_view textSignature;
+        const MagicSignature* magic = nullptr;
+        if (startsWith(data, size, { 0xef, 0xbb, 0xbf }))
+            {
+            start = 3;
+            textSignature = "UTF-8 BOM";
+            }
+        else
+            {
+            magic = findSignature(data, size);
+            if (magic && !magic->weak)
+                {
+                return binaryVerdict(magic->kind, magic->name);
+                }
+            }
+
+        const std::size_t length = size - start;
+        const ScanCounts counts = scan(data + start, length);
+        const std::size_t nulCount = counts.nulEven + counts.nulOdd;
+        if (nulCount > 0)
+            {
+            if (magic)
+                {
+                return binaryVerdict(magic->kind, magic->name);
+                }
+            // BOM-less UTF-16 of mostly ASCII text has a NUL in every other
+            // byte: odd positions for little endian, even ones for big endian.
+            const std::size_t pairs = length / 2;
+            if (pairs >= 2 && counts.nulOdd * 2 >= pairs && counts.nulEven * 16 <= pairs)
+                {
+                return textVerdict(ContentClass::textUtf16le, {});
+                }
+            if (pairs >= 2 && counts.nulEven * 2 >= pairs && counts.nulOdd * 16 <= pairs)
+                {
+                return textVerdict(ContentClass::textUtf16be, {});
+                }
+            return binaryVerdict(BinaryKind::nulBytes, {});
+            }
+        if (counts.control * 10 > length)
+            {
+            return binaryVerdict(BinaryKind::controlBytes, {});
+            }
+        // A sequence cut off by the end of the block is not held against the text.
+        return textVerdict(counts.utf8.valid ? ContentClass::textUtf8 : ContentClass::textLegacy, textSignature);
+        }
+
+    const char* contentClassLabel(ContentClass contentClass)
+        {
+        switch (contentClass)
+            {
+            case ContentClass::textUtf8:
+                return "text-utf8";
+            case ContentClass::textLegacy:
+                return "text-legacy";
+            case ContentClass::textUtf16le:
+                return "text-utf16le";
+            case ContentClass::textUtf16be:
+                return "text-utf16be";
+            case ContentClass::textUtf32le:
+                return "text-utf32le";
+            case ContentClass::textUtf32be:
+                return "text-utf32be";
+            case ContentClass::binary:
+                return "binary";
+            }
+        return "binary";
+        }
+
+    const char* binaryKindLabel(BinaryKind kind)
+        {
+        switch (kind)
+            {
+            case BinaryKind::none:
+                return "none";
+            case BinaryKind::executable:
+                return "executable";
+            case BinaryKind::image:
+                return "image";
+            case BinaryKind::archive:
+                return "archive";
+            case BinaryKind::nulBytes:
+                return "nul-bytes";
+            case BinaryKind::controlBytes:
+                return "control-bytes";
+            }
+        return "none";
+        }
+
+    bool looksBinaryHead(std::string_view head)
+        {
+        return !classifyContent(head).embeddable();
+        }
+
+    BinaryState resolveBinaryState(BinaryState state, std::string_view content)
+        {
+        if (state != BinaryState::unknown)
+            {
+            return state;
+            }
+        const std::string_view head = content.substr(0, std::min(content.size(), kSniffBytes));
+        return looksBinaryHead(head) ? BinaryState::binary : BinaryState::text;
+        }
+    }
@@ -0,0 +1,546 @@
+#include "repaddu/core_file_table.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <thread>
+
+namespace repaddu::core
+    {
+    namespace
+        {
+        // Byte-wise comparison of directory + '/' + name (no '/' at the root)
+        // for two rows, matching std::string ordering of the joined paths.
+        int compareJoined(std::string_view leftDirectory, std::string_view leftName,
+            std::string_view rightDirectory, std::string_view rightName)
+            {
+            auto charAt = [](std::string_view directory, std::string_view name, std::size_t position)
+                {
+                if (directory.empty())
+                    {
+                    return static_cast<unsigned char>(name[position]);
+                    }
+                if (position < directory.size())
+                    {
+                    return static_cast<unsigned char>(directory[position]);
+                    }
+                if (position == directory.size())
+                    {
+                    return static_cast<unsigned char>('/');
+                    }
+                return static_cast<unsigned char>(name[position - directory.size() - 1]);
+                };
+
+            const std::size_t leftLength = leftDirectory.empty() ? leftName.size() : leftDirectory.size() + 1 + leftName.size();
+            const std::size_t rightLength = rightDirectory.empty() ? rightName.size() : rightDirectory.size() + 1 + rightName.size();
+            const std::size_t common = std::min(leftLength, rightLength);
+            for (std::size_t position = 0; position < common; ++position)
+                {
+                const unsigned char left = charAt(leftDirectory, leftName, position);
+                const unsigned char right = charAt(rightDirectory, rightName, position);
+                if (left != right)
+                    {
+                    return left < right ? -1 : 1;
+                    }
+                }
+            if (leftLength == rightLength)
+                {
+                return 0;
+                }
+            return leftLength < rightLength ? -1 : 1;
+            }
+
+        std::string_view extensionOf(std::string_view name)
+            {
+            const std::size_t dot = name.rfind('.');
+            if (dot == std::string_view::npos || dot == 0 || name == "..")
+                {
+                return {};
+                }
+            return name.substr(dot);
+            }
+
+        // Joined relative paths of every row of one table in a single arena, so
+        // sorting and merging compare precomputed byte keys without allocating.
+        struct PathKeys
+            {
+            std::string bytes;
+            std::vector<std::size_t> offsets;
+
+            std::string_view operator[](std::size_t index) const
+                {
+                return std::string_view(bytes).substr(offsets[index], offsets[index + 1] - offsets[index]);
+                }
+            };
+
+        PathKeys buildPathKeys(const FileTable& table)
+            {
+            PathKeys keys;
+            keys.offsets.reserve(table.size() + 1);
+            keys.offsets.push_back(0);
+            for (std::size_t index = 0; index < table.size(); ++index)
+                {
+                table.appendRelativePath(index, keys.bytes);
+                keys.offsets.push_back(keys.bytes.size());
+                }
+            return keys;
+            }
+
+        // Runs task(0) .. task(count - 1) on up to threadCount threads, the
+        // calling thread included.
+        template <typename Task>
+        void runParallel(std::size_t count, std::size_t threadCount, const Task& task)
+            {
+            const std::size_t workerCount = std::max<std::size_t>(1, std::min(count, threadCount));
+            auto runStride = [&](std::size_t first)
+                {
+                for (std::size_t index = first; index < count; index += workerCount)
+                    {
+                    task(index);
+                    }
+                };
+            std::vector<std::thread> workers;
+            workers.reserve(workerCount - 1);
+            for (std::size_t worker = 1; worker < workerCount; ++worker)
+                {
+                workers.emplace_back(runStride, worker);
+                }
+            runStride(0);
+            for (std::thread& worker : workers)
+                {
+                worker.join();
+                }
+            }
+
+        // Below this many rows a single merge segment is cheaper than the
+        // splitter search and thread start-up.
+        constexpr std::size_t kParallelMergeRows = 64 * 1024;
+
+        struct RowRef
+            {
+            std::uint32_t run = 0;
+            std::uint32_t row = 0;
+            };
+
+        template <typename T>
+        void applyOrder(std::vector<T>& column, const std::vector<std::size_t>& order)
+            {
+            std::vector<T> reordered;
+            reordered.reserve(column.size());
+            for (std::size_t index : order)
+                {
+                reordered.push_back(column[index]);
+                }
+            column = std::move(reordered);
+            }
+        }
+
+    FileTable::FileTable(std::filesystem::path root)
+        : root_(std::move(root))
+        {
+        }
+
+    void FileTable::setRoot(std::filesystem::path root)
+        {
+        root_ = std::move(root);
+        }
+
+    void FileTable::reserve(std::size_t rowCount)
+        {
+        directoryIds_.reserve(rowCount);
+        nameOffsets_.reserve(rowCount);
+        nameLengths_.reserve(rowCount);
+        extensionIds_.reserve(rowCount);
+        sizes_.reserve(rowCount);
+        tokenCounts_.reserve(rowCount);
+        flags_.reserve(rowCount);
+        }
+
+    void FileTable::clear()
+        {
+        resizeRows(0);
+        names_.clear();
+        directories_.clear();
+        directoryLookup_.clear();
+        extensions_.clear();
+        extensionLookup_.clear();
+        sortedByPath_ = true;
+        }
+
+    std::uint32_t FileTable::internDirectory(std::string_view directory)
+        {
+        auto it = directoryLookup_.find(std::string(directory));
+        if (it != directoryLookup_.end())
+            {
+            return it->second;
+            }
+        const std::uint32_t id = static_cast<std::uint32_t>(directories_.size());
+        directories_.emplace_back(directory);
+        directoryLookup_.emplace(directories_.back(), id);
+        return id;
+        }
+
+    std::uint32_t FileTable::internExtension(std::string_view extensionLower)
+        {
+        auto it = extensionLookup_.find(std::string(extensionLower));
+        if (it != extensionLookup_.end())
+            {
+            return it->second;
+            }
+        const std::uint32_t id = static_cast<std::uint32_t>(extensions_.size());
+        extensions_.emplace_back(extensionLower);
+        extensionLookup_.emplace(extensions_.back(), id);
+        return id;
+        }
+
+    void FileTable::addRow(std::uint32_t directoryId, std::string_view name, std::uint32_t extensionId,
+        std::uintmax_t sizeBytes, std::uintmax_t tokenCount, std::uint8_t flags)
+        {
+        assert(name.size() <= std::numeric_limits<std::uint16_t>::max());
+        assert(names_.size() + name.size() <= std::numeric_limits<std::uint32_t>::max());
+        directoryIds_.push_back(directoryId);
+        nameOffsets_.push_back(static_cast<std::uint32_t>(names_.size()));
+        nameLengths_.push_back(static_cast<std::uint16_t>(name.size()));
+        names_.append(name);
+        extensionIds_.push_back(extensionId);
+        sizes_.push_back(static_cast<std::uint64_t>(sizeBytes));
+        tokenCounts_.push_back(static_cast<std::uint64_t>(tokenCount));
+        flags_.push_back(flags);
+        }
+
+    std::size_t FileTable::add(std::string_view relativePath, std::uintmax_t sizeBytes)
+        {
+        const std::size_t slash = relativePath.rfind('/');
+        const std::string_view directory = slash == std::string_view::npos ? std::string_view() : relativePath.substr(0, slash);
+        const std::string_view name = slash == std::string_view::npos ? relativePath : relativePath.substr(slash + 1);
+
+        const std::string extensionLower = toLowerCopy(extensionOf(name));
+        const FileClass fileClass = classifyExtension(extensionLower);
+        const std::uint8_t flags = static_cast<std::uint8_t>(static_cast<std::uint8_t>(fileClass)
+            | (static_cast<std::uint8_t>(BinaryState::unknown) << kBinaryShift));
+
+        if (!empty())
+            {
+            sortedByPath_ = false;
+            }
+        addRow(internDirectory(directory), name, internExtension(extensionLower), sizeBytes, 0, flags);
+        return size() - 1;
+        }
+
+    void FileTable::append(const FileTable& other)
+        {
+        sortedByPath_ = empty() ? other.sortedByPath_ : (sortedByPath_ && other.empty());
+        std::vector<std::uint32_t> directoryMap;
+        directoryMap.reserve(other.directories_.size());
+        for (const std::string& directory : other.directories_)
+            {
+            directoryMap.push_back(internDirectory(directory));
+            }
+        std::vector<std::uint32_t> extensionMap;
+        extensionMap.reserve(other.extensions_.size());
+        for (const std::string& extension : other.extensions_)
+            {
+            extensionMap.push_back(internExtension(extension));
+            }
+
+        reserve(size() + other.size());
+        names_.reserve(names_.size() + other.names_.size());
+        for (std::size_t index = 0; index < other.size(); ++index)
+            {
+            addRow(directoryMap[other.directoryIds_[index]],
+                other.name(index),
+                extensionMap[other.extensionIds_[index]],
+                other.sizes_[index],
+                other.tokenCounts_[index],
+                other.flags_[index]);
+            }
+        }
+
+    std::string FileTable::relativePath(std::size_t index) const
+        {
+        std::string result;
+        appendRelativePath(index, result);
+        return result;
+        }
+
+    void FileTable::appendRelativePath(std::size_t index, std::string& out) const
+        {
+        const std::string_view directoryName = directory(index);
+        if (!directoryName.empty())
+            {
+            out.append(directoryName);
+            out.push_back('/');
+            }
+        out.append(name(index));
+        }
+
+    std::filesystem::path FileTable::absolutePath(std::size_t index) const
+        {
+        std::filesystem::path result = root_;
+        const std::string_view directoryName = directory(index);
+        if (!directoryName.empty())
+            {
+            result /= std::filesystem::path(directoryName);
+            }
+        result /= std::filesystem::path(name(index));
+        return result;
+        }
+
+    void FileTable::setSizeBytes(std::size_t index, std::uintmax_t sizeBytes)
+        {
+        sizes_[index] = static_cast<std::uint64_t>(sizeBytes);
+        }
+
+    void FileTable::setTokenCount(std::size_t index, std::uintmax_t tokenCount)
+        {
+        tokenCounts_[index] = static_cast<std::uint64_t>(tokenCount);
+        }
+
+    void FileTable::setBinaryState(std::size_t index, BinaryState state)
+        {
+        flags_[index] = static_cast<std::uint8_t>((flags_[index] & ~(kBinaryMask << kBinaryShift))
+            | (static_cast<std::uint8_t>(state) << kBinaryShift));
+        }
+
+    bool FileTable::pathLess(std::size_t lhs, std::size_t rhs) const
+        {
+        if (sortedByPath_)
+            {
+            return lhs < rhs;
+            }
+        if (directoryIds_[lhs] == directoryIds_[rhs])
+            {
+            return name(lhs) < name(rhs);
+            }
+        return compareJoined(directory(lhs), name(lhs), directory(rhs), name(rhs)) < 0;
+        }
+
+    void FileTable::sortByPath()
+        {
+        if (sortedByPath_)
+            {
+            return;
+            }
+        const PathKeys keys = buildPathKeys(*this);
+        std::vector<std::size_t> order(size());
+        std::iota(order.begin(), order.end(), std::size_t{ 0 });
+        std::sort(order.begin(), order.end(),
+            [&keys](std::size_t lhs, std::size_t rhs)
+            {
+            return keys[lhs] < keys[rhs];
+            });
+
+        applyOrder(directoryIds_, order);
+        applyOrder(nameOffsets_, order);
+        applyOrder(nameLengths_, order);
+        applyOrder(extensionIds_, order);
+        applyOrder(sizes_, order);
+        applyOrder(tokenCounts_, order);
+        applyOrder(flags_, order);
+        sortedByPath_ = true;
+        }
+
+    void FileTable::mergeSortedRuns(const std::vector<FileTable>& runs, std::size_t threadCount)
+        {
+        std::vector<PathKeys> keys(runs.size());
+        runParallel(runs.size(), threadCount, [&](std::size_t run)
+            {
+            assert(runs[run].sortedByPath());
+            keys[run] = buildPathKeys(runs[run]);
+            });
+
+        std::size_t totalRows = 0;
+        std::size_t totalNameBytes = 0;
+        for (const FileTable& run : runs)
+            {
+            totalRows += run.size();
+            totalNameBytes += run.names_.size();
+            }
+
+        // Segment boundaries come from splitter keys sampled evenly from every
+        // run; each segment is then an independent k-way merge into its own
+        // slice of the output order.
+        const std::size_t segmentCount = totalRows < kParallelMergeRows ? 1 : std::max<std::size_t>(1, threadCount);
+        std::vector<std::string_view> splitters;
+        if (segmentCount > 1)
+            {
+            const std::size_t samplesPerRun = segmentCount * 8;
+            std::vector<std::string_view> samples;
+            for (std::size_t run = 0; run < runs.size(); ++run)
+                {
+                const std::size_t rowCount = runs[run].size();
+                for (std::size_t sample = 1; sample <= samplesPerRun && rowCount > 0; ++sample)
+                    {
+                    samples.push_back(keys[run][sample * rowCount / (samplesPerRun + 1)]);
+                    }
+                }
+            std::sort(samples.begin(), samples.end());
+            for (std::size_t segment = 1; segment < segmentCount; ++segment)
+                {
+                splitters.push_back(samples[segment * samples.size() / segmentCount]);
+                }
+            }
+
+        // bounds[segment][run] is the first row of run that belongs to segment.
+        std::vector<std::vector<std::size_t>> bounds(segmentCount + 1, std::vector<std::size_t>(runs.size(), 0));
+        for (std::size_t run = 0; run < runs.size(); ++run)
+            {
+            for (std::size_t segment = 1; segment < segmentCount; ++segment)
+                {
+                std::size_t low = bounds[segment - 1][run];
+                std::size_t high = runs[run].size();
+                while (low < high)
+                    {
+                    const std::size_t middle = low + (high - low) / 2;
+                    if (keys[run][middle] < splitters[segment - 1])
+                        {
+                        low = middle + 1;
+                        }
+                    else
+                        {
+                        high = middle;
+                        }
+                    }
+                bounds[segment][run] = low;
+                }
+            bounds[segmentCount][run] = runs[run].size();
+            }
+
+        std::vector<std::size_t> segmentOffsets(segmentCount + 1, 0);
+        for (std::size_t segment = 0; segment < segmentCount; ++segment)
+            {
+            std::size_t rows = 0;
+            for (std::size_t run = 0; run < runs.size(); ++run)
+                {
+                rows += bounds[segment + 1][run] - bounds[segment][run];
+                }
+            segmentOffsets[segment + 1] = segmentOffsets[segment] + rows;
+            }
+
+        std::vector<RowRef> order(totalRows);
+        runParallel(segmentCount, threadCount, [&](std::size_t segment)
+            {
+            // Ties between runs go to the lower run index so the result is deterministic.
+            auto greater = [&keys](const RowRef& lhs, const RowRef& rhs)
+                {
+                const std::string_view left = keys[lhs.run][lhs.row];
+                const std::string_view right = keys[rhs.run][rhs.row];
+                return left != right ? left > right : lhs.run > rhs.run;
+                };
+            std::priority_queue<RowRef, std::vector<RowRef>, decltype(greater)> heads(greater);
+            for (std::size_t run = 0; run < runs.size(); ++run)
+                {
+                if (bounds[segment][run] < bounds[segment + 1][run])
+                    {
+                    heads.push({ static_cast<std::uint32_t>(run), static_cast<std::uint32_t>(bounds[segment][run]) });
+                    }
+                }
+            std::size_t out = segmentOffsets[segment];
+            while (!heads.empty())
+                {
+                RowRef head = heads.top();
+                heads.pop();
+                order[out++] = head;
+                if (++head.row < bounds[segment + 1][head.run])
+                    {
+                    heads.push(head);
+                    }
+                }
+            });
+
+        clear();
+        reserve(totalRows);
+        names_.reserve(totalNameBytes);
+        std::vector<std::vector<std::uint32_t>> directoryMaps(runs.size());
+        std::vector<std::vector<std::uint32_t>> extensionMaps(runs.size());
+        for (std::size_t run = 0; run < runs.size(); ++run)
+            {
+            for (const std::string& directory : runs[run].directories_)
+                {
+                directoryMaps[run].push_back(internDirectory(directory));
+                }
+            for (const std::string& extension : runs[run].extensions_)
+                {
+                extensionMaps[run].push_back(internExtension(extension));
+                }
+            }
+        for (const RowRef& ref : order)
+            {
+            const FileTable& run = runs[ref.run];
+            addRow(directoryMaps[ref.run][run.directoryIds_[ref.row]],
+                run.name(ref.row),
+                extensionMaps[ref.run][run.extensionIds_[ref.row]],
+                run.sizes_[ref.row],
+                run.tokenCounts_[ref.row],
+                run.flags_[ref.row]);
+            }
+        sortedByPath_ = true;
+        }
+
+    std::optional<std::size_t> FileTable::find(std::string_view relativePath) const
+        {
+        const std::size_t slash = relativePath.rfind('/');
+        const std::string directoryName(slash == std::string_view::npos ? std::string_view() : relativePath.substr(0, slash));
+        const std::string_view fileName = slash == std::string_view::npos ? relativePath : relativePath.substr(slash + 1);
+
+        auto directoryIt = directoryLookup_.find(directoryName);
+        if (directoryIt == directoryLookup_.end())
+            {
+            return std::nullopt;
+            }
+        for (std::size_t index = 0; index < size(); ++index)
+            {
+            if (directoryIds_[index] == directoryIt->second && name(index) == fileName)
+                {
+                return index;
+                }
+            }
+        return std::nullopt;
+        }
+
+    std::size_t FileTable::memoryBytes() const
+        {
+        std::size_t bytes = directoryIds_.capacity() * sizeof(std::uint32_t)
+            + nameOffsets_.capacity() * sizeof(std::uint32_t)
+            + nameLengths_.capacity() * sizeof(std::uint16_t)
+            + extensionIds_.capacity() * sizeof(std::uint32_t)
+            + sizes_.capacity() * sizeof(std::uint64_t)
+            + tokenCounts_.capacity() * sizeof(std::uint64_t)
+            + flags_.capacity() * sizeof(std::uint8_t)
+            + names_.capacity();
+        for (const std::string& directory : directories_)
+            {
+            // Stored once in the column and once as the lookup key.
+            bytes += 2 * (sizeof(std::string) + directory.capacity());
+            }
+        for (const std::string& extension : extensions_)
+            {
+            bytes += 2 * (sizeof(std::string) + extension.capacity());
+            }
+        return bytes;
+        }
+
+    void FileTable::moveRow(std::size_t from, std::size_t to)
+        {
+        directoryIds_[to] = directoryIds_[from];
+        nameOffsets_[to] = nameOffsets_[from];
+        nameLengths_[to] = nameLengths_[from];
+        extensionIds_[to] = extensionIds_[from];
+        sizes_[to] = sizes_[from];
+        tokenCounts_[to] = tokenCounts_[from];
+        flags_[to] = flags_[from];
+        }
+
+    void FileTable::resizeRows(std::size_t rowCount)
+        {
+        directoryIds_.resize(rowCount);
+        nameOffsets_.resize(rowCount);
+        nameLengths_.resize(rowCount);
+        extensionIds_.resize(rowCount);
+        sizes_.resize(rowCount);
+        tokenCounts_.resize(rowCount);
+        flags_.resize(rowCount);
+        }
+    }
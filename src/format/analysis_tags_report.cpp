@@ -8,7 +8,7 @@
 namespace repaddu::format
     {
     std::string renderTagSummaryReport(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<std::size_t>& includedIndices)
         {
         analysis::TagExtractor extractor;
@@ -21,13 +21,12 @@ namespace repaddu::format
         std::vector<analysis::TagMatch> matches;
         for (std::size_t index : includedIndices)
             {
-            const auto& entry = files[index];
-            if (entry.isBinary)
+            if (files.binaryState(index) == core::BinaryState::binary)
                 {
                 continue;
                 }
 
-            const auto fileMatches = extractor.extractFromFile(entry.absolutePath, entry.relativePath.string());
+            const auto fileMatches = extractor.extractFromFile(files.absolutePath(index), files.relativePath(index));
             for (const auto& match : fileMatches)
                 {
                 counts[match.tag] += 1;
@@ -0,0 +1,117 @@
+#include "repaddu/format/pack_reader.h"
+
+#include "../format_writer_alt_formats.h"
+
+#include <cstring>
+
+namespace repaddu::format
+    {
+    core::RunResult PackReader::open(const std::filesystem::path& path)
+        {
+        storage_.reset();
+        records_ = nullptr;
+        count_ = 0;
+
+        core::RunResult readResult;
+        const detail::ContentView content = detail::readFileContent(path, readResult);
+        if (readResult.code != core::ExitCode::success)
+            {
+            return readResult;
+            }
+        const std::string_view data = content.view();
+        const core::RunResult corrupt{ core::ExitCode::io_failure, "Not a valid repaddu pack: " + path.string() };
+
+        PackHeader header{};
+        if (data.size() < sizeof(header))
+            {
+            return corrupt;
+            }
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, kPackFileMagic, sizeof(header.magic)) != 0 || header.version != kPackFileVersion
+            || header.recordBytes != sizeof(PackRecord))
+            {
+            return corrupt;
+            }
+
+        // Each region must lie inside the file, checked without overflow.
+        const std::uint64_t size = data.size();
+        const std::uint64_t maxEntries = (size - sizeof(PackHeader)) / sizeof(PackRecord);
+        if (header.entryCount > maxEntries
+            || header.pathsOffset != sizeof(PackHeader) + header.entryCount * sizeof(PackRecord)
+            || header.pathsBytes > size - header.pathsOffset
+            || header.contentOffset != header.pathsOffset + header.pathsBytes
+            || header.contentBytes != size - header.contentOffset)
+            {
+            return corrupt;
+            }
+
+        // The header keeps records 8-byte aligned within the mapping.
+        const auto* records = reinterpret_cast<const PackRecord*>(data.data() + sizeof(PackHeader));
+        const std::string_view paths = data.substr(header.pathsOffset, header.pathsBytes);
+        std::string_view previous;
+        for (std::size_t index = 0; index < header.entryCount; ++index)
+            {
+            const PackRecord& record = records[index];
+            if (record.pathOffset > paths.size() || record.pathBytes > paths.size() - record.pathOffset
+                || record.contentOffset > header.contentBytes
+                || record.contentBytes > header.contentBytes - record.contentOffset)
+                {
+                return corrupt;
+                }
+            const std::string_view current = paths.substr(record.pathOffset, record.pathBytes);
+            if (index > 0 && !(previous < current))
+                {
+                return corrupt;
+                }
+            previous = current;
+            }
+
+        storage_ = std::make_shared<const detail::ContentView>(content);
+        records_ = records;
+        count_ = static_cast<std::size_t>(header.entryCount);
+        paths_ = paths;
+        content_ = data.substr(header.contentOffset, header.contentBytes);
+        return { core::ExitCode::success, "" };
+        }
+
+    std::string_view PackReader::pathOf(std::size_t index) const
+        {
+        return paths_.substr(records_[index].pathOffset, records_[index].pathBytes);
+        }
+
+    PackEntry PackReader::entry(std::size_t index) const
+        {
+        const PackRecord& record = records_[index];
+        PackEntry result;
+        result.path = pathOf(index);
+        result.content = content_.substr(record.contentOffset, record.contentBytes);
+        result.tokenCount = record.tokenCount;
+        result.fileClass = record.fileClass <= static_cast<std::uint32_t>(core::FileClass::other)
+            ? static_cast<core::FileClass>(record.fileClass)
+            : core::FileClass::other;
+        return result;
+        }
+
+    std::optional<PackEntry> PackReader::find(std::string_view path) const
+        {
+        std::size_t low = 0;
+        std::size_t high = count_;
+        while (low < high)
+            {
+            const std::size_t middle = low + (high - low) / 2;
+            if (pathOf(middle) < path)
+                {
+                low = middle + 1;
+                }
+            else
+                {
+                high = middle;
+                }
+            }
+        if (low < count_ && pathOf(low) == path)
+            {
+            return entry(low);
+            }
+        return std::nullopt;
+        }
+    }
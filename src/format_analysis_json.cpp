@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <map>
 #include <sstream>
+#include <string_view>
 
 namespace repaddu::format
     {
@@ -53,7 +54,7 @@ namespace repaddu::format
             return value;
             }
 
-        std::string languageForExtension(const std::string& extensionLower)
+        std::string languageForExtension(std::string_view extensionLower)
             {
             if (extensionLower == ".c" || extensionLower == ".h")
                 {
@@ -77,51 +78,48 @@ namespace repaddu::format
         }
 
     std::string renderAnalysisJson(const core::CliOptions& options,
-                                   const std::vector<core::FileEntry>& allFiles,
+                                   const core::FileTable& allFiles,
                                    const std::vector<std::size_t>& includedIndices,
                                    const analysis::AnalysisGraph* graph,
                                    const analysis::AnalysisViewOptions* viewOptions)
         {
         std::uintmax_t totalSize = 0;
-        for (const auto& f : allFiles)
+        for (std::size_t idx = 0; idx < allFiles.size(); ++idx)
             {
-            totalSize += f.sizeBytes;
+            totalSize += allFiles.sizeBytes(idx);
             }
 
         std::uintmax_t includedSize = 0;
         std::uintmax_t includedTokens = 0;
-        std::vector<core::FileEntry> includedFiles;
-        includedFiles.reserve(includedIndices.size());
 
         for (std::size_t idx : includedIndices)
             {
-            const auto& f = allFiles[idx];
-            includedSize += f.sizeBytes;
-            std::uintmax_t tokens = f.tokenCount;
-            if (tokens == 0 && f.sizeBytes > 0 && !f.isBinary)
+            const std::uintmax_t sizeBytes = allFiles.sizeBytes(idx);
+            includedSize += sizeBytes;
+            std::uintmax_t tokens = allFiles.tokenCount(idx);
+            if (tokens == 0 && sizeBytes > 0 && allFiles.binaryState(idx) != core::BinaryState::binary)
                 {
-                tokens = f.sizeBytes / 4;
+                tokens = sizeBytes / 4;
                 }
             includedTokens += tokens;
-            includedFiles.push_back(f);
             }
 
         std::map<std::string, std::size_t> languageCounts;
         std::map<std::string, std::size_t> buildFiles;
         std::size_t totalFiles = 0;
 
-        for (const auto& entry : includedFiles)
+        for (std::size_t idx : includedIndices)
             {
-            if (!options.includeBinaries && entry.isBinary)
+            if (!options.includeBinaries && allFiles.binaryState(idx) == core::BinaryState::binary)
                 {
                 continue;
                 }
 
-            const std::string language = languageForExtension(entry.extensionLower);
+            const std::string language = languageForExtension(allFiles.extension(idx));
             languageCounts[language] += 1;
             ++totalFiles;
 
-            const std::string filename = normalizeName(entry.relativePath.filename().string());
+            const std::string filename = normalizeName(std::string(allFiles.name(idx)));
             if (filename == "cmakelists.txt")
                 {
                 buildFiles["CMakeLists.txt"] += 1;
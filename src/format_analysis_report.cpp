@@ -9,34 +9,31 @@
 namespace repaddu::format
     {
     std::string renderAnalysisReport(const core::CliOptions& options,
-                                     const std::vector<core::FileEntry>& allFiles,
+                                     const core::FileTable& allFiles,
                                      const std::vector<std::size_t>& includedIndices)
         {
         std::ostringstream out;
         
         std::uintmax_t totalSize = 0;
-        for (const auto& f : allFiles) totalSize += f.sizeBytes;
+        for (std::size_t idx = 0; idx < allFiles.size(); ++idx) totalSize += allFiles.sizeBytes(idx);
 
         std::uintmax_t includedSize = 0;
         std::uintmax_t includedTokens = 0;
-        std::vector<core::FileEntry> includedFiles;
-        includedFiles.reserve(includedIndices.size());
 
         for (std::size_t idx : includedIndices)
             {
-            const auto& f = allFiles[idx];
-            includedSize += f.sizeBytes;
-            // Note: f.tokenCount might be 0 if not read yet, 
+            const std::uintmax_t sizeBytes = allFiles.sizeBytes(idx);
+            includedSize += sizeBytes;
+            // Note: the token count might be 0 if not read yet,
             // but in analyze mode we should probably estimate them all.
             // However, traverseRepository doesn't read content. 
             // We'll do a quick estimate based on size for the report if 0.
-            std::uintmax_t tokens = f.tokenCount;
-            if (tokens == 0 && f.sizeBytes > 0 && !f.isBinary)
+            std::uintmax_t tokens = allFiles.tokenCount(idx);
+            if (tokens == 0 && sizeBytes > 0 && allFiles.binaryState(idx) != core::BinaryState::binary)
                 {
-                tokens = f.sizeBytes / 4; // very rough heuristic for analysis mode
+                tokens = sizeBytes / 4; // very rough heuristic for analysis mode
                 }
             includedTokens += tokens;
-            includedFiles.push_back(f);
             }
 
         out << "==========================================\n";
@@ -55,7 +52,7 @@ namespace repaddu::format
         out << "  Estimated tokens:     ~" << includedTokens << "\n\n";
 
         out << "LANGUAGE BREAKDOWN (Included files):\n";
-        out << renderLanguageReport(options, includedFiles);
+        out << renderLanguageReport(options, allFiles, includedIndices);
         
         out << "\n==========================================\n";
         
@@ -63,7 +60,7 @@ namespace repaddu::format
         }
 
     std::string renderAnalysisReportWithViews(const core::CliOptions& options,
-                                              const std::vector<core::FileEntry>& allFiles,
+                                              const core::FileTable& allFiles,
                                               const std::vector<std::size_t>& includedIndices,
                                               const analysis::AnalysisGraph& graph,
                                               const analysis::AnalysisViewOptions& viewOptions)
@@ -0,0 +1,98 @@
+#include "format_content_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace repaddu::format::detail
+    {
+    ContentCache::ContentCache(std::uintmax_t budgetBytes)
+        : shardBudget_(budgetBytes / kShardCount)
+        {
+        }
+
+    ContentCache::Shard& ContentCache::shardFor(const std::string& key)
+        {
+        return shards_[std::hash<std::string>{}(key) % kShardCount];
+        }
+
+    bool ContentCache::tryGet(const std::filesystem::path& path, ContentView& outContent)
+        {
+        const std::string key = path.string();
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end())
+            {
+            ++shard.stats.misses;
+            return false;
+            }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        outContent = it->second->second;
+        ++shard.stats.hits;
+        return true;
+        }
+
+    void ContentCache::store(const std::filesystem::path& path, const ContentView& content)
+        {
+        if (shardBudget_ == 0)
+            {
+            return;
+            }
+        const std::string key = path.string();
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (content.size() > shardBudget_)
+            {
+            ++shard.stats.rejected;
+            return;
+            }
+        auto it = shard.index.find(key);
+        if (it != shard.index.end())
+            {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+            }
+
+        shard.lru.emplace_front(key, content);
+        shard.index.emplace(key, shard.lru.begin());
+        shard.stats.bytes += content.size();
+        ++shard.stats.insertions;
+        while (shard.stats.bytes > shardBudget_)
+            {
+            const Shard::Entry& victim = shard.lru.back();
+            shard.stats.bytes -= victim.second.size();
+            shard.index.erase(victim.first);
+            shard.lru.pop_back();
+            ++shard.stats.evictions;
+            }
+        shard.stats.peakBytes = std::max(shard.stats.peakBytes, shard.stats.bytes);
+        }
+
+    ContentCacheStats ContentCache::stats() const
+        {
+        ContentCacheStats total;
+        for (const Shard& shard : shards_)
+            {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total.hits += shard.stats.hits;
+            total.misses += shard.stats.misses;
+            total.insertions += shard.stats.insertions;
+            total.evictions += shard.stats.evictions;
+            total.rejected += shard.stats.rejected;
+            total.bytes += shard.stats.bytes;
+            // Shards peak at different times; the sum is an upper bound.
+            total.peakBytes += shard.stats.peakBytes;
+            }
+        return total;
+        }
+
+    std::string formatContentCacheStats(const ContentCacheStats& stats)
+        {
+        return "Content cache: " + std::to_string(stats.hits) + " hits, "
+            + std::to_string(stats.misses) + " misses, "
+            + std::to_string(stats.insertions) + " insertions, "
+            + std::to_string(stats.evictions) + " evictions, "
+            + std::to_string(stats.rejected) + " rejected, "
+            + std::to_string(stats.bytes) + " bytes held (peak <= " + std::to_string(stats.peakBytes) + ").";
+        }
+    }
@@ -0,0 +1,63 @@
+#ifndef REPADDU_FORMAT_CONTENT_CACHE_H
+#define REPADDU_FORMAT_CONTENT_CACHE_H
+
+#include "format_content_view.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace repaddu::format::detail
+    {
+    struct ContentCacheStats
+        {
+        std::uintmax_t hits = 0;
+        std::uintmax_t misses = 0;
+        std::uintmax_t insertions = 0;
+        std::uintmax_t evictions = 0;
+        std::uintmax_t rejected = 0; // Larger than a shard's budget.
+        std::uintmax_t bytes = 0;
+        std::uintmax_t peakBytes = 0;
+        };
+
+    // Byte-budgeted LRU cache of file contents keyed by path, split into
+    // shards that each own a slice of the budget and a mutex. Entries share
+    // ownership of their ContentView, so hits are zero-copy. A zero budget
+    // disables the cache.
+    class ContentCache
+        {
+        public:
+            explicit ContentCache(std::uintmax_t budgetBytes);
+
+            bool tryGet(const std::filesystem::path& path, ContentView& outContent);
+            void store(const std::filesystem::path& path, const ContentView& content);
+            ContentCacheStats stats() const;
+
+        private:
+            static constexpr std::size_t kShardCount = 16;
+
+            struct Shard
+                {
+                using Entry = std::pair<std::string, ContentView>;
+
+                mutable std::mutex mutex;
+                std::list<Entry> lru; // Most recently used first.
+                std::unordered_map<std::string, std::list<Entry>::iterator> index;
+                ContentCacheStats stats;
+                };
+
+            Shard& shardFor(const std::string& key);
+
+            std::uintmax_t shardBudget_ = 0;
+            std::array<Shard, kShardCount> shards_;
+        };
+
+    std::string formatContentCacheStats(const ContentCacheStats& stats);
+    }
+
+#endif // REPADDU_FORMAT_CONTENT_CACHE_H
@@ -0,0 +1,469 @@
+#include "format_content_store.h"
+
+#include "format_writer_alt_formats.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <unordered_set>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace repaddu::format::detail
+    {
+    namespace
+        {
+        // The last byte is the index version; an index of another version
+        // is dropped without a warning.
+        constexpr char kIndexMagic[8] = { 'R', 'P', 'D', 'C', 'I', 'D', 'X', '2' };
+        constexpr char kPackMagic[8] = { 'R', 'P', 'D', 'C', 'P', 'A', 'K', '1' };
+
+        // magic, u32 generation, u32 reserved, u64 record count.
+        constexpr std::size_t kIndexHeaderBytes = 24;
+
+        // Files modified this close to the run start may still change within
+        // the same timestamp tick, so their results are never stored.
+        constexpr std::int64_t kRacyWindowNs = 2'000'000'000;
+
+        std::int64_t nowNs()
+            {
+            const auto now = std::chrono::system_clock::now();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+            }
+
+        std::uint64_t mixField(std::uint64_t hash, std::uint64_t value)
+            {
+            constexpr std::uint64_t prime = 1099511628211ULL;
+            for (int shift = 0; shift < 64; shift += 8)
+                {
+                hash ^= (value >> shift) & 0xFF;
+                hash *= prime;
+                }
+            return hash;
+            }
+
+        bool writeFreshPack(const std::filesystem::path& path)
+            {
+            std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+            stream.write(kPackMagic, sizeof(kPackMagic));
+            return static_cast<bool>(stream);
+            }
+        }
+
+    ContentStore::~ContentStore()
+        {
+        unlock();
+        }
+
+    bool ContentStore::lock()
+        {
+        const std::filesystem::path lockPath = directory_ / "lock";
+#if defined(_WIN32)
+        HANDLE handle = CreateFileW(lockPath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            {
+            return false;
+            }
+        OVERLAPPED overlapped{};
+        if (!LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped))
+            {
+            CloseHandle(handle);
+            return false;
+            }
+        lock_ = handle;
+#else
+        const int fd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+            {
+            return false;
+            }
+        int status = 0;
+        while ((status = ::flock(fd, LOCK_EX)) != 0 && errno == EINTR)
+            {
+            }
+        if (status != 0)
+            {
+            ::close(fd);
+            return false;
+            }
+        lock_ = fd;
+#endif
+        return true;
+        }
+
+    void ContentStore::unlock()
+        {
+        // Closing the handle releases the lock.
+#if defined(_WIN32)
+        if (lock_)
+            {
+            CloseHandle(static_cast<HANDLE>(lock_));
+            lock_ = nullptr;
+            }
+#else
+        if (lock_ >= 0)
+            {
+            ::close(lock_);
+            lock_ = -1;
+            }
+#endif
+        }
+
+    core::RunResult ContentStore::open(const std::filesystem::path& directory, std::uint64_t rulesHash)
+        {
+        directory_ = directory;
+        rulesHash_ = rulesHash;
+        openedNs_ = nowNs();
+        opened_ = true;
+
+        std::error_code errorCode;
+        std::filesystem::create_directories(directory_, errorCode);
+        if (errorCode)
+            {
+            opened_ = false;
+            return { core::ExitCode::io_failure, "Failed to create content store: " + directory_.string() };
+            }
+        if (!lock())
+            {
+            opened_ = false;
+            return { core::ExitCode::io_failure, "Failed to lock content store: " + directory_.string() };
+            }
+
+        const std::filesystem::path indexPath = directory_ / "index";
+        const std::filesystem::path packPath = directory_ / "pack";
+        core::RunResult result{ core::ExitCode::success, "" };
+        if (std::filesystem::exists(indexPath, errorCode))
+            {
+            core::RunResult readResult;
+            index_ = readFileContent(indexPath, readResult);
+            pack_ = readFileContent(packPath, readResult);
+            const std::string_view index = index_.view();
+            const std::string_view pack = pack_.view();
+            std::uint64_t count = 0;
+            const bool otherVersion = index.size() >= kIndexHeaderBytes
+                && std::memcmp(index.data(), kIndexMagic, sizeof(kIndexMagic) - 1) == 0
+                && index[sizeof(kIndexMagic) - 1] != kIndexMagic[sizeof(kIndexMagic) - 1];
+            bool valid = readResult.code == core::ExitCode::success && index.size() >= kIndexHeaderBytes
+                && std::memcmp(index.data(), kIndexMagic, sizeof(kIndexMagic)) == 0
+                && pack.size() >= sizeof(kPackMagic) && std::memcmp(pack.data(), kPackMagic, sizeof(kPackMagic)) == 0;
+            if (valid)
+                {
+                std::memcpy(&count, index.data() + 16, sizeof(count));
+                valid = count == (index.size() - kIndexHeaderBytes) / sizeof(Record)
+                    && (index.size() - kIndexHeaderBytes) % sizeof(Record) == 0;
+                }
+            if (valid)
+                {
+                std::uint32_t generation = 0;
+                std::memcpy(&generation, index.data() + 8, sizeof(generation));
+                generation_ = generation + 1;
+                // The header keeps records 8-byte aligned within the mapping.
+                records_ = reinterpret_cast<const Record*>(index.data() + kIndexHeaderBytes);
+                recordCount_ = static_cast<std::size_t>(count);
+                packSize_ = pack.size();
+                }
+            else
+                {
+                if (!otherVersion)
+                    {
+                    result = { core::ExitCode::io_failure, "Content store is corrupt: " + directory_.string() };
+                    }
+                index_ = ContentView();
+                pack_ = ContentView();
+                }
+            }
+
+        if (!records_ && !writeFreshPack(packPath))
+            {
+            opened_ = false;
+            unlock();
+            return { core::ExitCode::io_failure, "Failed to write content store: " + directory_.string() };
+            }
+        if (!records_)
+            {
+            packSize_ = sizeof(kPackMagic);
+            }
+
+        packAppend_.open(packPath, std::ios::binary | std::ios::app);
+        if (!packAppend_)
+            {
+            opened_ = false;
+            unlock();
+            return { core::ExitCode::io_failure, "Failed to write content store: " + directory_.string() };
+            }
+        return result;
+        }
+
+    bool ContentStore::sameKey(const Record& lhs, const Record& rhs)
+        {
+        return lhs.key == rhs.key && lhs.rulesHash == rhs.rulesHash && lhs.device == rhs.device && lhs.inode == rhs.inode
+            && lhs.sizeBytes == rhs.sizeBytes && lhs.mtimeNs == rhs.mtimeNs && lhs.ctimeNs == rhs.ctimeNs;
+        }
+
+    ContentStore::Record ContentStore::recordOf(const FileIdentity& identity) const
+        {
+        Record record{};
+        record.rulesHash = rulesHash_;
+        record.device = identity.device;
+        record.inode = identity.inode;
+        record.sizeBytes = identity.sizeBytes;
+        record.mtimeNs = identity.mtimeNs;
+        record.ctimeNs = identity.ctimeNs;
+        std::uint64_t key = mixField(rulesHash_, identity.device);
+        key = mixField(key, identity.inode);
+        key = mixField(key, identity.sizeBytes);
+        key = mixField(key, static_cast<std::uint64_t>(identity.mtimeNs));
+        record.key = mixField(key, static_cast<std::uint64_t>(identity.ctimeNs));
+        return record;
+        }
+
+    const ContentStore::Record* ContentStore::findRecord(const Record& key) const
+        {
+        const Record* end = records_ + recordCount_;
+        for (const Record* it = std::lower_bound(records_, end, key.key,
+                 [](const Record& record, std::uint64_t value)
+                 {
+                 return record.key < value;
+                 });
+             it != end && it->key == key.key; ++it)
+            {
+            if (sameKey(*it, key))
+                {
+                return it;
+                }
+            }
+        return nullptr;
+        }
+
+    bool ContentStore::lookup(const FileIdentity& identity, StoredContent& outContent)
+        {
+        if (!opened_ || !identity.valid)
+            {
+            return false;
+            }
+        const Record* record = records_ ? findRecord(recordOf(identity)) : nullptr;
+        const bool usable = record && record->packOffset <= pack_.size()
+            && record->packLength <= pack_.size() - record->packOffset;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!usable)
+            {
+            ++stats_.misses;
+            return false;
+            }
+        ++stats_.hits;
+        usedRecords_.push_back(static_cast<std::size_t>(record - records_));
+
+        outContent.unchanged = (record->flags & kUnchanged) != 0;
+        outContent.tokenCount = record->tokenCount;
+        outContent.redacted = outContent.unchanged
+            ? ContentView()
+            : pack_.subview(static_cast<std::size_t>(record->packOffset), static_cast<std::size_t>(record->packLength));
+        return true;
+        }
+
+    void ContentStore::insert(const FileIdentity& identity, bool unchanged, std::string_view redacted,
+        std::uint64_t tokenCount)
+        {
+        if (!opened_ || !identity.valid)
+            {
+            return;
+            }
+        // Only writes change the content, and a write moves mtime; ctime
+        // is part of the key and needs no racy check of its own.
+        if (identity.mtimeNs >= openedNs_ - kRacyWindowNs)
+            {
+            return;
+            }
+
+        Record record = recordOf(identity);
+        record.tokenCount = tokenCount;
+        record.flags = unchanged ? kUnchanged : 0;
+        record.generation = generation_;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!unchanged)
+            {
+            if (!packAppend_)
+                {
+                return;
+                }
+            // Offsets come from the end of the file itself, not from what
+            // this run believes it has appended.
+            packAppend_.seekp(0, std::ios::end);
+            const std::streamoff end = packAppend_.tellp();
+            if (!packAppend_ || end < 0)
+                {
+                return;
+                }
+            record.packOffset = static_cast<std::uint64_t>(end);
+            record.packLength = redacted.size();
+            packAppend_.write(redacted.data(), static_cast<std::streamsize>(redacted.size()));
+            if (!packAppend_)
+                {
+                return;
+                }
+            packSize_ = record.packOffset + redacted.size();
+            }
+        const auto range = inserted_.equal_range(record.key);
+        const auto same = std::find_if(range.first, range.second,
+            [&](const auto& entry)
+            {
+            return sameKey(entry.second, record);
+            });
+        if (same != range.second)
+            {
+            same->second = record;
+            }
+        else
+            {
+            inserted_.emplace(record.key, record);
+            }
+        ++stats_.insertions;
+        }
+
+    core::RunResult ContentStore::save()
+        {
+        const core::RunResult result = saveLocked();
+        opened_ = false;
+        unlock();
+        return result;
+        }
+
+    core::RunResult ContentStore::saveLocked()
+        {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!opened_)
+            {
+            return { core::ExitCode::success, "" };
+            }
+        packAppend_.close();
+        if (!packAppend_)
+            {
+            return { core::ExitCode::io_failure, "Failed to write content store: " + directory_.string() };
+            }
+
+        const std::unordered_set<std::size_t> used(usedRecords_.begin(), usedRecords_.end());
+        std::vector<Record> records;
+        records.reserve(recordCount_ + inserted_.size());
+        std::uint64_t liveBytes = 0;
+        for (std::size_t index = 0; index < recordCount_; ++index)
+            {
+            Record record = records_[index];
+            const auto range = inserted_.equal_range(record.key);
+            if (std::any_of(range.first, range.second,
+                    [&](const auto& entry)
+                    {
+                    return sameKey(entry.second, record);
+                    }))
+                {
+                continue;
+                }
+            if (used.count(index) != 0)
+                {
+                record.generation = generation_;
+                }
+            if (generation_ - record.generation >= kKeepRuns)
+                {
+                continue;
+                }
+            liveBytes += record.packLength;
+            records.push_back(record);
+            }
+        for (const auto& entry : inserted_)
+            {
+            liveBytes += entry.second.packLength;
+            records.push_back(entry.second);
+            }
+        std::sort(records.begin(), records.end(),
+            [](const Record& lhs, const Record& rhs)
+            {
+            return lhs.key < rhs.key;
+            });
+
+        // Rewrite the pack once dropped records make up most of it. The old
+        // mapping stays valid for views still held by this run.
+        const std::filesystem::path packPath = directory_ / "pack";
+        std::error_code errorCode;
+        if (liveBytes * 2 < packSize_ - sizeof(kPackMagic))
+            {
+            core::RunResult readResult;
+            const ContentView pack = readFileContent(packPath, readResult);
+            if (readResult.code != core::ExitCode::success || pack.size() != packSize_)
+                {
+                return { core::ExitCode::io_failure, "Failed to read content store: " + directory_.string() };
+                }
+            std::filesystem::path tempPath = packPath;
+            tempPath += ".tmp";
+            {
+                std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+                stream.write(kPackMagic, sizeof(kPackMagic));
+                std::uint64_t offset = sizeof(kPackMagic);
+                for (Record& record : records)
+                    {
+                    if (record.packLength == 0)
+                        {
+                        continue;
+                        }
+                    stream.write(pack.view().data() + record.packOffset, static_cast<std::streamsize>(record.packLength));
+                    record.packOffset = offset;
+                    offset += record.packLength;
+                    }
+                if (!stream)
+                    {
+                    return { core::ExitCode::io_failure, "Failed to write content store: " + directory_.string() };
+                    }
+            }
+            std::filesystem::rename(tempPath, packPath, errorCode);
+            if (errorCode)
+                {
+                std::filesystem::remove(tempPath, errorCode);
+                return { core::ExitCode::io_failure, "Failed to replace content store: " + directory_.string() };
+                }
+            }
+
+        // Write next to the target and rename so a crashed run never leaves a torn index.
+        const std::filesystem::path indexPath = directory_ / "index";
+        std::filesystem::path tempPath = indexPath;
+        tempPath += ".tmp";
+        {
+            std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+            const std::uint32_t reserved = 0;
+            const std::uint64_t count = records.size();
+            stream.write(kIndexMagic, sizeof(kIndexMagic));
+            stream.write(reinterpret_cast<const char*>(&generation_), sizeof(generation_));
+            stream.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+            stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            stream.write(reinterpret_cast<const char*>(records.data()),
+                static_cast<std::streamsize>(records.size() * sizeof(Record)));
+            if (!stream)
+                {
+                return { core::ExitCode::io_failure, "Failed to write content store: " + directory_.string() };
+                }
+        }
+        std::filesystem::rename(tempPath, indexPath, errorCode);
+        if (errorCode)
+            {
+            std::filesystem::remove(tempPath, errorCode);
+            return { core::ExitCode::io_failure, "Failed to replace content store: " + directory_.string() };
+            }
+        return { core::ExitCode::success, "" };
+        }
+
+    ContentStoreStats ContentStore::stats() const
+        {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+        }
+    }
@@ -0,0 +1,130 @@
+#ifndef REPADDU_FORMAT_CONTENT_STORE_H
+#define REPADDU_FORMAT_CONTENT_STORE_H
+
+#include "format_content_view.h"
+
+#include "repaddu/core_types.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace repaddu::format::detail
+    {
+    // What fstat() says about an open file. The store trusts a file to be
+    // unchanged while every field matches; valid is false where no stat
+    // was taken (Windows, stream fallback).
+    struct FileIdentity
+        {
+        std::uint64_t device = 0;
+        std::uint64_t inode = 0;
+        std::uint64_t sizeBytes = 0;
+        std::int64_t mtimeNs = 0;
+        std::int64_t ctimeNs = 0;
+        bool valid = false;
+        };
+
+    struct StoredContent
+        {
+        bool unchanged = true;    // Redaction left the file as it is.
+        std::uint64_t tokenCount = 0;
+        ContentView redacted;     // Set when !unchanged; a view of the mapped pack.
+        };
+
+    struct ContentStoreStats
+        {
+        std::uintmax_t hits = 0;
+        std::uintmax_t misses = 0;
+        std::uintmax_t insertions = 0;
+        };
+
+    // Persistent cache of redaction results and token counts, keyed by
+    // file identity plus the redaction rule set and tokenizer. A directory
+    // holds two files:
+    //   index - header and fixed-size records sorted by a hash of the key,
+    //           mapped and binary-searched in place (native byte order);
+    //           each record holds the full key, compared on lookup;
+    //   pack  - append-only redacted bodies; unchanged files store none.
+    // Lookups only see the index as it was when the store was opened;
+    // save() merges this run's insertions, drops records unused for
+    // kKeepRuns runs and compacts the pack once most of it is dead.
+    // open() takes an exclusive lock on the directory's lock file and
+    // holds it until save() or destruction, so runs sharing a store wait
+    // for each other instead of appending to the same pack.
+    class ContentStore
+        {
+        public:
+            ContentStore() = default;
+            ~ContentStore();
+            ContentStore(const ContentStore&) = delete;
+            ContentStore& operator=(const ContentStore&) = delete;
+
+            // A missing store starts empty; an unreadable or foreign one is
+            // discarded and rebuilt by save().
+            core::RunResult open(const std::filesystem::path& directory, std::uint64_t rulesHash);
+            core::RunResult save();
+
+            bool lookup(const FileIdentity& identity, StoredContent& outContent);
+            // redacted is ignored when unchanged is set.
+            void insert(const FileIdentity& identity, bool unchanged, std::string_view redacted, std::uint64_t tokenCount);
+
+            ContentStoreStats stats() const;
+
+        private:
+            struct Record
+                {
+                std::uint64_t key;        // Hash of the fields below; orders the index.
+                std::uint64_t rulesHash;
+                std::uint64_t device;
+                std::uint64_t inode;
+                std::uint64_t sizeBytes;
+                std::int64_t mtimeNs;
+                std::int64_t ctimeNs;
+                std::uint64_t packOffset;
+                std::uint64_t packLength;
+                std::uint64_t tokenCount;
+                std::uint32_t flags;
+                std::uint32_t generation; // Run that last used the record.
+                };
+            static_assert(sizeof(Record) == 88, "index records are stored as raw bytes");
+
+            static constexpr std::uint32_t kUnchanged = 1;
+            static constexpr std::uint32_t kKeepRuns = 8;
+
+            static bool sameKey(const Record& lhs, const Record& rhs);
+
+            Record recordOf(const FileIdentity& identity) const;
+            const Record* findRecord(const Record& key) const;
+            bool lock();
+            void unlock();
+            core::RunResult saveLocked();
+
+            std::filesystem::path directory_;
+            std::uint64_t rulesHash_ = 0;
+            std::int64_t openedNs_ = 0;
+            std::uint32_t generation_ = 1;
+            ContentView index_;
+            ContentView pack_;
+            const Record* records_ = nullptr;
+            std::size_t recordCount_ = 0;
+
+            mutable std::mutex mutex_;
+            std::ofstream packAppend_;
+            std::uint64_t packSize_ = 0;
+            std::vector<std::size_t> usedRecords_;
+            std::unordered_multimap<std::uint64_t, Record> inserted_;
+            ContentStoreStats stats_;
+            bool opened_ = false;
+#if defined(_WIN32)
+            void* lock_ = nullptr;
+#else
+            int lock_ = -1;
+#endif
+        };
+    }
+
+#endif // REPADDU_FORMAT_CONTENT_STORE_H
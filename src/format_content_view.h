@@ -0,0 +1,59 @@
+#ifndef REPADDU_FORMAT_CONTENT_VIEW_H
+#define REPADDU_FORMAT_CONTENT_VIEW_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace repaddu::format::detail
+    {
+    // Read-only file content shared by reference. The bytes are either a
+    // memory mapping of the file or an owned string (stream reads, redacted
+    // content); copies of a view share the same storage, so passing one
+    // through the cache and the writers never copies the bytes.
+    class ContentView
+        {
+        public:
+            ContentView() = default;
+
+            explicit ContentView(std::string text)
+                {
+                auto owned = std::make_shared<const std::string>(std::move(text));
+                data_ = *owned;
+                owner_ = std::move(owned);
+                }
+
+            // Borrows data, which stays valid for as long as owner is alive.
+            ContentView(std::shared_ptr<const void> owner, std::string_view data)
+                : owner_(std::move(owner)), data_(data)
+                {
+                }
+
+            std::string_view view() const
+                {
+                return data_;
+                }
+
+            std::size_t size() const
+                {
+                return data_.size();
+                }
+
+            bool empty() const
+                {
+                return data_.empty();
+                }
+
+            // A view of part of this one that shares its storage.
+            ContentView subview(std::size_t offset, std::size_t length) const
+                {
+                return ContentView(owner_, data_.substr(offset, length));
+                }
+
+        private:
+            std::shared_ptr<const void> owner_;
+            std::string_view data_;
+        };
+    }
+
+#endif // REPADDU_FORMAT_CONTENT_VIEW_H
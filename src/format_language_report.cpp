@@ -6,12 +6,13 @@
 #include <iomanip>
 #include <map>
 #include <sstream>
+#include <string_view>
 
 namespace repaddu::format
     {
     namespace
         {
-        std::string languageForExtension(const std::string& extensionLower)
+        std::string languageForExtension(std::string_view extensionLower)
             {
             if (extensionLower == ".c" || extensionLower == ".h")
                 {
@@ -33,8 +34,9 @@ namespace repaddu::format
             return "Other";
             }
 
-        std::string normalizeName(std::string value)
+        std::string normalizeName(std::string_view name)
             {
+            std::string value(name);
             std::transform(value.begin(), value.end(), value.begin(),
                 [](unsigned char ch)
                 {
@@ -45,24 +47,36 @@ namespace repaddu::format
         }
 
     std::string renderLanguageReport(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files)
+        const core::FileTable& files)
+        {
+        std::vector<std::size_t> indices(files.size());
+        for (std::size_t index = 0; index < indices.size(); ++index)
+            {
+            indices[index] = index;
+            }
+        return renderLanguageReport(options, files, indices);
+        }
+
+    std::string renderLanguageReport(const core::CliOptions& options,
+        const core::FileTable& files,
+        const std::vector<std::size_t>& indices)
         {
         std::map<std::string, std::size_t> languageCounts;
         std::map<std::string, std::size_t> buildFiles;
         std::size_t totalFiles = 0;
 
-        for (const auto& entry : files)
+        for (std::size_t index : indices)
             {
-            if (!options.includeBinaries && entry.isBinary)
+            if (!options.includeBinaries && files.binaryState(index) == core::BinaryState::binary)
                 {
                 continue;
                 }
 
-            const std::string language = languageForExtension(entry.extensionLower);
+            const std::string language = languageForExtension(files.extension(index));
             languageCounts[language] += 1;
             ++totalFiles;
 
-            const std::string filename = normalizeName(entry.relativePath.filename().string());
+            const std::string filename = normalizeName(files.name(index));
             if (filename == "cmakelists.txt")
                 {
                 buildFiles["CMakeLists.txt"] += 1;
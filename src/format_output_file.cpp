@@ -0,0 +1,407 @@
+#include "format_output_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <new>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+#endif
+
+namespace repaddu::format::detail
+    {
+    namespace
+        {
+        constexpr std::align_val_t kBufferAlignment{ 4096 };
+
+#if !defined(_WIN32)
+        // writev() until every byte of every iovec is out, resuming after
+        // short writes and EINTR.
+        bool writeAll(int fd, iovec* parts, int count)
+            {
+            while (count > 0)
+                {
+                const ssize_t written = ::writev(fd, parts, count);
+                if (written < 0)
+                    {
+                    if (errno == EINTR)
+                        {
+                        continue;
+                        }
+                    return false;
+                    }
+                std::size_t remaining = static_cast<std::size_t>(written);
+                while (count > 0 && remaining >= parts->iov_len)
+                    {
+                    remaining -= parts->iov_len;
+                    ++parts;
+                    --count;
+                    }
+                if (count > 0)
+                    {
+                    parts->iov_base = static_cast<char*>(parts->iov_base) + remaining;
+                    parts->iov_len -= remaining;
+                    }
+                }
+            return true;
+            }
+#endif
+        }
+
+    void OutputFile::BufferDelete::operator()(char* buffer) const
+        {
+        ::operator delete(buffer, kBufferAlignment);
+        }
+
+    OutputFile::OutputFile()
+        : buffer_(static_cast<char*>(::operator new(kBufferBytes, kBufferAlignment)))
+        {
+        }
+
+    OutputFile::~OutputFile()
+        {
+        close();
+        }
+
+    bool OutputFile::isOpen() const
+        {
+#if defined(_WIN32)
+        return handle_ != nullptr;
+#else
+        return fd_ >= 0;
+#endif
+        }
+
+    bool OutputFile::open(const std::filesystem::path& path)
+        {
+        close();
+        used_ = 0;
+#if defined(_WIN32)
+        HANDLE handle = CreateFileW(path.wstring().c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        handle_ = handle == INVALID_HANDLE_VALUE ? nullptr : handle;
+#else
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+#endif
+        ok_ = isOpen();
+        return ok_;
+        }
+
+    bool OutputFile::openStandardOutput()
+        {
+        close();
+        used_ = 0;
+#if defined(_WIN32)
+        HANDLE handle = nullptr;
+        const HANDLE process = GetCurrentProcess();
+        if (!DuplicateHandle(process, GetStdHandle(STD_OUTPUT_HANDLE), process, &handle, 0, FALSE,
+                DUPLICATE_SAME_ACCESS))
+            {
+            handle = nullptr;
+            }
+        handle_ = handle;
+#else
+        fd_ = ::fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0);
+#endif
+        ok_ = isOpen();
+        return ok_;
+        }
+
+    bool OutputFile::openMapped(const std::filesystem::path& path, std::uintmax_t size)
+        {
+#if defined(_WIN32)
+        return open(path);
+#else
+        if (size == 0 || size > std::numeric_limits<std::size_t>::max())
+            {
+            return open(path);
+            }
+        close();
+        used_ = 0;
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        ok_ = fd_ >= 0;
+        if (!ok_)
+            {
+            return false;
+            }
+        const off_t length = static_cast<off_t>(size);
+#if defined(__linux__)
+        // Allocating the whole file at once gives the filesystem the chance
+        // to lay it out contiguously; ftruncate only sets the size.
+        bool allocated = ::fallocate(fd_, 0, 0, length) == 0;
+        if (!allocated && errno != EOPNOTSUPP && errno != ENOSYS)
+            {
+            ok_ = false;
+            return false;
+            }
+#else
+        bool allocated = false;
+#endif
+        if (!allocated && ::ftruncate(fd_, length) != 0)
+            {
+            ok_ = false;
+            return false;
+            }
+        void* mapping = ::mmap(nullptr, static_cast<std::size_t>(size), PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED)
+            {
+            ok_ = false;
+            return false;
+            }
+        map_ = static_cast<char*>(mapping);
+        mapSize_ = static_cast<std::size_t>(size);
+        position_ = 0;
+        return true;
+#endif
+        }
+
+    bool OutputFile::write(std::string_view text)
+        {
+        if (!ok_)
+            {
+            return false;
+            }
+#if !defined(_WIN32)
+        if (map_)
+            {
+            return writeMapped(text);
+            }
+#endif
+        if (text.size() >= kDirectWriteBytes)
+            {
+            return writeOut(text);
+            }
+        if (used_ + text.size() > kBufferBytes && !writeOut({}))
+            {
+            return false;
+            }
+        std::memcpy(buffer_.get() + used_, text.data(), text.size());
+        used_ += text.size();
+        return true;
+        }
+
+    bool OutputFile::writeOut(std::string_view tail)
+        {
+        if (!isOpen())
+            {
+            ok_ = false;
+            return false;
+            }
+#if defined(_WIN32)
+        auto writeRange = [&](const char* data, std::size_t size)
+            {
+            while (size > 0)
+                {
+                const DWORD chunk = static_cast<DWORD>(size < (1u << 30) ? size : (1u << 30));
+                DWORD written = 0;
+                if (!WriteFile(static_cast<HANDLE>(handle_), data, chunk, &written, nullptr) || written == 0)
+                    {
+                    return false;
+                    }
+                data += written;
+                size -= written;
+                }
+            return true;
+            };
+        ok_ = writeRange(buffer_.get(), used_) && writeRange(tail.data(), tail.size());
+#else
+        iovec parts[2];
+        int count = 0;
+        if (used_ > 0)
+            {
+            parts[count++] = { buffer_.get(), used_ };
+            }
+        if (!tail.empty())
+            {
+            parts[count++] = { const_cast<char*>(tail.data()), tail.size() };
+            }
+        ok_ = writeAll(fd_, parts, count);
+#endif
+        used_ = 0;
+        return ok_;
+        }
+
+    bool OutputFile::writeMapped(std::string_view text)
+        {
+#if !defined(_WIN32)
+        if (text.size() > mapSize_ - position_)
+            {
+            ok_ = false;
+            return false;
+            }
+        std::memcpy(map_ + position_, text.data(), text.size());
+        position_ += text.size();
+#endif
+        return ok_;
+        }
+
+    std::uintmax_t OutputFile::copyFrom(const std::filesystem::path& source, std::uintmax_t bytes)
+        {
+        if (!ok_ || (used_ > 0 && !writeOut({})))
+            {
+            return 0;
+            }
+        std::uintmax_t copied = 0;
+#if defined(_WIN32)
+        std::ifstream stream(source, std::ios::binary);
+        if (!stream)
+            {
+            ok_ = false;
+            return 0;
+            }
+        while (copied < bytes && ok_)
+            {
+            const std::size_t chunk = static_cast<std::size_t>(std::min<std::uintmax_t>(bytes - copied, kBufferBytes));
+            stream.read(buffer_.get(), static_cast<std::streamsize>(chunk));
+            const std::size_t read = static_cast<std::size_t>(stream.gcount());
+            if (read == 0)
+                {
+                break;
+                }
+            used_ = read;
+            writeOut({});
+            copied += read;
+            }
+#else
+        if (map_ && bytes > mapSize_ - position_)
+            {
+            ok_ = false;
+            return 0;
+            }
+        const int input = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+        if (input < 0)
+            {
+            ok_ = false;
+            return 0;
+            }
+#if defined(__linux__)
+        // Each method is dropped for the rest of the file once the kernel
+        // says it cannot serve this pair of files. A mapped file is written
+        // at an explicit offset, which sendfile cannot do.
+        bool tryCopyRange = true;
+        bool trySendfile = map_ == nullptr;
+#endif
+        while (copied < bytes)
+            {
+            const std::size_t chunk = static_cast<std::size_t>(std::min<std::uintmax_t>(bytes - copied, 1u << 30));
+            ssize_t moved = 0;
+#if defined(__linux__)
+            if (tryCopyRange)
+                {
+                loff_t offset = static_cast<loff_t>(position_);
+                moved = ::copy_file_range(input, nullptr, fd_, map_ ? &offset : nullptr, chunk, 0);
+                if (moved < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+                    {
+                    tryCopyRange = false;
+                    continue;
+                    }
+                }
+            else if (trySendfile)
+                {
+                moved = ::sendfile(fd_, input, nullptr, chunk);
+                if (moved < 0 && (errno == ENOSYS || errno == EINVAL))
+                    {
+                    trySendfile = false;
+                    continue;
+                    }
+                }
+            else
+#endif
+            if (map_)
+                {
+                moved = ::read(input, map_ + position_, chunk);
+                }
+            else
+                {
+                moved = ::read(input, buffer_.get(), std::min(chunk, kBufferBytes));
+                if (moved > 0)
+                    {
+                    iovec part{ buffer_.get(), static_cast<std::size_t>(moved) };
+                    if (!writeAll(fd_, &part, 1))
+                        {
+                        ok_ = false;
+                        break;
+                        }
+                    }
+                }
+            if (moved < 0)
+                {
+                if (errno == EINTR)
+                    {
+                    continue;
+                    }
+                ok_ = false;
+                break;
+                }
+            if (moved == 0)
+                {
+                break;
+                }
+            copied += static_cast<std::uintmax_t>(moved);
+            if (map_)
+                {
+                position_ += static_cast<std::size_t>(moved);
+                }
+            }
+        ::close(input);
+#endif
+        return copied;
+        }
+
+    bool OutputFile::close()
+        {
+        if (!isOpen())
+            {
+            return ok_;
+            }
+        if (ok_ && used_ > 0)
+            {
+            writeOut({});
+            }
+#if defined(_WIN32)
+        if (!CloseHandle(static_cast<HANDLE>(handle_)))
+            {
+            ok_ = false;
+            }
+        handle_ = nullptr;
+#else
+        if (map_)
+            {
+            // Every byte of the allocation must have been written; the
+            // writeback itself is left to the kernel, as for write().
+            if (position_ != mapSize_)
+                {
+                ok_ = false;
+                }
+            if (::msync(map_, mapSize_, MS_ASYNC) != 0 || ::munmap(map_, mapSize_) != 0)
+                {
+                ok_ = false;
+                }
+            map_ = nullptr;
+            mapSize_ = 0;
+            position_ = 0;
+            }
+        if (::close(fd_) != 0)
+            {
+            ok_ = false;
+            }
+        fd_ = -1;
+#endif
+        used_ = 0;
+        return ok_;
+        }
+    }
@@ -0,0 +1,83 @@
+#ifndef REPADDU_FORMAT_OUTPUT_FILE_H
+#define REPADDU_FORMAT_OUTPUT_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+namespace repaddu::format::detail
+    {
+    // An output file written through one large page-aligned buffer instead
+    // of an ofstream. Marker fragments are copied into the buffer; a write
+    // of at least kDirectWriteBytes (file content, usually mapped) goes out
+    // together with the buffered fragments in a single writev() without
+    // being copied; whole file bodies can instead be copied by the kernel
+    // without passing through userspace at all. Failures are sticky: once
+    // a write fails, every later call reports it and close() does too.
+    //
+    // openMapped() instead allocates a file of a known final size up front
+    // and maps it: writes are copies into the mapping, bodies are copied by
+    // the kernel at their offset, and writing past the planned size fails.
+    class OutputFile
+        {
+        public:
+            static constexpr std::size_t kBufferBytes = 256 * 1024;
+            static constexpr std::size_t kDirectWriteBytes = 64 * 1024;
+
+            OutputFile();
+            ~OutputFile();
+
+            OutputFile(const OutputFile&) = delete;
+            OutputFile& operator=(const OutputFile&) = delete;
+
+            // Creates or truncates path; closes any file already open.
+            bool open(const std::filesystem::path& path);
+            // Creates path with exactly size bytes allocated (fallocate where
+            // the filesystem supports it) and maps it for writing. Falls back
+            // to open() where files are not mapped (Windows, empty files).
+            bool openMapped(const std::filesystem::path& path, std::uintmax_t size);
+            // Writes to a duplicate of the standard output handle, so close()
+            // leaves standard output itself open.
+            bool openStandardOutput();
+            bool write(std::string_view text);
+            // Appends the first bytes of source, copied file to file by the
+            // kernel (copy_file_range, then sendfile, then read/write) after
+            // flushing the buffer. Returns how many bytes were copied, fewer
+            // than asked when source is shorter; errors fail the file.
+            std::uintmax_t copyFrom(const std::filesystem::path& source, std::uintmax_t bytes);
+            // Flushes and closes; true when every write since open() landed.
+            // A mapped file is also checked to have been filled exactly.
+            bool close();
+
+            bool isOpen() const;
+            bool ok() const
+                {
+                return ok_;
+                }
+
+        private:
+            bool writeOut(std::string_view tail);
+            bool writeMapped(std::string_view text);
+
+            struct BufferDelete
+                {
+                void operator()(char* buffer) const;
+                };
+
+            std::unique_ptr<char, BufferDelete> buffer_;
+            std::size_t used_ = 0;
+            bool ok_ = true;
+#if defined(_WIN32)
+            void* handle_ = nullptr;
+#else
+            int fd_ = -1;
+            char* map_ = nullptr;
+            std::size_t mapSize_ = 0;
+            std::size_t position_ = 0;
+#endif
+        };
+    }
+
+#endif // REPADDU_FORMAT_OUTPUT_FILE_H
@@ -0,0 +1,85 @@
+#include "format_tar_stream.h"
+
+#include "format_writer_internal.h"
+
+#include <cstring>
+
+namespace repaddu::format::detail
+    {
+    namespace
+        {
+        constexpr char kZeroBlock[kTarBlockBytes] = {};
+
+        // Zero-padded octal in all but the last byte of field, which stays NUL.
+        bool writeOctal(char* field, std::size_t width, std::uintmax_t value)
+            {
+            for (std::size_t digit = width - 1; digit-- > 0;)
+                {
+                field[digit] = static_cast<char>('0' + (value & 7));
+                value >>= 3;
+                }
+            return value == 0;
+            }
+        }
+
+    bool formatTarHeader(std::string_view name,
+        std::uintmax_t sizeBytes,
+        std::time_t modified,
+        std::array<char, kTarBlockBytes>& outHeader)
+        {
+        if (name.empty() || name.size() > kTarNameBytes)
+            {
+            return false;
+            }
+        outHeader.fill('\0');
+        char* header = outHeader.data();
+        std::memcpy(header, name.data(), name.size());
+        writeOctal(header + 100, 8, 0644);
+        writeOctal(header + 108, 8, 0);
+        writeOctal(header + 116, 8, 0);
+        if (!writeOctal(header + 124, 12, sizeBytes))
+            {
+            // Base-256: the high bit of the first byte set, the size in the
+            // remaining eleven bytes, big-endian.
+            std::uintmax_t value = sizeBytes;
+            for (std::size_t index = 11; index > 0; --index)
+                {
+                header[124 + index] = static_cast<char>(value & 0xFF);
+                value >>= 8;
+                }
+            header[124] = static_cast<char>(0x80);
+            }
+        writeOctal(header + 136, 12, modified > 0 ? static_cast<std::uintmax_t>(modified) : 0);
+        header[156] = '0';
+        std::memcpy(header + 257, "ustar", 6);
+        std::memcpy(header + 263, "00", 2);
+
+        // The checksum is taken with its own field read as eight spaces,
+        // then stored as six octal digits, a NUL and a space.
+        std::memset(header + 148, ' ', 8);
+        unsigned int checksum = 0;
+        for (const char byte : outHeader)
+            {
+            checksum += static_cast<unsigned char>(byte);
+            }
+        writeOctal(header + 148, 7, checksum);
+        header[154] = '\0';
+        header[155] = ' ';
+        return true;
+        }
+
+    void writeTarPadding(OutputWriter& writer, std::uintmax_t sizeBytes)
+        {
+        const std::size_t remainder = static_cast<std::size_t>(sizeBytes % kTarBlockBytes);
+        if (remainder != 0)
+            {
+            writer.write(std::string_view(kZeroBlock, kTarBlockBytes - remainder));
+            }
+        }
+
+    void writeTarEnd(OutputWriter& writer)
+        {
+        writer.write(std::string_view(kZeroBlock, kTarBlockBytes));
+        writer.write(std::string_view(kZeroBlock, kTarBlockBytes));
+        }
+    }
@@ -0,0 +1,33 @@
+#ifndef REPADDU_FORMAT_TAR_STREAM_H
+#define REPADDU_FORMAT_TAR_STREAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+
+namespace repaddu::format::detail
+    {
+    struct OutputWriter;
+
+    // POSIX ustar framing for outputs streamed to standard output
+    // (--output -). Every entry is a regular file in the archive root: a
+    // 512-byte header, the content, then zero padding to the next block;
+    // two zero blocks end the archive.
+    constexpr std::size_t kTarBlockBytes = 512;
+    constexpr std::size_t kTarNameBytes = 100;
+
+    // False when name does not fit the 100-byte name field. Sizes of
+    // 8 GiB and above use the base-256 size encoding that GNU tar, bsdtar
+    // and libarchive read.
+    bool formatTarHeader(std::string_view name,
+        std::uintmax_t sizeBytes,
+        std::time_t modified,
+        std::array<char, kTarBlockBytes>& outHeader);
+
+    void writeTarPadding(OutputWriter& writer, std::uintmax_t sizeBytes);
+    void writeTarEnd(OutputWriter& writer);
+    }
+
+#endif // REPADDU_FORMAT_TAR_STREAM_H
@@ -1,291 +1,842 @@
 #include "repaddu/format_writer.h"
 
+#include "format_tar_stream.h"
 #include "format_writer_alt_formats.h"
 #include "format_writer_internal.h"
 
+#include "repaddu/analysis_tokens.h"
 #include "repaddu/logger.h"
 
+#include <ctime>
 #include <filesystem>
-#include <fstream>
+#include <functional>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace repaddu::format
     {
-    core::RunResult writeOutputs(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
-        const std::vector<core::OutputChunk>& chunks,
-        const std::string& treeListing,
-        const std::vector<std::filesystem::path>& cmakeLists,
-        const std::vector<std::filesystem::path>& buildFiles)
+    namespace
         {
-        std::error_code errorCode;
-        std::filesystem::create_directories(options.outputPath, errorCode);
-        if (errorCode)
+        // Options that change the bytes of any output; a mismatch drops the cache.
+        std::string outputOptionsKey(const core::CliOptions& options)
             {
-            return { core::ExitCode::io_failure, "Failed to create output directory." };
+            std::string key = options.outputPath.generic_string();
+            key += '|' + std::to_string(static_cast<int>(options.markers));
+            key += '|' + std::to_string(options.numberWidth);
+            key += '|' + std::to_string(options.maxBytes);
+            key += options.emitFrontmatter ? "|fm" : "|-";
+            key += options.emitTree ? "|tree" : "|-";
+            key += options.emitCMake ? "|cmake" : "|-";
+            key += options.emitBuildFiles ? "|build" : "|-";
+            key += options.emitLinks ? "|links" : "|-";
+            key += options.redactPii ? "|redact" : "|-";
+            return key;
             }
 
-        std::unique_ptr<security::PiiRedactor> redactor;
-        if (options.redactPii)
+        std::uint64_t generationOf(const OutputCache* cache, const std::string& relativePath)
             {
-            redactor = std::make_unique<security::PiiRedactor>();
+            if (!cache)
+                {
+                return 0;
+                }
+            auto it = cache->generations.find(relativePath);
+            return it == cache->generations.end() ? 0 : it->second;
             }
 
-        if (options.format == core::OutputFormat::jsonl)
+        std::uint64_t aggregatedSignature(const std::string& filename,
+            const std::string& overviewName,
+            const std::vector<std::filesystem::path>& paths,
+            const OutputCache* cache)
             {
-            return detail::writeJsonlOutput(options, files, chunks, redactor.get());
+            std::uint64_t signature = detail::extendSignature(detail::kSignatureSeed, filename);
+            signature = detail::extendSignature(signature, overviewName);
+            for (const auto& path : paths)
+                {
+                const std::string relative = path.generic_string();
+                signature = detail::extendSignature(signature, relative);
+                signature = detail::extendSignature(signature, std::to_string(generationOf(cache, relative)));
+                }
+            return signature;
             }
 
-        if (options.format == core::OutputFormat::html)
+        std::uint64_t partSignature(const detail::ChunkPartPlan& part,
+            const std::string& overviewName,
+            const core::FileTable& files,
+            const std::vector<std::uintmax_t>& tokenCounts,
+            const OutputCache* cache)
             {
-            return detail::writeHtmlOutput(options, files, redactor.get());
+            std::uint64_t signature = detail::extendSignature(detail::kSignatureSeed, part.filename);
+            signature = detail::extendSignature(signature, part.title);
+            signature = detail::extendSignature(signature, overviewName);
+            for (std::size_t fileIndex : part.fileIndices)
+                {
+                const std::string relative = files.relativePath(fileIndex);
+                signature = detail::extendSignature(signature, relative);
+                signature = detail::extendSignature(signature, std::to_string(generationOf(cache, relative)));
+                signature = detail::extendSignature(signature, std::to_string(files.sizeBytes(fileIndex)));
+                signature = detail::extendSignature(signature, std::to_string(tokenCounts[fileIndex]));
+                signature = detail::extendSignature(signature, core::fileClassLabel(files.fileClass(fileIndex)));
+                }
+            return signature;
             }
 
-        std::vector<detail::OutputPlanEntry> outputs;
-        std::vector<detail::ChunkPartPlan> chunkParts;
-        std::vector<std::uintmax_t> tokenCounts(files.size(), 0);
-        detail::ContentCache contentCache;
-        const std::string overviewName = detail::padNumber(0, options.numberWidth) + "_overview.md";
-
-        int outputIndex = 1;
-        if (options.emitTree)
+        const OutputCache::WrittenOutput* findUpToDate(const OutputCache* cache,
+            const std::filesystem::path& outputPath,
+            const std::string& filename,
+            std::uint64_t signature)
             {
-            detail::OutputWriter counter;
-            detail::writeTreeOutput(counter, overviewName, treeListing);
-            outputs.push_back({ detail::padNumber(outputIndex, options.numberWidth) + "_tree.md", counter.bytes });
-            ++outputIndex;
+            if (!cache)
+                {
+                return nullptr;
+                }
+            auto it = cache->outputs.find(filename);
+            if (it == cache->outputs.end() || it->second.signature != signature)
+                {
+                return nullptr;
+                }
+            std::error_code errorCode;
+            if (!std::filesystem::exists(outputPath / filename, errorCode))
+                {
+                return nullptr;
+                }
+            return &it->second;
             }
 
-        if (options.emitCMake)
+        void recordOutput(OutputCache* cache, const std::string& filename, std::uint64_t signature, std::uintmax_t bytes)
             {
-            detail::OutputWriter counter;
-            core::RunResult cmakeResult = detail::writeAggregatedFilesOutput(counter,
-                overviewName,
-                "# Aggregated CMakeLists.txt files",
-                "No CMakeLists.txt files were found.",
-                cmakeLists,
-                options,
-                redactor.get(),
-                &contentCache);
-            if (cmakeResult.code != core::ExitCode::success)
-                {
-                return cmakeResult;
-                }
-            outputs.push_back({ detail::padNumber(outputIndex, options.numberWidth) + "_cmake.md", counter.bytes });
-            ++outputIndex;
+            if (cache)
+                {
+                cache->outputs[filename] = { signature, bytes };
+                ++cache->outputsWritten;
+                }
             }
 
-        if (options.emitBuildFiles)
+        // One read per input file: outputs are streamed into staged files and
+        // moved into place once every constraint has been checked, with the
+        // overview written last because it lists the other outputs.
+        core::RunResult writeOutputsSinglePass(const core::CliOptions& options,
+            const core::FileTable& files,
+            const std::vector<core::OutputChunk>& chunks,
+            const std::string& treeListing,
+            const std::vector<std::filesystem::path>& cmakeLists,
+            const std::vector<std::filesystem::path>& buildFiles,
+            security::PiiRedactor* redactor,
+            detail::ContentCache& contentCache,
+            detail::ContentStore* store,
+            const ProgressCallback& progress)
             {
-            detail::OutputWriter counter;
-            core::RunResult buildFilesResult = detail::writeAggregatedFilesOutput(counter,
-                overviewName,
-                "# Aggregated build-system files",
-                "No build-system files were found.",
-                buildFiles,
-                options,
-                redactor.get(),
-                &contentCache);
-            if (buildFilesResult.code != core::ExitCode::success)
-                {
-                return buildFilesResult;
-                }
-            outputs.push_back({ detail::padNumber(outputIndex, options.numberWidth) + "_build_context.md", counter.bytes });
-            ++outputIndex;
-            }
+            const std::string overviewName = detail::padNumber(0, options.numberWidth) + "_overview.md";
+            detail::StagedOutputs staged(options.outputPath);
+            detail::ContentPreparer preparer(options, files, redactor, store);
+            std::vector<detail::OutputPlanEntry> outputs;
+            const std::size_t fixedOutputs = 1 + (options.emitTree ? 1 : 0) + (options.emitCMake ? 1 : 0)
+                + (options.emitBuildFiles ? 1 : 0);
+            detail::ProgressReporter reporter(progress, fixedOutputs + chunks.size());
 
-        core::RunResult chunkPlanResult = detail::planChunkOutputs(options,
-            overviewName,
-            chunks,
-            files,
-            chunkParts,
-            outputs,
-            outputIndex,
-            redactor.get(),
-            tokenCounts,
-            &contentCache);
-        if (chunkPlanResult.code != core::ExitCode::success)
-            {
-            return chunkPlanResult;
-            }
+            auto writeStaged = [&](const std::string& filename, const auto& render) -> core::RunResult
+                {
+                detail::OutputFile file;
+                core::RunResult openResult = staged.open(filename, file);
+                if (openResult.code != core::ExitCode::success)
+                    {
+                    return openResult;
+                    }
+                detail::OutputWriter writer{ &file };
+                core::RunResult renderResult = render(writer);
+                if (renderResult.code != core::ExitCode::success)
+                    {
+                    return renderResult;
+                    }
+                if (!file.close() || !writer.ok)
+                    {
+                    return { core::ExitCode::io_failure, "Failed to flush output file." };
+                    }
+                outputs.push_back({ filename, writer.bytes });
+                reporter.advance(filename);
+                return { core::ExitCode::success, "" };
+                };
 
-        if (options.maxFiles > 0 && static_cast<int>(outputs.size() + 1) > options.maxFiles)
-            {
-            return { core::ExitCode::output_constraints, "Output file count exceeds --max-files." };
-            }
+            int outputIndex = 1;
+            if (options.emitTree)
+                {
+                core::RunResult treeResult = writeStaged(detail::padNumber(outputIndex, options.numberWidth) + "_tree.md",
+                    [&](detail::OutputWriter& writer) -> core::RunResult
+                    {
+                    detail::writeTreeOutput(writer, overviewName, treeListing);
+                    return { core::ExitCode::success, "" };
+                    });
+                if (treeResult.code != core::ExitCode::success)
+                    {
+                    return treeResult;
+                    }
+                ++outputIndex;
+                }
 
-        for (const auto& output : outputs)
-            {
-            if (options.maxBytes > 0 && output.contentBytes > options.maxBytes)
+            if (options.emitCMake)
                 {
-                return { core::ExitCode::output_constraints, "Output file exceeds --max-bytes." };
+                core::RunResult cmakeResult = writeStaged(detail::padNumber(outputIndex, options.numberWidth) + "_cmake.md",
+                    [&](detail::OutputWriter& writer)
+                    {
+                    return detail::writeAggregatedFilesOutput(writer,
+                        overviewName,
+                        "# Aggregated CMakeLists.txt files",
+                        "No CMakeLists.txt files were found.",
+                        cmakeLists,
+                        options,
+                        redactor,
+                        &contentCache);
+                    });
+                if (cmakeResult.code != core::ExitCode::success)
+                    {
+                    return cmakeResult;
+                    }
+                ++outputIndex;
                 }
-            }
 
-        std::vector<std::string> outputNames;
-        outputNames.reserve(outputs.size());
-        for (const auto& output : outputs)
-            {
-            outputNames.push_back(output.filename);
-            }
+            if (options.emitBuildFiles)
+                {
+                core::RunResult buildFilesResult = writeStaged(
+                    detail::padNumber(outputIndex, options.numberWidth) + "_build_context.md",
+                    [&](detail::OutputWriter& writer)
+                    {
+                    return detail::writeAggregatedFilesOutput(writer,
+                        overviewName,
+                        "# Aggregated build-system files",
+                        "No build-system files were found.",
+                        buildFiles,
+                        options,
+                        redactor,
+                        &contentCache);
+                    });
+                if (buildFilesResult.code != core::ExitCode::success)
+                    {
+                    return buildFilesResult;
+                    }
+                ++outputIndex;
+                }
 
-        const std::string overviewContent = detail::overviewTemplate(overviewName,
-            options.markers,
-            options.emitBuildFiles,
-            options.emitLinks,
-            outputNames);
-        const std::uintmax_t overviewBytes = static_cast<std::uintmax_t>(overviewContent.size());
-        if (options.maxBytes > 0 && overviewBytes > options.maxBytes)
-            {
-            return { core::ExitCode::output_constraints, "Output file exceeds --max-bytes." };
-            }
+            core::RunResult chunkResult = detail::streamChunkOutputs(options,
+                overviewName,
+                chunks,
+                files,
+                staged,
+                outputs,
+                outputIndex,
+                preparer,
+                reporter);
+            if (chunkResult.code != core::ExitCode::success)
+                {
+                return chunkResult;
+                }
 
-        if (options.dryRun)
-            {
-            LogInfo("[Dry Run] Would write: " + overviewName + " (" + std::to_string(overviewBytes) + " bytes)");
+            if (options.maxFiles > 0 && static_cast<int>(outputs.size() + 1) > options.maxFiles)
+                {
+                return { core::ExitCode::output_constraints, "Output file count exceeds --max-files." };
+                }
             for (const auto& output : outputs)
                 {
-                LogInfo("[Dry Run] Would write: " + output.filename + " (" + std::to_string(output.contentBytes) + " bytes)");
+                if (options.maxBytes > 0 && output.contentBytes > options.maxBytes)
+                    {
+                    return { core::ExitCode::output_constraints, "Output file exceeds --max-bytes." };
+                    }
                 }
-            LogInfo("[Dry Run] Simulation complete. No files were written.");
-            return { core::ExitCode::success, "" };
-            }
 
-        {
-            const std::filesystem::path outPath = options.outputPath / overviewName;
-            std::ofstream stream(outPath, std::ios::binary);
-            if (!stream)
+            std::vector<std::string> outputNames;
+            outputNames.reserve(outputs.size());
+            for (const auto& output : outputs)
                 {
-                return { core::ExitCode::io_failure, "Failed to write output file." };
+                outputNames.push_back(output.filename);
                 }
-            stream << overviewContent;
-            if (!stream)
+            const std::string overviewContent = detail::overviewTemplate(overviewName,
+                options.markers,
+                options.emitBuildFiles,
+                options.emitLinks,
+                outputNames);
+            if (options.maxBytes > 0 && overviewContent.size() > options.maxBytes)
                 {
-                return { core::ExitCode::io_failure, "Failed to flush output file." };
+                return { core::ExitCode::output_constraints, "Output file exceeds --max-bytes." };
                 }
+            core::RunResult overviewResult = writeStaged(overviewName,
+                [&](detail::OutputWriter& writer) -> core::RunResult
+                {
+                writer.write(overviewContent);
+                return { core::ExitCode::success, "" };
+                });
+            if (overviewResult.code != core::ExitCode::success)
+                {
+                return overviewResult;
+                }
+
+            return staged.commit();
+            }
         }
 
-        if (options.emitTree)
+    void OutputCache::invalidate(const std::string& relativePath)
+        {
+        measures.erase(relativePath);
+        ++generations[relativePath];
+        }
+
+    namespace
+        {
+        core::RunResult writeOutputsUsing(const core::CliOptions& options,
+            const core::FileTable& files,
+            const std::vector<core::OutputChunk>& chunks,
+            const std::string& treeListing,
+            const std::vector<std::filesystem::path>& cmakeLists,
+            const std::vector<std::filesystem::path>& buildFiles,
+            OutputCache* cache,
+            security::PiiRedactor* redactor,
+            detail::ContentStore* store,
+            const ProgressCallback& progress)
             {
-            const std::filesystem::path outPath = options.outputPath / (detail::padNumber(1, options.numberWidth) + "_tree.md");
-            std::ofstream stream(outPath, std::ios::binary);
-            if (!stream)
+            const bool toStandardOutput = writesToStandardOutput(options);
+            if (toStandardOutput && options.format != core::OutputFormat::markdown)
                 {
-                return { core::ExitCode::io_failure, "Failed to write output file." };
+                return { core::ExitCode::invalid_usage, "--output - requires --format markdown." };
                 }
-            detail::OutputWriter writer{ &stream };
-            detail::writeTreeOutput(writer, overviewName, treeListing);
-            if (!stream)
+            if (toStandardOutput)
                 {
-                return { core::ExitCode::io_failure, "Failed to flush output file." };
+                // An archive carries every output, changed or not.
+                cache = nullptr;
+                }
+            std::error_code errorCode;
+            if (!toStandardOutput)
+                {
+                std::filesystem::create_directories(options.outputPath, errorCode);
+                }
+            if (errorCode)
+                {
+                return { core::ExitCode::io_failure, "Failed to create output directory." };
                 }
-            }
 
-        int fileIndexBase = 1;
-        if (options.emitTree)
-            {
-            ++fileIndexBase;
-            }
+            if (options.format == core::OutputFormat::jsonl)
+                {
+                return detail::writeJsonlOutput(options, files, chunks, redactor, store);
+                }
 
-        if (options.emitCMake)
-            {
-            const std::filesystem::path outPath = options.outputPath / (detail::padNumber(fileIndexBase, options.numberWidth) + "_cmake.md");
-            std::ofstream stream(outPath, std::ios::binary);
-            if (!stream)
+            if (options.format == core::OutputFormat::html)
                 {
-                return { core::ExitCode::io_failure, "Failed to write output file." };
+                return detail::writeHtmlOutput(options, files, redactor, store);
                 }
-            detail::OutputWriter writer{ &stream };
-            core::RunResult cmakeResult = detail::writeAggregatedFilesOutput(writer,
-                overviewName,
-                "# Aggregated CMakeLists.txt files",
-                "No CMakeLists.txt files were found.",
-                cmakeLists,
-                options,
-                redactor.get(),
-                &contentCache);
-            if (cmakeResult.code != core::ExitCode::success)
+
+            if (options.format == core::OutputFormat::pack)
                 {
-                return cmakeResult;
+                return detail::writePackOutput(options, files, chunks, redactor, store);
                 }
-            if (!stream)
+
+            // Incremental sessions need the plan first to skip unchanged parts,
+            // dry runs only measure, and preallocated outputs and tar headers
+            // need every size before the first byte is written; everything
+            // else streams in one pass.
+            detail::ContentCache contentCache(options.contentCacheMb * 1024 * 1024);
+            if (!cache && !options.dryRun && !options.preallocateOutputs && !toStandardOutput)
                 {
-                return { core::ExitCode::io_failure, "Failed to flush output file." };
+                core::RunResult result = writeOutputsSinglePass(options, files, chunks, treeListing, cmakeLists, buildFiles,
+                    redactor, contentCache, store, progress);
+                if (result.code == core::ExitCode::success && options.contentCacheStats)
+                    {
+                    LogInfo(detail::formatContentCacheStats(contentCache.stats()));
+                    }
+                return result;
                 }
-            ++fileIndexBase;
-            }
 
-        if (options.emitBuildFiles)
-            {
-            const std::filesystem::path outPath = options.outputPath / (detail::padNumber(fileIndexBase, options.numberWidth) + "_build_context.md");
-            std::ofstream stream(outPath, std::ios::binary);
-            if (!stream)
+            if (cache)
                 {
-                return { core::ExitCode::io_failure, "Failed to write output file." };
+                const std::string optionsKey = outputOptionsKey(options);
+                if (cache->optionsKey != optionsKey)
+                    {
+                    cache->measures.clear();
+                    cache->outputs.clear();
+                    cache->optionsKey = optionsKey;
+                    }
+                cache->outputsWritten = 0;
+                cache->outputsSkipped = 0;
                 }
-            detail::OutputWriter writer{ &stream };
-            core::RunResult buildFilesResult = detail::writeAggregatedFilesOutput(writer,
+
+            std::vector<detail::OutputPlanEntry> outputs;
+            std::vector<detail::ChunkPartPlan> chunkParts;
+            std::vector<std::uintmax_t> tokenCounts(files.size(), 0);
+            detail::ContentPreparer preparer(options, files, redactor, store);
+            const std::string overviewName = detail::padNumber(0, options.numberWidth) + "_overview.md";
+
+            // Signatures of the fixed outputs, used to skip rewriting them when a
+            // cache from a previous call says they are unchanged.
+            const std::string treeName = detail::padNumber(1, options.numberWidth) + "_tree.md";
+            std::uint64_t treeSignature = 0;
+            std::uint64_t cmakeSignature = 0;
+            std::uint64_t buildFilesSignature = 0;
+
+            int outputIndex = 1;
+            if (options.emitTree)
+                {
+                treeSignature = detail::extendSignature(detail::extendSignature(detail::kSignatureSeed, overviewName), treeListing);
+                detail::OutputWriter counter;
+                detail::writeTreeOutput(counter, overviewName, treeListing);
+                outputs.push_back({ treeName, counter.bytes });
+                ++outputIndex;
+                }
+
+            if (options.emitCMake)
+                {
+                const std::string filename = detail::padNumber(outputIndex, options.numberWidth) + "_cmake.md";
+                cmakeSignature = aggregatedSignature(filename, overviewName, cmakeLists, cache);
+                if (const auto* cached = findUpToDate(cache, options.outputPath, filename, cmakeSignature))
+                    {
+                    outputs.push_back({ filename, cached->bytes });
+                    }
+                else
+                    {
+                    detail::OutputWriter counter;
+                    core::RunResult cmakeResult = detail::writeAggregatedFilesOutput(counter,
+                        overviewName,
+                        "# Aggregated CMakeLists.txt files",
+                        "No CMakeLists.txt files were found.",
+                        cmakeLists,
+                        options,
+                        redactor,
+                        &contentCache);
+                    if (cmakeResult.code != core::ExitCode::success)
+                        {
+                        return cmakeResult;
+                        }
+                    outputs.push_back({ filename, counter.bytes });
+                    }
+                ++outputIndex;
+                }
+
+            if (options.emitBuildFiles)
+                {
+                const std::string filename = detail::padNumber(outputIndex, options.numberWidth) + "_build_context.md";
+                buildFilesSignature = aggregatedSignature(filename, overviewName, buildFiles, cache);
+                if (const auto* cached = findUpToDate(cache, options.outputPath, filename, buildFilesSignature))
+                    {
+                    outputs.push_back({ filename, cached->bytes });
+                    }
+                else
+                    {
+                    detail::OutputWriter counter;
+                    core::RunResult buildFilesResult = detail::writeAggregatedFilesOutput(counter,
+                        overviewName,
+                        "# Aggregated build-system files",
+                        "No build-system files were found.",
+                        buildFiles,
+                        options,
+                        redactor,
+                        &contentCache);
+                    if (buildFilesResult.code != core::ExitCode::success)
+                        {
+                        return buildFilesResult;
+                        }
+                    outputs.push_back({ filename, counter.bytes });
+                    }
+                ++outputIndex;
+                }
+
+            core::RunResult chunkPlanResult = detail::planChunkOutputs(options,
                 overviewName,
-                "# Aggregated build-system files",
-                "No build-system files were found.",
-                buildFiles,
-                options,
-                redactor.get(),
-                &contentCache);
-            if (buildFilesResult.code != core::ExitCode::success)
+                chunks,
+                files,
+                chunkParts,
+                outputs,
+                outputIndex,
+                tokenCounts,
+                &contentCache,
+                preparer,
+                cache);
+            if (chunkPlanResult.code != core::ExitCode::success)
+                {
+                return chunkPlanResult;
+                }
+
+            if (options.maxFiles > 0 && static_cast<int>(outputs.size() + 1) > options.maxFiles)
                 {
-                return buildFilesResult;
+                return { core::ExitCode::output_constraints, "Output file count exceeds --max-files." };
                 }
-            if (!stream)
+
+            for (const auto& output : outputs)
                 {
-                return { core::ExitCode::io_failure, "Failed to flush output file." };
+                if (options.maxBytes > 0 && output.contentBytes > options.maxBytes)
+                    {
+                    return { core::ExitCode::output_constraints, "Output file exceeds --max-bytes." };
+                    }
                 }
-            ++fileIndexBase;
-            }
 
-        for (const auto& part : chunkParts)
-            {
-            const std::filesystem::path outPath = options.outputPath / part.filename;
-            std::ofstream stream(outPath, std::ios::binary);
-            if (!stream)
+            std::vector<std::string> outputNames;
+            outputNames.reserve(outputs.size());
+            for (const auto& output : outputs)
                 {
-                return { core::ExitCode::io_failure, "Failed to write output file." };
+                outputNames.push_back(output.filename);
                 }
-            detail::OutputWriter writer{ &stream };
-            writer.write(detail::boilerplateLine(overviewName));
-            writer.write("# ");
-            writer.write(part.title);
-            writer.write("\n\n");
 
-            for (std::size_t fileIndex : part.fileIndices)
+            const std::string overviewContent = detail::overviewTemplate(overviewName,
+                options.markers,
+                options.emitBuildFiles,
+                options.emitLinks,
+                outputNames);
+            const std::uintmax_t overviewBytes = static_cast<std::uintmax_t>(overviewContent.size());
+            if (options.maxBytes > 0 && overviewBytes > options.maxBytes)
+                {
+                return { core::ExitCode::output_constraints, "Output file exceeds --max-bytes." };
+                }
+
+            if (options.dryRun)
+                {
+                LogInfo("[Dry Run] Would write: " + overviewName + " (" + std::to_string(overviewBytes) + " bytes)");
+                for (const auto& output : outputs)
+                    {
+                    LogInfo("[Dry Run] Would write: " + output.filename + " (" + std::to_string(output.contentBytes) + " bytes)");
+                    }
+                LogInfo("[Dry Run] Simulation complete. No files were written.");
+                if (options.contentCacheStats)
+                    {
+                    LogInfo(detail::formatContentCacheStats(contentCache.stats()));
+                    }
+                return { core::ExitCode::success, "" };
+                }
+
+            // Every output below is an independent file with a known name and
+            // planned size, so they are written concurrently; the cache is
+            // only read and updated on this thread.
+            struct OutputJob
+                {
+                std::string filename;
+                std::uint64_t signature = 0;
+                std::function<core::RunResult(detail::OutputWriter&)> render;
+                std::uintmax_t plannedBytes = 0;
+                std::uintmax_t bytes = 0;
+                bool written = false;
+                };
+            std::vector<OutputJob> jobs;
+            std::unordered_map<std::string, std::uintmax_t> plannedBytes;
+            plannedBytes[overviewName] = overviewBytes;
+            for (const auto& output : outputs)
+                {
+                plannedBytes[output.filename] = output.contentBytes;
+                }
+
+            const std::uint64_t overviewSignature = detail::extendSignature(detail::kSignatureSeed, overviewContent);
+            if (findUpToDate(cache, options.outputPath, overviewName, overviewSignature))
+                {
+                ++cache->outputsSkipped;
+                }
+            else
+                {
+                jobs.push_back({ overviewName, overviewSignature,
+                    [&](detail::OutputWriter& writer) -> core::RunResult
+                    {
+                    writer.write(overviewContent);
+                    return { core::ExitCode::success, "" };
+                    } });
+                }
+
+            if (options.emitTree && findUpToDate(cache, options.outputPath, treeName, treeSignature))
+                {
+                ++cache->outputsSkipped;
+                }
+            else if (options.emitTree)
+                {
+                jobs.push_back({ treeName, treeSignature,
+                    [&](detail::OutputWriter& writer) -> core::RunResult
+                    {
+                    detail::writeTreeOutput(writer, overviewName, treeListing);
+                    return { core::ExitCode::success, "" };
+                    } });
+                }
+
+            int fileIndexBase = 1;
+            if (options.emitTree)
+                {
+                ++fileIndexBase;
+                }
+
+            const std::string cmakeName = detail::padNumber(fileIndexBase, options.numberWidth) + "_cmake.md";
+            if (options.emitCMake && findUpToDate(cache, options.outputPath, cmakeName, cmakeSignature))
+                {
+                ++cache->outputsSkipped;
+                ++fileIndexBase;
+                }
+            else if (options.emitCMake)
+                {
+                jobs.push_back({ cmakeName, cmakeSignature,
+                    [&](detail::OutputWriter& writer)
+                    {
+                    return detail::writeAggregatedFilesOutput(writer,
+                        overviewName,
+                        "# Aggregated CMakeLists.txt files",
+                        "No CMakeLists.txt files were found.",
+                        cmakeLists,
+                        options,
+                        redactor,
+                        &contentCache);
+                    } });
+                ++fileIndexBase;
+                }
+
+            const std::string buildFilesName = detail::padNumber(fileIndexBase, options.numberWidth) + "_build_context.md";
+            if (options.emitBuildFiles && findUpToDate(cache, options.outputPath, buildFilesName, buildFilesSignature))
+                {
+                ++cache->outputsSkipped;
+                ++fileIndexBase;
+                }
+            else if (options.emitBuildFiles)
+                {
+                jobs.push_back({ buildFilesName, buildFilesSignature,
+                    [&](detail::OutputWriter& writer)
+                    {
+                    return detail::writeAggregatedFilesOutput(writer,
+                        overviewName,
+                        "# Aggregated build-system files",
+                        "No build-system files were found.",
+                        buildFiles,
+                        options,
+                        redactor,
+                        &contentCache);
+                    } });
+                ++fileIndexBase;
+                }
+
+            for (const auto& part : chunkParts)
                 {
-                core::FileEntry entry = files[fileIndex];
-                std::string content;
-                core::RunResult readResult = detail::readContentWithCache(entry.absolutePath,
-                    entry.relativePath.string(),
-                    redactor.get(),
-                    &contentCache,
-                    content,
-                    nullptr);
-                if (readResult.code != core::ExitCode::success)
-                    {
-                    return readResult;
+                const std::uint64_t signature = cache ? partSignature(part, overviewName, files, tokenCounts, cache) : 0;
+                if (findUpToDate(cache, options.outputPath, part.filename, signature))
+                    {
+                    ++cache->outputsSkipped;
+                    continue;
                     }
-                entry.tokenCount = tokenCounts[fileIndex];
-                detail::writeChunkMarkerBlock(writer, entry, content, options.markers, options.emitFrontmatter);
-                writer.write("\n");
-                if (!writer.ok)
+
+                jobs.push_back({ part.filename, signature,
+                    [&](detail::OutputWriter& writer) -> core::RunResult
+                    {
+                    writer.write(detail::boilerplateLine(overviewName));
+                    writer.write("# ");
+                    writer.write(part.title);
+                    writer.write("\n\n");
+
+                    for (std::size_t fileIndex : part.fileIndices)
+                        {
+                        const std::string relative = files.relativePath(fileIndex);
+                        const MarkerFile marker = markerFileOf(files, fileIndex, tokenCounts[fileIndex]);
+                        if (detail::streamsContent(options, files.sizeBytes(fileIndex)))
+                            {
+                            core::RunResult streamResult = detail::writeStreamedBlock(writer, marker,
+                                files.absolutePath(fileIndex), redactor, nullptr, options.markers, options.emitFrontmatter);
+                            if (streamResult.code != core::ExitCode::success)
+                                {
+                                return streamResult;
+                                }
+                            }
+                        else
+                            {
+                            detail::ContentView content;
+                            core::RunResult readResult = detail::readContentWithCache(files.absolutePath(fileIndex),
+                                relative,
+                                redactor,
+                                &contentCache,
+                                content,
+                                nullptr,
+                                nullptr,
+                                true,
+                                store,
+                                !options.watch);
+                            if (readResult.code != core::ExitCode::success)
+                                {
+                                return readResult;
+                                }
+                            detail::writeChunkMarkerBlock(writer, marker, content.view(), options.markers,
+                                options.emitFrontmatter);
+                            }
+                        writer.write("\n");
+                        if (!writer.ok)
+                            {
+                            return { core::ExitCode::io_failure, "Failed to write output file." };
+                            }
+                        }
+                    return { core::ExitCode::success, "" };
+                    } });
+                }
+
+            for (OutputJob& job : jobs)
+                {
+                job.plannedBytes = plannedBytes[job.filename];
+                }
+
+            detail::ProgressReporter reporter(progress, jobs.size());
+            if (toStandardOutput)
+                {
+                // One archive entry per job, in file order. Each header
+                // carries the planned size, so content must match it exactly.
+                std::array<char, detail::kTarBlockBytes> header{};
+                for (const OutputJob& job : jobs)
+                    {
+                    if (!detail::formatTarHeader(job.filename, job.plannedBytes, 0, header))
+                        {
+                        return { core::ExitCode::output_constraints, "Output name too long for a tar entry: " + job.filename };
+                        }
+                    }
+                detail::OutputFile file;
+                if (!file.openStandardOutput())
+                    {
+                    return { core::ExitCode::io_failure, "Failed to open standard output." };
+                    }
+                detail::OutputWriter writer{ &file };
+                const std::time_t now = std::time(nullptr);
+                for (const OutputJob& job : jobs)
+                    {
+                    detail::formatTarHeader(job.filename, job.plannedBytes, now, header);
+                    writer.write(std::string_view(header.data(), header.size()));
+                    const std::uintmax_t start = writer.bytes;
+                    core::RunResult renderResult = job.render(writer);
+                    if (renderResult.code != core::ExitCode::success)
+                        {
+                        return renderResult;
+                        }
+                    if (writer.bytes - start != job.plannedBytes)
+                        {
+                        return { core::ExitCode::io_failure, "Output does not match its planned size: " + job.filename };
+                        }
+                    detail::writeTarPadding(writer, job.plannedBytes);
+                    reporter.advance(job.filename);
+                    }
+                detail::writeTarEnd(writer);
+                if (!file.close() || !writer.ok)
+                    {
+                    return { core::ExitCode::io_failure, "Failed to write to standard output." };
+                    }
+                if (options.contentCacheStats)
+                    {
+                    LogInfo(detail::formatContentCacheStats(contentCache.stats()));
+                    }
+                return { core::ExitCode::success, "" };
+                }
+
+            core::RunResult writeResult = detail::runOutputJobs(jobs.size(), detail::workerThreadCount(options),
+                [&](std::size_t index) -> core::RunResult
+                {
+                OutputJob& job = jobs[index];
+                detail::OutputFile file;
+                const std::filesystem::path path = options.outputPath / job.filename;
+                const bool opened = options.preallocateOutputs ? file.openMapped(path, job.plannedBytes) : file.open(path);
+                if (!opened)
                     {
                     return { core::ExitCode::io_failure, "Failed to write output file." };
                     }
+                detail::OutputWriter writer{ &file };
+                core::RunResult renderResult = job.render(writer);
+                // Rendering past a preallocated file's plan fails as a write
+                // error; the size check reports the actual cause instead.
+                if (options.preallocateOutputs && (writer.bytes > job.plannedBytes
+                        || (renderResult.code == core::ExitCode::success && writer.bytes != job.plannedBytes)))
+                    {
+                    return { core::ExitCode::io_failure, "Output does not match its planned size: " + job.filename };
+                    }
+                if (renderResult.code != core::ExitCode::success)
+                    {
+                    return renderResult;
+                    }
+                if (!file.close() || !writer.ok)
+                    {
+                    return { core::ExitCode::io_failure, "Failed to flush output file." };
+                    }
+                job.bytes = writer.bytes;
+                job.written = true;
+                reporter.advance(job.filename);
+                return { core::ExitCode::success, "" };
+                });
+            for (const OutputJob& job : jobs)
+                {
+                if (job.written)
+                    {
+                    recordOutput(cache, job.filename, job.signature, job.bytes);
+                    }
+                }
+            if (writeResult.code != core::ExitCode::success)
+                {
+                return writeResult;
                 }
 
-            if (!stream)
+            if (cache)
                 {
-                return { core::ExitCode::io_failure, "Failed to flush output file." };
+                // Parts that no longer exist (fewer chunks or splits) are removed so
+                // the output directory matches a fresh run.
+                std::unordered_set<std::string> current(outputNames.begin(), outputNames.end());
+                current.insert(overviewName);
+                for (auto it = cache->outputs.begin(); it != cache->outputs.end();)
+                    {
+                    if (current.count(it->first) == 0)
+                        {
+                        std::error_code removeError;
+                        std::filesystem::remove(options.outputPath / it->first, removeError);
+                        it = cache->outputs.erase(it);
+                        }
+                    else
+                        {
+                        ++it;
+                        }
+                    }
                 }
+
+            if (options.contentCacheStats)
+                {
+                LogInfo(detail::formatContentCacheStats(contentCache.stats()));
+                }
+            return { core::ExitCode::success, "" };
             }
+        }
 
-        return { core::ExitCode::success, "" };
+    bool writesToStandardOutput(const core::CliOptions& options)
+        {
+        return options.outputPath == "-";
+        }
+
+    core::RunResult writeOutputs(const core::CliOptions& options,
+        const core::FileTable& files,
+        const std::vector<core::OutputChunk>& chunks,
+        const std::string& treeListing,
+        const std::vector<std::filesystem::path>& cmakeLists,
+        const std::vector<std::filesystem::path>& buildFiles,
+        OutputCache* cache,
+        const ProgressCallback& progress)
+        {
+        std::unique_ptr<security::PiiRedactor> redactor;
+        if (options.redactPii)
+            {
+            redactor = std::make_unique<security::PiiRedactor>();
+            }
+
+        // Stored results are only valid for the rule set and tokenizer that
+        // produced them; both are part of every key.
+        std::unique_ptr<detail::ContentStore> store;
+        if (!options.contentStorePath.empty())
+            {
+            std::uint64_t rulesHash = detail::extendSignature(detail::kSignatureSeed,
+                redactor ? std::to_string(redactor->ruleSetHash()) : "none");
+            rulesHash = detail::extendSignature(rulesHash, analysis::TokenEstimator::tokenizerId());
+            store = std::make_unique<detail::ContentStore>();
+            core::RunResult openResult = store->open(options.contentStorePath, rulesHash);
+            if (openResult.code != core::ExitCode::success)
+                {
+                LogWarn(openResult.message);
+                }
+            }
+
+        core::RunResult result = writeOutputsUsing(options, files, chunks, treeListing, cmakeLists, buildFiles, cache,
+            redactor.get(), store.get(), progress);
+        if (store && result.code == core::ExitCode::success)
+            {
+            if (options.contentCacheStats)
+                {
+                const detail::ContentStoreStats stats = store->stats();
+                LogInfo("Content store: " + std::to_string(stats.hits) + " hits, " + std::to_string(stats.misses)
+                    + " misses, " + std::to_string(stats.insertions) + " insertions");
+                }
+            core::RunResult saveResult = store->save();
+            if (saveResult.code != core::ExitCode::success)
+                {
+                LogWarn(saveResult.message);
+                }
+            }
+        return result;
         }
     }
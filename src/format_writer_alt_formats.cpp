@@ -1,53 +1,110 @@
 #include "format_writer_alt_formats.h"
+#include "format_writer_internal.h"
 
 #include "repaddu/logger.h"
 
+#include <algorithm>
 #include <fstream>
-#include <iomanip>
-#include <sstream>
+#include <string_view>
 
 namespace repaddu::format::detail
     {
     namespace
         {
-        std::string escapeJsonString(const std::string& value)
+        // Appends value as a quoted JSON string. Runs of characters that need
+        // no escaping are appended in one piece.
+        void appendJsonString(std::string& out, std::string_view value)
             {
-            std::ostringstream ss;
-            ss << '"';
-            for (char c : value)
+            static constexpr char kHex[] = "0123456789abcdef";
+            out += '"';
+            std::size_t runStart = 0;
+            for (std::size_t index = 0; index < value.size(); ++index)
                 {
+                const unsigned char c = static_cast<unsigned char>(value[index]);
+                if (c >= 0x20 && c != '"' && c != '\\')
+                    {
+                    continue;
+                    }
+                out.append(value.data() + runStart, index - runStart);
+                runStart = index + 1;
                 switch (c)
                     {
-                    case '"': ss << "\\\""; break;
-                    case '\\': ss << "\\\\"; break;
-                    case '\b': ss << "\\b"; break;
-                    case '\f': ss << "\\f"; break;
-                    case '\n': ss << "\\n"; break;
-                    case '\r': ss << "\\r"; break;
-                    case '\t': ss << "\\t"; break;
+                    case '"': out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\b': out += "\\b"; break;
+                    case '\f': out += "\\f"; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    case '\t': out += "\\t"; break;
                     default:
-                        if ('\x00' <= c && c <= '\x1f')
-                            {
-                            ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
-                            }
-                        else
-                            {
-                            ss << c;
-                            }
+                        out += "\\u00";
+                        out += kHex[c >> 4];
+                        out += kHex[c & 0xF];
                     }
                 }
-            ss << '"';
-            return ss.str();
+            out.append(value.data() + runStart, value.size() - runStart);
+            out += '"';
+            }
+
+        std::string escapeJsonString(std::string_view value)
+            {
+            std::string out;
+            out.reserve(value.size() + 2);
+            appendJsonString(out, value);
+            return out;
+            }
+
+        // A batch is held in memory until it has been appended in order, so
+        // it is capped both by record count and by input bytes per thread.
+        // JSONL reads files whole; a file larger than the byte budget makes
+        // a batch of its own.
+        constexpr std::size_t kJsonlRecordsPerThread = 32;
+        constexpr std::uintmax_t kJsonlBatchBytesPerThread = 64ULL * 1024 * 1024;
+
+        std::string shardFilename(std::size_t shard)
+            {
+            std::string number = std::to_string(shard);
+            if (number.size() < 5)
+                {
+                number.insert(0, 5 - number.size(), '0');
+                }
+            return "dataset-" + number + ".jsonl";
+            }
+
+        struct JsonlShard
+            {
+            std::string filename;
+            std::size_t records = 0;
+            std::uintmax_t bytes = 0;
+            };
+
+        std::string renderManifest(const std::vector<JsonlShard>& shards, std::uintmax_t shardBytes)
+            {
+            std::size_t records = 0;
+            std::string out = "{\n  \"shard_bytes\": " + std::to_string(shardBytes) + ",\n  \"shards\": [";
+            for (std::size_t index = 0; index < shards.size(); ++index)
+                {
+                out += index == 0 ? "\n" : ",\n";
+                out += "    { \"file\": ";
+                appendJsonString(out, shards[index].filename);
+                out += ", \"records\": " + std::to_string(shards[index].records);
+                out += ", \"bytes\": " + std::to_string(shards[index].bytes) + " }";
+                records += shards[index].records;
+                }
+            out += shards.empty() ? "],\n" : "\n  ],\n";
+            out += "  \"records\": " + std::to_string(records) + "\n}\n";
+            return out;
             }
         }
 
     core::RunResult writeJsonlOutput(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<core::OutputChunk>& chunks,
-        security::PiiRedactor* redactor)
+        security::PiiRedactor* redactor,
+        ContentStore* store)
         {
-        const std::string filename = "dataset.jsonl";
-        const std::filesystem::path outPath = options.outputPath / filename;
+        const bool sharded = options.jsonlShardBytes > 0;
+        const std::string filename = sharded ? "dataset-*.jsonl" : "dataset.jsonl";
 
         if (options.dryRun)
             {
@@ -55,49 +112,161 @@ namespace repaddu::format::detail
             return { core::ExitCode::success, "" };
             }
 
-        std::ofstream stream(outPath, std::ios::binary);
-        if (!stream)
-            {
-            return { core::ExitCode::io_failure, "Failed to create JSONL output file." };
-            }
-
+        // Every file once, in chunk order; records keep this order.
+        std::vector<std::size_t> order;
         std::vector<bool> visited(files.size(), false);
-
         for (const auto& chunk : chunks)
             {
             for (std::size_t fileIndex : chunk.fileIndices)
                 {
-                if (visited[fileIndex])
+                if (!visited[fileIndex])
                     {
-                    continue;
+                    visited[fileIndex] = true;
+                    order.push_back(fileIndex);
                     }
-                visited[fileIndex] = true;
+                }
+            }
 
-                core::RunResult readResult;
-                core::FileEntry entry = files[fileIndex];
-                const std::string content = readFileContent(entry.absolutePath, readResult, &entry.tokenCount, redactor, entry.relativePath.string());
+        std::vector<JsonlShard> shards;
+        OutputFile file;
+        auto openShard = [&]() -> core::RunResult
+            {
+            if (!file.close())
+                {
+                return { core::ExitCode::io_failure, "Failed to write JSONL output file." };
+                }
+            shards.push_back({ sharded ? shardFilename(shards.size()) : filename });
+            if (!file.open(options.outputPath / shards.back().filename))
+                {
+                return { core::ExitCode::io_failure, "Failed to create JSONL output file." };
+                }
+            return { core::ExitCode::success, "" };
+            };
+        core::RunResult openResult = openShard();
+        if (openResult.code != core::ExitCode::success)
+            {
+            return openResult;
+            }
 
+        // Records are read, redacted and escaped in parallel batches, then
+        // appended in order on this thread, so shard boundaries and bytes
+        // do not depend on the thread count.
+        const std::size_t threadCount = workerThreadCount(options);
+        const std::size_t batchSize = threadCount * kJsonlRecordsPerThread;
+        const std::uintmax_t batchBytes = threadCount * kJsonlBatchBytesPerThread;
+        std::vector<std::string> records;
+        for (std::size_t batchStart = 0, count = 0; batchStart < order.size(); batchStart += count)
+            {
+            std::uintmax_t inputBytes = files.sizeBytes(order[batchStart]);
+            count = 1;
+            while (count < batchSize && batchStart + count < order.size()
+                && inputBytes + files.sizeBytes(order[batchStart + count]) <= batchBytes)
+                {
+                inputBytes += files.sizeBytes(order[batchStart + count]);
+                ++count;
+                }
+            records.assign(count, std::string());
+            core::RunResult batchResult = runOutputJobs(count, threadCount, [&](std::size_t task) -> core::RunResult
+                {
+                const std::size_t fileIndex = order[batchStart + task];
+                core::RunResult readResult;
+                const std::string relative = files.relativePath(fileIndex);
+                std::uintmax_t tokenCount = 0;
+                core::BinaryState binaryState = files.binaryState(fileIndex);
+                const ContentView content = readFileContent(files.absolutePath(fileIndex), readResult, &tokenCount, redactor,
+                    relative, &binaryState, options.includeBinaries, store, !options.watch);
                 if (readResult.code != core::ExitCode::success)
                     {
                     return readResult;
                     }
+                if (!options.includeBinaries && binaryState == core::BinaryState::binary)
+                    {
+                    return { core::ExitCode::success, "" };
+                    }
 
-                stream << "{";
-                stream << "\"path\": " << escapeJsonString(entry.relativePath.generic_string()) << ", ";
-                stream << "\"class\": " << escapeJsonString(core::fileClassLabel(entry.fileClass)) << ", ";
-                stream << "\"bytes\": " << entry.sizeBytes << ", ";
-                stream << "\"tokens\": " << entry.tokenCount << ", ";
-                stream << "\"content\": " << escapeJsonString(content);
-                stream << "}\n";
+                std::string& record = records[task];
+                record.reserve(content.size() + relative.size() + 96);
+                record += "{\"path\": ";
+                appendJsonString(record, relative);
+                record += ", \"class\": ";
+                appendJsonString(record, core::fileClassLabel(files.fileClass(fileIndex)));
+                record += ", \"bytes\": " + std::to_string(files.sizeBytes(fileIndex));
+                record += ", \"tokens\": " + std::to_string(tokenCount);
+                record += ", \"content\": ";
+                appendJsonString(record, content.view());
+                record += "}\n";
+                return { core::ExitCode::success, "" };
+                });
+            if (batchResult.code != core::ExitCode::success)
+                {
+                return batchResult;
                 }
+
+            for (const std::string& record : records)
+                {
+                if (record.empty())
+                    {
+                    continue;
+                    }
+                // A record larger than the limit gets a shard of its own.
+                if (sharded && shards.back().records > 0 && shards.back().bytes + record.size() > options.jsonlShardBytes)
+                    {
+                    openResult = openShard();
+                    if (openResult.code != core::ExitCode::success)
+                        {
+                        return openResult;
+                        }
+                    }
+                if (!file.write(record))
+                    {
+                    return { core::ExitCode::io_failure, "Failed to write JSONL output file." };
+                    }
+                ++shards.back().records;
+                shards.back().bytes += record.size();
+                }
+            }
+        if (!file.close())
+            {
+            return { core::ExitCode::io_failure, "Failed to write JSONL output file." };
+            }
+        if (!sharded)
+            {
+            return { core::ExitCode::success, "" };
             }
 
+        // Shards left over from an earlier, larger run are not part of this
+        // dataset.
+        std::error_code errorCode;
+        std::vector<std::filesystem::path> stale;
+        for (const auto& entry : std::filesystem::directory_iterator(options.outputPath, errorCode))
+            {
+            const std::string name = entry.path().filename().string();
+            if (name.size() == shardFilename(0).size() && name.compare(0, 8, "dataset-") == 0
+                && name.compare(13, 6, ".jsonl") == 0
+                && std::all_of(name.begin() + 8, name.begin() + 13, [](char ch) { return ch >= '0' && ch <= '9'; })
+                && std::stoul(name.substr(8, 5)) >= shards.size())
+                {
+                stale.push_back(entry.path());
+                }
+            }
+        for (const auto& path : stale)
+            {
+            std::filesystem::remove(path, errorCode);
+            }
+
+        OutputFile manifest;
+        if (!manifest.open(options.outputPath / "dataset.manifest.json") || !manifest.write(renderManifest(shards,
+                options.jsonlShardBytes)) || !manifest.close())
+            {
+            return { core::ExitCode::io_failure, "Failed to write JSONL manifest." };
+            }
         return { core::ExitCode::success, "" };
         }
 
     core::RunResult writeHtmlOutput(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
-        security::PiiRedactor* redactor)
+        const core::FileTable& files,
+        security::PiiRedactor* redactor,
+        ContentStore* store)
         {
         const std::string filename = "index.html";
         const std::filesystem::path outPath = options.outputPath / filename;
@@ -138,7 +307,7 @@ namespace repaddu::format::detail
 )";
 
         bool first = true;
-        for (const auto& entry : files)
+        for (std::size_t fileIndex = 0; fileIndex < files.size(); ++fileIndex)
             {
             if (!first)
                 {
@@ -147,10 +316,12 @@ namespace repaddu::format::detail
             first = false;
 
             core::RunResult readResult;
-            const std::string content = readFileContent(entry.absolutePath, readResult, nullptr, redactor, entry.relativePath.string());
+            const std::string relative = files.relativePath(fileIndex);
+            const ContentView content = readFileContent(files.absolutePath(fileIndex), readResult, nullptr, redactor, relative,
+                nullptr, true, store, !options.watch);
 
-            stream << "{ \"path\": " << escapeJsonString(entry.relativePath.generic_string())
-                   << ", \"content\": " << escapeJsonString(content) << " }";
+            stream << "{ \"path\": " << escapeJsonString(relative)
+                   << ", \"content\": " << escapeJsonString(content.view()) << " }";
             }
 
         stream << R"(
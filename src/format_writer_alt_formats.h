@@ -1,6 +1,9 @@
 #ifndef REPADDU_FORMAT_WRITER_ALT_FORMATS_H
 #define REPADDU_FORMAT_WRITER_ALT_FORMATS_H
 
+#include "format_content_view.h"
+
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 #include "repaddu/pii_redactor.h"
 
@@ -10,20 +13,45 @@
 
 namespace repaddu::format::detail
     {
-    std::string readFileContent(const std::filesystem::path& path,
+    class ContentStore;
+
+    // Reads, redacts and token-counts a file in one open. An unknown
+    // *binaryState is resolved from the leading block of this read; a binary
+    // file then comes back empty unless keepBinary is set. Unredacted content
+    // of a file of 256 KiB or more is returned as a view of the file mapping
+    // where mmap is available; smaller files, and every file when mapContent
+    // is false, are copied into owned memory. With a store, a file whose
+    // identity is stored skips redaction and token counting, and other files
+    // are added to it.
+    ContentView readFileContent(const std::filesystem::path& path,
         core::RunResult& outResult,
         std::uintmax_t* outTokens = nullptr,
         security::PiiRedactor* redactor = nullptr,
-        const std::string& relativePath = "");
+        const std::string& relativePath = "",
+        core::BinaryState* binaryState = nullptr,
+        bool keepBinary = true,
+        ContentStore* store = nullptr,
+        bool mapContent = true);
 
     core::RunResult writeJsonlOutput(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
+        const std::vector<core::OutputChunk>& chunks,
+        security::PiiRedactor* redactor,
+        ContentStore* store);
+
+    // Writes repository.pack (see repaddu/format/pack_reader.h): every file
+    // is measured first, then header, records, paths and contents are
+    // written in one sequential pass.
+    core::RunResult writePackOutput(const core::CliOptions& options,
+        const core::FileTable& files,
         const std::vector<core::OutputChunk>& chunks,
-        security::PiiRedactor* redactor);
+        security::PiiRedactor* redactor,
+        ContentStore* store);
 
     core::RunResult writeHtmlOutput(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
-        security::PiiRedactor* redactor);
+        const core::FileTable& files,
+        security::PiiRedactor* redactor,
+        ContentStore* store);
     }
 
 #endif // REPADDU_FORMAT_WRITER_ALT_FORMATS_H
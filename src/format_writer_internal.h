@@ -1,13 +1,25 @@
 #ifndef REPADDU_FORMAT_WRITER_INTERNAL_H
 #define REPADDU_FORMAT_WRITER_INTERNAL_H
 
+#include "format_content_cache.h"
+#include "format_content_store.h"
+#include "format_content_view.h"
+#include "format_output_file.h"
+
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
+#include "repaddu/format_writer.h"
+#include "repaddu/format/marker_encoder.h"
 #include "repaddu/pii_redactor.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <filesystem>
-#include <ostream>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -28,37 +40,206 @@ namespace repaddu::format::detail
         std::uintmax_t contentBytes = 0;
         };
 
+    // Counts every byte it is given and, when file is set, writes them too;
+    // planning runs the same rendering code with no file to size outputs.
     struct OutputWriter
         {
-        std::ostream* stream = nullptr;
+        OutputFile* file = nullptr;
         std::uintmax_t bytes = 0;
         bool ok = true;
 
         void write(std::string_view text)
             {
             bytes += static_cast<std::uintmax_t>(text.size());
-            if (!stream)
+            if (file && !file->write(text))
                 {
-                return;
+                ok = false;
                 }
-            (*stream) << text;
-            if (!(*stream))
+            }
+
+        // Appends the first size bytes of path, copied file to file when
+        // writing. False when path turned out shorter than size.
+        bool copyFile(const std::filesystem::path& path, std::uintmax_t size)
+            {
+            bytes += size;
+            if (!file)
                 {
-                ok = false;
+                return true;
                 }
+            const std::uintmax_t copied = file->copyFrom(path, size);
+            ok = ok && file->ok();
+            return copied == size;
             }
         };
 
-    struct ContentCache
+    // Threads for content preparation and output writing: one per hardware
+    // thread unless --single-thread is set.
+    std::size_t workerThreadCount(const core::CliOptions& options);
+
+    // Forwards steps to a ProgressCallback one call at a time; does nothing
+    // without a callback.
+    class ProgressReporter
+        {
+        public:
+            ProgressReporter(const ProgressCallback& callback, std::size_t total);
+
+            ProgressReporter(const ProgressReporter&) = delete;
+            ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+            void advance(const std::string& filename);
+
+        private:
+            const ProgressCallback& callback_;
+            std::size_t total_;
+            std::size_t done_ = 0;
+            std::mutex mutex_;
+        };
+
+    // Runs job(0) .. job(count - 1) on up to threadCount threads, the
+    // calling thread included, and returns the failure of the lowest
+    // numbered job that failed, as a sequential loop would. No job starts
+    // once one has failed; jobs already running finish first.
+    core::RunResult runOutputJobs(std::size_t count,
+        std::size_t threadCount,
+        const std::function<core::RunResult(std::size_t)>& job);
+
+    // Output files written under a hidden temporary name and renamed into
+    // place by commit(). A run that fails a constraint halfway through the
+    // single-pass writer removes its partial files instead of leaving them.
+    class StagedOutputs
+        {
+        public:
+            explicit StagedOutputs(std::filesystem::path directory);
+            ~StagedOutputs();
+
+            StagedOutputs(const StagedOutputs&) = delete;
+            StagedOutputs& operator=(const StagedOutputs&) = delete;
+
+            core::RunResult open(const std::string& filename, OutputFile& file);
+            core::RunResult commit();
+
+        private:
+            std::filesystem::path stagingPath(const std::string& filename) const;
+
+            std::filesystem::path directory_;
+            std::vector<std::string> filenames_;
+            bool committed_ = false;
+        };
+
+    // Files larger than --stream-threshold-mb are never held in memory:
+    // they are read, redacted and written in windows of this size, once to
+    // measure them and once more while writing.
+    constexpr std::size_t kStreamWindowBytes = 1024 * 1024;
+
+    bool streamsContent(const core::CliOptions& options, std::uintmax_t sizeBytes);
+
+    // What a windowed pass over a file produced, after redaction.
+    struct StreamedContent
+        {
+        std::uintmax_t bytes = 0;
+        std::uintmax_t tokens = 0;
+        bool endsWithNewline = false;
+        };
+
+    // Reads path window by window, redacting across window boundaries, and
+    // writes the result to writer when one is given. An unknown *binaryState
+    // is resolved from the first window, as in readFileContent; a binary
+    // file then stops there unless keepBinary is set. Warnings for redacted
+    // matches are logged only when logMatches is set, so the writing pass
+    // does not repeat the measuring one.
+    core::RunResult streamFileContent(const std::filesystem::path& path,
+        const security::PiiRedactor* redactor,
+        const std::string& relativePath,
+        core::BinaryState* binaryState,
+        bool keepBinary,
+        bool logMatches,
+        OutputWriter* writer,
+        StreamedContent& outContent);
+
+    // A file read, redacted, token-counted and measured ahead of the
+    // sequential part-splitting loop.
+    struct PreparedFile
+        {
+        core::RunResult result;
+        ContentView content;
+        core::BinaryState binaryState = core::BinaryState::unknown;
+        std::uintmax_t tokenCount = 0;
+        std::uintmax_t blockBytes = 0; // Marker block plus the separating newline.
+        bool streamed = false;         // content is empty; write with writeStreamedBlock().
+        StreamedContent streamedContent;
+        };
+
+    // Prepares files in batches on a fixed set of worker threads (plus the
+    // calling thread). Batches keep the number of held mappings bounded;
+    // with one thread each file is prepared on its own, right before use,
+    // exactly like the serial writer.
+    class ContentPreparer
         {
-        std::unordered_map<std::string, std::string> entries;
-        std::uintmax_t totalBytes = 0;
-        std::uintmax_t maxBytes = 4 * 1024 * 1024;
+        public:
+            ContentPreparer(const core::CliOptions& options,
+                const core::FileTable& files,
+                security::PiiRedactor* redactor,
+                ContentStore* store = nullptr);
+            ~ContentPreparer();
+
+            ContentPreparer(const ContentPreparer&) = delete;
+            ContentPreparer& operator=(const ContentPreparer&) = delete;
+
+            // Queues the files to prepare, in the order they will be taken.
+            void setOrder(std::vector<std::size_t> fileIndices);
+            // Returns the prepared next file of the order; the batch it
+            // belongs to is prepared on first use.
+            PreparedFile take();
+
+            security::PiiRedactor* redactor() const
+                {
+                return redactor_;
+                }
+
+        private:
+            void prepare(std::size_t fileIndex, PreparedFile& out) const;
+            void runBatch(std::size_t count);
+            void runTasks();
+            void workerLoop();
 
-        bool tryGet(const std::filesystem::path& path, std::string& outContent) const;
-        void store(const std::filesystem::path& path, const std::string& content);
+            const core::CliOptions& options_;
+            const core::FileTable& files_;
+            security::PiiRedactor* redactor_;
+            ContentStore* store_;
+            std::vector<std::size_t> order_;
+            std::size_t nextInOrder_ = 0;
+            std::vector<PreparedFile> batch_;
+            std::size_t batchStart_ = 0;
+            std::size_t batchSize_ = 1;
+            std::size_t threadCount_ = 1;
+
+            std::vector<std::thread> workers_;
+            std::mutex mutex_;
+            std::condition_variable wake_;
+            std::condition_variable done_;
+            std::uint64_t generation_ = 0;
+            std::size_t busyWorkers_ = 0;
+            std::size_t batchCount_ = 0;
+            std::atomic<std::size_t> nextTask_{ 0 };
+            bool stop_ = false;
         };
 
+    // FNV-1a over the fields that determine an output file's bytes; a zero
+    // byte separates fields so ("ab","c") and ("a","bc") differ.
+    constexpr std::uint64_t kSignatureSeed = 14695981039346656037ULL;
+
+    inline std::uint64_t extendSignature(std::uint64_t signature, std::string_view field)
+        {
+        constexpr std::uint64_t prime = 1099511628211ULL;
+        for (const char ch : field)
+            {
+            signature ^= static_cast<unsigned char>(ch);
+            signature *= prime;
+            }
+        signature *= prime;
+        return signature;
+        }
+
     std::string padNumber(int value, int width);
     std::string overviewTemplate(const std::string& overviewName,
         core::MarkerMode mode,
@@ -66,17 +247,41 @@ namespace repaddu::format::detail
         bool emitLinks,
         const std::vector<std::string>& generatedFiles);
     std::string boilerplateLine(const std::string& overviewName);
+    std::string partFilename(int index, int numberWidth, const std::string& category, int part);
 
     core::RunResult readContentWithCache(const std::filesystem::path& path,
         const std::string& relativePath,
         security::PiiRedactor* redactor,
         ContentCache* cache,
-        std::string& outContent,
-        std::uintmax_t* outTokens = nullptr);
+        ContentView& outContent,
+        std::uintmax_t* outTokens = nullptr,
+        core::BinaryState* binaryState = nullptr,
+        bool keepBinary = true,
+        ContentStore* store = nullptr,
+        bool mapContent = true);
 
+    // Runtime-dispatched wrappers over MarkerEncoder.
     void writeChunkMarkerBlock(OutputWriter& writer,
-        const core::FileEntry& entry,
-        const std::string& content,
+        const MarkerFile& file,
+        std::string_view content,
+        core::MarkerMode mode,
+        bool emitFrontmatter);
+
+    // The parts of a marker block around the content, for blocks whose
+    // content is streamed rather than held in one view.
+    void writeChunkMarkerHeader(OutputWriter& writer,
+        const MarkerFile& file,
+        core::MarkerMode mode,
+        bool emitFrontmatter);
+    void writeChunkMarkerFooter(OutputWriter& writer, bool closeLine, core::MarkerMode mode);
+
+    // Writes the marker block of a streamed file. With expected set, the
+    // content must come out as measured, since the header was sized from it.
+    core::RunResult writeStreamedBlock(OutputWriter& writer,
+        const MarkerFile& file,
+        const std::filesystem::path& path,
+        const security::PiiRedactor* redactor,
+        const StreamedContent* expected,
         core::MarkerMode mode,
         bool emitFrontmatter);
 
@@ -93,21 +298,41 @@ namespace repaddu::format::detail
         security::PiiRedactor* redactor,
         ContentCache* cache);
 
-    std::uintmax_t markerBlockBytes(const core::FileEntry& entry,
-        const std::string& content,
+    // Block sizes computed from field lengths, without rendering.
+    std::uintmax_t markerBlockBytes(const MarkerFile& file,
+        std::string_view content,
+        core::MarkerMode mode,
+        bool emitFrontmatter);
+    std::uintmax_t streamedBlockBytes(const MarkerFile& file,
+        const StreamedContent& content,
         core::MarkerMode mode,
         bool emitFrontmatter);
 
     core::RunResult planChunkOutputs(const core::CliOptions& options,
         const std::string& overviewName,
         const std::vector<core::OutputChunk>& chunks,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         std::vector<ChunkPartPlan>& outParts,
         std::vector<OutputPlanEntry>& outOutputs,
         int& index,
-        security::PiiRedactor* redactor,
         std::vector<std::uintmax_t>& outTokenCounts,
-        ContentCache* cache);
+        ContentCache* cache,
+        ContentPreparer& preparer,
+        OutputCache* outputCache = nullptr);
+
+    // Single-pass counterpart of planChunkOutputs plus the write loop: each
+    // file is read and redacted once, measured, and written straight into
+    // the current part, which is closed when the next block would exceed
+    // --max-bytes. --max-files is checked as each part is opened.
+    core::RunResult streamChunkOutputs(const core::CliOptions& options,
+        const std::string& overviewName,
+        const std::vector<core::OutputChunk>& chunks,
+        const core::FileTable& files,
+        StagedOutputs& staged,
+        std::vector<OutputPlanEntry>& outOutputs,
+        int& index,
+        ContentPreparer& preparer,
+        ProgressReporter& progress);
     }
 
 #endif // REPADDU_FORMAT_WRITER_INTERNAL_H
@@ -3,151 +3,97 @@
 #include "format_writer_alt_formats.h"
 
 #include "repaddu/analysis_tokens.h"
+#include "repaddu/core_binary.h"
 
 #include <sstream>
 
 namespace repaddu::format::detail
     {
-    namespace
+    std::string padNumber(int value, int width)
         {
-        std::string escapeQuotes(std::string value)
-            {
-            std::string result;
-            result.reserve(value.size());
-            for (char ch : value)
-                {
-                if (ch == '"')
-                    {
-                    result.push_back('\\');
-                    }
-                result.push_back(ch);
-                }
-            return result;
-            }
+        std::ostringstream out;
+        out.fill('0');
+        out.width(width);
+        out << value;
+        return out.str();
         }
 
-    bool ContentCache::tryGet(const std::filesystem::path& path, std::string& outContent) const
+    void writeChunkMarkerHeader(OutputWriter& writer,
+        const MarkerFile& file,
+        core::MarkerMode mode,
+        bool emitFrontmatter)
         {
-        const std::string key = path.string();
-        auto it = entries.find(key);
-        if (it == entries.end())
+        visitMarkerEncoder(mode, emitFrontmatter, [&](auto encoder)
             {
-            return false;
-            }
-        outContent = it->second;
-        return true;
+            encoder.writeHeader(writer, file);
+            });
         }
 
-    void ContentCache::store(const std::filesystem::path& path, const std::string& content)
+    void writeChunkMarkerFooter(OutputWriter& writer, bool closeLine, core::MarkerMode mode)
         {
-        if (content.size() > maxBytes)
-            {
-            return;
-            }
-        if (totalBytes + static_cast<std::uintmax_t>(content.size()) > maxBytes)
+        visitMarkerEncoder(mode, false, [&](auto encoder)
             {
-            return;
-            }
-        const std::string key = path.string();
-        if (entries.find(key) != entries.end())
-            {
-            return;
-            }
-        entries.emplace(key, content);
-        totalBytes += static_cast<std::uintmax_t>(content.size());
+            encoder.writeFooter(writer, closeLine);
+            });
         }
 
-    std::string padNumber(int value, int width)
+    void writeChunkMarkerBlock(OutputWriter& writer,
+        const MarkerFile& file,
+        std::string_view content,
+        core::MarkerMode mode,
+        bool emitFrontmatter)
         {
-        std::ostringstream out;
-        out.fill('0');
-        out.width(width);
-        out << value;
-        return out.str();
+        visitMarkerEncoder(mode, emitFrontmatter, [&](auto encoder)
+            {
+            encoder.writeHeader(writer, file);
+            writer.write(content);
+            encoder.writeFooter(writer, !content.empty() && content.back() != '\n');
+            });
         }
 
-    void writeChunkMarkerBlock(OutputWriter& writer,
-        const core::FileEntry& entry,
-        const std::string& content,
+    core::RunResult writeStreamedBlock(OutputWriter& writer,
+        const MarkerFile& file,
+        const std::filesystem::path& path,
+        const security::PiiRedactor* redactor,
+        const StreamedContent* expected,
         core::MarkerMode mode,
         bool emitFrontmatter)
         {
-        const std::string relative = entry.relativePath.generic_string();
-        if (mode == core::MarkerMode::fenced)
+        writeChunkMarkerHeader(writer, file, mode, emitFrontmatter);
+        if (!redactor && expected)
             {
-            writer.write("```repaddu-file\n");
-            writer.write("path: ");
-            writer.write(relative);
-            writer.write("\n");
-            writer.write("bytes: ");
-            writer.write(std::to_string(entry.sizeBytes));
-            writer.write("\n");
-            writer.write("tokens: ");
-            writer.write(std::to_string(entry.tokenCount));
-            writer.write("\n");
-            writer.write("class: ");
-            writer.write(core::fileClassLabel(entry.fileClass));
-            writer.write("\n");
-            writer.write("```\n");
-            if (emitFrontmatter)
+            // Unredacted and already measured: the body is the file as is.
+            const bool complete = writer.copyFile(path, expected->bytes);
+            if (!writer.ok)
                 {
-                writer.write("---\n");
-                writer.write("path: ");
-                writer.write(relative);
-                writer.write("\n");
-                writer.write("bytes: ");
-                writer.write(std::to_string(entry.sizeBytes));
-                writer.write("\n");
-                writer.write("tokens: ");
-                writer.write(std::to_string(entry.tokenCount));
-                writer.write("\n");
-                writer.write("class: ");
-                writer.write(core::fileClassLabel(entry.fileClass));
-                writer.write("\n");
-                writer.write("---\n");
+                return { core::ExitCode::io_failure, "Failed to write output file." };
                 }
-            writer.write(content);
-            if (!content.empty() && content.back() != '\n')
+            if (!complete)
                 {
-                writer.write("\n");
+                return { core::ExitCode::io_failure, "File changed while it was being written: " + path.string() };
                 }
-            writer.write("```\n");
+            writeChunkMarkerFooter(writer, expected->bytes > 0 && !expected->endsWithNewline, mode);
+            return { core::ExitCode::success, "" };
             }
-        else
+        StreamedContent written;
+        std::string relative(file.directory);
+        if (!relative.empty())
             {
-            writer.write("@@@ REPADDU FILE BEGIN path=\"");
-            writer.write(escapeQuotes(relative));
-            writer.write("\" bytes=");
-            writer.write(std::to_string(entry.sizeBytes));
-            writer.write(" tokens=");
-            writer.write(std::to_string(entry.tokenCount));
-            writer.write(" class=");
-            writer.write(core::fileClassLabel(entry.fileClass));
-            writer.write(" @@@\n");
-            if (emitFrontmatter)
-                {
-                writer.write("---\n");
-                writer.write("path: ");
-                writer.write(relative);
-                writer.write("\n");
-                writer.write("bytes: ");
-                writer.write(std::to_string(entry.sizeBytes));
-                writer.write("\n");
-                writer.write("tokens: ");
-                writer.write(std::to_string(entry.tokenCount));
-                writer.write("\n");
-                writer.write("class: ");
-                writer.write(core::fileClassLabel(entry.fileClass));
-                writer.write("\n");
-                writer.write("---\n");
-                }
-            writer.write(content);
-            if (!content.empty() && content.back() != '\n')
-                {
-                writer.write("\n");
-                }
-            writer.write("@@@ REPADDU FILE END @@@\n");
+            relative += '/';
+            }
+        relative += file.name;
+        core::RunResult streamResult = streamFileContent(path, redactor, relative, nullptr, true, false, &writer,
+            written);
+        if (streamResult.code != core::ExitCode::success)
+            {
+            return streamResult;
             }
+        if (expected && (written.bytes != expected->bytes || written.endsWithNewline != expected->endsWithNewline))
+            {
+            return { core::ExitCode::io_failure, "File changed while it was being written: " + path.string() };
+            }
+        writeChunkMarkerFooter(writer, written.bytes > 0 && !written.endsWithNewline, mode);
+        return { core::ExitCode::success, "" };
         }
 
     std::string overviewTemplate(const std::string& overviewName,
@@ -249,25 +195,38 @@ namespace repaddu::format::detail
         const std::string& relativePath,
         security::PiiRedactor* redactor,
         ContentCache* cache,
-        std::string& outContent,
-        std::uintmax_t* outTokens)
+        ContentView& outContent,
+        std::uintmax_t* outTokens,
+        core::BinaryState* binaryState,
+        bool keepBinary,
+        ContentStore* store,
+        bool mapContent)
         {
         if (cache && cache->tryGet(path, outContent))
             {
+            if (binaryState)
+                {
+                *binaryState = core::resolveBinaryState(*binaryState, outContent.view());
+                if (*binaryState == core::BinaryState::binary && !keepBinary)
+                    {
+                    outContent = ContentView();
+                    }
+                }
             if (outTokens)
                 {
-                *outTokens = analysis::TokenEstimator::estimateTokens(outContent);
+                *outTokens = analysis::TokenEstimator::estimateTokens(outContent.view());
                 }
             return { core::ExitCode::success, "" };
             }
 
         core::RunResult readResult;
-        outContent = readFileContent(path, readResult, outTokens, redactor, relativePath);
+        outContent = readFileContent(path, readResult, outTokens, redactor, relativePath, binaryState, keepBinary,
+            store, mapContent);
         if (readResult.code != core::ExitCode::success)
             {
             return readResult;
             }
-        if (cache)
+        if (cache && !(binaryState && *binaryState == core::BinaryState::binary && !keepBinary))
             {
             cache->store(path, outContent);
             }
@@ -308,23 +267,28 @@ namespace repaddu::format::detail
             {
             const std::filesystem::path absolute = options.inputPath / path;
 
-            core::FileEntry entry;
-            entry.relativePath = path;
-            std::string content;
+            const std::string relative = path.generic_string();
+            MarkerFile file;
+            file.name = relative;
+            ContentView content;
             core::RunResult readResult = readContentWithCache(absolute,
                 path.string(),
                 redactor,
                 cache,
                 content,
-                &entry.tokenCount);
+                &file.tokenCount,
+                nullptr,
+                true,
+                nullptr,
+                !options.watch);
             if (readResult.code != core::ExitCode::success)
                 {
                 return readResult;
                 }
 
-            entry.sizeBytes = static_cast<std::uintmax_t>(content.size());
-            entry.fileClass = core::classifyExtension(core::toLowerCopy(entry.relativePath.extension().string()));
-            writeChunkMarkerBlock(writer, entry, content, options.markers, options.emitFrontmatter);
+            file.sizeBytes = static_cast<std::uintmax_t>(content.size());
+            file.fileClass = core::classifyExtension(core::toLowerCopy(path.extension().string()));
+            writeChunkMarkerBlock(writer, file, content.view(), options.markers, options.emitFrontmatter);
             writer.write("\n");
             if (!writer.ok)
                 {
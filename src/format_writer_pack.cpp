@@ -0,0 +1,210 @@
+#include "format_writer_alt_formats.h"
+#include "format_writer_internal.h"
+
+#include "repaddu/format/pack_reader.h"
+#include "repaddu/logger.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace repaddu::format::detail
+    {
+    namespace
+        {
+        struct PackMember
+            {
+            std::size_t fileIndex = 0;
+            std::string relative;
+            bool streamed = false;
+            StreamedContent measured{}; // bytes and tokens after redaction.
+            };
+
+        template <typename T>
+        void writeRaw(OutputWriter& writer, const T& value)
+            {
+            writer.write(std::string_view(reinterpret_cast<const char*>(&value), sizeof(value)));
+            }
+
+        // Writes one member's content, which must come out as measured since
+        // the records in front of it were sized from the measurement.
+        core::RunResult writeMemberContent(OutputWriter& writer,
+            const PackMember& member,
+            const core::FileTable& files,
+            security::PiiRedactor* redactor,
+            ContentCache& cache,
+            ContentStore* store,
+            bool mapContent)
+            {
+            const std::filesystem::path path = files.absolutePath(member.fileIndex);
+            const core::RunResult changed{ core::ExitCode::io_failure,
+                "File changed while it was being written: " + member.relative };
+            const std::uintmax_t before = writer.bytes;
+            if (member.streamed && !redactor)
+                {
+                // Never held in memory, so the body is the file as is.
+                if (!writer.copyFile(path, member.measured.bytes))
+                    {
+                    return changed;
+                    }
+                }
+            else if (member.streamed)
+                {
+                StreamedContent produced;
+                core::BinaryState binaryState = core::BinaryState::text;
+                core::RunResult streamResult = streamFileContent(path, redactor, member.relative, &binaryState, true, false,
+                    &writer, produced);
+                if (streamResult.code != core::ExitCode::success)
+                    {
+                    return streamResult;
+                    }
+                }
+            else
+                {
+                ContentView content;
+                core::RunResult readResult = readContentWithCache(path, member.relative, redactor, &cache, content, nullptr,
+                    nullptr, true, store, mapContent);
+                if (readResult.code != core::ExitCode::success)
+                    {
+                    return readResult;
+                    }
+                writer.write(content.view());
+                }
+            if (!writer.ok)
+                {
+                return { core::ExitCode::io_failure, "Failed to write pack output file." };
+                }
+            return writer.bytes - before == member.measured.bytes ? core::RunResult{ core::ExitCode::success, "" } : changed;
+            }
+        }
+
+    core::RunResult writePackOutput(const core::CliOptions& options,
+        const core::FileTable& files,
+        const std::vector<core::OutputChunk>& chunks,
+        security::PiiRedactor* redactor,
+        ContentStore* store)
+        {
+        if constexpr (std::endian::native != std::endian::little)
+            {
+            return { core::ExitCode::invalid_usage, "--format pack requires a little-endian host." };
+            }
+
+        const std::string filename = "repository.pack";
+
+        // Members in path order, each listed once, as the records store them.
+        std::vector<PackMember> members;
+        std::vector<bool> listed(files.size(), false);
+        for (const auto& chunk : chunks)
+            {
+            for (std::size_t fileIndex : chunk.fileIndices)
+                {
+                if (!listed[fileIndex])
+                    {
+                    listed[fileIndex] = true;
+                    members.push_back({ fileIndex, files.relativePath(fileIndex) });
+                    }
+                }
+            }
+        std::sort(members.begin(), members.end(), [](const PackMember& left, const PackMember& right)
+            {
+            return left.relative < right.relative;
+            });
+
+        // Planning pass: every size and token count is known before the
+        // first byte is written, so the file goes out front to back.
+        ContentCache cache(options.contentCacheMb * 1024 * 1024);
+        ContentPreparer preparer(options, files, redactor, store);
+        std::vector<std::size_t> order;
+        order.reserve(members.size());
+        for (const PackMember& member : members)
+            {
+            order.push_back(member.fileIndex);
+            }
+        preparer.setOrder(std::move(order));
+
+        std::vector<PackMember> kept;
+        kept.reserve(members.size());
+        std::uint64_t pathsBytes = 0;
+        std::uint64_t contentBytes = 0;
+        for (PackMember& member : members)
+            {
+            PreparedFile prepared = preparer.take();
+            if (prepared.result.code != core::ExitCode::success)
+                {
+                return prepared.result;
+                }
+            if (!options.includeBinaries && prepared.binaryState == core::BinaryState::binary)
+                {
+                continue;
+                }
+            member.streamed = prepared.streamed;
+            member.measured = prepared.streamed ? prepared.streamedContent
+                                                : StreamedContent{ prepared.content.size(), prepared.tokenCount };
+            if (!prepared.streamed)
+                {
+                cache.store(files.absolutePath(member.fileIndex), prepared.content);
+                }
+            pathsBytes += member.relative.size();
+            contentBytes += member.measured.bytes;
+            kept.push_back(std::move(member));
+            }
+
+        PackHeader header{};
+        std::memcpy(header.magic, kPackFileMagic, sizeof(header.magic));
+        header.version = kPackFileVersion;
+        header.recordBytes = sizeof(PackRecord);
+        header.entryCount = kept.size();
+        header.pathsOffset = sizeof(PackHeader) + kept.size() * sizeof(PackRecord);
+        header.pathsBytes = pathsBytes;
+        header.contentOffset = header.pathsOffset + pathsBytes;
+        header.contentBytes = contentBytes;
+        const std::uint64_t totalBytes = header.contentOffset + contentBytes;
+
+        if (options.dryRun)
+            {
+            LogInfo("[Dry Run] Would write pack: " + filename + " (" + std::to_string(totalBytes) + " bytes)");
+            return { core::ExitCode::success, "" };
+            }
+
+        OutputFile file;
+        if (!file.open(options.outputPath / filename))
+            {
+            return { core::ExitCode::io_failure, "Failed to create pack output file." };
+            }
+        OutputWriter writer{ &file };
+        writeRaw(writer, header);
+        std::uint64_t pathOffset = 0;
+        std::uint64_t contentOffset = 0;
+        for (const PackMember& member : kept)
+            {
+            PackRecord record{};
+            record.pathOffset = pathOffset;
+            record.contentOffset = contentOffset;
+            record.contentBytes = member.measured.bytes;
+            record.tokenCount = member.measured.tokens;
+            record.pathBytes = static_cast<std::uint32_t>(member.relative.size());
+            record.fileClass = static_cast<std::uint32_t>(files.fileClass(member.fileIndex));
+            writeRaw(writer, record);
+            pathOffset += member.relative.size();
+            contentOffset += member.measured.bytes;
+            }
+        for (const PackMember& member : kept)
+            {
+            writer.write(member.relative);
+            }
+        for (const PackMember& member : kept)
+            {
+            core::RunResult contentResult = writeMemberContent(writer, member, files, redactor, cache, store,
+                !options.watch);
+            if (contentResult.code != core::ExitCode::success)
+                {
+                return contentResult;
+                }
+            }
+        if (!file.close() || !writer.ok || writer.bytes != totalBytes)
+            {
+            return { core::ExitCode::io_failure, "Failed to write pack output file." };
+            }
+        return { core::ExitCode::success, "" };
+        }
+    }
@@ -2,27 +2,73 @@
 
 namespace repaddu::format::detail
     {
-    std::uintmax_t markerBlockBytes(const core::FileEntry& entry,
-        const std::string& content,
+    std::uintmax_t markerBlockBytes(const MarkerFile& file,
+        std::string_view content,
         core::MarkerMode mode,
         bool emitFrontmatter)
         {
-        OutputWriter counter;
-        writeChunkMarkerBlock(counter, entry, content, mode, emitFrontmatter);
-        return counter.bytes;
+        return visitMarkerEncoder(mode, emitFrontmatter, [&](auto encoder)
+            {
+            return encoder.blockBytes(file, content.size(), !content.empty() && content.back() != '\n');
+            });
+        }
+
+    std::uintmax_t streamedBlockBytes(const MarkerFile& file,
+        const StreamedContent& content,
+        core::MarkerMode mode,
+        bool emitFrontmatter)
+        {
+        return visitMarkerEncoder(mode, emitFrontmatter, [&](auto encoder)
+            {
+            return encoder.blockBytes(file, content.bytes, content.bytes > 0 && !content.endsWithNewline);
+            });
+        }
+
+    bool streamsContent(const core::CliOptions& options, std::uintmax_t sizeBytes)
+        {
+        return options.streamThresholdMb > 0 && sizeBytes > options.streamThresholdMb * 1024 * 1024;
+        }
+
+    std::string partFilename(int index, int numberWidth, const std::string& category, int part)
+        {
+        const std::string partSuffix = (part > 1) ? "_part" + std::to_string(part) : "";
+        return padNumber(index, numberWidth) + "_" + category + partSuffix + ".md";
         }
 
     core::RunResult planChunkOutputs(const core::CliOptions& options,
         const std::string& overviewName,
         const std::vector<core::OutputChunk>& chunks,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         std::vector<ChunkPartPlan>& outParts,
         std::vector<OutputPlanEntry>& outOutputs,
         int& index,
-        security::PiiRedactor* redactor,
         std::vector<std::uintmax_t>& outTokenCounts,
-        ContentCache* cache)
+        ContentCache* cache,
+        ContentPreparer& preparer,
+        OutputCache* outputCache)
         {
+        // The files the loop below will read, in the order it reads them, so
+        // the preparer can work ahead. Files with a cached measure are skipped
+        // and are only measured once even if listed twice.
+        std::vector<std::size_t> order;
+        std::unordered_map<std::string, bool> queued;
+        for (const auto& chunk : chunks)
+            {
+            for (std::size_t fileIndex : chunk.fileIndices)
+                {
+                if (outputCache)
+                    {
+                    const std::string relative = files.relativePath(fileIndex);
+                    if (outputCache->measures.count(relative) != 0 || !queued.emplace(relative, true).second)
+                        {
+                        continue;
+                        }
+                    }
+                order.push_back(fileIndex);
+                }
+            }
+        preparer.setOrder(std::move(order));
+
         for (const auto& chunk : chunks)
             {
             std::string header = boilerplateLine(overviewName);
@@ -34,30 +80,62 @@ namespace repaddu::format::detail
 
             for (std::size_t fileIndex : chunk.fileIndices)
                 {
-                core::FileEntry entry = files[fileIndex];
-                std::string content;
-                core::RunResult readResult = readContentWithCache(entry.absolutePath,
-                    entry.relativePath.string(),
-                    redactor,
-                    cache,
-                    content,
-                    &outTokenCounts[fileIndex]);
-                if (readResult.code != core::ExitCode::success)
+                const std::string relative = files.relativePath(fileIndex);
+                std::uintmax_t blockBytes = 0;
+                const OutputCache::FileMeasure* measure = nullptr;
+                if (outputCache)
+                    {
+                    auto it = outputCache->measures.find(relative);
+                    if (it != outputCache->measures.end())
+                        {
+                        measure = &it->second;
+                        }
+                    }
+
+                if (measure)
                     {
-                    return readResult;
+                    if (measure->binary)
+                        {
+                        continue;
+                        }
+                    outTokenCounts[fileIndex] = measure->tokenCount;
+                    blockBytes = measure->blockBytes;
                     }
-                entry.tokenCount = outTokenCounts[fileIndex];
+                else
+                    {
+                    // Files that grouping could not classify yet are sniffed on
+                    // this read; binaries drop out before their body is copied.
+                    PreparedFile prepared = preparer.take();
+                    if (prepared.result.code != core::ExitCode::success)
+                        {
+                        return prepared.result;
+                        }
+                    outTokenCounts[fileIndex] = prepared.tokenCount;
+                    if (!options.includeBinaries && prepared.binaryState == core::BinaryState::binary)
+                        {
+                        if (outputCache)
+                            {
+                            outputCache->measures[relative] = { 0, 0, true };
+                            }
+                        continue;
+                        }
+                    if (cache && !prepared.streamed)
+                        {
+                        cache->store(files.absolutePath(fileIndex), prepared.content);
+                        }
 
-                std::uintmax_t blockBytes = markerBlockBytes(entry, content, options.markers,
-                    options.emitFrontmatter);
-                blockBytes += 1;
+                    blockBytes = prepared.blockBytes;
+                    if (outputCache)
+                        {
+                        outputCache->measures[relative] = { outTokenCounts[fileIndex], blockBytes };
+                        }
+                    }
 
                 if (options.maxBytes > 0 && !chunk.fileIndices.empty()
                     && currentBytes + blockBytes > options.maxBytes)
                     {
                     ChunkPartPlan partPlan;
-                    const std::string partSuffix = (part > 1) ? "_part" + std::to_string(part) : "";
-                    partPlan.filename = padNumber(index, options.numberWidth) + "_" + chunk.category + partSuffix + ".md";
+                    partPlan.filename = partFilename(index, options.numberWidth, chunk.category, part);
                     partPlan.category = chunk.category;
                     partPlan.title = chunk.title;
                     partPlan.fileIndices = std::move(currentIndices);
@@ -80,11 +158,11 @@ namespace repaddu::format::detail
                     }
                 }
 
-            if (currentBytes > 0)
+            const bool allSkipped = !chunk.fileIndices.empty() && currentIndices.empty();
+            if (currentBytes > 0 && !allSkipped)
                 {
                 ChunkPartPlan partPlan;
-                const std::string partSuffix = (part > 1) ? "_part" + std::to_string(part) : "";
-                partPlan.filename = padNumber(index, options.numberWidth) + "_" + chunk.category + partSuffix + ".md";
+                partPlan.filename = partFilename(index, options.numberWidth, chunk.category, part);
                 partPlan.category = chunk.category;
                 partPlan.title = chunk.title;
                 partPlan.fileIndices = std::move(currentIndices);
@@ -0,0 +1,167 @@
+#include "format_writer_internal.h"
+
+#include "format_writer_alt_formats.h"
+
+#include <algorithm>
+
+namespace repaddu::format::detail
+    {
+    namespace
+        {
+        // Files per batch and thread; enough to keep every worker busy
+        // across uneven file sizes without holding many mappings at once.
+        constexpr std::size_t kBatchFilesPerThread = 32;
+        }
+
+    ContentPreparer::ContentPreparer(const core::CliOptions& options,
+        const core::FileTable& files,
+        security::PiiRedactor* redactor,
+        ContentStore* store)
+        : options_(options), files_(files), redactor_(redactor), store_(store)
+        {
+        threadCount_ = workerThreadCount(options);
+        batchSize_ = threadCount_ == 1 ? 1 : threadCount_ * kBatchFilesPerThread;
+        }
+
+    ContentPreparer::~ContentPreparer()
+        {
+            {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            }
+        wake_.notify_all();
+        for (std::thread& worker : workers_)
+            {
+            worker.join();
+            }
+        }
+
+    void ContentPreparer::setOrder(std::vector<std::size_t> fileIndices)
+        {
+        order_ = std::move(fileIndices);
+        nextInOrder_ = 0;
+        batchStart_ = 0;
+        batch_.clear();
+        }
+
+    PreparedFile ContentPreparer::take()
+        {
+        if (nextInOrder_ >= batchStart_ + batch_.size())
+            {
+            batchStart_ = nextInOrder_;
+            batch_.clear();
+            batch_.resize(std::min(batchSize_, order_.size() - batchStart_));
+            runBatch(batch_.size());
+            }
+        PreparedFile prepared = std::move(batch_[nextInOrder_ - batchStart_]);
+        ++nextInOrder_;
+        return prepared;
+        }
+
+    void ContentPreparer::prepare(std::size_t fileIndex, PreparedFile& out) const
+        {
+        const std::string relative = files_.relativePath(fileIndex);
+        out.binaryState = files_.binaryState(fileIndex);
+        if (streamsContent(options_, files_.sizeBytes(fileIndex)))
+            {
+            // Measured here without holding the content; written later in a second pass.
+            out.streamed = true;
+            out.result = streamFileContent(files_.absolutePath(fileIndex), redactor_, relative, &out.binaryState,
+                options_.includeBinaries, true, nullptr, out.streamedContent);
+            if (out.result.code != core::ExitCode::success
+                || (!options_.includeBinaries && out.binaryState == core::BinaryState::binary))
+                {
+                return;
+                }
+            out.tokenCount = out.streamedContent.tokens;
+            const MarkerFile marker = markerFileOf(files_, fileIndex, out.tokenCount);
+            out.blockBytes = streamedBlockBytes(marker, out.streamedContent, options_.markers, options_.emitFrontmatter) + 1;
+            return;
+            }
+        out.content = readFileContent(files_.absolutePath(fileIndex),
+            out.result,
+            &out.tokenCount,
+            redactor_,
+            relative,
+            &out.binaryState,
+            options_.includeBinaries,
+            store_,
+            !options_.watch);
+        if (out.result.code != core::ExitCode::success
+            || (!options_.includeBinaries && out.binaryState == core::BinaryState::binary))
+            {
+            return;
+            }
+        const MarkerFile marker = markerFileOf(files_, fileIndex, out.tokenCount);
+        out.blockBytes = markerBlockBytes(marker, out.content.view(), options_.markers, options_.emitFrontmatter) + 1;
+        }
+
+    void ContentPreparer::runTasks()
+        {
+        for (std::size_t task = nextTask_.fetch_add(1); task < batchCount_; task = nextTask_.fetch_add(1))
+            {
+            prepare(order_[batchStart_ + task], batch_[task]);
+            }
+        }
+
+    void ContentPreparer::runBatch(std::size_t count)
+        {
+        if (threadCount_ == 1 || count == 1)
+            {
+            for (std::size_t task = 0; task < count; ++task)
+                {
+                prepare(order_[batchStart_ + task], batch_[task]);
+                }
+            return;
+            }
+
+        // Workers start on the first batch that needs them.
+        const std::size_t workerCount = std::min(threadCount_, count) - 1;
+        while (workers_.size() < workerCount)
+            {
+            workers_.emplace_back(&ContentPreparer::workerLoop, this);
+            }
+
+            {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batchCount_ = count;
+            nextTask_.store(0);
+            busyWorkers_ = workers_.size();
+            ++generation_;
+            }
+        wake_.notify_all();
+        runTasks();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]()
+            {
+            return busyWorkers_ == 0;
+            });
+        }
+
+    void ContentPreparer::workerLoop()
+        {
+        std::uint64_t seen = 0;
+        while (true)
+            {
+                {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this, seen]()
+                    {
+                    return stop_ || generation_ != seen;
+                    });
+                if (stop_)
+                    {
+                    return;
+                    }
+                seen = generation_;
+                }
+            runTasks();
+                {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --busyWorkers_;
+                }
+            done_.notify_one();
+            }
+        }
+    }
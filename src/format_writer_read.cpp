@@ -1,11 +1,20 @@
 #include "format_writer_alt_formats.h"
 
+#include "format_content_store.h"
+#include "format_writer_internal.h"
+
 #include "repaddu/analysis_tokens.h"
+#include "repaddu/core_binary.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <filesystem>
 #include <fstream>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <sstream>
+#include <string_view>
 
 #if defined(_WIN32)
 #ifndef NOMINMAX
@@ -23,7 +32,105 @@ namespace repaddu::format::detail
     {
     namespace
         {
-        bool tryReadFileMmap(const std::filesystem::path& path, std::string& outContent)
+        // Keeps a file mapping alive for the ContentViews that borrow it.
+        class FileMapping
+            {
+            public:
+                FileMapping(const void* address, std::size_t length)
+                    : address_(address), length_(length)
+                    {
+                    }
+
+                FileMapping(const FileMapping&) = delete;
+                FileMapping& operator=(const FileMapping&) = delete;
+
+                ~FileMapping()
+                    {
+#if defined(_WIN32)
+                    UnmapViewOfFile(address_);
+#else
+                    ::munmap(const_cast<void*>(address_), length_);
+#endif
+                    }
+
+            private:
+                const void* address_;
+                std::size_t length_;
+            };
+
+        // Resolves an unknown binaryState from the leading block of the read in
+        // progress; true when the caller should stop without reading the rest.
+        bool stopAfterSniff(std::string_view head,
+            core::BinaryState* binaryState,
+            bool keepBinary)
+            {
+            if (!binaryState)
+                {
+                return false;
+                }
+            *binaryState = core::resolveBinaryState(*binaryState, head);
+            return *binaryState == core::BinaryState::binary && !keepBinary;
+            }
+
+        // Files below this size are copied into owned memory rather than
+        // mapped: a mapping of a file another process truncates faults with
+        // SIGBUS when touched, and views outlive the read in the content
+        // cache and through writing. Larger files are still mapped unless
+        // the caller asks for a copy.
+        constexpr std::size_t kMapMinBytes = 256 * 1024;
+
+#if !defined(_WIN32)
+        // Reads sizeBytes from fd into owned memory, stopping after the
+        // leading block when the sniff says so. A file that shrank since the
+        // fstat yields what is left of it.
+        bool readOwned(int fd,
+            std::size_t sizeBytes,
+            ContentView& outContent,
+            core::BinaryState* binaryState,
+            bool keepBinary)
+            {
+            std::string buffer(sizeBytes, '\0');
+            std::size_t filled = 0;
+            bool sniffed = false;
+            while (filled < sizeBytes)
+                {
+                const std::size_t want = sniffed ? sizeBytes - filled : std::min(sizeBytes, core::kSniffBytes) - filled;
+                const ssize_t got = ::read(fd, buffer.data() + filled, want);
+                if (got < 0 && errno == EINTR)
+                    {
+                    continue;
+                    }
+                if (got < 0)
+                    {
+                    return false;
+                    }
+                filled += static_cast<std::size_t>(got);
+                if (!sniffed && (got == 0 || filled == std::min(sizeBytes, core::kSniffBytes)))
+                    {
+                    sniffed = true;
+                    if (stopAfterSniff(std::string_view(buffer.data(), filled), binaryState, keepBinary))
+                        {
+                        outContent = ContentView();
+                        return true;
+                        }
+                    }
+                if (got == 0)
+                    {
+                    break;
+                    }
+                }
+            buffer.resize(filled);
+            outContent = ContentView(std::move(buffer));
+            return true;
+            }
+#endif
+
+        bool tryReadFileMmap(const std::filesystem::path& path,
+            ContentView& outContent,
+            core::BinaryState* binaryState,
+            bool keepBinary,
+            bool mapContent,
+            FileIdentity* outIdentity)
             {
 #if defined(_WIN32)
             const std::wstring widePath = path.wstring();
@@ -43,13 +150,16 @@ namespace repaddu::format::detail
 
             if (size.QuadPart <= 0)
                 {
-                outContent.clear();
+                outContent = ContentView();
+                stopAfterSniff({}, binaryState, keepBinary);
                 CloseHandle(fileHandle);
                 return true;
                 }
 
-            if (size.QuadPart > static_cast<LONGLONG>((std::numeric_limits<std::size_t>::max)()))
+            if (size.QuadPart > static_cast<LONGLONG>((std::numeric_limits<std::size_t>::max)())
+                || !mapContent || size.QuadPart < static_cast<LONGLONG>(kMapMinBytes))
                 {
+                // The stream read below copies these into owned memory.
                 CloseHandle(fileHandle);
                 return false;
                 }
@@ -71,11 +181,19 @@ namespace repaddu::format::detail
 
             const std::size_t sizeBytes = static_cast<std::size_t>(size.QuadPart);
             const char* data = static_cast<const char*>(view);
-            outContent.assign(data, data + sizeBytes);
-
-            UnmapViewOfFile(view);
+            // The view keeps its pages mapped after both handles are closed.
             CloseHandle(mapping);
             CloseHandle(fileHandle);
+            if (stopAfterSniff(std::string_view(data, (std::min)(sizeBytes, core::kSniffBytes)), binaryState, keepBinary))
+                {
+                UnmapViewOfFile(view);
+                outContent = ContentView();
+                }
+            else
+                {
+                outContent = ContentView(std::make_shared<const FileMapping>(view, sizeBytes),
+                    std::string_view(data, sizeBytes));
+                }
             return true;
 #else
             const int fd = ::open(path.c_str(), O_RDONLY);
@@ -91,9 +209,27 @@ namespace repaddu::format::detail
                 return false;
                 }
 
+            if (outIdentity)
+                {
+#if defined(__APPLE__)
+                const struct timespec& modified = statbuf.st_mtimespec;
+                const struct timespec& changed = statbuf.st_ctimespec;
+#else
+                const struct timespec& modified = statbuf.st_mtim;
+                const struct timespec& changed = statbuf.st_ctim;
+#endif
+                outIdentity->device = static_cast<std::uint64_t>(statbuf.st_dev);
+                outIdentity->inode = static_cast<std::uint64_t>(statbuf.st_ino);
+                outIdentity->sizeBytes = static_cast<std::uint64_t>(statbuf.st_size);
+                outIdentity->mtimeNs = static_cast<std::int64_t>(modified.tv_sec) * 1'000'000'000 + modified.tv_nsec;
+                outIdentity->ctimeNs = static_cast<std::int64_t>(changed.tv_sec) * 1'000'000'000 + changed.tv_nsec;
+                outIdentity->valid = true;
+                }
+
             if (statbuf.st_size <= 0)
                 {
-                outContent.clear();
+                outContent = ContentView();
+                stopAfterSniff({}, binaryState, keepBinary);
                 ::close(fd);
                 return true;
                 }
@@ -104,56 +240,212 @@ namespace repaddu::format::detail
                 return false;
                 }
 
-            void* mapping = ::mmap(nullptr, static_cast<std::size_t>(statbuf.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            const std::size_t sizeBytes = static_cast<std::size_t>(statbuf.st_size);
+            if (!mapContent || sizeBytes < kMapMinBytes)
+                {
+                const bool read = readOwned(fd, sizeBytes, outContent, binaryState, keepBinary);
+                ::close(fd);
+                return read;
+                }
+
+            void* mapping = ::mmap(nullptr, sizeBytes, PROT_READ, MAP_PRIVATE, fd, 0);
             if (mapping == MAP_FAILED)
                 {
                 ::close(fd);
                 return false;
                 }
 
-            const std::size_t sizeBytes = static_cast<std::size_t>(statbuf.st_size);
             const char* data = static_cast<const char*>(mapping);
-            outContent.assign(data, data + sizeBytes);
-
-            ::munmap(mapping, sizeBytes);
             ::close(fd);
+            if (stopAfterSniff(std::string_view(data, std::min(sizeBytes, core::kSniffBytes)), binaryState, keepBinary))
+                {
+                ::munmap(mapping, sizeBytes);
+                outContent = ContentView();
+                }
+            else
+                {
+                outContent = ContentView(std::make_shared<const FileMapping>(mapping, sizeBytes),
+                    std::string_view(data, sizeBytes));
+                }
             return true;
 #endif
             }
         }
 
-    std::string readFileContent(const std::filesystem::path& path,
+    ContentView readFileContent(const std::filesystem::path& path,
         core::RunResult& outResult,
         std::uintmax_t* outTokens,
         security::PiiRedactor* redactor,
-        const std::string& relativePath)
+        const std::string& relativePath,
+        core::BinaryState* binaryState,
+        bool keepBinary,
+        ContentStore* store,
+        bool mapContent)
         {
-        std::string content;
-        if (!tryReadFileMmap(path, content))
+        ContentView content;
+        FileIdentity identity;
+        if (!tryReadFileMmap(path, content, binaryState, keepBinary, mapContent, store ? &identity : nullptr))
             {
+            identity.valid = false;
             std::ifstream stream(path, std::ios::binary);
             if (!stream)
                 {
                 outResult = { core::ExitCode::io_failure, "Failed to open file for reading." };
                 return {};
                 }
-            std::ostringstream buffer;
-            buffer << stream.rdbuf();
-            content = buffer.str();
+            // The sniff block doubles as the first block of the content.
+            std::string buffer(core::kSniffBytes, '\0');
+            stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.resize(static_cast<std::size_t>(stream.gcount()));
+            if (stopAfterSniff(buffer, binaryState, keepBinary))
+                {
+                buffer.clear();
+                }
+            else if (buffer.size() == core::kSniffBytes)
+                {
+                std::ostringstream rest;
+                rest << stream.rdbuf();
+                buffer += rest.str();
+                }
+            content = ContentView(std::move(buffer));
             }
 
         outResult = { core::ExitCode::success, "" };
+        if (binaryState && *binaryState == core::BinaryState::binary && !keepBinary)
+            {
+            if (outTokens)
+                {
+                *outTokens = 0;
+                }
+            return content;
+            }
 
-        if (redactor)
+        StoredContent stored;
+        if (store && identity.valid && store->lookup(identity, stored))
             {
-            content = redactor->redact(content, relativePath);
+            if (!stored.unchanged)
+                {
+                content = stored.redacted;
+                }
+            if (outTokens)
+                {
+                *outTokens = stored.tokenCount;
+                }
+            return content;
             }
 
-        if (outTokens)
+        // Only content the redactor actually rewrites gets its own copy.
+        std::string redacted;
+        const bool changed = redactor && redactor->redactInto(content.view(), redacted, relativePath);
+        if (changed)
             {
-            *outTokens = analysis::TokenEstimator::estimateTokens(content);
+            content = ContentView(std::move(redacted));
+            }
+
+        if (outTokens || store)
+            {
+            const std::uintmax_t tokenCount = analysis::TokenEstimator::estimateTokens(content.view());
+            if (outTokens)
+                {
+                *outTokens = tokenCount;
+                }
+            if (store)
+                {
+                store->insert(identity, !changed, content.view(), tokenCount);
+                }
             }
 
         return content;
         }
+
+    core::RunResult streamFileContent(const std::filesystem::path& path,
+        const security::PiiRedactor* redactor,
+        const std::string& relativePath,
+        core::BinaryState* binaryState,
+        bool keepBinary,
+        bool logMatches,
+        OutputWriter* writer,
+        StreamedContent& outContent)
+        {
+        outContent = StreamedContent();
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+            {
+            return { core::ExitCode::io_failure, "Failed to open file for reading." };
+            }
+
+        std::optional<security::StreamingRedactor> redaction;
+        if (redactor)
+            {
+            redaction.emplace(*redactor, relativePath, security::StreamingRedactor::kDefaultOverlapBytes, logMatches);
+            }
+
+        analysis::TokenCounter tokens;
+        auto emit = [&](std::string_view text)
+            {
+            if (text.empty())
+                {
+                return;
+                }
+            tokens.add(text);
+            outContent.bytes += static_cast<std::uintmax_t>(text.size());
+            outContent.endsWithNewline = text.back() == '\n';
+            if (writer)
+                {
+                writer->write(text);
+                }
+            };
+
+        std::string window(kStreamWindowBytes, '\0');
+        std::string redacted;
+        bool first = true;
+        while (stream)
+            {
+            stream.read(window.data(), static_cast<std::streamsize>(window.size()));
+            const std::string_view block(window.data(), static_cast<std::size_t>(stream.gcount()));
+            if (first)
+                {
+                first = false;
+                if (stopAfterSniff(block.substr(0, core::kSniffBytes), binaryState, keepBinary))
+                    {
+                    return { core::ExitCode::success, "" };
+                    }
+                }
+            if (block.empty())
+                {
+                break;
+                }
+            if (redaction)
+                {
+                redacted.clear();
+                redaction->feed(block, redacted);
+                emit(redacted);
+                }
+            else
+                {
+                emit(block);
+                }
+            if (writer && !writer->ok)
+                {
+                return { core::ExitCode::io_failure, "Failed to write output file." };
+                }
+            }
+        if (stream.bad())
+            {
+            return { core::ExitCode::io_failure, "Failed to read file." };
+            }
+
+        if (redaction)
+            {
+            redacted.clear();
+            redaction->finish(redacted);
+            emit(redacted);
+            }
+        outContent.tokens = tokens.total();
+        if (writer && !writer->ok)
+            {
+            return { core::ExitCode::io_failure, "Failed to write output file." };
+            }
+        return { core::ExitCode::success, "" };
+        }
     }
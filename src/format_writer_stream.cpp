@@ -0,0 +1,278 @@
+#include "format_writer_internal.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace repaddu::format::detail
+    {
+    std::size_t workerThreadCount(const core::CliOptions& options)
+        {
+        if (!options.parallelTraversal)
+            {
+            return 1;
+            }
+        const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        return std::max<std::size_t>(1, hardwareThreads == 0 ? 1 : hardwareThreads);
+        }
+
+    ProgressReporter::ProgressReporter(const ProgressCallback& callback, std::size_t total)
+        : callback_(callback), total_(total)
+        {
+        if (callback_)
+            {
+            callback_(0, total_, "");
+            }
+        }
+
+    void ProgressReporter::advance(const std::string& filename)
+        {
+        if (!callback_)
+            {
+            return;
+            }
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++done_;
+        callback_(done_, total_, filename);
+        }
+
+    core::RunResult runOutputJobs(std::size_t count,
+        std::size_t threadCount,
+        const std::function<core::RunResult(std::size_t)>& job)
+        {
+        constexpr std::size_t kNoFailure = std::numeric_limits<std::size_t>::max();
+        std::atomic<std::size_t> nextJob{ 0 };
+        std::atomic<std::size_t> firstFailure{ kNoFailure };
+        std::vector<core::RunResult> results(count);
+
+        auto runJobs = [&]()
+            {
+            for (std::size_t index = nextJob.fetch_add(1); index < count; index = nextJob.fetch_add(1))
+                {
+                if (index > firstFailure.load())
+                    {
+                    return;
+                    }
+                results[index] = job(index);
+                if (results[index].code != core::ExitCode::success)
+                    {
+                    std::size_t current = firstFailure.load();
+                    while (index < current && !firstFailure.compare_exchange_weak(current, index))
+                        {
+                        }
+                    }
+                }
+            };
+
+        const std::size_t workerCount = std::min(threadCount, count);
+        std::vector<std::thread> workers;
+        for (std::size_t worker = 1; worker < workerCount; ++worker)
+            {
+            workers.emplace_back(runJobs);
+            }
+        runJobs();
+        for (std::thread& worker : workers)
+            {
+            worker.join();
+            }
+
+        // Jobs are taken in order, so every job before the first failure
+        // ran; a lower-numbered job may still have failed after it did.
+        const std::size_t failure = firstFailure.load();
+        return failure == kNoFailure ? core::RunResult{ core::ExitCode::success, "" } : results[failure];
+        }
+
+    StagedOutputs::StagedOutputs(std::filesystem::path directory)
+        : directory_(std::move(directory))
+        {
+        }
+
+    StagedOutputs::~StagedOutputs()
+        {
+        if (committed_)
+            {
+            return;
+            }
+        for (const std::string& filename : filenames_)
+            {
+            std::error_code errorCode;
+            std::filesystem::remove(stagingPath(filename), errorCode);
+            }
+        }
+
+    std::filesystem::path StagedOutputs::stagingPath(const std::string& filename) const
+        {
+        return directory_ / ("." + filename + ".partial");
+        }
+
+    core::RunResult StagedOutputs::open(const std::string& filename, OutputFile& file)
+        {
+        if (!file.open(stagingPath(filename)))
+            {
+            return { core::ExitCode::io_failure, "Failed to write output file." };
+            }
+        filenames_.push_back(filename);
+        return { core::ExitCode::success, "" };
+        }
+
+    core::RunResult StagedOutputs::commit()
+        {
+        for (const std::string& filename : filenames_)
+            {
+            std::error_code errorCode;
+            std::filesystem::rename(stagingPath(filename), directory_ / filename, errorCode);
+            if (errorCode)
+                {
+                return { core::ExitCode::io_failure, "Failed to move output file into place." };
+                }
+            }
+        committed_ = true;
+        return { core::ExitCode::success, "" };
+        }
+
+    core::RunResult streamChunkOutputs(const core::CliOptions& options,
+        const std::string& overviewName,
+        const std::vector<core::OutputChunk>& chunks,
+        const core::FileTable& files,
+        StagedOutputs& staged,
+        std::vector<OutputPlanEntry>& outOutputs,
+        int& index,
+        ContentPreparer& preparer,
+        ProgressReporter& progress)
+        {
+        std::vector<std::size_t> order;
+        for (const auto& chunk : chunks)
+            {
+            order.insert(order.end(), chunk.fileIndices.begin(), chunk.fileIndices.end());
+            }
+        preparer.setOrder(std::move(order));
+
+        for (const auto& chunk : chunks)
+            {
+            std::string header = boilerplateLine(overviewName);
+            header += "# " + chunk.title + "\n\n";
+            int part = 1;
+            const std::size_t outputsBefore = outOutputs.size();
+            OutputFile file;
+            OutputWriter writer;
+            bool partOpen = false;
+            std::size_t filesInPart = 0;
+
+            auto openPart = [&]() -> core::RunResult
+                {
+                // The overview counts towards --max-files as well.
+                if (options.maxFiles > 0 && static_cast<int>(outOutputs.size() + 2) > options.maxFiles)
+                    {
+                    return { core::ExitCode::output_constraints, "Output file count exceeds --max-files." };
+                    }
+                outOutputs.push_back({ partFilename(index, options.numberWidth, chunk.category, part), 0 });
+                core::RunResult openResult = staged.open(outOutputs.back().filename, file);
+                if (openResult.code != core::ExitCode::success)
+                    {
+                    return openResult;
+                    }
+                writer = OutputWriter{ &file };
+                writer.write(header);
+                partOpen = true;
+                filesInPart = 0;
+                return { core::ExitCode::success, "" };
+                };
+
+            auto closePart = [&]() -> core::RunResult
+                {
+                const bool closed = file.close();
+                partOpen = false;
+                if (!writer.ok || !closed)
+                    {
+                    return { core::ExitCode::io_failure, "Failed to flush output file." };
+                    }
+                outOutputs.back().contentBytes = writer.bytes;
+                ++index;
+                return { core::ExitCode::success, "" };
+                };
+
+            for (std::size_t fileIndex : chunk.fileIndices)
+                {
+                PreparedFile prepared = preparer.take();
+                if (prepared.result.code != core::ExitCode::success)
+                    {
+                    return prepared.result;
+                    }
+                if (!options.includeBinaries && prepared.binaryState == core::BinaryState::binary)
+                    {
+                    continue;
+                    }
+
+                const MarkerFile marker = markerFileOf(files, fileIndex, prepared.tokenCount);
+                const std::uintmax_t blockBytes = prepared.blockBytes;
+                if (options.maxBytes > 0 && blockBytes > options.maxBytes)
+                    {
+                    return { core::ExitCode::output_constraints, "A single file block exceeds --max-bytes." };
+                    }
+
+                if (partOpen && options.maxBytes > 0 && filesInPart > 0
+                    && writer.bytes + blockBytes > options.maxBytes)
+                    {
+                    core::RunResult closeResult = closePart();
+                    if (closeResult.code != core::ExitCode::success)
+                        {
+                        return closeResult;
+                        }
+                    ++part;
+                    }
+                if (!partOpen)
+                    {
+                    core::RunResult openResult = openPart();
+                    if (openResult.code != core::ExitCode::success)
+                        {
+                        return openResult;
+                        }
+                    }
+                if (options.maxBytes > 0 && writer.bytes + blockBytes > options.maxBytes)
+                    {
+                    return { core::ExitCode::output_constraints, "Output file exceeds --max-bytes." };
+                    }
+
+                if (prepared.streamed)
+                    {
+                    core::RunResult streamResult = writeStreamedBlock(writer, marker, files.absolutePath(fileIndex),
+                        preparer.redactor(), &prepared.streamedContent, options.markers, options.emitFrontmatter);
+                    if (streamResult.code != core::ExitCode::success)
+                        {
+                        return streamResult;
+                        }
+                    }
+                else
+                    {
+                    writeChunkMarkerBlock(writer, marker, prepared.content.view(), options.markers, options.emitFrontmatter);
+                    }
+                writer.write("\n");
+                if (!writer.ok)
+                    {
+                    return { core::ExitCode::io_failure, "Failed to write output file." };
+                    }
+                ++filesInPart;
+                }
+
+            // An empty chunk still gets its header-only part, as in the planned path.
+            if (chunk.fileIndices.empty())
+                {
+                core::RunResult openResult = openPart();
+                if (openResult.code != core::ExitCode::success)
+                    {
+                    return openResult;
+                    }
+                }
+            if (partOpen)
+                {
+                core::RunResult closeResult = closePart();
+                if (closeResult.code != core::ExitCode::success)
+                    {
+                    return closeResult;
+                    }
+                }
+            progress.advance(outOutputs.size() > outputsBefore ? outOutputs.back().filename : std::string());
+            }
+
+        return { core::ExitCode::success, "" };
+        }
+    }
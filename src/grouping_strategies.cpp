@@ -57,7 +57,7 @@ namespace repaddu::grouping
             return result;
             }
 
-        bool extensionAllowed(const std::string& extensionLower,
+        bool extensionAllowed(std::string_view extensionLower,
             const std::vector<std::string>& include,
             const std::vector<std::string>& exclude)
             {
@@ -75,7 +75,7 @@ namespace repaddu::grouping
             return true;
             }
 
-        std::vector<std::size_t> applyHeadersFirst(const std::vector<core::FileEntry>& files,
+        std::vector<std::size_t> applyHeadersFirst(const core::FileTable& files,
             const std::vector<std::size_t>& indices,
             bool headersFirst)
             {
@@ -85,13 +85,13 @@ namespace repaddu::grouping
                 std::sort(result.begin(), result.end(),
                     [&files](std::size_t lhs, std::size_t rhs)
                     {
-                    const core::FileEntry& left = files[lhs];
-                    const core::FileEntry& right = files[rhs];
-                    if (left.fileClass != right.fileClass)
+                    const core::FileClass left = files.fileClass(lhs);
+                    const core::FileClass right = files.fileClass(rhs);
+                    if (left != right)
                         {
-                        return static_cast<int>(left.fileClass) < static_cast<int>(right.fileClass);
+                        return static_cast<int>(left) < static_cast<int>(right);
                         }
-                    return left.relativePath.string() < right.relativePath.string();
+                    return files.pathLess(lhs, rhs);
                     });
                 }
             else
@@ -99,28 +99,27 @@ namespace repaddu::grouping
                 std::sort(result.begin(), result.end(),
                     [&files](std::size_t lhs, std::size_t rhs)
                     {
-                    return files[lhs].relativePath.string() < files[rhs].relativePath.string();
+                    return files.pathLess(lhs, rhs);
                     });
                 }
             return result;
             }
 
-        bool isDocumentationFile(const core::FileEntry& entry)
+        bool isDocumentationFile(const core::FileTable& files, std::size_t index)
             {
-            const std::string filenameLower = core::toLowerCopy(entry.relativePath.filename().string());
-            if (filenameLower == "cmakelists.txt" || filenameLower == "requirements.txt")
+            const std::string_view ext = files.extension(index);
+            if (ext != ".md" && ext != ".txt" && ext != ".rst" && ext != ".adoc")
                 {
                 return false;
                 }
-
-            const std::string& ext = entry.extensionLower;
-            return ext == ".md" || ext == ".txt" || ext == ".rst" || ext == ".adoc";
+            const std::string filenameLower = core::toLowerCopy(files.name(index));
+            return filenameLower != "cmakelists.txt" && filenameLower != "requirements.txt";
             }
 
-        std::string groupKeyForPath(const core::CliOptions& options, const core::FileEntry& entry,
+        std::string groupKeyForPath(const core::CliOptions& options, const core::FileTable& files, std::size_t index,
             const ComponentMap* componentMap)
             {
-            if (options.isolateDocs && isDocumentationFile(entry))
+            if (options.isolateDocs && isDocumentationFile(files, index))
                 {
                 return "documentation";
                 }
@@ -134,20 +133,16 @@ namespace repaddu::grouping
                         {
                         depth = 1;
                         }
-                    std::string key;
-                    int currentDepth = 0;
-                    for (const auto& component : entry.relativePath)
+                    // The first `depth` components of the relative path, file name included.
+                    std::string key = files.relativePath(index);
+                    std::size_t end = key.find('/');
+                    for (int currentDepth = 1; currentDepth < depth && end != std::string::npos; ++currentDepth)
                         {
-                        if (currentDepth >= depth)
-                            {
-                            break;
-                            }
-                        if (!key.empty())
-                            {
-                            key += '/';
-                            }
-                        key += component.string();
-                        ++currentDepth;
+                        end = key.find('/', end + 1);
+                        }
+                    if (end != std::string::npos)
+                        {
+                        key.resize(end);
                         }
                     if (key.empty())
                         {
@@ -159,12 +154,12 @@ namespace repaddu::grouping
                     {
                     if (componentMap != nullptr)
                         {
-                        return resolveComponent(*componentMap, entry.relativePath);
+                        return resolveComponent(*componentMap, files.relativePath(index));
                         }
                     return "unmapped";
                     }
                 case core::GroupingMode::type:
-                    return core::fileClassLabel(entry.fileClass);
+                    return core::fileClassLabel(files.fileClass(index));
                 case core::GroupingMode::size:
                     return "size";
                 }
@@ -172,18 +167,18 @@ namespace repaddu::grouping
             }
 
         std::vector<core::OutputChunk> sizeBalancedChunks(const core::CliOptions& options,
-            const std::vector<core::FileEntry>& files,
+            const core::FileTable& files,
             const std::vector<std::size_t>& indices)
             {
             std::vector<std::size_t> sorted = indices;
             std::sort(sorted.begin(), sorted.end(),
                 [&files](std::size_t lhs, std::size_t rhs)
                 {
-                if (files[lhs].sizeBytes != files[rhs].sizeBytes)
+                if (files.sizeBytes(lhs) != files.sizeBytes(rhs))
                     {
-                    return files[lhs].sizeBytes > files[rhs].sizeBytes;
+                    return files.sizeBytes(lhs) > files.sizeBytes(rhs);
                     }
-                return files[lhs].relativePath.string() < files[rhs].relativePath.string();
+                return files.pathLess(lhs, rhs);
                 });
 
             std::vector<core::OutputChunk> chunks;
@@ -198,9 +193,9 @@ namespace repaddu::grouping
                         std::uintmax_t total = 0;
                         for (std::size_t fileIndex : chunk.fileIndices)
                             {
-                            total += files[fileIndex].sizeBytes;
+                            total += files.sizeBytes(fileIndex);
                             }
-                        if (total + files[index].sizeBytes <= capacity)
+                        if (total + files.sizeBytes(index) <= capacity)
                             {
                             chunk.fileIndices.push_back(index);
                             placed = true;
@@ -236,7 +231,7 @@ namespace repaddu::grouping
                         std::uintmax_t total = 0;
                         for (std::size_t fileIndex : chunks[i].fileIndices)
                             {
-                            total += files[fileIndex].sizeBytes;
+                            total += files.sizeBytes(fileIndex);
                             }
                         if (total < bestSize)
                             {
@@ -267,7 +262,7 @@ namespace repaddu::grouping
                 std::sort(chunk.fileIndices.begin(), chunk.fileIndices.end(),
                     [&files](std::size_t lhs, std::size_t rhs)
                     {
-                    return files[lhs].relativePath.string() < files[rhs].relativePath.string();
+                    return files.pathLess(lhs, rhs);
                     });
                 }
 
@@ -276,7 +271,7 @@ namespace repaddu::grouping
         }
 
     GroupingResult filterAndGroupFiles(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const ComponentMap* componentMap,
         core::RunResult& outResult)
         {
@@ -298,23 +293,17 @@ namespace repaddu::grouping
 
         for (std::size_t index = 0; index < files.size(); ++index)
             {
-            const core::FileEntry& entry = files[index];
-            const bool documentationFile = options.isolateDocs && isDocumentationFile(entry);
-            if (!options.includeBinaries && entry.isBinary)
-                {
-                continue;
-                }
-            
+            const bool documentationFile = options.isolateDocs && isDocumentationFile(files, index);
             // Size check
-            if (entry.sizeBytes > options.maxFileSize && !options.forceLargeFiles)
+            if (files.sizeBytes(index) > options.maxFileSize && !options.forceLargeFiles)
                 {
-                LogWarn("Skipping large file: " + entry.relativePath.string() + 
-                        " (" + std::to_string(entry.sizeBytes) + " bytes > " + 
+                LogWarn("Skipping large file: " + files.relativePath(index) +
+                        " (" + std::to_string(files.sizeBytes(index)) + " bytes > " + 
                         std::to_string(options.maxFileSize) + " bytes)");
                 continue;
                 }
 
-            if (!extensionAllowed(entry.extensionLower, includeExt, excludeExt))
+            if (!extensionAllowed(files.extension(index), includeExt, excludeExt))
                 {
                 continue;
                 }
@@ -323,27 +312,34 @@ namespace repaddu::grouping
                 {
                 if (options.includeHeaders && !options.includeSources)
                     {
-                    if (entry.fileClass != core::FileClass::header)
+                    if (files.fileClass(index) != core::FileClass::header)
                         {
                         continue;
                         }
                     }
                 else if (options.includeSources && !options.includeHeaders)
                     {
-                    if (entry.fileClass != core::FileClass::source)
+                    if (files.fileClass(index) != core::FileClass::source)
                         {
                         continue;
                         }
                     }
                 else
                     {
-                    if (entry.fileClass == core::FileClass::other)
+                    if (files.fileClass(index) == core::FileClass::other)
                         {
                         continue;
                         }
                     }
                 }
 
+            // Entries still unknown are classified by the writers while they read
+            // the content, so a binary is sniffed only if it survives the checks above.
+            if (!options.includeBinaries && files.binaryState(index) == core::BinaryState::binary)
+                {
+                continue;
+                }
+
             result.includedIndices.push_back(index);
             }
 
@@ -358,7 +354,7 @@ namespace repaddu::grouping
 
                 for (std::size_t index : result.includedIndices)
                     {
-                    if (isDocumentationFile(files[index]))
+                    if (isDocumentationFile(files, index))
                         {
                         docsGroup.fileIndices.push_back(index);
                         }
@@ -393,8 +389,7 @@ namespace repaddu::grouping
         std::unordered_map<std::string, std::vector<std::size_t>> buckets;
         for (std::size_t index : result.includedIndices)
             {
-            const core::FileEntry& entry = files[index];
-            const std::string key = groupKeyForPath(options, entry, componentMap);
+            const std::string key = groupKeyForPath(options, files, index, componentMap);
             buckets[key].push_back(index);
             }
 
@@ -452,7 +447,7 @@ namespace repaddu::grouping
         }
 
     std::vector<core::OutputChunk> chunkGroups(const core::CliOptions& options,
-        const std::vector<core::FileEntry>& files,
+        const core::FileTable& files,
         const std::vector<core::Group>& groups,
         core::RunResult& outResult)
         {
@@ -482,7 +477,7 @@ namespace repaddu::grouping
                     std::sort(docsChunk.fileIndices.begin(), docsChunk.fileIndices.end(),
                         [&files](std::size_t lhs, std::size_t rhs)
                         {
-                        return files[lhs].relativePath.string() < files[rhs].relativePath.string();
+                        return files.pathLess(lhs, rhs);
                         });
                     result.push_back(std::move(docsChunk));
                     continue;
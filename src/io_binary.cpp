@@ -1,86 +1,79 @@
 #include "repaddu/io_binary.h"
-#include "repaddu/logger.h"
 
 #include <array>
+#include <string_view>
+
+#if defined(_WIN32)
 #include <fstream>
-#include <vector>
-#include <string>
-#include <cstring>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace repaddu::io
     {
-    struct MagicSig
-        {
-        std::vector<uint8_t> bytes;
-        std::string name;
-        };
-
-    // Common magic bytes
-    static const std::vector<MagicSig> kSignatures = 
-        {
-        { {0x7f, 0x45, 0x4c, 0x46}, "ELF Executable" },
-        { {0x4d, 0x5a}, "PE Executable (Windows)" },
-        { {0xfe, 0xed, 0xfa, 0xcf}, "Mach-O (Mac 64)" },
-        { {0xfe, 0xed, 0xfa, 0xce}, "Mach-O (Mac 32)" },
-        { {0xca, 0xfe, 0xba, 0xbe}, "Java Class / Mach-O Fat" },
-        { {0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a}, "PNG Image" },
-        { {0xff, 0xd8, 0xff}, "JPEG Image" },
-        { {0x47, 0x49, 0x46, 0x38}, "GIF Image" },
-        { {0x50, 0x4b, 0x03, 0x04}, "ZIP Archive" },
-        { {0x1f, 0x8b}, "GZIP Archive" },
-        { {0x42, 0x4d}, "BMP Image" },
-        { {0x00, 0x00, 0x01, 0x00}, "ICO Icon" } 
-        // Add more as needed
-        };
-
-    bool looksBinary(const std::filesystem::path& filePath)
+    namespace
         {
-        std::ifstream stream(filePath, std::ios::binary);
-        if (!stream)
+        // Reads up to buffer.size() leading bytes; returns the count, 0 when
+        // the file cannot be opened.
+        std::size_t readHead(const std::filesystem::path& filePath, std::array<char, core::kSniffBytes>& buffer)
             {
-            return false;
-            }
-
-        std::array<char, 4096> buffer{};
-        stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-        std::streamsize readCount = stream.gcount();
-        
-        if (readCount == 0) return false; // Empty file is text-safe usually
-
-        // 1. Check Magic Signatures
-        for (const auto& sig : kSignatures)
-            {
-            if (readCount >= static_cast<std::streamsize>(sig.bytes.size()))
+#if defined(_WIN32)
+            std::ifstream stream(filePath, std::ios::binary);
+            if (!stream)
+                {
+                return 0;
+                }
+            stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            return static_cast<std::size_t>(stream.gcount());
+#else
+            const int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
                 {
-                bool match = true;
-                for (size_t i = 0; i < sig.bytes.size(); ++i)
+                return 0;
+                }
+            std::size_t total = 0;
+            while (total < buffer.size())
+                {
+                const ssize_t count = ::read(fd, buffer.data() + total, buffer.size() - total);
+                if (count < 0 && errno == EINTR)
                     {
-                    if (static_cast<uint8_t>(buffer[i]) != sig.bytes[i])
-                        {
-                        match = false;
-                        break;
-                        }
+                    continue;
                     }
-                
-                if (match)
+                if (count <= 0)
                     {
-                    LogInfo("Binary detected via magic bytes (" + sig.name + "): " + filePath.string());
-                    return true;
+                    break;
                     }
+                total += static_cast<std::size_t>(count);
                 }
+            ::close(fd);
+            return total;
+#endif
             }
+        }
+
+    core::ContentVerdict classifyFile(const std::filesystem::path& filePath)
+        {
+        std::array<char, core::kSniffBytes> buffer;
+        const std::size_t readCount = readHead(filePath, buffer);
+        return core::classifyContent(std::string_view(buffer.data(), readCount));
+        }
 
-        // 2. Check for NUL bytes (fallback)
-        // Heuristic: If more than N nul bytes or nul bytes in first K chars?
-        // Simple heuristic: any NUL in first 4KB means binary (except UTF-16? we assume source is UTF-8/ASCII for now)
-        for (std::streamsize i = 0; i < readCount; ++i)
+    bool looksBinary(const std::filesystem::path& filePath)
+        {
+        return !classifyFile(filePath).embeddable();
+        }
+
+    void resolveBinaryStates(core::FileTable& files, const std::vector<std::size_t>& indices)
+        {
+        for (std::size_t index : indices)
             {
-            if (buffer[static_cast<std::size_t>(i)] == '\0')
+            if (files.binaryState(index) == core::BinaryState::unknown)
                 {
-                LogInfo("Binary detected via NUL byte check: " + filePath.string());
-                return true;
+                files.setBinaryState(index,
+                    looksBinary(files.absolutePath(index)) ? core::BinaryState::binary : core::BinaryState::text);
                 }
             }
-        return false;
         }
     }
@@ -0,0 +1,414 @@
+#include "repaddu/io_ignore.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace repaddu::io
+    {
+    namespace
+        {
+        bool hasGlobCharacters(std::string_view value)
+            {
+            return value.find_first_of("*?[\\") != std::string_view::npos;
+            }
+
+        // Matches a bracket expression starting at pattern[index] == '['. Returns
+        // false through `valid` when the class is unterminated.
+        bool matchClass(std::string_view pattern, std::size_t& index, char ch, bool& valid)
+            {
+            std::size_t cursor = index + 1;
+            bool negated = false;
+            if (cursor < pattern.size() && (pattern[cursor] == '!' || pattern[cursor] == '^'))
+                {
+                negated = true;
+                ++cursor;
+                }
+
+            bool matched = false;
+            bool first = true;
+            while (cursor < pattern.size() && (first || pattern[cursor] != ']'))
+                {
+                first = false;
+                char low = pattern[cursor];
+                if (low == '\\' && cursor + 1 < pattern.size())
+                    {
+                    low = pattern[++cursor];
+                    }
+                char high = low;
+                if (cursor + 2 < pattern.size() && pattern[cursor + 1] == '-' && pattern[cursor + 2] != ']')
+                    {
+                    high = pattern[cursor + 2];
+                    cursor += 2;
+                    }
+                if (ch >= low && ch <= high)
+                    {
+                    matched = true;
+                    }
+                ++cursor;
+                }
+
+            if (cursor >= pattern.size())
+                {
+                valid = false;
+                return false;
+                }
+            valid = true;
+            index = cursor + 1;
+            return matched != negated;
+            }
+
+        // gitignore glob semantics: '*' and '?' never cross '/', a "**" path
+        // segment matches any number of directories.
+        bool wildMatch(std::string_view pattern, std::string_view text)
+            {
+            std::size_t pi = 0;
+            std::size_t ti = 0;
+            while (pi < pattern.size())
+                {
+                const char ch = pattern[pi];
+                if (ch == '*')
+                    {
+                    const bool doubleStar = pi + 1 < pattern.size() && pattern[pi + 1] == '*';
+                    if (doubleStar)
+                        {
+                        const bool segmentStart = pi == 0 || pattern[pi - 1] == '/';
+                        const std::size_t after = pi + 2;
+                        const bool segmentEnd = after == pattern.size() || pattern[after] == '/';
+                        if (segmentStart && segmentEnd)
+                            {
+                            if (after == pattern.size())
+                                {
+                                return true;
+                                }
+                            const std::string_view rest = pattern.substr(after + 1);
+                            if (wildMatch(rest, text.substr(ti)))
+                                {
+                                return true;
+                                }
+                            for (std::size_t cursor = ti; cursor < text.size(); ++cursor)
+                                {
+                                if (text[cursor] == '/' && wildMatch(rest, text.substr(cursor + 1)))
+                                    {
+                                    return true;
+                                    }
+                                }
+                            return false;
+                            }
+                        }
+
+                    while (pi < pattern.size() && pattern[pi] == '*')
+                        {
+                        ++pi;
+                        }
+                    const std::string_view rest = pattern.substr(pi);
+                    for (std::size_t cursor = ti; ; ++cursor)
+                        {
+                        if (wildMatch(rest, text.substr(cursor)))
+                            {
+                            return true;
+                            }
+                        if (cursor >= text.size() || text[cursor] == '/')
+                            {
+                            return false;
+                            }
+                        }
+                    }
+
+                if (ti >= text.size())
+                    {
+                    return false;
+                    }
+
+                if (ch == '?')
+                    {
+                    if (text[ti] == '/')
+                        {
+                        return false;
+                        }
+                    ++pi;
+                    ++ti;
+                    continue;
+                    }
+
+                if (ch == '[')
+                    {
+                    bool valid = false;
+                    std::size_t cursor = pi;
+                    const bool matched = matchClass(pattern, cursor, text[ti], valid);
+                    if (valid)
+                        {
+                        if (!matched || text[ti] == '/')
+                            {
+                            return false;
+                            }
+                        pi = cursor;
+                        ++ti;
+                        continue;
+                        }
+                    }
+
+                char literal = ch;
+                if (ch == '\\' && pi + 1 < pattern.size())
+                    {
+                    literal = pattern[++pi];
+                    }
+                if (text[ti] != literal)
+                    {
+                    return false;
+                    }
+                ++pi;
+                ++ti;
+                }
+            return ti == text.size();
+            }
+
+        std::string readTextFile(const std::filesystem::path& path)
+            {
+            std::ifstream stream(path, std::ios::binary);
+            if (!stream)
+                {
+                return {};
+                }
+            std::ostringstream buffer;
+            buffer << stream.rdbuf();
+            return buffer.str();
+            }
+        }
+
+    IgnoreRules IgnoreRules::compile(std::string_view text)
+        {
+        IgnoreRules rules;
+        std::size_t lineStart = 0;
+        while (lineStart <= text.size())
+            {
+            std::size_t lineEnd = text.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos)
+                {
+                lineEnd = text.size();
+                }
+            std::string line(text.substr(lineStart, lineEnd - lineStart));
+            lineStart = lineEnd + 1;
+
+            if (!line.empty() && line.back() == '\r')
+                {
+                line.pop_back();
+                }
+            if (line.empty() || line.front() == '#')
+                {
+                continue;
+                }
+            while (!line.empty() && line.back() == ' '
+                && !(line.size() >= 2 && line[line.size() - 2] == '\\'))
+                {
+                line.pop_back();
+                }
+
+            Pattern pattern;
+            if (!line.empty() && line.front() == '!')
+                {
+                pattern.negated = true;
+                line.erase(line.begin());
+                }
+            if (!line.empty() && line.back() == '/')
+                {
+                pattern.directoryOnly = true;
+                line.pop_back();
+                }
+            if (line.find('/') != std::string::npos)
+                {
+                pattern.matchesBasename = false;
+                if (line.front() == '/')
+                    {
+                    line.erase(line.begin());
+                    }
+                }
+            if (line.empty())
+                {
+                continue;
+                }
+            pattern.glob = std::move(line);
+            rules.addPattern(std::move(pattern));
+            }
+        return rules;
+        }
+
+    void IgnoreRules::addPattern(Pattern pattern)
+        {
+        const std::uint32_t index = static_cast<std::uint32_t>(patterns_.size());
+        const std::string& glob = pattern.glob;
+        if (pattern.matchesBasename && !hasGlobCharacters(glob))
+            {
+            basenameLiterals_[glob].push_back(index);
+            }
+        else if (pattern.matchesBasename && glob.size() > 1 && glob.front() == '*'
+            && !hasGlobCharacters(std::string_view(glob).substr(1)))
+            {
+            const std::string suffix = glob.substr(1);
+            basenameSuffixes_[suffix].push_back(index);
+            if (std::find(suffixLengths_.begin(), suffixLengths_.end(), suffix.size()) == suffixLengths_.end())
+                {
+                suffixLengths_.push_back(suffix.size());
+                }
+            }
+        else if (!pattern.matchesBasename && !hasGlobCharacters(glob))
+            {
+            pathLiterals_[glob].push_back(index);
+            }
+        else
+            {
+            globPatterns_.push_back(index);
+            }
+        patterns_.push_back(std::move(pattern));
+        }
+
+    long IgnoreRules::lastMatchIn(const IndexBucket& bucket, const std::string& key, bool isDirectory, long best) const
+        {
+        auto it = bucket.find(key);
+        if (it == bucket.end())
+            {
+            return best;
+            }
+        for (auto index = it->second.rbegin(); index != it->second.rend(); ++index)
+            {
+            if (static_cast<long>(*index) <= best)
+                {
+                break;
+                }
+            if (!patterns_[*index].directoryOnly || isDirectory)
+                {
+                return static_cast<long>(*index);
+                }
+            }
+        return best;
+        }
+
+    IgnoreRules::Verdict IgnoreRules::match(std::string_view relativePath, bool isDirectory) const
+        {
+        if (patterns_.empty())
+            {
+            return Verdict::none;
+            }
+
+        const std::size_t slash = relativePath.rfind('/');
+        const std::string_view name = slash == std::string_view::npos ? relativePath : relativePath.substr(slash + 1);
+
+        long best = -1;
+        if (!basenameLiterals_.empty())
+            {
+            best = lastMatchIn(basenameLiterals_, std::string(name), isDirectory, best);
+            }
+        for (std::size_t length : suffixLengths_)
+            {
+            if (name.size() >= length)
+                {
+                best = lastMatchIn(basenameSuffixes_, std::string(name.substr(name.size() - length)), isDirectory, best);
+                }
+            }
+        if (!pathLiterals_.empty())
+            {
+            best = lastMatchIn(pathLiterals_, std::string(relativePath), isDirectory, best);
+            }
+        for (auto index = globPatterns_.rbegin(); index != globPatterns_.rend(); ++index)
+            {
+            if (static_cast<long>(*index) <= best)
+                {
+                break;
+                }
+            const Pattern& pattern = patterns_[*index];
+            if (pattern.directoryOnly && !isDirectory)
+                {
+                continue;
+                }
+            if (wildMatch(pattern.glob, pattern.matchesBasename ? name : relativePath))
+                {
+                best = static_cast<long>(*index);
+                break;
+                }
+            }
+
+        if (best < 0)
+            {
+            return Verdict::none;
+            }
+        return patterns_[static_cast<std::size_t>(best)].negated ? Verdict::included : Verdict::ignored;
+        }
+
+    const std::vector<std::string>& ignoreFileNames()
+        {
+        static const std::vector<std::string> names = { ".gitignore", ".repadduignore" };
+        return names;
+        }
+
+    IgnoreLevelPtr extendIgnoreLevel(const IgnoreLevelPtr& parent,
+        const std::string& relativeDirectory,
+        const std::vector<std::string>& fileContents)
+        {
+        std::vector<IgnoreRules> rules;
+        for (const std::string& content : fileContents)
+            {
+            IgnoreRules compiled = IgnoreRules::compile(content);
+            if (!compiled.empty())
+                {
+                rules.push_back(std::move(compiled));
+                }
+            }
+        if (rules.empty())
+            {
+            return parent;
+            }
+        auto level = std::make_shared<IgnoreLevel>();
+        level->parent = parent;
+        level->baseDirectory = relativeDirectory;
+        level->rules = std::move(rules);
+        return level;
+        }
+
+    IgnoreLevelPtr loadIgnoreLevel(const IgnoreLevelPtr& parent,
+        const std::filesystem::path& absoluteDirectory,
+        const std::string& relativeDirectory)
+        {
+        IgnoreLevelPtr base = parent;
+        if (relativeDirectory.empty())
+            {
+            base = extendIgnoreLevel(base, relativeDirectory,
+                { readTextFile(absoluteDirectory / ".git" / "info" / "exclude") });
+            }
+
+        std::vector<std::string> contents;
+        contents.reserve(ignoreFileNames().size());
+        for (const std::string& name : ignoreFileNames())
+            {
+            contents.push_back(readTextFile(absoluteDirectory / name));
+            }
+        return extendIgnoreLevel(base, relativeDirectory, contents);
+        }
+
+    bool isIgnored(const IgnoreLevel* level, std::string_view relativePath, bool isDirectory)
+        {
+        for (; level != nullptr; level = level->parent.get())
+            {
+            std::string_view local = relativePath;
+            const std::string& base = level->baseDirectory;
+            if (!base.empty())
+                {
+                if (relativePath.size() <= base.size() || relativePath.compare(0, base.size(), base) != 0
+                    || relativePath[base.size()] != '/')
+                    {
+                    continue;
+                    }
+                local = relativePath.substr(base.size() + 1);
+                }
+
+            for (auto rules = level->rules.rbegin(); rules != level->rules.rend(); ++rules)
+                {
+                const IgnoreRules::Verdict verdict = rules->match(local, isDirectory);
+                if (verdict != IgnoreRules::Verdict::none)
+                    {
+                    return verdict == IgnoreRules::Verdict::ignored;
+                    }
+                }
+            }
+        return false;
+        }
+    }
@@ -1,14 +1,15 @@
 #include "repaddu/io_traversal.h"
 
 #include "repaddu/core_types.h"
-#include "repaddu/io_binary.h"
+#include "repaddu/io_ignore.h"
 #include "repaddu/language_profiles.h"
 
+#include "io_traversal_internal.h"
+#include "io_traversal_scheduler.h"
+
 #include <algorithm>
 #include <atomic>
 #include <filesystem>
-#include <deque>
-#include <condition_variable>
 #include <cctype>
 #include <iterator>
 #include <mutex>
@@ -68,6 +69,13 @@ namespace repaddu::io
                 std::filesystem::recursive_directory_iterator iterator(options.inputPath, dirOptions);
                 const std::filesystem::recursive_directory_iterator end;
 
+                // ignoreLevels[d] holds the rules in effect for entries at depth d.
+                std::vector<IgnoreLevelPtr> ignoreLevels(1);
+                if (options.useIgnoreFiles)
+                    {
+                    ignoreLevels[0] = loadIgnoreLevel(nullptr, options.inputPath, "");
+                    }
+
                 for (; iterator != end; ++iterator)
                     {
                     const std::filesystem::directory_entry& entry = *iterator;
@@ -77,6 +85,7 @@ namespace repaddu::io
                         {
                         return { core::ExitCode::traversal_failure, "Failed to compute relative path." };
                         }
+                    const std::size_t depth = static_cast<std::size_t>(iterator.depth());
 
                     if (isGitPath(relativePath))
                         {
@@ -96,9 +105,25 @@ namespace repaddu::io
                         continue;
                         }
 
+                    const IgnoreLevel* ignoreLevel = options.useIgnoreFiles ? ignoreLevels[depth].get() : nullptr;
+                    if (ignoreLevel != nullptr && isIgnored(ignoreLevel, relativePath.generic_string(), entry.is_directory()))
+                        {
+                        if (entry.is_directory())
+                            {
+                            iterator.disable_recursion_pending();
+                            }
+                        continue;
+                        }
+
                     if (entry.is_directory())
                         {
                         outResult.directories.push_back(relativePath);
+                        if (options.useIgnoreFiles)
+                            {
+                            ignoreLevels.resize(depth + 2);
+                            ignoreLevels[depth + 1] = loadIgnoreLevel(ignoreLevels[depth], currentPath,
+                                relativePath.generic_string());
+                            }
                         continue;
                         }
 
@@ -123,19 +148,12 @@ namespace repaddu::io
                         outResult.buildFiles.push_back(relativePath);
                         }
 
-                    core::FileEntry fileEntry;
-                    fileEntry.absolutePath = currentPath;
-                    fileEntry.relativePath = relativePath;
-                    fileEntry.sizeBytes = entry.file_size(errorCode);
+                    const std::uintmax_t sizeBytes = entry.file_size(errorCode);
                     if (errorCode)
                         {
                         return { core::ExitCode::io_failure, "Failed to read file size." };
                         }
-                    fileEntry.extensionLower = core::toLowerCopy(currentPath.extension().string());
-                    fileEntry.fileClass = core::classifyExtension(fileEntry.extensionLower);
-                    fileEntry.isBinary = looksBinary(currentPath);
-
-                    outResult.files.push_back(std::move(fileEntry));
+                    outResult.files.add(relativePath.generic_string(), sizeBytes);
                     }
                 }
             catch (const std::filesystem::filesystem_error&)
@@ -146,22 +164,41 @@ namespace repaddu::io
             return { core::ExitCode::success, "" };
             }
 
+        struct TraversalTask
+            {
+            std::filesystem::path directory;
+            std::vector<std::filesystem::directory_entry> entries;
+            // Directory tasks carry the parent's rules; batches carry the directory's own.
+            IgnoreLevelPtr ignoreLevel;
+            };
+
+        struct WorkerOutput
+            {
+            std::vector<std::filesystem::path> directories;
+            core::FileTable files;
+            std::vector<std::filesystem::path> cmakeLists;
+            std::vector<std::filesystem::path> buildFiles;
+            };
+
+        // Directories with more entries than this are split into batches that idle
+        // workers can steal, so one huge directory does not serialize the scan.
+        constexpr std::size_t kEntryBatchSize = 256;
+
         core::RunResult traverseParallel(const core::CliOptions& options,
             const std::filesystem::directory_options& dirOptions,
             const std::vector<std::string>& buildFileNamesLower,
             TraversalResult& outResult)
             {
+            const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            const std::size_t threadCount = std::max<std::size_t>(1, hardwareThreads == 0 ? 1 : hardwareThreads);
+
             std::atomic<bool> hasError(false);
             core::RunResult errorResult{ core::ExitCode::success, "" };
             std::mutex errorMutex;
-            std::mutex resultMutex;
-            std::mutex queueMutex;
-            std::condition_variable queueCv;
-            std::deque<std::filesystem::path> pending;
-            std::size_t activeWorkers = 0;
-            bool done = false;
+            detail::WorkStealingScheduler<TraversalTask> scheduler(threadCount);
+            std::vector<WorkerOutput> outputs(threadCount);
 
-            pending.push_back(options.inputPath);
+            scheduler.push(0, TraversalTask{ options.inputPath, {}, nullptr });
 
             auto setError = [&](const core::RunResult& result)
                 {
@@ -173,208 +210,200 @@ namespace repaddu::io
                     std::lock_guard<std::mutex> lock(errorMutex);
                     errorResult = result;
                 }
-                {
-                    std::lock_guard<std::mutex> lock(queueMutex);
-                    done = true;
-                }
-                queueCv.notify_all();
+                scheduler.stop();
                 };
 
-            auto pushDirectory = [&](const std::filesystem::path& path)
+            auto processEntry = [&](std::size_t worker, const IgnoreLevelPtr& ignoreLevel,
+                const std::filesystem::directory_entry& entry) -> bool
                 {
-                std::lock_guard<std::mutex> lock(queueMutex);
-                pending.push_back(path);
-                queueCv.notify_one();
-                };
+                WorkerOutput& local = outputs[worker];
+                const std::filesystem::path& currentPath = entry.path();
+                std::error_code errorCode;
+                std::filesystem::path relativePath = std::filesystem::relative(currentPath, options.inputPath, errorCode);
+                if (errorCode)
+                    {
+                    setError({ core::ExitCode::traversal_failure, "Failed to compute relative path." });
+                    return false;
+                    }
 
-            auto appendBatch = [&](std::vector<std::filesystem::path>& directories,
-                std::vector<core::FileEntry>& files,
-                std::vector<std::filesystem::path>& cmakeLists,
-                std::vector<std::filesystem::path>& buildFiles)
-                {
-                std::lock_guard<std::mutex> lock(resultMutex);
-                outResult.directories.insert(outResult.directories.end(),
-                    std::make_move_iterator(directories.begin()),
-                    std::make_move_iterator(directories.end()));
-                outResult.files.insert(outResult.files.end(),
-                    std::make_move_iterator(files.begin()),
-                    std::make_move_iterator(files.end()));
-                outResult.cmakeLists.insert(outResult.cmakeLists.end(),
-                    std::make_move_iterator(cmakeLists.begin()),
-                    std::make_move_iterator(cmakeLists.end()));
-                outResult.buildFiles.insert(outResult.buildFiles.end(),
-                    std::make_move_iterator(buildFiles.begin()),
-                    std::make_move_iterator(buildFiles.end()));
-                };
+                std::error_code typeError;
+                const bool isDirectory = entry.is_directory(typeError);
+                if (typeError)
+                    {
+                    setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
+                    return false;
+                    }
 
-            auto processDirectory = [&](const std::filesystem::path& directory)
-                {
-                std::vector<std::filesystem::path> localDirectories;
-                std::vector<core::FileEntry> localFiles;
-                std::vector<std::filesystem::path> localCmakeLists;
-                std::vector<std::filesystem::path> localBuildFiles;
+                if (isGitPath(relativePath))
+                    {
+                    return true;
+                    }
 
-                std::error_code iterError;
-                std::filesystem::directory_iterator iterator(directory, dirOptions, iterError);
-                if (iterError)
+                if (!options.includeHidden && shouldSkipHidden(relativePath))
                     {
-                    setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
-                    return;
+                    return true;
                     }
-                const std::filesystem::directory_iterator end;
-                for (; iterator != end; iterator.increment(iterError))
+
+                if (ignoreLevel && isIgnored(ignoreLevel.get(), relativePath.generic_string(), isDirectory))
                     {
-                    if (iterError)
+                    return true;
+                    }
+
+                if (isDirectory)
+                    {
+                    local.directories.push_back(relativePath);
+                    std::error_code symlinkError;
+                    const bool isSymlink = entry.is_symlink(symlinkError);
+                    if (symlinkError)
                         {
                         setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
-                        return;
-                        }
-                    if (hasError.load())
-                        {
-                        return;
+                        return false;
                         }
-
-                    const std::filesystem::directory_entry& entry = *iterator;
-                    const std::filesystem::path currentPath = entry.path();
-                    std::error_code errorCode;
-                    std::filesystem::path relativePath = std::filesystem::relative(currentPath, options.inputPath, errorCode);
-                    if (errorCode)
+                    if (!options.followSymlinks && isSymlink)
                         {
-                        setError({ core::ExitCode::traversal_failure, "Failed to compute relative path." });
-                        return;
+                        return true;
                         }
+                    scheduler.push(worker, TraversalTask{ currentPath, {}, ignoreLevel });
+                    return true;
+                    }
 
-                    std::error_code typeError;
-                    const bool isDirectory = entry.is_directory(typeError);
-                    if (typeError)
-                        {
-                        setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
-                        return;
-                        }
+                std::error_code fileTypeError;
+                const bool isRegular = entry.is_regular_file(fileTypeError);
+                if (fileTypeError)
+                    {
+                    setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
+                    return false;
+                    }
+                if (!isRegular)
+                    {
+                    return true;
+                    }
 
-                    if (isGitPath(relativePath))
-                        {
-                        continue;
-                        }
+                std::error_code symlinkError;
+                const bool isSymlink = entry.is_symlink(symlinkError);
+                if (symlinkError)
+                    {
+                    setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
+                    return false;
+                    }
+                if (!options.followSymlinks && isSymlink)
+                    {
+                    return true;
+                    }
 
-                    if (!options.includeHidden && shouldSkipHidden(relativePath))
-                        {
-                        continue;
-                        }
+                const std::uintmax_t sizeBytes = entry.file_size(errorCode);
+                if (errorCode)
+                    {
+                    setError({ core::ExitCode::io_failure, "Failed to read file size." });
+                    return false;
+                    }
 
-                    if (isDirectory)
-                        {
-                        localDirectories.push_back(relativePath);
-                        std::error_code symlinkError;
-                        const bool isSymlink = entry.is_symlink(symlinkError);
-                        if (symlinkError)
-                            {
-                            setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
-                            return;
-                            }
-                        if (!options.followSymlinks && isSymlink)
-                            {
-                            continue;
-                            }
-                        pushDirectory(currentPath);
-                        continue;
-                        }
+                const std::string filenameLower = normalizeFileName(currentPath.filename().string());
+                if (filenameLower == "cmakelists.txt")
+                    {
+                    local.cmakeLists.push_back(relativePath);
+                    }
+                if (std::find(buildFileNamesLower.begin(), buildFileNamesLower.end(), filenameLower)
+                    != buildFileNamesLower.end())
+                    {
+                    local.buildFiles.push_back(relativePath);
+                    }
+                local.files.add(relativePath.generic_string(), sizeBytes);
+                return true;
+                };
 
-                    std::error_code fileTypeError;
-                    const bool isRegular = entry.is_regular_file(fileTypeError);
-                    if (fileTypeError)
+            auto processBatch = [&](std::size_t worker, const IgnoreLevelPtr& ignoreLevel,
+                const std::vector<std::filesystem::directory_entry>& entries)
+                {
+                for (const auto& entry : entries)
+                    {
+                    if (hasError.load(std::memory_order_relaxed) || !processEntry(worker, ignoreLevel, entry))
                         {
-                        setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
                         return;
                         }
-                    if (!isRegular)
+                    }
+                };
+
+            auto processDirectory = [&](std::size_t worker, const std::filesystem::path& directory,
+                const IgnoreLevelPtr& parentLevel)
+                {
+                IgnoreLevelPtr ignoreLevel = parentLevel;
+                if (options.useIgnoreFiles)
+                    {
+                    std::error_code relativeError;
+                    std::string relativeDirectory = std::filesystem::relative(directory, options.inputPath, relativeError)
+                        .generic_string();
+                    if (relativeDirectory == ".")
                         {
-                        continue;
+                        relativeDirectory.clear();
                         }
+                    ignoreLevel = loadIgnoreLevel(parentLevel, directory, relativeDirectory);
+                    }
 
-                    std::error_code symlinkError;
-                    const bool isSymlink = entry.is_symlink(symlinkError);
-                    if (symlinkError)
+                std::error_code iterError;
+                std::filesystem::directory_iterator iterator(directory, dirOptions, iterError);
+                if (iterError)
+                    {
+                    setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
+                    return;
+                    }
+
+                std::vector<std::filesystem::directory_entry> batch;
+                const std::filesystem::directory_iterator end;
+                for (; iterator != end; iterator.increment(iterError))
+                    {
+                    if (iterError)
                         {
                         setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
                         return;
                         }
-                    if (!options.followSymlinks && isSymlink)
-                        {
-                        continue;
-                        }
-
-                    core::FileEntry fileEntry;
-                    fileEntry.absolutePath = currentPath;
-                    fileEntry.relativePath = relativePath;
-                    fileEntry.sizeBytes = entry.file_size(errorCode);
-                    if (errorCode)
+                    if (hasError.load(std::memory_order_relaxed))
                         {
-                        setError({ core::ExitCode::io_failure, "Failed to read file size." });
                         return;
                         }
-                    fileEntry.extensionLower = core::toLowerCopy(currentPath.extension().string());
-                    fileEntry.fileClass = core::classifyExtension(fileEntry.extensionLower);
-                    fileEntry.isBinary = looksBinary(currentPath);
 
-                    const std::string filenameLower = normalizeFileName(currentPath.filename().string());
-                    if (filenameLower == "cmakelists.txt")
+                    batch.push_back(*iterator);
+                    if (batch.size() == kEntryBatchSize)
                         {
-                        localCmakeLists.push_back(relativePath);
+                        scheduler.push(worker, TraversalTask{ directory, std::move(batch), ignoreLevel });
+                        batch = {};
                         }
-                    if (std::find(buildFileNamesLower.begin(), buildFileNamesLower.end(), filenameLower)
-                        != buildFileNamesLower.end())
-                        {
-                        localBuildFiles.push_back(relativePath);
-                        }
-                    localFiles.push_back(std::move(fileEntry));
                     }
-                if (hasError.load())
+                if (iterError)
                     {
+                    setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
                     return;
                     }
-                appendBatch(localDirectories, localFiles, localCmakeLists, localBuildFiles);
+
+                processBatch(worker, ignoreLevel, batch);
                 };
 
-            const unsigned int hardwareThreads = std::thread::hardware_concurrency();
-            const std::size_t threadCount = std::max<std::size_t>(1, hardwareThreads == 0 ? 1 : hardwareThreads);
             std::vector<std::thread> workers;
             workers.reserve(threadCount);
 
             for (std::size_t index = 0; index < threadCount; ++index)
                 {
-                workers.emplace_back([&]()
+                workers.emplace_back([&, index]()
                     {
-                    while (true)
-                        {
-                        std::filesystem::path directory;
-                        {
-                        std::unique_lock<std::mutex> lock(queueMutex);
-                        queueCv.wait(lock, [&]() { return done || !pending.empty(); });
-                        if (done && pending.empty())
-                            {
-                            return;
-                            }
-                        directory = pending.front();
-                        pending.pop_front();
-                        ++activeWorkers;
-                        }
-
-                        processDirectory(directory);
-
+                    TraversalTask task;
+                    while (scheduler.pop(index, task))
                         {
-                        std::lock_guard<std::mutex> lock(queueMutex);
-                        if (activeWorkers > 0)
-                            {
-                            --activeWorkers;
-                            }
-                        if (!done && pending.empty() && activeWorkers == 0)
+                        if (!hasError.load(std::memory_order_relaxed))
                             {
-                            done = true;
-                            queueCv.notify_all();
+                            if (task.entries.empty())
+                                {
+                                processDirectory(index, task.directory, task.ignoreLevel);
+                                }
+                            else
+                                {
+                                processBatch(index, task.ignoreLevel, task.entries);
+                                }
                             }
+                        task = TraversalTask{};
+                        scheduler.complete();
                         }
-                        }
+                    // Each worker sorts its own run; the runs are merged below.
+                    outputs[index].files.sortByPath();
                     });
                 }
 
@@ -389,21 +418,63 @@ namespace repaddu::io
                 return errorResult;
                 }
 
+            std::vector<core::FileTable> runs;
+            runs.reserve(outputs.size());
+            for (WorkerOutput& local : outputs)
+                {
+                outResult.directories.insert(outResult.directories.end(),
+                    std::make_move_iterator(local.directories.begin()),
+                    std::make_move_iterator(local.directories.end()));
+                runs.push_back(std::move(local.files));
+                outResult.cmakeLists.insert(outResult.cmakeLists.end(),
+                    std::make_move_iterator(local.cmakeLists.begin()),
+                    std::make_move_iterator(local.cmakeLists.end()));
+                outResult.buildFiles.insert(outResult.buildFiles.end(),
+                    std::make_move_iterator(local.buildFiles.begin()),
+                    std::make_move_iterator(local.buildFiles.end()));
+                }
+            outResult.files.mergeSortedRuns(runs, threadCount);
+
             return { core::ExitCode::success, "" };
             }
         }
 
-    core::RunResult traverseRepository(const core::CliOptions& options, TraversalResult& outResult)
+    namespace detail
         {
-        outResult = TraversalResult{};
+        std::vector<std::string> lowerBuildFileNames(const core::CliOptions& options)
+            {
+            const std::vector<std::string> buildFileNames = core::resolveBuildFileNames(options);
+            std::vector<std::string> buildFileNamesLower;
+            buildFileNamesLower.reserve(buildFileNames.size());
+            for (const std::string& name : buildFileNames)
+                {
+                buildFileNamesLower.push_back(normalizeFileName(name));
+                }
+            return buildFileNamesLower;
+            }
 
-        const std::vector<std::string> buildFileNames = core::resolveBuildFileNames(options);
-        std::vector<std::string> buildFileNamesLower;
-        buildFileNamesLower.reserve(buildFileNames.size());
-        for (const std::string& name : buildFileNames)
+        void sortTraversalResult(TraversalResult& result)
             {
-            buildFileNamesLower.push_back(normalizeFileName(name));
+            result.files.sortByPath();
+
+            // native() is a reference, unlike string(), so these comparisons
+            // do not allocate.
+            auto nativeLess = [](const std::filesystem::path& a, const std::filesystem::path& b)
+                {
+                return a.native() < b.native();
+                };
+            std::sort(result.directories.begin(), result.directories.end(), nativeLess);
+            std::sort(result.cmakeLists.begin(), result.cmakeLists.end(), nativeLess);
+            std::sort(result.buildFiles.begin(), result.buildFiles.end(), nativeLess);
             }
+        }
+
+    core::RunResult traverseRepository(const core::CliOptions& options, TraversalResult& outResult)
+        {
+        outResult = TraversalResult{};
+        outResult.files.setRoot(options.inputPath);
+
+        const std::vector<std::string> buildFileNamesLower = detail::lowerBuildFileNames(options);
 
         std::error_code errorCode;
         if (!std::filesystem::exists(options.inputPath, errorCode))
@@ -418,7 +489,11 @@ namespace repaddu::io
             }
 
         core::RunResult traversalResult;
-        if (options.parallelTraversal)
+        if (options.traversalBackend == core::TraversalBackend::native && detail::nativeTraversalAvailable())
+            {
+            traversalResult = detail::traverseNative(options, buildFileNamesLower, outResult);
+            }
+        else if (options.parallelTraversal)
             {
             traversalResult = traverseParallel(options, dirOptions, buildFileNamesLower, outResult);
             }
@@ -431,29 +506,7 @@ namespace repaddu::io
             return traversalResult;
             }
 
-        std::sort(outResult.files.begin(), outResult.files.end(),
-            [](const core::FileEntry& a, const core::FileEntry& b)
-            {
-            return a.relativePath.string() < b.relativePath.string();
-            });
-
-        std::sort(outResult.directories.begin(), outResult.directories.end(),
-            [](const std::filesystem::path& a, const std::filesystem::path& b)
-            {
-            return a.string() < b.string();
-            });
-
-        std::sort(outResult.cmakeLists.begin(), outResult.cmakeLists.end(),
-            [](const std::filesystem::path& a, const std::filesystem::path& b)
-            {
-            return a.string() < b.string();
-            });
-
-        std::sort(outResult.buildFiles.begin(), outResult.buildFiles.end(),
-            [](const std::filesystem::path& a, const std::filesystem::path& b)
-            {
-            return a.string() < b.string();
-            });
+        detail::sortTraversalResult(outResult);
 
         return { core::ExitCode::success, "" };
         }
@@ -0,0 +1,645 @@
+#include "repaddu/io_traversal_cache.h"
+
+#include "repaddu/io_ignore.h"
+
+#include "io_traversal_internal.h"
+#include "io_traversal_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+namespace repaddu::io
+    {
+    namespace
+        {
+        constexpr char kSnapshotMagic[8] = { 'R', 'P', 'D', 'T', 'S', 'N', 'P', '3' };
+
+        // Entries modified this close to the scan start may still change within the
+        // same timestamp tick, so they are never trusted on the next run.
+        constexpr std::int64_t kRacyWindowNs = 2'000'000'000;
+
+        struct NodeStat
+            {
+            std::uintmax_t sizeBytes = 0;
+            std::int64_t mtimeNs = 0;
+            std::uint64_t inode = 0;
+            };
+
+        bool statNode(const std::filesystem::path& path, bool followSymlinks, NodeStat& outStat)
+            {
+#if defined(_WIN32)
+            std::error_code errorCode;
+            const std::filesystem::file_status status = followSymlinks
+                ? std::filesystem::status(path, errorCode)
+                : std::filesystem::symlink_status(path, errorCode);
+            if (errorCode)
+                {
+                return false;
+                }
+            outStat.sizeBytes = std::filesystem::is_regular_file(status) ? std::filesystem::file_size(path, errorCode) : 0;
+            if (errorCode)
+                {
+                return false;
+                }
+            const auto writeTime = std::filesystem::last_write_time(path, errorCode);
+            if (errorCode)
+                {
+                return false;
+                }
+            outStat.mtimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(writeTime.time_since_epoch()).count();
+            outStat.inode = 0;
+            return true;
+#else
+            struct stat statBuffer;
+            const int status = followSymlinks ? ::stat(path.c_str(), &statBuffer) : ::lstat(path.c_str(), &statBuffer);
+            if (status != 0)
+                {
+                return false;
+                }
+#if defined(__APPLE__)
+            const struct timespec& modified = statBuffer.st_mtimespec;
+#else
+            const struct timespec& modified = statBuffer.st_mtim;
+#endif
+            outStat.sizeBytes = static_cast<std::uintmax_t>(statBuffer.st_size);
+            outStat.mtimeNs = static_cast<std::int64_t>(modified.tv_sec) * 1'000'000'000 + modified.tv_nsec;
+            outStat.inode = static_cast<std::uint64_t>(statBuffer.st_ino);
+            return true;
+#endif
+            }
+
+        std::int64_t nowNs()
+            {
+#if defined(_WIN32)
+            const auto now = std::filesystem::file_time_type::clock::now();
+#else
+            const auto now = std::chrono::system_clock::now();
+#endif
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+            }
+
+        struct IncrementalTask
+            {
+            std::string relativeDirectory;
+            IgnoreLevelPtr parentIgnoreLevel;
+            };
+
+        struct IncrementalWorkerOutput
+            {
+            TraversalResult result;
+            std::vector<std::pair<std::string, SnapshotDirectory>> directories;
+            IncrementalTraversalStats stats;
+            };
+
+        class SnapshotWriter
+            {
+            public:
+                explicit SnapshotWriter(std::ostream& stream) : stream_(stream) {}
+
+                void u8(std::uint8_t value)
+                    {
+                    stream_.put(static_cast<char>(value));
+                    }
+
+                void u32(std::uint32_t value)
+                    {
+                    raw(&value, sizeof(value));
+                    }
+
+                void u64(std::uint64_t value)
+                    {
+                    raw(&value, sizeof(value));
+                    }
+
+                void i64(std::int64_t value)
+                    {
+                    raw(&value, sizeof(value));
+                    }
+
+                void string(const std::string& value)
+                    {
+                    u32(static_cast<std::uint32_t>(value.size()));
+                    stream_.write(value.data(), static_cast<std::streamsize>(value.size()));
+                    }
+
+            private:
+                void raw(const void* data, std::size_t size)
+                    {
+                    stream_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                    }
+
+                std::ostream& stream_;
+            };
+
+        class SnapshotReader
+            {
+            public:
+                explicit SnapshotReader(const std::string& data) : data_(data) {}
+
+                bool u8(std::uint8_t& value)
+                    {
+                    return raw(&value, sizeof(value));
+                    }
+
+                bool u32(std::uint32_t& value)
+                    {
+                    return raw(&value, sizeof(value));
+                    }
+
+                bool u64(std::uint64_t& value)
+                    {
+                    return raw(&value, sizeof(value));
+                    }
+
+                bool i64(std::int64_t& value)
+                    {
+                    return raw(&value, sizeof(value));
+                    }
+
+                bool string(std::string& value)
+                    {
+                    std::uint32_t size = 0;
+                    if (!u32(size) || data_.size() - offset_ < size)
+                        {
+                        return false;
+                        }
+                    value.assign(data_, offset_, size);
+                    offset_ += size;
+                    return true;
+                    }
+
+                bool atEnd() const
+                    {
+                    return offset_ == data_.size();
+                    }
+
+            private:
+                bool raw(void* out, std::size_t size)
+                    {
+                    if (data_.size() - offset_ < size)
+                        {
+                        return false;
+                        }
+                    std::memcpy(out, data_.data() + offset_, size);
+                    offset_ += size;
+                    return true;
+                    }
+
+                const std::string& data_;
+                std::size_t offset_ = 0;
+            };
+        }
+
+    std::string traversalSnapshotFingerprint(const core::CliOptions& options)
+        {
+        std::error_code errorCode;
+        std::filesystem::path root = std::filesystem::absolute(options.inputPath, errorCode);
+        if (errorCode)
+            {
+            root = options.inputPath;
+            }
+        std::ostringstream out;
+        out << "v3|hidden=" << (options.includeHidden ? 1 : 0)
+            << "|follow=" << (options.followSymlinks ? 1 : 0)
+            << "|ignore=" << (options.useIgnoreFiles ? 1 : 0)
+            << "|root=" << root.lexically_normal().generic_string();
+        return out.str();
+        }
+
+    core::RunResult loadTraversalSnapshot(const std::filesystem::path& path, TraversalSnapshot& outSnapshot)
+        {
+        outSnapshot = TraversalSnapshot{};
+        std::error_code errorCode;
+        if (!std::filesystem::exists(path, errorCode))
+            {
+            return { core::ExitCode::success, "" };
+            }
+
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+            {
+            return { core::ExitCode::io_failure, "Failed to open traversal cache: " + path.string() };
+            }
+        std::ostringstream buffer;
+        buffer << stream.rdbuf();
+        const std::string data = buffer.str();
+
+        const core::RunResult corrupt{ core::ExitCode::io_failure, "Traversal cache is corrupt: " + path.string() };
+        if (data.size() < sizeof(kSnapshotMagic) || std::memcmp(data.data(), kSnapshotMagic, sizeof(kSnapshotMagic)) != 0)
+            {
+            return corrupt;
+            }
+
+        const std::string payload = data.substr(sizeof(kSnapshotMagic));
+        SnapshotReader reader(payload);
+        TraversalSnapshot snapshot;
+        std::uint64_t directoryCount = 0;
+        if (!reader.string(snapshot.fingerprint) || !reader.u64(directoryCount))
+            {
+            return corrupt;
+            }
+
+        for (std::uint64_t index = 0; index < directoryCount; ++index)
+            {
+            std::string key;
+            SnapshotDirectory directory;
+            std::uint32_t subdirectoryCount = 0;
+            if (!reader.string(key) || !reader.i64(directory.mtimeNs) || !reader.u64(directory.inode)
+                || !reader.u32(subdirectoryCount))
+                {
+                return corrupt;
+                }
+            directory.subdirectories.resize(subdirectoryCount);
+            for (SnapshotSubdirectory& subdirectory : directory.subdirectories)
+                {
+                std::uint8_t descend = 0;
+                if (!reader.string(subdirectory.name) || !reader.u8(descend))
+                    {
+                    return corrupt;
+                    }
+                subdirectory.descend = descend != 0;
+                }
+
+            std::uint32_t fileCount = 0;
+            if (!reader.u32(fileCount))
+                {
+                return corrupt;
+                }
+            directory.files.resize(fileCount);
+            for (std::string& name : directory.files)
+                {
+                if (!reader.string(name))
+                    {
+                    return corrupt;
+                    }
+                }
+            snapshot.directories.emplace(std::move(key), std::move(directory));
+            }
+
+        if (!reader.atEnd())
+            {
+            return corrupt;
+            }
+
+        outSnapshot = std::move(snapshot);
+        return { core::ExitCode::success, "" };
+        }
+
+    core::RunResult saveTraversalSnapshot(const std::filesystem::path& path, const TraversalSnapshot& snapshot)
+        {
+        std::error_code errorCode;
+        if (path.has_parent_path())
+            {
+            std::filesystem::create_directories(path.parent_path(), errorCode);
+            }
+
+        // Write next to the target and rename so a crashed run never leaves a torn cache.
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+        {
+            std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+            if (!stream)
+                {
+                return { core::ExitCode::io_failure, "Failed to write traversal cache: " + path.string() };
+                }
+
+            std::vector<const std::string*> keys;
+            keys.reserve(snapshot.directories.size());
+            for (const auto& directory : snapshot.directories)
+                {
+                keys.push_back(&directory.first);
+                }
+            std::sort(keys.begin(), keys.end(),
+                [](const std::string* lhs, const std::string* rhs)
+                {
+                return *lhs < *rhs;
+                });
+
+            stream.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+            SnapshotWriter writer(stream);
+            writer.string(snapshot.fingerprint);
+            writer.u64(static_cast<std::uint64_t>(keys.size()));
+            for (const std::string* key : keys)
+                {
+                const SnapshotDirectory& directory = snapshot.directories.at(*key);
+                writer.string(*key);
+                writer.i64(directory.mtimeNs);
+                writer.u64(directory.inode);
+                writer.u32(static_cast<std::uint32_t>(directory.subdirectories.size()));
+                for (const SnapshotSubdirectory& subdirectory : directory.subdirectories)
+                    {
+                    writer.string(subdirectory.name);
+                    writer.u8(subdirectory.descend ? 1 : 0);
+                    }
+                writer.u32(static_cast<std::uint32_t>(directory.files.size()));
+                for (const std::string& name : directory.files)
+                    {
+                    writer.string(name);
+                    }
+                }
+
+            if (!stream)
+                {
+                return { core::ExitCode::io_failure, "Failed to write traversal cache: " + path.string() };
+                }
+        }
+
+        std::filesystem::rename(tempPath, path, errorCode);
+        if (errorCode)
+            {
+            std::filesystem::remove(tempPath, errorCode);
+            return { core::ExitCode::io_failure, "Failed to replace traversal cache: " + path.string() };
+            }
+        return { core::ExitCode::success, "" };
+        }
+
+    core::RunResult traverseRepositoryIncremental(const core::CliOptions& options,
+        const TraversalSnapshot& previous,
+        TraversalResult& outResult,
+        TraversalSnapshot& outSnapshot,
+        IncrementalTraversalStats* outStats)
+        {
+        outResult = TraversalResult{};
+        outResult.files.setRoot(options.inputPath);
+        outSnapshot = TraversalSnapshot{};
+        outSnapshot.fingerprint = traversalSnapshotFingerprint(options);
+
+        std::error_code errorCode;
+        if (!std::filesystem::exists(options.inputPath, errorCode))
+            {
+            return { core::ExitCode::io_failure, "Input path does not exist." };
+            }
+        if (!std::filesystem::is_directory(options.inputPath, errorCode))
+            {
+            return { core::ExitCode::traversal_failure, "Filesystem traversal failed." };
+            }
+
+        const bool snapshotUsable = previous.fingerprint == outSnapshot.fingerprint;
+        const std::vector<std::string> buildFileNamesLower = detail::lowerBuildFileNames(options);
+        const std::int64_t trustedBeforeNs = nowNs() - kRacyWindowNs;
+
+        std::filesystem::directory_options dirOptions = std::filesystem::directory_options::skip_permission_denied;
+        if (options.followSymlinks)
+            {
+            dirOptions |= std::filesystem::directory_options::follow_directory_symlink;
+            }
+
+        std::size_t threadCount = 1;
+        if (options.parallelTraversal)
+            {
+            const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            threadCount = std::max<std::size_t>(1, hardwareThreads == 0 ? 1 : hardwareThreads);
+            }
+
+        std::atomic<bool> hasError(false);
+        core::RunResult errorResult{ core::ExitCode::success, "" };
+        std::mutex errorMutex;
+        detail::WorkStealingScheduler<IncrementalTask> scheduler(threadCount);
+        std::vector<IncrementalWorkerOutput> outputs(threadCount);
+
+        scheduler.push(0, IncrementalTask{});
+
+        auto setError = [&](const core::RunResult& result)
+            {
+            if (hasError.exchange(true))
+                {
+                return;
+                }
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                errorResult = result;
+            }
+            scheduler.stop();
+            };
+
+        auto listDirectory = [&](const std::filesystem::path& absoluteDirectory, SnapshotDirectory& outDirectory) -> bool
+            {
+            std::error_code iterError;
+            std::filesystem::directory_iterator iterator(absoluteDirectory, dirOptions, iterError);
+            if (iterError)
+                {
+                setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
+                return false;
+                }
+            const std::filesystem::directory_iterator end;
+            for (; iterator != end; iterator.increment(iterError))
+                {
+                if (iterError)
+                    {
+                    break;
+                    }
+                const std::filesystem::directory_entry& entry = *iterator;
+                std::string name = entry.path().filename().string();
+                if (!name.empty() && name.front() == '.' && (name == ".git" || !options.includeHidden))
+                    {
+                    continue;
+                    }
+
+                std::error_code typeError;
+                const bool isSymlink = entry.is_symlink(typeError);
+                if (entry.is_directory(typeError))
+                    {
+                    outDirectory.subdirectories.push_back({ std::move(name), options.followSymlinks || !isSymlink });
+                    continue;
+                    }
+                if (entry.is_regular_file(typeError) && (options.followSymlinks || !isSymlink))
+                    {
+                    outDirectory.files.push_back(std::move(name));
+                    }
+                }
+            if (iterError)
+                {
+                setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
+                return false;
+                }
+            std::sort(outDirectory.files.begin(), outDirectory.files.end());
+            return true;
+            };
+
+        auto processDirectory = [&](std::size_t worker, const IncrementalTask& task)
+            {
+            IncrementalWorkerOutput& local = outputs[worker];
+            const std::string& relativeDirectory = task.relativeDirectory;
+            const std::filesystem::path absoluteDirectory = relativeDirectory.empty()
+                ? options.inputPath
+                : options.inputPath / relativeDirectory;
+
+            NodeStat directoryStat;
+            if (!statNode(absoluteDirectory, true, directoryStat))
+                {
+                setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
+                return;
+                }
+
+            const SnapshotDirectory* cached = nullptr;
+            if (snapshotUsable)
+                {
+                auto it = previous.directories.find(relativeDirectory);
+                if (it != previous.directories.end())
+                    {
+                    cached = &it->second;
+                    }
+                }
+
+            SnapshotDirectory current;
+            if (cached && cached->mtimeNs != 0 && cached->mtimeNs == directoryStat.mtimeNs
+                && cached->inode == directoryStat.inode)
+                {
+                current.subdirectories = cached->subdirectories;
+                current.files = cached->files;
+                ++local.stats.directoriesReused;
+                }
+            else
+                {
+                if (!listDirectory(absoluteDirectory, current))
+                    {
+                    return;
+                    }
+                ++local.stats.directoriesListed;
+                }
+            current.mtimeNs = directoryStat.mtimeNs < trustedBeforeNs ? directoryStat.mtimeNs : 0;
+            current.inode = directoryStat.inode;
+
+            // Ignore rules are applied to the listing on every run rather than
+            // baked into the snapshot, so edits to ignore files take effect even
+            // when the directory itself is unchanged.
+            const IgnoreLevelPtr ignoreLevel = options.useIgnoreFiles
+                ? loadIgnoreLevel(task.parentIgnoreLevel, absoluteDirectory, relativeDirectory)
+                : nullptr;
+
+            const std::string prefix = relativeDirectory.empty() ? std::string() : relativeDirectory + '/';
+            for (const SnapshotSubdirectory& subdirectory : current.subdirectories)
+                {
+                std::string relative = prefix + subdirectory.name;
+                if (ignoreLevel && isIgnored(ignoreLevel.get(), relative, true))
+                    {
+                    continue;
+                    }
+                local.result.directories.emplace_back(relative);
+                if (subdirectory.descend)
+                    {
+                    scheduler.push(worker, IncrementalTask{ std::move(relative), ignoreLevel });
+                    }
+                }
+
+            for (const std::string& name : current.files)
+                {
+                if (hasError.load(std::memory_order_relaxed))
+                    {
+                    return;
+                    }
+
+                const std::string relative = prefix + name;
+                if (ignoreLevel && isIgnored(ignoreLevel.get(), relative, false))
+                    {
+                    continue; // Kept in the snapshot, never stat'ed.
+                    }
+
+                NodeStat fileStat;
+                if (!statNode(options.inputPath / relative, options.followSymlinks, fileStat))
+                    {
+                    setError({ core::ExitCode::io_failure, "Failed to read file size." });
+                    return;
+                    }
+
+                const std::string filenameLower = core::toLowerCopy(name);
+                if (filenameLower == "cmakelists.txt")
+                    {
+                    local.result.cmakeLists.push_back(relative);
+                    }
+                if (std::find(buildFileNamesLower.begin(), buildFileNamesLower.end(), filenameLower)
+                    != buildFileNamesLower.end())
+                    {
+                    local.result.buildFiles.push_back(relative);
+                    }
+                local.result.files.add(relative, fileStat.sizeBytes);
+                }
+
+            local.directories.emplace_back(relativeDirectory, std::move(current));
+            };
+
+        auto runWorker = [&](std::size_t worker)
+            {
+            IncrementalTask task;
+            while (scheduler.pop(worker, task))
+                {
+                if (!hasError.load(std::memory_order_relaxed))
+                    {
+                    processDirectory(worker, task);
+                    }
+                task = IncrementalTask{};
+                scheduler.complete();
+                }
+            // Each worker sorts its own run; the runs are merged below.
+            outputs[worker].result.files.sortByPath();
+            };
+
+        if (threadCount == 1)
+            {
+            runWorker(0);
+            }
+        else
+            {
+            std::vector<std::thread> workers;
+            workers.reserve(threadCount);
+            for (std::size_t index = 0; index < threadCount; ++index)
+                {
+                workers.emplace_back(runWorker, index);
+                }
+            for (auto& worker : workers)
+                {
+                worker.join();
+                }
+            }
+
+        if (hasError.load())
+            {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            return errorResult;
+            }
+
+        IncrementalTraversalStats stats;
+        std::vector<core::FileTable> runs;
+        runs.reserve(outputs.size());
+        for (IncrementalWorkerOutput& local : outputs)
+            {
+            TraversalResult& result = local.result;
+            outResult.directories.insert(outResult.directories.end(),
+                std::make_move_iterator(result.directories.begin()),
+                std::make_move_iterator(result.directories.end()));
+            runs.push_back(std::move(result.files));
+            outResult.cmakeLists.insert(outResult.cmakeLists.end(),
+                std::make_move_iterator(result.cmakeLists.begin()),
+                std::make_move_iterator(result.cmakeLists.end()));
+            outResult.buildFiles.insert(outResult.buildFiles.end(),
+                std::make_move_iterator(result.buildFiles.begin()),
+                std::make_move_iterator(result.buildFiles.end()));
+            for (auto& directory : local.directories)
+                {
+                outSnapshot.directories.emplace(std::move(directory.first), std::move(directory.second));
+                }
+            stats.directoriesListed += local.stats.directoriesListed;
+            stats.directoriesReused += local.stats.directoriesReused;
+            }
+
+        outResult.files.mergeSortedRuns(runs, threadCount);
+
+        detail::sortTraversalResult(outResult);
+        if (outStats)
+            {
+            *outStats = stats;
+            }
+        return { core::ExitCode::success, "" };
+        }
+    }
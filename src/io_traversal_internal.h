@@ -0,0 +1,28 @@
+#ifndef REPADDU_IO_TRAVERSAL_INTERNAL_H
+#define REPADDU_IO_TRAVERSAL_INTERNAL_H
+
+#include "repaddu/core_types.h"
+#include "repaddu/io_traversal.h"
+
+#include <string>
+#include <vector>
+
+namespace repaddu::io::detail
+    {
+    // Lowercased build-system file names recognized for the resolved build profile.
+    std::vector<std::string> lowerBuildFileNames(const core::CliOptions& options);
+
+    // Applies the canonical ordering shared by every traversal backend.
+    void sortTraversalResult(TraversalResult& result);
+
+    // True when the fd-based getdents64 backend is compiled in for this platform.
+    bool nativeTraversalAvailable();
+
+    // Walks options.inputPath from directory file descriptors. Results are
+    // appended unsorted; traverseRepository applies the final ordering.
+    core::RunResult traverseNative(const core::CliOptions& options,
+        const std::vector<std::string>& buildFileNamesLower,
+        TraversalResult& outResult);
+    }
+
+#endif // REPADDU_IO_TRAVERSAL_INTERNAL_H
@@ -0,0 +1,447 @@
+#include "io_traversal_internal.h"
+
+#include "repaddu/io_ignore.h"
+
+#include "io_traversal_scheduler.h"
+
+#if defined(__linux__)
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace repaddu::io::detail
+    {
+#if defined(__linux__)
+    namespace
+        {
+        struct NativeEntry
+            {
+            std::string name;
+            unsigned char type = DT_UNKNOWN;
+            };
+
+        struct NativeTask
+            {
+            // Directory path relative to the input root; empty for the root itself.
+            std::string relativeDirectory;
+            std::vector<NativeEntry> entries;
+            // Directory tasks carry the parent's rules; batches carry the directory's own.
+            IgnoreLevelPtr ignoreLevel;
+            };
+
+        struct NativeWorkerOutput
+            {
+            std::vector<std::filesystem::path> directories;
+            core::FileTable files;
+            std::vector<std::filesystem::path> cmakeLists;
+            std::vector<std::filesystem::path> buildFiles;
+            };
+
+        constexpr std::size_t kEntryBatchSize = 256;
+        constexpr std::size_t kDirentBufferBytes = 64 * 1024;
+
+        // Byte offsets inside struct linux_dirent64; glibc does not expose the
+        // raw record layout so it is decoded by hand.
+        constexpr std::size_t kDirentReclenOffset = 16;
+        constexpr std::size_t kDirentTypeOffset = 18;
+        constexpr std::size_t kDirentNameOffset = 19;
+
+        class FdGuard
+            {
+            public:
+                explicit FdGuard(int fd) : fd_(fd) {}
+                ~FdGuard()
+                    {
+                    if (fd_ >= 0)
+                        {
+                        ::close(fd_);
+                        }
+                    }
+                FdGuard(const FdGuard&) = delete;
+                FdGuard& operator=(const FdGuard&) = delete;
+
+                int get() const
+                    {
+                    return fd_;
+                    }
+
+            private:
+                int fd_;
+            };
+
+        bool readSize(int dirFd, const char* name, int flags, std::uintmax_t& outSize)
+            {
+#if defined(STATX_SIZE)
+            struct statx statxBuffer;
+            if (::statx(dirFd, name, flags, STATX_SIZE, &statxBuffer) != 0)
+                {
+                return false;
+                }
+            outSize = static_cast<std::uintmax_t>(statxBuffer.stx_size);
+#else
+            struct stat statBuffer;
+            if (::fstatat(dirFd, name, &statBuffer, flags) != 0)
+                {
+                return false;
+                }
+            outSize = static_cast<std::uintmax_t>(statBuffer.st_size);
+#endif
+            return true;
+            }
+
+        std::string readFileAt(int dirFd, const char* name)
+            {
+            const FdGuard file(::openat(dirFd, name, O_RDONLY | O_CLOEXEC | O_NOCTTY));
+            std::string content;
+            if (file.get() < 0)
+                {
+                return content;
+                }
+            std::array<char, 4096> buffer;
+            while (true)
+                {
+                const ssize_t count = ::read(file.get(), buffer.data(), buffer.size());
+                if (count < 0 && errno == EINTR)
+                    {
+                    continue;
+                    }
+                if (count <= 0)
+                    {
+                    break;
+                    }
+                content.append(buffer.data(), static_cast<std::size_t>(count));
+                }
+            return content;
+            }
+
+        IgnoreLevelPtr loadIgnoreLevelAt(const IgnoreLevelPtr& parent, int dirFd, const std::string& relativeDirectory)
+            {
+            IgnoreLevelPtr base = parent;
+            if (relativeDirectory.empty())
+                {
+                base = extendIgnoreLevel(base, relativeDirectory, { readFileAt(dirFd, ".git/info/exclude") });
+                }
+            std::vector<std::string> contents;
+            contents.reserve(ignoreFileNames().size());
+            for (const std::string& name : ignoreFileNames())
+                {
+                contents.push_back(readFileAt(dirFd, name.c_str()));
+                }
+            return extendIgnoreLevel(base, relativeDirectory, contents);
+            }
+        }
+
+    bool nativeTraversalAvailable()
+        {
+        return true;
+        }
+
+    core::RunResult traverseNative(const core::CliOptions& options,
+        const std::vector<std::string>& buildFileNamesLower,
+        TraversalResult& outResult)
+        {
+        const FdGuard rootFd(::open(options.inputPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        if (rootFd.get() < 0)
+            {
+            return { core::ExitCode::traversal_failure, "Filesystem traversal failed." };
+            }
+
+        std::size_t threadCount = 1;
+        if (options.parallelTraversal)
+            {
+            const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            threadCount = std::max<std::size_t>(1, hardwareThreads == 0 ? 1 : hardwareThreads);
+            }
+
+        std::atomic<bool> hasError(false);
+        core::RunResult errorResult{ core::ExitCode::success, "" };
+        std::mutex errorMutex;
+        WorkStealingScheduler<NativeTask> scheduler(threadCount);
+        std::vector<NativeWorkerOutput> outputs(threadCount);
+
+        scheduler.push(0, NativeTask{});
+
+        auto setError = [&](const core::RunResult& result)
+            {
+            if (hasError.exchange(true))
+                {
+                return;
+                }
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                errorResult = result;
+            }
+            scheduler.stop();
+            };
+
+        auto openDirectory = [&](const std::string& relativeDirectory)
+            {
+            return ::openat(rootFd.get(), relativeDirectory.empty() ? "." : relativeDirectory.c_str(),
+                O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            };
+
+        auto addFile = [&](NativeWorkerOutput& local, const std::string& name,
+            const std::string& relative, std::uintmax_t sizeBytes)
+            {
+            const std::string filenameLower = core::toLowerCopy(name);
+            if (filenameLower == "cmakelists.txt")
+                {
+                local.cmakeLists.push_back(relative);
+                }
+            if (std::find(buildFileNamesLower.begin(), buildFileNamesLower.end(), filenameLower)
+                != buildFileNamesLower.end())
+                {
+                local.buildFiles.push_back(relative);
+                }
+            local.files.add(relative, sizeBytes);
+            };
+
+        // Hidden, .git and ignore-rule pruning happens here, once per entry of the directory
+        // that contains it; pruned directories are never opened.
+        auto processEntry = [&](std::size_t worker, int dirFd, const std::string& relativeDirectory,
+            const IgnoreLevelPtr& ignoreLevel, const NativeEntry& entry) -> bool
+            {
+            NativeWorkerOutput& local = outputs[worker];
+            const std::string& name = entry.name;
+            if (name.front() == '.')
+                {
+                if (name == ".git" || !options.includeHidden)
+                    {
+                    return true;
+                    }
+                }
+
+            std::string relative = relativeDirectory.empty() ? name : relativeDirectory + '/' + name;
+            unsigned char type = entry.type;
+            bool isSymlink = false;
+            struct stat statBuffer;
+
+            if (type == DT_UNKNOWN)
+                {
+                if (::fstatat(dirFd, name.c_str(), &statBuffer, AT_SYMLINK_NOFOLLOW) != 0)
+                    {
+                    return true;
+                    }
+                type = S_ISDIR(statBuffer.st_mode) ? DT_DIR
+                    : S_ISREG(statBuffer.st_mode) ? DT_REG
+                    : S_ISLNK(statBuffer.st_mode) ? DT_LNK
+                    : DT_UNKNOWN;
+                }
+
+            if (type == DT_LNK)
+                {
+                isSymlink = true;
+                if (::fstatat(dirFd, name.c_str(), &statBuffer, 0) != 0)
+                    {
+                    return true; // Dangling link.
+                    }
+                type = S_ISDIR(statBuffer.st_mode) ? DT_DIR : S_ISREG(statBuffer.st_mode) ? DT_REG : DT_UNKNOWN;
+                }
+
+            if (ignoreLevel && isIgnored(ignoreLevel.get(), relative, type == DT_DIR))
+                {
+                return true;
+                }
+
+            if (type == DT_DIR)
+                {
+                local.directories.emplace_back(relative);
+                if (isSymlink && !options.followSymlinks)
+                    {
+                    return true;
+                    }
+                scheduler.push(worker, NativeTask{ std::move(relative), {}, ignoreLevel });
+                return true;
+                }
+
+            if (type != DT_REG)
+                {
+                return true;
+                }
+
+            if (isSymlink)
+                {
+                if (options.followSymlinks)
+                    {
+                    addFile(local, name, relative, static_cast<std::uintmax_t>(statBuffer.st_size));
+                    }
+                return true;
+                }
+
+            std::uintmax_t sizeBytes = 0;
+            if (!readSize(dirFd, name.c_str(), AT_SYMLINK_NOFOLLOW, sizeBytes))
+                {
+                setError({ core::ExitCode::io_failure, "Failed to read file size." });
+                return false;
+                }
+            addFile(local, name, relative, sizeBytes);
+            return true;
+            };
+
+        auto processBatch = [&](std::size_t worker, int dirFd, const std::string& relativeDirectory,
+            const IgnoreLevelPtr& ignoreLevel, const std::vector<NativeEntry>& entries)
+            {
+            for (const NativeEntry& entry : entries)
+                {
+                if (hasError.load(std::memory_order_relaxed)
+                    || !processEntry(worker, dirFd, relativeDirectory, ignoreLevel, entry))
+                    {
+                    return;
+                    }
+                }
+            };
+
+        auto processTask = [&](std::size_t worker, std::vector<char>& direntBuffer, const NativeTask& task)
+            {
+            const FdGuard dirFd(openDirectory(task.relativeDirectory));
+            if (dirFd.get() < 0)
+                {
+                if (errno == EACCES || errno == EPERM)
+                    {
+                    return; // Mirrors directory_options::skip_permission_denied.
+                    }
+                setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
+                return;
+                }
+
+            if (!task.entries.empty())
+                {
+                processBatch(worker, dirFd.get(), task.relativeDirectory, task.ignoreLevel, task.entries);
+                return;
+                }
+
+            const IgnoreLevelPtr ignoreLevel = options.useIgnoreFiles
+                ? loadIgnoreLevelAt(task.ignoreLevel, dirFd.get(), task.relativeDirectory)
+                : nullptr;
+
+            std::vector<NativeEntry> batch;
+            while (true)
+                {
+                const long count = ::syscall(SYS_getdents64, dirFd.get(), direntBuffer.data(), direntBuffer.size());
+                if (count < 0)
+                    {
+                    setError({ core::ExitCode::traversal_failure, "Filesystem traversal failed." });
+                    return;
+                    }
+                if (count == 0)
+                    {
+                    break;
+                    }
+
+                std::size_t offset = 0;
+                while (offset < static_cast<std::size_t>(count))
+                    {
+                    const char* record = direntBuffer.data() + offset;
+                    unsigned short recordLength = 0;
+                    std::memcpy(&recordLength, record + kDirentReclenOffset, sizeof(recordLength));
+                    const unsigned char type = static_cast<unsigned char>(record[kDirentTypeOffset]);
+                    const char* name = record + kDirentNameOffset;
+                    offset += recordLength;
+
+                    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                        {
+                        continue;
+                        }
+                    batch.push_back(NativeEntry{ name, type });
+                    if (batch.size() == kEntryBatchSize)
+                        {
+                        scheduler.push(worker, NativeTask{ task.relativeDirectory, std::move(batch), ignoreLevel });
+                        batch = {};
+                        }
+                    }
+                if (hasError.load(std::memory_order_relaxed))
+                    {
+                    return;
+                    }
+                }
+
+            processBatch(worker, dirFd.get(), task.relativeDirectory, ignoreLevel, batch);
+            };
+
+        auto runWorker = [&](std::size_t worker)
+            {
+            std::vector<char> direntBuffer(kDirentBufferBytes);
+            NativeTask task;
+            while (scheduler.pop(worker, task))
+                {
+                if (!hasError.load(std::memory_order_relaxed))
+                    {
+                    processTask(worker, direntBuffer, task);
+                    }
+                task = NativeTask{};
+                scheduler.complete();
+                }
+            // Each worker sorts its own run; the runs are merged below.
+            outputs[worker].files.sortByPath();
+            };
+
+        if (threadCount == 1)
+            {
+            runWorker(0);
+            }
+        else
+            {
+            std::vector<std::thread> workers;
+            workers.reserve(threadCount);
+            for (std::size_t index = 0; index < threadCount; ++index)
+                {
+                workers.emplace_back(runWorker, index);
+                }
+            for (auto& worker : workers)
+                {
+                worker.join();
+                }
+            }
+
+        if (hasError.load())
+            {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            return errorResult;
+            }
+
+        std::vector<core::FileTable> runs;
+        runs.reserve(outputs.size());
+        for (NativeWorkerOutput& local : outputs)
+            {
+            outResult.directories.insert(outResult.directories.end(),
+                std::make_move_iterator(local.directories.begin()),
+                std::make_move_iterator(local.directories.end()));
+            runs.push_back(std::move(local.files));
+            outResult.cmakeLists.insert(outResult.cmakeLists.end(),
+                std::make_move_iterator(local.cmakeLists.begin()),
+                std::make_move_iterator(local.cmakeLists.end()));
+            outResult.buildFiles.insert(outResult.buildFiles.end(),
+                std::make_move_iterator(local.buildFiles.begin()),
+                std::make_move_iterator(local.buildFiles.end()));
+            }
+        outResult.files.mergeSortedRuns(runs, threadCount);
+
+        return { core::ExitCode::success, "" };
+        }
+#else
+    bool nativeTraversalAvailable()
+        {
+        return false;
+        }
+
+    core::RunResult traverseNative(const core::CliOptions&,
+        const std::vector<std::string>&,
+        TraversalResult&)
+        {
+        return { core::ExitCode::traversal_failure, "Native traversal backend is not available on this platform." };
+        }
+#endif
+    }
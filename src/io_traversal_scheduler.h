@@ -0,0 +1,136 @@
+#ifndef REPADDU_IO_TRAVERSAL_SCHEDULER_H
+#define REPADDU_IO_TRAVERSAL_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace repaddu::io::detail
+    {
+    // Work-stealing scheduler used by the parallel traversal backends.
+    // Every worker owns a deque: the owner pushes/pops at the back (LIFO keeps the
+    // walk depth-first and cache friendly), idle workers steal from the front of
+    // other deques. Each deque has its own lock, so the common path never touches
+    // shared state. Completion is tracked with a single atomic counter of
+    // outstanding tasks, which makes termination detection lock-free.
+    template <typename Task>
+    class WorkStealingScheduler
+        {
+        public:
+            explicit WorkStealingScheduler(std::size_t workerCount)
+                {
+                queues_.reserve(workerCount);
+                for (std::size_t index = 0; index < workerCount; ++index)
+                    {
+                    queues_.push_back(std::make_unique<WorkerQueue>());
+                    }
+                }
+
+            std::size_t workerCount() const
+                {
+                return queues_.size();
+                }
+
+            // Enqueues a task on the given worker's deque. Must be called before the
+            // producing task is marked complete so the outstanding count never
+            // reaches zero while work remains.
+            void push(std::size_t worker, Task task)
+                {
+                outstanding_.fetch_add(1, std::memory_order_relaxed);
+                WorkerQueue& queue = *queues_[worker];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+                }
+
+            // Fetches the next task for a worker, stealing if the local deque is
+            // empty. Returns false once all work has completed or stop() was called.
+            bool pop(std::size_t worker, Task& outTask)
+                {
+                unsigned int idleRounds = 0;
+                while (!stopped_.load(std::memory_order_acquire))
+                    {
+                    if (popLocal(worker, outTask) || steal(worker, outTask))
+                        {
+                        return true;
+                        }
+                    if (outstanding_.load(std::memory_order_acquire) == 0)
+                        {
+                        return false;
+                        }
+                    backoff(idleRounds++);
+                    }
+                return false;
+                }
+
+            // Marks a task returned by pop() as finished.
+            void complete()
+                {
+                outstanding_.fetch_sub(1, std::memory_order_acq_rel);
+                }
+
+            void stop()
+                {
+                stopped_.store(true, std::memory_order_release);
+                }
+
+        private:
+            struct alignas(64) WorkerQueue
+                {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+                };
+
+            bool popLocal(std::size_t worker, Task& outTask)
+                {
+                WorkerQueue& queue = *queues_[worker];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.tasks.empty())
+                    {
+                    return false;
+                    }
+                outTask = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                return true;
+                }
+
+            bool steal(std::size_t thief, Task& outTask)
+                {
+                const std::size_t count = queues_.size();
+                for (std::size_t offset = 1; offset < count; ++offset)
+                    {
+                    WorkerQueue& victim = *queues_[(thief + offset) % count];
+                    std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+                    if (!lock.owns_lock() || victim.tasks.empty())
+                        {
+                        continue;
+                        }
+                    outTask = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                    }
+                return false;
+                }
+
+            static void backoff(unsigned int idleRounds)
+                {
+                if (idleRounds < 16)
+                    {
+                    std::this_thread::yield();
+                    return;
+                    }
+                const unsigned int exponent = idleRounds < 22 ? idleRounds - 16 : 6;
+                std::this_thread::sleep_for(std::chrono::microseconds(10u << exponent));
+                }
+
+            std::vector<std::unique_ptr<WorkerQueue>> queues_;
+            std::atomic<std::size_t> outstanding_{ 0 };
+            std::atomic<bool> stopped_{ false };
+        };
+    }
+
+#endif // REPADDU_IO_TRAVERSAL_SCHEDULER_H
@@ -0,0 +1,190 @@
+#include "repaddu/io_watch.h"
+
+#if defined(__linux__)
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace repaddu::io
+    {
+#if defined(__linux__)
+    namespace
+        {
+        constexpr std::uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE
+            | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+        constexpr std::uint32_t kStructuralMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+            | IN_DELETE_SELF | IN_MOVE_SELF;
+        }
+
+    DirectoryWatcher::~DirectoryWatcher()
+        {
+        if (fd_ >= 0)
+            {
+            ::close(fd_);
+            }
+        }
+
+    bool DirectoryWatcher::available()
+        {
+        return true;
+        }
+
+    core::RunResult DirectoryWatcher::open(const std::filesystem::path& root)
+        {
+        if (fd_ >= 0)
+            {
+            ::close(fd_);
+            directories_.clear();
+            }
+        fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd_ < 0)
+            {
+            return { core::ExitCode::io_failure, std::string("Failed to initialize inotify: ") + std::strerror(errno) };
+            }
+        root_ = root;
+        return { core::ExitCode::success, "" };
+        }
+
+    bool DirectoryWatcher::addDirectory(const std::string& relativeDirectory)
+        {
+        if (fd_ < 0)
+            {
+            return false;
+            }
+        const std::filesystem::path absolute = relativeDirectory.empty() ? root_ : root_ / relativeDirectory;
+        const int wd = ::inotify_add_watch(fd_, absolute.c_str(), kWatchMask);
+        if (wd < 0)
+            {
+            return false;
+            }
+        directories_[wd] = relativeDirectory;
+        return true;
+        }
+
+    core::RunResult DirectoryWatcher::waitForChanges(int timeoutMs, int debounceMs, std::vector<WatchChange>& outChanges)
+        {
+        outChanges.clear();
+        if (fd_ < 0)
+            {
+            return { core::ExitCode::io_failure, "Watcher is not open." };
+            }
+
+        // Ordered so the caller sees a deterministic change list.
+        std::map<std::string, WatchChange> changes;
+        bool overflow = false;
+        alignas(struct inotify_event) std::array<char, 64 * 1024> buffer;
+
+        int waitMs = timeoutMs;
+        while (true)
+            {
+            pollfd descriptor{ fd_, POLLIN, 0 };
+            const int ready = ::poll(&descriptor, 1, waitMs);
+            if (ready < 0)
+                {
+                if (errno == EINTR)
+                    {
+                    continue;
+                    }
+                return { core::ExitCode::io_failure, std::string("Failed to wait for file changes: ") + std::strerror(errno) };
+                }
+            if (ready == 0)
+                {
+                break; // Timed out, or the debounce window passed quietly.
+                }
+
+            while (true)
+                {
+                const ssize_t length = ::read(fd_, buffer.data(), buffer.size());
+                if (length < 0 && errno == EINTR)
+                    {
+                    continue;
+                    }
+                if (length <= 0)
+                    {
+                    break;
+                    }
+
+                for (ssize_t offset = 0; offset < length;)
+                    {
+                    const auto* event = reinterpret_cast<const struct inotify_event*>(buffer.data() + offset);
+                    offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+
+                    if ((event->mask & IN_Q_OVERFLOW) != 0)
+                        {
+                        overflow = true;
+                        continue;
+                        }
+                    if ((event->mask & IN_IGNORED) != 0)
+                        {
+                        directories_.erase(event->wd);
+                        continue;
+                        }
+                    auto directory = directories_.find(event->wd);
+                    if (directory == directories_.end())
+                        {
+                        continue;
+                        }
+
+                    std::string relative = directory->second;
+                    if (event->len > 0 && event->name[0] != '\0')
+                        {
+                        relative = relative.empty() ? std::string(event->name) : relative + '/' + event->name;
+                        }
+
+                    WatchChange& change = changes[relative];
+                    change.relativePath = relative;
+                    change.structural = change.structural || (event->mask & kStructuralMask) != 0;
+                    change.isDirectory = change.isDirectory || (event->mask & IN_ISDIR) != 0
+                        || (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0;
+                    }
+                }
+
+            waitMs = std::max(0, debounceMs);
+            }
+
+        if (overflow)
+            {
+            WatchChange change;
+            change.structural = true;
+            change.overflow = true;
+            outChanges.push_back(change);
+            }
+        for (auto& entry : changes)
+            {
+            outChanges.push_back(std::move(entry.second));
+            }
+        return { core::ExitCode::success, "" };
+        }
+#else
+    DirectoryWatcher::~DirectoryWatcher() = default;
+
+    bool DirectoryWatcher::available()
+        {
+        return false;
+        }
+
+    core::RunResult DirectoryWatcher::open(const std::filesystem::path&)
+        {
+        return { core::ExitCode::invalid_usage, "--watch is only supported on Linux." };
+        }
+
+    bool DirectoryWatcher::addDirectory(const std::string&)
+        {
+        return false;
+        }
+
+    core::RunResult DirectoryWatcher::waitForChanges(int, int, std::vector<WatchChange>& outChanges)
+        {
+        outChanges.clear();
+        return { core::ExitCode::invalid_usage, "--watch is only supported on Linux." };
+        }
+#endif
+    }
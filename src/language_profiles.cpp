@@ -96,7 +96,7 @@ namespace repaddu::core
         return nullptr;
         }
 
-    DetectionResult detectLanguageAndBuildSystem(const std::vector<FileEntry>& files)
+    DetectionResult detectLanguageAndBuildSystem(const FileTable& files)
         {
         DetectionResult result;
 
@@ -109,9 +109,9 @@ namespace repaddu::core
         bool hasPythonBuild = false;
         bool hasMake = false;
 
-        for (const auto& file : files)
+        for (std::size_t index = 0; index < files.size(); ++index)
             {
-            const std::string filename = toLowerCopy(file.relativePath.filename().string());
+            const std::string filename = toLowerCopy(files.name(index));
             if (filename == "cmakelists.txt")
                 {
                 hasCMake = true;
@@ -144,19 +144,20 @@ namespace repaddu::core
                 hasMake = true;
                 }
 
-            if (file.isBinary)
+            if (files.binaryState(index) == BinaryState::binary)
                 {
                 continue;
                 }
 
+            const std::string_view extensionLower = files.extension(index);
             for (const auto& profile : languageProfiles())
                 {
                 bool matched = std::find(profile.sourceExtensions.begin(), profile.sourceExtensions.end(),
-                    file.extensionLower) != profile.sourceExtensions.end();
+                    extensionLower) != profile.sourceExtensions.end();
                 if (!matched && profile.supportsHeaders)
                     {
                     matched = std::find(profile.headerExtensions.begin(), profile.headerExtensions.end(),
-                        file.extensionLower) != profile.headerExtensions.end();
+                        extensionLower) != profile.headerExtensions.end();
                     }
                 if (matched)
                     {
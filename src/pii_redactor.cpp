@@ -1,6 +1,7 @@
 #include "repaddu/pii_redactor.h"
 #include "repaddu/logger.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace repaddu::security
@@ -8,84 +9,183 @@ namespace repaddu::security
     PiiRedactor::PiiRedactor()
         {
         // Email
-        patterns_.push_back({
-            std::regex(R"(\b[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}\b)"),
+        addPattern(R"(\b[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}\b)",
             "<REDACTED:EMAIL>",
-            "Email Address"
-        });
+            "Email Address");
 
         // IPv4 (Simplified)
-        patterns_.push_back({
-            std::regex(R"(\b(?:(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\.){3}(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\b)"),
+        addPattern(R"(\b(?:(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\.){3}(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\b)",
             "<REDACTED:IPV4>",
-            "IPv4 Address"
-        });
+            "IPv4 Address");
 
         // GitHub Personal Access Token
-        patterns_.push_back({
-            std::regex(R"(ghp_[a-zA-Z0-9]{36})"),
+        addPattern(R"(ghp_[a-zA-Z0-9]{36})",
             "<REDACTED:GITHUB_TOKEN>",
-            "GitHub Token"
-        });
+            "GitHub Token");
 
         // AWS Access Key ID
-        patterns_.push_back({
-            std::regex(R"((?:AKIA|ASIA)[0-9A-Z]{16})"),
+        addPattern(R"((?:AKIA|ASIA)[0-9A-Z]{16})",
             "<REDACTED:AWS_KEY>",
-            "AWS Access Key"
-        });
-        
+            "AWS Access Key");
+
         // Generic "API Key" assignment (conservative)
         // Look for "api_key = '...'"
-        patterns_.push_back({
-            std::regex(R"((api_key|secret_key|auth_token)\s*[:=]\s*['"]([a-zA-Z0-9_\-]{20,})['"])"),
+        addPattern(R"((api_key|secret_key|auth_token)\s*[:=]\s*['"]([a-zA-Z0-9_\-]{20,})['"])",
             "$1 = <REDACTED:SECRET>", // Preserves the key name
-            "Generic Secret Assignment"
-        });
+            "Generic Secret Assignment");
+        }
+
+    void PiiRedactor::addPattern(const char* source, std::string replacement, std::string name)
+        {
+        // FNV-1a over every field, with a zero byte after each one.
+        for (const std::string_view field : { std::string_view(source), std::string_view(replacement), std::string_view(name) })
+            {
+            for (const char ch : field)
+                {
+                ruleSetHash_ ^= static_cast<unsigned char>(ch);
+                ruleSetHash_ *= 1099511628211ULL;
+                }
+            ruleSetHash_ *= 1099511628211ULL;
+            }
+        patterns_.push_back({ std::regex(source), std::move(replacement), std::move(name) });
+        }
+
+    std::string PiiRedactor::redact(const std::string& input, const std::string& filePath) const
+        {
+        std::string result;
+        if (!redactInto(input, result, filePath))
+            {
+            return input;
+            }
+        return result;
         }
 
-    std::string PiiRedactor::redact(const std::string& input, const std::string& filePath)
+    bool PiiRedactor::redactInto(std::string_view input,
+        std::string& output,
+        const std::string& filePath,
+        bool logMatches) const
         {
-        std::string result = input;
         bool modified = false;
 
         for (const auto& pattern : patterns_)
             {
-            // We use a callback approach or just regex_replace?
-            // regex_replace replaces ALL occurrences.
-            // We also want to log if we found something.
-            
-            if (std::regex_search(result, pattern.regex))
+            // Search the borrowed input until the first match; only then copy.
+            const bool found = modified
+                ? std::regex_search(output, pattern.regex)
+                : std::regex_search(input.data(), input.data() + input.size(), pattern.regex);
+            if (!found)
+                {
+                continue;
+                }
+            if (!modified)
                 {
-                // We found matches.
-                // To get specific matches for logging, we can iterate. 
-                // But for performance, maybe we just replace and verify change.
-                
-                // Let's iterate to log "Found X in file Y"
-                auto begin = std::sregex_iterator(result.begin(), result.end(), pattern.regex);
+                output.assign(input);
+                modified = true;
+                }
+
+            // Log one line per match; the matched text itself is not logged.
+            if (logMatches)
+                {
+                auto begin = std::sregex_iterator(output.begin(), output.end(), pattern.regex);
                 auto end = std::sregex_iterator();
-                
                 for (std::sregex_iterator i = begin; i != end; ++i)
                     {
-                    std::smatch match = *i;
-                    std::string matchStr = match.str();
-                    // Avoid logging the actual secret if possible, or just log "Found GitHub Token"
-                    LogWarn("PII/Secret detected (" + pattern.name + ") in " + 
+                    LogWarn("PII/Secret detected (" + pattern.name + ") in " +
                             (filePath.empty() ? "content" : filePath));
                     }
+                }
+
+            // If the pattern is the generic one with groups, we need to handle format differently
+            if (pattern.name == "Generic Secret Assignment")
+                {
+                output = std::regex_replace(output, pattern.regex, "$1 = \"<REDACTED:SECRET>\"");
+                }
+            else
+                {
+                output = std::regex_replace(output, pattern.regex, pattern.replacement);
+                }
+            }
 
-                // If the pattern is the generic one with groups, we need to handle format differently
-                if (pattern.name == "Generic Secret Assignment")
+        return modified;
+        }
+
+    std::size_t PiiRedactor::safeSplit(std::string_view input, std::size_t preferred, std::size_t lookBehind) const
+        {
+        std::size_t cut = std::min(preferred, input.size());
+        const char* end = input.data() + input.size();
+        bool moved = true;
+        while (moved && cut > 0)
+            {
+            moved = false;
+            const std::size_t scanStart = cut > lookBehind ? cut - lookBehind : 0;
+            // Word boundaries at the scan start must see the preceding byte.
+            const auto flags = scanStart > 0 ? std::regex_constants::match_prev_avail : std::regex_constants::match_default;
+            for (const auto& pattern : patterns_)
+                {
+                for (std::cregex_iterator match(input.data() + scanStart, end, pattern.regex, flags), last;
+                    match != last; ++match)
                     {
-                    result = std::regex_replace(result, pattern.regex, "$1 = \"<REDACTED:SECRET>\"");
+                    const std::size_t matchStart = scanStart + static_cast<std::size_t>(match->position());
+                    if (matchStart >= cut)
+                        {
+                        break;
+                        }
+                    if (matchStart + static_cast<std::size_t>(match->length()) > cut)
+                        {
+                        cut = matchStart;
+                        moved = true;
+                        break;
+                        }
                     }
-                else
+                if (moved)
                     {
-                    result = std::regex_replace(result, pattern.regex, pattern.replacement);
+                    break;
                     }
                 }
             }
-        
-        return result;
+        return cut;
+        }
+
+    StreamingRedactor::StreamingRedactor(const PiiRedactor& redactor,
+        std::string filePath,
+        std::size_t overlapBytes,
+        bool logMatches)
+        : redactor_(redactor), filePath_(std::move(filePath)), overlapBytes_(overlapBytes), logMatches_(logMatches)
+        {
+        }
+
+    void StreamingRedactor::feed(std::string_view window, std::string& out)
+        {
+        pending_.append(window);
+        // Nothing is cut until there is more than the held-back overlap to emit.
+        if (pending_.size() <= 2 * overlapBytes_)
+            {
+            return;
+            }
+        const std::size_t cut = redactor_.safeSplit(pending_, pending_.size() - overlapBytes_, overlapBytes_);
+        if (cut > 0)
+            {
+            emit(cut, out);
+            }
+        }
+
+    void StreamingRedactor::finish(std::string& out)
+        {
+        emit(pending_.size(), out);
+        }
+
+    void StreamingRedactor::emit(std::size_t length, std::string& out)
+        {
+        const std::string_view head(pending_.data(), length);
+        std::string redacted;
+        if (redactor_.redactInto(head, redacted, filePath_, logMatches_))
+            {
+            out += redacted;
+            }
+        else
+            {
+            out.append(head);
+            }
+        pending_.erase(0, length);
         }
     }
@@ -14,19 +14,11 @@ void test_analysis_json()
     options.analysisEnabled = true;
     options.analysisViews = { "symbols" };
 
-    repaddu::core::FileEntry fileA;
-    fileA.relativePath = std::filesystem::path("src/a.cpp");
-    fileA.extensionLower = ".cpp";
-    fileA.sizeBytes = 100;
-    fileA.isBinary = false;
-
-    repaddu::core::FileEntry fileB;
-    fileB.relativePath = std::filesystem::path("include/b.hpp");
-    fileB.extensionLower = ".hpp";
-    fileB.sizeBytes = 40;
-    fileB.isBinary = false;
-
-    std::vector<repaddu::core::FileEntry> files = { fileA, fileB };
+    repaddu::core::FileTable files(options.inputPath);
+    files.add("src/a.cpp", 100);
+    files.add("include/b.hpp", 40);
+    files.setBinaryState(0, repaddu::core::BinaryState::text);
+    files.setBinaryState(1, repaddu::core::BinaryState::text);
     std::vector<std::size_t> included = { 0, 1 };
 
     repaddu::analysis::AnalysisGraph graph;
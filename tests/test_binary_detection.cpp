@@ -1,4 +1,8 @@
+#include "repaddu/core_binary.h"
+#include "repaddu/format_writer.h"
+#include "repaddu/grouping_strategies.h"
 #include "repaddu/io_binary.h"
+#include "repaddu/io_traversal.h"
 #include <fstream>
 #include <cassert>
 #include <filesystem>
@@ -48,11 +52,146 @@ void test_nul_detection()
     std::cout << "NUL detection passed." << std::endl;
     }
 
+void test_resolve_state()
+    {
+    using repaddu::core::BinaryState;
+    const std::string withNul("abc\0def", 7);
+    assert(repaddu::core::resolveBinaryState(BinaryState::unknown, withNul) == BinaryState::binary);
+    assert(repaddu::core::resolveBinaryState(BinaryState::unknown, "plain text") == BinaryState::text);
+    assert(repaddu::core::resolveBinaryState(BinaryState::text, withNul) == BinaryState::text);
+
+    // Only the leading sniff block is inspected.
+    std::string lateNul(repaddu::core::kSniffBytes, 'a');
+    lateNul.push_back('\0');
+    assert(repaddu::core::resolveBinaryState(BinaryState::unknown, lateNul) == BinaryState::text);
+    std::cout << "Binary state resolution passed." << std::endl;
+    }
+
+void test_content_verdicts()
+    {
+    using repaddu::core::BinaryKind;
+    using repaddu::core::ContentClass;
+    using repaddu::core::classifyContent;
+
+    assert(classifyContent("").contentClass == ContentClass::textUtf8);
+    assert(classifyContent("plain\ttext\r\n\x1b[0m").contentClass == ContentClass::textUtf8);
+
+    // Multi-byte sequences straddling the 16 and 32 byte vector blocks.
+    std::string utf8(30, 'a');
+    utf8 += "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+    utf8 += std::string(40, 'b');
+    const repaddu::core::ContentVerdict utf8Verdict = classifyContent(utf8);
+    assert(utf8Verdict.contentClass == ContentClass::textUtf8);
+    assert(utf8Verdict.embeddable());
+
+    // A sequence cut by the end of the sniffed block is still UTF-8.
+    assert(classifyContent(std::string(20, 'a') + "\xe2\x82").contentClass == ContentClass::textUtf8);
+    // Overlong encodings and surrogates are not.
+    assert(classifyContent(std::string(40, 'a') + "\xc0\xaf").contentClass == ContentClass::textLegacy);
+    assert(classifyContent(std::string(40, 'a') + "\xed\xa0\x80").contentClass == ContentClass::textLegacy);
+    const std::string latin1 = "caf\xe9 cr\xe8me";
+    const repaddu::core::ContentVerdict legacy = classifyContent(latin1);
+    assert(legacy.contentClass == ContentClass::textLegacy && legacy.embeddable());
+
+    const std::string bom8 = "\xef\xbb\xbfhello";
+    assert(classifyContent(bom8).contentClass == ContentClass::textUtf8);
+    const std::string bom16le("\xff\xfeh\0i\0", 6);
+    assert(classifyContent(bom16le).contentClass == ContentClass::textUtf16le);
+    const std::string bom16be("\xfe\xff\0h\0i", 6);
+    assert(classifyContent(bom16be).contentClass == ContentClass::textUtf16be);
+    const std::string bom32le("\xff\xfe\0\0h\0\0\0", 8);
+    assert(classifyContent(bom32le).contentClass == ContentClass::textUtf32le);
+
+    std::string utf16le;
+    std::string utf16be;
+    for (char ch : std::string("int main() { return 0; }\n"))
+        {
+        utf16le.push_back(ch);
+        utf16le.push_back('\0');
+        utf16be.push_back('\0');
+        utf16be.push_back(ch);
+        }
+    const repaddu::core::ContentVerdict le = classifyContent(utf16le);
+    assert(le.contentClass == ContentClass::textUtf16le && !le.embeddable());
+    assert(classifyContent(utf16be).contentClass == ContentClass::textUtf16be);
+
+    const std::string elf("\x7f" "ELF\x02\x01", 6);
+    const repaddu::core::ContentVerdict executable = classifyContent(elf);
+    assert(executable.contentClass == ContentClass::binary && executable.binaryKind == BinaryKind::executable);
+    assert(executable.signature == "ELF Executable");
+
+    // Two-letter signatures need binary content behind them.
+    assert(classifyContent("MZ is a text file").contentClass == ContentClass::textUtf8);
+    assert(classifyContent("BM notes").contentClass == ContentClass::textUtf8);
+    const std::string bitmap("BM\x36\0\0\0\0\0", 8);
+    assert(classifyContent(bitmap).binaryKind == BinaryKind::image);
+
+    std::string nul(50, 'a');
+    nul[37] = '\0';
+    assert(classifyContent(nul).binaryKind == BinaryKind::nulBytes);
+
+    std::string control(64, 'a');
+    for (std::size_t index = 0; index < 10; ++index)
+        {
+        control[index * 6] = '\x01';
+        }
+    assert(classifyContent(control).binaryKind == BinaryKind::controlBytes);
+    std::cout << "Content verdicts passed." << std::endl;
+    }
+
+void test_deferred_detection()
+    {
+    const fs::path root = fs::temp_directory_path() / "repaddu_deferred_binary";
+    fs::remove_all(root);
+    fs::create_directories(root / "in");
+    create_file((root / "in" / "main.cpp").string(), { 'i', 'n', 't', ' ', 'x', ';', '\n' });
+    create_file((root / "in" / "blob.cpp").string(), { 0x7f, 0x45, 0x4c, 0x46, 0x00, 0x01 });
+    create_file((root / "in" / "skip.bin").string(), { 0x00, 0x01 });
+
+    repaddu::core::CliOptions options;
+    options.inputPath = root / "in";
+    options.outputPath = root / "out";
+    options.emitCMake = false;
+    options.emitBuildFiles = false;
+
+    repaddu::io::TraversalResult traversal;
+    const repaddu::core::RunResult traversalResult = repaddu::io::traverseRepository(options, traversal);
+    assert(traversalResult.code == repaddu::core::ExitCode::success);
+    assert(traversal.files.size() == 3);
+    for (std::size_t index = 0; index < traversal.files.size(); ++index)
+        {
+        assert(traversal.files.binaryState(index) == repaddu::core::BinaryState::unknown);
+        }
+
+    repaddu::core::RunResult result;
+    const repaddu::grouping::GroupingResult grouped = repaddu::grouping::filterAndGroupFiles(options, traversal.files, nullptr, result);
+    assert(result.code == repaddu::core::ExitCode::success);
+    assert(grouped.includedIndices.size() == 2);
+    const std::vector<repaddu::core::OutputChunk> chunks = repaddu::grouping::chunkGroups(options, traversal.files, grouped.groups, result);
+    const repaddu::core::RunResult writeResult = repaddu::format::writeOutputs(options, traversal.files, chunks, "tree\n", {}, {});
+    assert(writeResult.code == repaddu::core::ExitCode::success);
+
+    std::string combined;
+    for (const auto& output : fs::directory_iterator(options.outputPath))
+        {
+        std::ifstream stream(output.path(), std::ios::binary);
+        combined.append(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        }
+    assert(combined.find("int x;") != std::string::npos);
+    assert(combined.find("blob.cpp") == std::string::npos);
+
+    fs::remove_all(root);
+    std::cout << "Deferred binary detection passed." << std::endl;
+    }
+
 int main()
     {
     test_png_detection();
     test_text_detection();
     test_nul_detection();
+    test_resolve_state();
+    test_content_verdicts();
+    test_deferred_detection();
     std::cout << "All binary detection tests passed!" << std::endl;
     return 0;
     }
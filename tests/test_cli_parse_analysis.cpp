@@ -89,6 +89,35 @@ void test_parallel_flags()
     assert(result.options.parallelTraversal == true);
     }
 
+void test_content_cache_flags()
+    {
+    std::vector<std::string> args =
+        {
+        "repaddu",
+        "--content-cache-mb",
+        "512",
+        "--content-cache-stats",
+        "--preallocate-outputs",
+        "--jsonl-shard-bytes",
+        "1048576",
+        "-i",
+        "input",
+        "-o",
+        "out"
+        };
+
+    auto result = repaddu::cli::parseArgs(args);
+    assert(result.result.code == repaddu::core::ExitCode::success);
+    assert(result.options.contentCacheMb == 512);
+    assert(result.options.contentCacheStats == true);
+    assert(result.options.preallocateOutputs == true);
+    assert(result.options.jsonlShardBytes == 1048576);
+
+    args = { "repaddu", "--content-cache-mb", "-4", "-i", "input", "-o", "out" };
+    result = repaddu::cli::parseArgs(args);
+    assert(result.result.code == repaddu::core::ExitCode::invalid_usage);
+    }
+
 void test_help_mentions_config_generation_formats()
     {
     const std::string help = repaddu::cli::helpText();
@@ -130,6 +159,17 @@ void test_format_flag_accepts_known_values()
     result = repaddu::cli::parseArgs(args);
     assert(result.result.code == repaddu::core::ExitCode::success);
     assert(result.options.format == repaddu::core::OutputFormat::html);
+
+    args = { "repaddu", "--format", "pack", "-i", "input", "-o", "out" };
+    result = repaddu::cli::parseArgs(args);
+    assert(result.result.code == repaddu::core::ExitCode::success);
+    assert(result.options.format == repaddu::core::OutputFormat::pack);
+
+    args = { "repaddu", "-i", "input", "-o", "-" };
+    result = repaddu::cli::parseArgs(args);
+    assert(result.result.code == repaddu::core::ExitCode::success);
+    args = { "repaddu", "--format", "pack", "-i", "input", "-o", "-" };
+    assert(repaddu::cli::parseArgs(args).result.code == repaddu::core::ExitCode::invalid_usage);
     }
 
 void test_format_flag_rejects_unknown_value()
@@ -147,7 +187,7 @@ void test_format_flag_rejects_unknown_value()
 
     const auto result = repaddu::cli::parseArgs(args);
     assert(result.result.code == repaddu::core::ExitCode::invalid_usage);
-    assert(result.result.message.find("--format must be one of: markdown, jsonl, html.") != std::string::npos);
+    assert(result.result.message.find("--format must be one of: markdown, jsonl, html, pack.") != std::string::npos);
     }
 
 int main()
@@ -155,6 +195,7 @@ int main()
     test_analysis_flags();
     test_invalid_collapse();
     test_parallel_flags();
+    test_content_cache_flags();
     test_help_mentions_config_generation_formats();
     test_format_flag_accepts_known_values();
     test_format_flag_rejects_unknown_value();
@@ -3,7 +3,9 @@
 
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <string>
 
 namespace
     {
@@ -18,13 +20,13 @@ namespace
             }
         }
 
-    bool sameFileEntry(const repaddu::core::FileEntry& lhs, const repaddu::core::FileEntry& rhs)
+    bool sameFileRow(const repaddu::core::FileTable& lhs, const repaddu::core::FileTable& rhs, std::size_t index)
         {
-        return lhs.relativePath == rhs.relativePath
-            && lhs.sizeBytes == rhs.sizeBytes
-            && lhs.extensionLower == rhs.extensionLower
-            && lhs.isBinary == rhs.isBinary
-            && lhs.fileClass == rhs.fileClass;
+        return lhs.relativePath(index) == rhs.relativePath(index)
+            && lhs.sizeBytes(index) == rhs.sizeBytes(index)
+            && lhs.extension(index) == rhs.extension(index)
+            && lhs.binaryState(index) == rhs.binaryState(index)
+            && lhs.fileClass(index) == rhs.fileClass(index);
         }
 
     void compareTraversal(const repaddu::io::TraversalResult& singleThread,
@@ -43,7 +45,7 @@ namespace
             {
             for (std::size_t index = 0; index < singleThread.files.size(); ++index)
                 {
-                expectTrue(sameFileEntry(singleThread.files[index], parallelThread.files[index]),
+                expectTrue(sameFileRow(singleThread.files, parallelThread.files, index),
                     "File entry mismatch between single-thread and parallel traversal");
                 }
             }
@@ -103,6 +105,53 @@ namespace
             {
             compareTraversal(singleTraversal, parallelTraversal);
             }
+
+        for (bool parallel : { false, true })
+            {
+            repaddu::core::CliOptions nativeOptions = singleOptions;
+            nativeOptions.traversalBackend = repaddu::core::TraversalBackend::native;
+            nativeOptions.parallelTraversal = parallel;
+            repaddu::io::TraversalResult nativeTraversal;
+            repaddu::core::RunResult nativeResult = repaddu::io::traverseRepository(nativeOptions, nativeTraversal);
+            expectTrue(nativeResult.code == repaddu::core::ExitCode::success,
+                "Native traversal must succeed");
+            if (singleResult.code == repaddu::core::ExitCode::success
+                && nativeResult.code == repaddu::core::ExitCode::success)
+                {
+                compareTraversal(singleTraversal, nativeTraversal);
+                }
+            }
+        }
+
+    void testLargeDirectoryBatching()
+        {
+        // More entries than one scheduler batch so the directory is split across tasks.
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "repaddu_concurrency_large_dir";
+        std::error_code errorCode;
+        std::filesystem::remove_all(root, errorCode);
+        std::filesystem::create_directories(root / "wide", errorCode);
+        for (int index = 0; index < 700; ++index)
+            {
+            std::ofstream(root / "wide" / ("file_" + std::to_string(index) + ".cpp")) << "int v" << index << ";\n";
+            if (index % 100 == 0)
+                {
+                const std::filesystem::path nested = root / "wide" / ("dir_" + std::to_string(index));
+                std::filesystem::create_directories(nested, errorCode);
+                std::ofstream(nested / "CMakeLists.txt") << "project(x)\n";
+                }
+            }
+
+        testTraversalDeterminism(root);
+
+        repaddu::core::CliOptions options;
+        options.inputPath = root;
+        repaddu::io::TraversalResult traversal;
+        const repaddu::core::RunResult result = repaddu::io::traverseRepository(options, traversal);
+        expectTrue(result.code == repaddu::core::ExitCode::success, "Parallel traversal of a wide directory must succeed");
+        expectTrue(traversal.files.size() == 707, "Parallel traversal must report every file of a wide directory");
+        expectTrue(traversal.cmakeLists.size() == 7, "Parallel traversal must report nested CMakeLists of a wide directory");
+
+        std::filesystem::remove_all(root, errorCode);
         }
     }
 
@@ -111,6 +160,7 @@ int main()
     const std::filesystem::path fixtureRoot = std::filesystem::path(REPADDU_TEST_ROOT) / "fixtures";
     testTraversalDeterminism(fixtureRoot / "sample_repo");
     testTraversalDeterminism(fixtureRoot / "multi_language");
+    testLargeDirectoryBatching();
 
     return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
     }
@@ -0,0 +1,169 @@
+#include "repaddu/core_file_table.h"
+
+#include <cassert>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void test_add_derives_columns()
+    {
+    repaddu::core::FileTable files("/repo");
+    const std::size_t header = files.add("include/Widget.HPP", 120);
+    const std::size_t rootFile = files.add("Makefile", 7);
+    const std::size_t dotFile = files.add("src/.clang-format", 3);
+
+    assert(files.size() == 3);
+    assert(files.directory(header) == "include");
+    assert(files.name(header) == "Widget.HPP");
+    assert(files.extension(header) == ".hpp");
+    assert(files.fileClass(header) == repaddu::core::FileClass::header);
+    assert(files.sizeBytes(header) == 120);
+    assert(files.tokenCount(header) == 0);
+    assert(files.binaryState(header) == repaddu::core::BinaryState::unknown);
+
+    assert(files.directory(rootFile).empty());
+    assert(files.extension(rootFile).empty());
+    assert(files.fileClass(rootFile) == repaddu::core::FileClass::other);
+    assert(files.extension(dotFile).empty());
+
+    assert(files.relativePath(header) == "include/Widget.HPP");
+    assert(files.relativePath(rootFile) == "Makefile");
+    assert(files.absolutePath(header) == std::filesystem::path("/repo") / "include" / "Widget.HPP");
+    assert(files.absolutePath(rootFile) == std::filesystem::path("/repo") / "Makefile");
+    }
+
+void test_setters_keep_other_bits()
+    {
+    repaddu::core::FileTable files;
+    const std::size_t index = files.add("src/main.cpp", 10);
+    files.setBinaryState(index, repaddu::core::BinaryState::binary);
+    files.setTokenCount(index, 42);
+    files.setSizeBytes(index, 11);
+
+    assert(files.binaryState(index) == repaddu::core::BinaryState::binary);
+    assert(files.fileClass(index) == repaddu::core::FileClass::source);
+    assert(files.tokenCount(index) == 42);
+    assert(files.sizeBytes(index) == 11);
+
+    files.setBinaryState(index, repaddu::core::BinaryState::text);
+    assert(files.binaryState(index) == repaddu::core::BinaryState::text);
+    assert(files.fileClass(index) == repaddu::core::FileClass::source);
+    }
+
+void test_sort_matches_string_order()
+    {
+    // '-' sorts before '/', so "a-c" precedes "a/b" as whole strings even
+    // though directory "a" is a prefix of "a-c".
+    repaddu::core::FileTable files;
+    files.add("a/b", 1);
+    files.add("a-c", 1);
+    files.add("a/a", 1);
+    files.add("B", 1);
+    files.add("a0/x", 1);
+    files.sortByPath();
+
+    const std::string expected[] = { "B", "a-c", "a/a", "a/b", "a0/x" };
+    assert(files.size() == 5);
+    for (std::size_t index = 0; index < files.size(); ++index)
+        {
+        assert(files.relativePath(index) == expected[index]);
+        }
+    for (std::size_t index = 0; index + 1 < files.size(); ++index)
+        {
+        assert(files.pathLess(index, index + 1));
+        assert(!files.pathLess(index + 1, index));
+        }
+    }
+
+void test_merge_sorted_runs()
+    {
+    // Enough rows to split the merge into several segments.
+    const std::size_t runCount = 5;
+    std::vector<repaddu::core::FileTable> runs(runCount);
+    repaddu::core::FileTable expected;
+    for (std::size_t index = 0; index < 90000; ++index)
+        {
+        const std::string path = "dir" + std::to_string(index % 37) + (index % 3 == 0 ? "-x/" : "/")
+            + "f" + std::to_string(index * 7919 % 100003) + ".cpp";
+        runs[index % runCount].add(path, index);
+        expected.add(path, index);
+        }
+    for (repaddu::core::FileTable& run : runs)
+        {
+        run.sortByPath();
+        }
+    expected.sortByPath();
+
+    repaddu::core::FileTable merged("/root");
+    merged.mergeSortedRuns(runs, 4);
+    assert(merged.sortedByPath());
+    assert(merged.root() == std::filesystem::path("/root"));
+    assert(merged.size() == expected.size());
+    for (std::size_t index = 0; index < merged.size(); ++index)
+        {
+        assert(merged.relativePath(index) == expected.relativePath(index));
+        assert(merged.sizeBytes(index) == expected.sizeBytes(index));
+        }
+
+    repaddu::core::FileTable serial;
+    serial.mergeSortedRuns(runs, 1);
+    assert(serial.size() == merged.size());
+    assert(serial.relativePath(serial.size() - 1) == merged.relativePath(merged.size() - 1));
+    }
+
+void test_append_remove_and_find()
+    {
+    repaddu::core::FileTable left;
+    left.add("src/a.cpp", 1);
+    repaddu::core::FileTable right;
+    right.add("include/b.h", 2);
+    right.add("src/c.cpp", 3);
+    right.setBinaryState(1, repaddu::core::BinaryState::binary);
+
+    left.append(right);
+    assert(left.size() == 3);
+    assert(left.relativePath(1) == "include/b.h");
+    assert(left.directoryId(0) == left.directoryId(2));
+    assert(left.binaryState(2) == repaddu::core::BinaryState::binary);
+
+    const std::optional<std::size_t> found = left.find("src/c.cpp");
+    assert(found.has_value() && *found == 2);
+    assert(!left.find("src/b.h").has_value());
+    assert(!left.find("missing/a.cpp").has_value());
+
+    const std::size_t removed = left.removeIf([&left](std::size_t index)
+        {
+        return left.directory(index) == "src";
+        });
+    assert(removed == 2);
+    assert(left.size() == 1);
+    assert(left.relativePath(0) == "include/b.h");
+    assert(left.sizeBytes(0) == 2);
+    }
+
+void test_rows_stay_compact()
+    {
+    repaddu::core::FileTable files;
+    const std::size_t rowCount = 10000;
+    files.reserve(rowCount);
+    for (std::size_t index = 0; index < rowCount; ++index)
+        {
+        files.add("src/module" + std::to_string(index % 50) + "/file" + std::to_string(index) + ".cpp", index);
+        }
+    // Columns take 33 bytes per row plus the ~12 byte file name.
+    const std::size_t perRow = files.memoryBytes() / rowCount;
+    assert(perRow < 64);
+    }
+
+int main()
+    {
+    test_add_derives_columns();
+    test_setters_keep_other_bits();
+    test_sort_matches_string_order();
+    test_merge_sorted_runs();
+    test_append_remove_and_find();
+    test_rows_stay_compact();
+    std::cout << "All file table tests passed." << std::endl;
+    return 0;
+    }
@@ -1,5 +1,6 @@
 #include "repaddu/core_types.h"
 #include "repaddu/grouping_strategies.h"
+#include "repaddu/io_binary.h"
 #include "repaddu/io_traversal.h"
 
 #include <cstdlib>
@@ -41,9 +42,9 @@ int main()
 
     bool hasGit = false;
     bool hasHidden = false;
-    for (const auto& entry : traversal.files)
+    for (std::size_t index = 0; index < traversal.files.size(); ++index)
         {
-        const std::string rel = entry.relativePath.generic_string();
+        const std::string rel = traversal.files.relativePath(index);
         if (rel.find(".git") != std::string::npos)
             {
             hasGit = true;
@@ -72,6 +73,10 @@ int main()
     options.includeSources = false;
     options.includeBinaries = false;
     grouped = repaddu::grouping::filterAndGroupFiles(options, traversal.files, nullptr, groupingResult);
+    expectEqual(grouped.includedIndices.size(), 1, "Unsniffed binary file should survive grouping");
+
+    repaddu::io::resolveBinaryStates(traversal.files, grouped.includedIndices);
+    grouped = repaddu::grouping::filterAndGroupFiles(options, traversal.files, nullptr, groupingResult);
     expectEqual(grouped.includedIndices.size(), 0, "Binary exclusion should drop binary file");
 
     return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
@@ -19,13 +19,13 @@ int main()
 
     bool sawHeader = false;
     bool sawExample = false;
-    for (const auto& entry : traversal.files)
+    for (std::size_t index = 0; index < traversal.files.size(); ++index)
         {
-        if (entry.relativePath == std::filesystem::path("include/picobench/picobench.hpp"))
+        if (traversal.files.relativePath(index) == "include/picobench/picobench.hpp")
             {
             sawHeader = true;
             }
-        if (entry.relativePath == std::filesystem::path("example/basic.cpp"))
+        if (traversal.files.relativePath(index) == "example/basic.cpp")
             {
             sawExample = true;
             }
@@ -1,9 +1,15 @@
 #include "repaddu/format_writer.h"
+#include "repaddu/logger.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace
     {
@@ -14,15 +20,11 @@ namespace
         return data;
         }
 
-    repaddu::core::FileEntry makeEntry(const std::filesystem::path& repoRoot)
+    repaddu::core::FileTable makeTable(const std::filesystem::path& repoRoot)
         {
-        repaddu::core::FileEntry entry;
-        entry.absolutePath = repoRoot / "src" / "main.cpp";
-        entry.relativePath = std::filesystem::path("src/main.cpp");
-        entry.extensionLower = ".cpp";
-        entry.fileClass = repaddu::core::FileClass::source;
-        entry.sizeBytes = std::filesystem::file_size(entry.absolutePath);
-        return entry;
+        repaddu::core::FileTable files(repoRoot);
+        files.add("src/main.cpp", std::filesystem::file_size(repoRoot / "src" / "main.cpp"));
+        return files;
         }
 
     std::filesystem::path makeTempOutDir(const std::string& name)
@@ -34,15 +36,79 @@ namespace
         return path;
         }
 
-    repaddu::core::FileEntry makeCustomEntry(const std::filesystem::path& absolutePath, const std::filesystem::path& relativePath)
+    repaddu::core::FileTable makeCustomTable(const std::filesystem::path& root, const std::string& relativePath)
         {
-        repaddu::core::FileEntry entry;
-        entry.absolutePath = absolutePath;
-        entry.relativePath = relativePath;
-        entry.extensionLower = repaddu::core::toLowerCopy(absolutePath.extension().string());
-        entry.fileClass = repaddu::core::classifyExtension(entry.extensionLower);
-        entry.sizeBytes = std::filesystem::file_size(absolutePath);
-        return entry;
+        repaddu::core::FileTable files(root);
+        files.add(relativePath, std::filesystem::file_size(root / relativePath));
+        return files;
+        }
+
+    // Files written under a fresh input directory, all in one source chunk.
+    struct SourceInput
+        {
+        std::filesystem::path root;
+        repaddu::core::FileTable files;
+        repaddu::core::OutputChunk chunk;
+        };
+
+    SourceInput makeSourceInput(const std::string& name,
+        const std::vector<std::pair<std::string, std::string>>& bodies)
+        {
+        SourceInput input;
+        input.root = makeTempOutDir(name);
+        input.files.setRoot(input.root);
+        input.chunk.category = "source";
+        input.chunk.title = "source";
+        for (const auto& [relativePath, body] : bodies)
+            {
+            std::ofstream(input.root / relativePath, std::ios::binary) << body;
+            input.chunk.fileIndices.push_back(input.files.add(relativePath, body.size()));
+            }
+        return input;
+        }
+
+    // Markdown options that write the overview and the parts only.
+    repaddu::core::CliOptions partsOnlyOptions(const SourceInput& input)
+        {
+        repaddu::core::CliOptions options;
+        options.inputPath = input.root;
+        options.emitTree = false;
+        options.emitCMake = false;
+        options.emitBuildFiles = false;
+        return options;
+        }
+
+    // Writes input into a fresh directory named after the pass and returns it.
+    std::filesystem::path writePass(repaddu::core::CliOptions& options,
+        const SourceInput& input,
+        const std::string& name,
+        int pass,
+        repaddu::format::OutputCache* cache = nullptr,
+        const std::string& treeListing = "",
+        const std::vector<std::filesystem::path>& cmakeLists = {})
+        {
+        options.outputPath = makeTempOutDir(name + std::to_string(pass));
+        const auto result = repaddu::format::writeOutputs(options, input.files, { input.chunk }, treeListing,
+            cmakeLists, {}, cache);
+        assert(result.code == repaddu::core::ExitCode::success);
+        return options.outputPath;
+        }
+
+    // Every output's name followed by its content, in name order.
+    std::string readOutputs(const std::filesystem::path& directory)
+        {
+        std::vector<std::string> names;
+        for (const auto& entry : std::filesystem::directory_iterator(directory))
+            {
+            names.push_back(entry.path().filename().string());
+            }
+        std::sort(names.begin(), names.end());
+        std::string outputs;
+        for (const std::string& name : names)
+            {
+            outputs += name + "\n" + readText(directory / name);
+            }
+        return outputs;
         }
     }
 
@@ -58,7 +124,7 @@ void test_frontmatter_enabled()
     options.emitBuildFiles = false;
     options.emitFrontmatter = true;
 
-    std::vector<repaddu::core::FileEntry> files = { makeEntry(repoRoot) };
+    const repaddu::core::FileTable files = makeTable(repoRoot);
     repaddu::core::OutputChunk chunk;
     chunk.category = "source";
     chunk.title = "source";
@@ -83,7 +149,7 @@ void test_frontmatter_disabled()
     options.emitBuildFiles = false;
     options.emitFrontmatter = false;
 
-    std::vector<repaddu::core::FileEntry> files = { makeEntry(repoRoot) };
+    const repaddu::core::FileTable files = makeTable(repoRoot);
     repaddu::core::OutputChunk chunk;
     chunk.category = "source";
     chunk.title = "source";
@@ -108,7 +174,7 @@ void test_overview_links_disabled()
     options.emitBuildFiles = false;
     options.emitLinks = false;
 
-    std::vector<repaddu::core::FileEntry> files = { makeEntry(repoRoot) };
+    const repaddu::core::FileTable files = makeTable(repoRoot);
     repaddu::core::OutputChunk chunk;
     chunk.category = "source";
     chunk.title = "source";
@@ -141,10 +207,7 @@ void test_jsonl_output_writes_dataset_and_escapes_content()
     options.outputPath = outputRoot;
     options.format = repaddu::core::OutputFormat::jsonl;
 
-    std::vector<repaddu::core::FileEntry> files =
-        {
-        makeCustomEntry(sourcePath, std::filesystem::path("src/escaped.cpp"))
-        };
+    const repaddu::core::FileTable files = makeCustomTable(inputRoot, "src/escaped.cpp");
 
     repaddu::core::OutputChunk chunk;
     chunk.category = "source";
@@ -184,7 +247,7 @@ void test_jsonl_dry_run_writes_nothing()
     options.format = repaddu::core::OutputFormat::jsonl;
     options.dryRun = true;
 
-    std::vector<repaddu::core::FileEntry> files = { makeEntry(repoRoot) };
+    const repaddu::core::FileTable files = makeTable(repoRoot);
     repaddu::core::OutputChunk chunk;
     chunk.category = "source";
     chunk.title = "source";
@@ -195,6 +258,261 @@ void test_jsonl_dry_run_writes_nothing()
     assert(!std::filesystem::exists(outputRoot / "dataset.jsonl"));
     }
 
+void test_jsonl_shards_concatenate_to_single_dataset()
+    {
+    std::vector<std::pair<std::string, std::string>> bodies;
+    for (int index = 0; index < 200; ++index)
+        {
+        bodies.emplace_back("f" + std::to_string(index) + ".cpp",
+            std::string(static_cast<std::size_t>(index * 13 % 700), 'z') + "\x01\t\"q\" mail" + std::to_string(index)
+                + "@example.com\n");
+        }
+    const SourceInput input = makeSourceInput("repaddu_jsonl_shard_in", bodies);
+
+    repaddu::core::CliOptions options;
+    options.inputPath = input.root;
+    options.format = repaddu::core::OutputFormat::jsonl;
+    options.redactPii = true;
+
+    writePass(options, input, "repaddu_jsonl_shard_single", 0);
+    const std::string single = readText(options.outputPath / "dataset.jsonl");
+    assert(single.find("\\u0001\\t\\\"q\\\" <REDACTED:EMAIL>\\n") != std::string::npos);
+    assert(!std::filesystem::exists(options.outputPath / "dataset.manifest.json"));
+
+    // Sharded output matches whether records were rendered in parallel or not.
+    options.jsonlShardBytes = 4096;
+    std::string sharded[2];
+    for (int pass = 0; pass < 2; ++pass)
+        {
+        options.parallelTraversal = pass == 0;
+        options.outputPath = makeTempOutDir("repaddu_jsonl_shard_out" + std::to_string(pass));
+        // A shard beyond this run's last one is removed.
+        std::ofstream(options.outputPath / "dataset-00050.jsonl") << "stale\n";
+        assert(repaddu::format::writeOutputs(options, input.files, { input.chunk }, "", {}, {}).code
+            == repaddu::core::ExitCode::success);
+        assert(!std::filesystem::exists(options.outputPath / "dataset.jsonl"));
+
+        std::size_t shard = 0;
+        for (;; ++shard)
+            {
+            std::string name = std::to_string(shard);
+            name = "dataset-" + std::string(5 - name.size(), '0') + name + ".jsonl";
+            if (!std::filesystem::exists(options.outputPath / name))
+                {
+                break;
+                }
+            const std::string text = readText(options.outputPath / name);
+            assert(text.size() <= options.jsonlShardBytes && !text.empty() && text.back() == '\n');
+            sharded[pass] += text;
+            }
+        assert(shard > 1 && shard < 50);
+        assert(!std::filesystem::exists(options.outputPath / "dataset-00050.jsonl"));
+        const std::string manifest = readText(options.outputPath / "dataset.manifest.json");
+        assert(manifest.find("\"file\": \"dataset-00000.jsonl\"") != std::string::npos);
+        assert(manifest.find("\"records\": 200\n}") != std::string::npos);
+        }
+    assert(sharded[0] == single && sharded[1] == single);
+    }
+
+void test_single_pass_splits_parts_and_stages_outputs()
+    {
+    const std::string body = std::string(3000, 'x') + "\n";
+    const SourceInput input = makeSourceInput("repaddu_single_pass_in",
+        { { "a.cpp", body }, { "b.cpp", body }, { "c.cpp", body } });
+
+    repaddu::core::CliOptions options = partsOnlyOptions(input);
+    options.maxBytes = 4000;
+
+    writePass(options, input, "repaddu_single_pass_out", 0);
+    for (const char* name : { "001_source.md", "002_source_part2.md", "003_source_part3.md" })
+        {
+        const std::filesystem::path part = options.outputPath / name;
+        assert(std::filesystem::exists(part));
+        assert(std::filesystem::file_size(part) <= options.maxBytes);
+        }
+    assert(readText(options.outputPath / "000_overview.md").find("003_source_part3.md") != std::string::npos);
+    for (const auto& entry : std::filesystem::directory_iterator(options.outputPath))
+        {
+        assert(entry.path().extension() != ".partial");
+        }
+
+    // Exceeding --max-files halfway through leaves nothing behind.
+    options.outputPath = makeTempOutDir("repaddu_single_pass_limit");
+    options.maxFiles = 3;
+    const auto result = repaddu::format::writeOutputs(options, input.files, { input.chunk }, "", {}, {});
+    assert(result.code == repaddu::core::ExitCode::output_constraints);
+    assert(std::filesystem::is_empty(options.outputPath));
+    }
+
+void test_parallel_preparation_matches_single_thread()
+    {
+    std::vector<std::pair<std::string, std::string>> bodies;
+    for (int index = 0; index < 300; ++index)
+        {
+        bodies.emplace_back("f" + std::to_string(index) + ".cpp",
+            std::string(static_cast<std::size_t>(index * 7 % 500), 'y') + " mail" + std::to_string(index)
+                + "@example.com\n");
+        }
+    const SourceInput input = makeSourceInput("repaddu_prepare_in", bodies);
+
+    repaddu::core::CliOptions options = partsOnlyOptions(input);
+    options.redactPii = true;
+    options.maxBytes = 8000;
+
+    std::string outputs[2];
+    for (int pass = 0; pass < 2; ++pass)
+        {
+        options.parallelTraversal = pass == 0;
+        outputs[pass] = readOutputs(writePass(options, input, "repaddu_prepare_out", pass));
+        }
+    assert(outputs[0] == outputs[1]);
+    assert(outputs[0].find("002_source_part2.md") != std::string::npos);
+    assert(outputs[0].find("<REDACTED:EMAIL>") != std::string::npos);
+    }
+
+void test_content_store_reuses_redacted_content()
+    {
+    const SourceInput input = makeSourceInput("repaddu_store_in",
+        { { "s0.cpp", "int a; // a@example.com\n" }, { "s1.cpp", "int b;\n" }, { "s2.cpp", "// ping 10.0.0.1\n" } });
+    // Files written just now fall in the racy window and are never stored.
+    for (const auto& entry : std::filesystem::directory_iterator(input.root))
+        {
+        std::filesystem::last_write_time(entry.path(),
+            std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+        }
+    const std::filesystem::path storeDir = makeTempOutDir("repaddu_store_db");
+
+    repaddu::core::CliOptions options = partsOnlyOptions(input);
+    options.redactPii = true;
+    options.contentStorePath = storeDir;
+    options.contentCacheStats = true;
+
+    // The store's hit counts are only visible in the log.
+    const std::filesystem::path logPath = makeTempOutDir("repaddu_store_log") / "run.log";
+    repaddu::Logger::instance().setLogFile(logPath.string());
+
+    // Only the second pass reads a store that holds every file; the third
+    // finds it corrupt and starts over.
+    const char* expectedStats[3] = { "Content store: 0 hits, 3 misses, 3 insertions",
+        "Content store: 3 hits, 0 misses, 0 insertions", "Content store: 0 hits, 3 misses, 3 insertions" };
+    std::string outputs[3];
+    for (int pass = 0; pass < 3; ++pass)
+        {
+        if (pass == 2)
+            {
+            std::ofstream(storeDir / "index", std::ios::trunc) << "not an index";
+            }
+        const std::size_t logStart = readText(logPath).size();
+        outputs[pass] = readText(writePass(options, input, "repaddu_store_out", pass) / "001_source.md");
+        assert(readText(logPath).find(expectedStats[pass], logStart) != std::string::npos);
+        // A 24-byte header and one 88-byte record per file.
+        assert(std::filesystem::file_size(storeDir / "index") == 24 + 3 * 88);
+        assert(std::filesystem::exists(storeDir / "pack"));
+        }
+    assert(outputs[0] == outputs[1]);
+    assert(outputs[0] == outputs[2]);
+    assert(outputs[0].find("<REDACTED:EMAIL>") != std::string::npos);
+    assert(outputs[0].find("int b;") != std::string::npos);
+    }
+
+void test_streamed_large_file_matches_whole_read()
+    {
+    // Just over 1.5 MiB so the file spans two windows, with no final newline.
+    // Redaction across window boundaries is covered by the PII tests.
+    std::string big;
+    while (big.size() < 1536 * 1024)
+        {
+        big += "line " + std::to_string(big.size()) + "\n";
+        }
+    big.pop_back();
+    const SourceInput input = makeSourceInput("repaddu_stream_in",
+        { { "big.log", big }, { "small.cpp", "int small;\n" } });
+
+    repaddu::core::CliOptions options = partsOnlyOptions(input);
+
+    // Whole read, streamed single pass, streamed planned pass.
+    std::string outputs[3];
+    for (int pass = 0; pass < 3; ++pass)
+        {
+        options.streamThresholdMb = pass == 0 ? 0 : 1;
+        repaddu::format::OutputCache cache;
+        outputs[pass] = readText(writePass(options, input, "repaddu_stream_out", pass, pass == 2 ? &cache : nullptr)
+            / "001_source.md");
+        }
+    assert(outputs[0] == outputs[1]);
+    assert(outputs[0] == outputs[2]);
+    assert(outputs[0].find(big.substr(big.size() - 20) + "\n```\n") != std::string::npos);
+    }
+
+void test_copied_bodies_match_held_writes()
+    {
+    // Above a 1 MiB stream threshold, without a final newline and nothing to redact.
+    std::string body;
+    while (body.size() < 1200 * 1024)
+        {
+        body += "value " + std::to_string(body.size()) + ";\n";
+        }
+    body.pop_back();
+    const SourceInput input = makeSourceInput("repaddu_copy_in", { { "big.cpp", body } });
+
+    repaddu::core::CliOptions options = partsOnlyOptions(input);
+    options.markers = repaddu::core::MarkerMode::sentinel;
+
+    // Streamed and copied by the kernel in a single and a planned pass, then
+    // held whole and written from memory.
+    std::string outputs[3];
+    for (int pass = 0; pass < 3; ++pass)
+        {
+        options.streamThresholdMb = pass == 2 ? 0 : 1;
+        repaddu::format::OutputCache cache;
+        outputs[pass] = readText(writePass(options, input, "repaddu_copy_out", pass, pass == 1 ? &cache : nullptr)
+            / "001_source.md");
+        }
+    assert(outputs[0] == outputs[1]);
+    assert(outputs[0] == outputs[2]);
+    assert(outputs[0].find(body.substr(body.size() - 20) + "\n@@@ REPADDU FILE END @@@\n") != std::string::npos);
+    }
+
+void test_preallocated_outputs_match_single_pass()
+    {
+    std::vector<std::pair<std::string, std::string>> bodies;
+    std::string big;
+    while (big.size() < 100 * 1024)
+        {
+        big += "int v" + std::to_string(big.size()) + " = 1;\n";
+        }
+    bodies.emplace_back("big.cpp", big);
+    for (int index = 0; index < 40; ++index)
+        {
+        bodies.emplace_back("f" + std::to_string(index) + ".cpp",
+            "int f" + std::to_string(index) + "() { return " + std::to_string(index) + "; } // ops@example.com");
+        }
+    const SourceInput input = makeSourceInput("repaddu_prealloc_in", bodies);
+    std::ofstream(input.root / "CMakeLists.txt") << "project(p)\n";
+
+    repaddu::core::CliOptions options;
+    options.inputPath = input.root;
+    options.emitBuildFiles = false;
+    // The big block fills most of the first part; the small ones spill over.
+    options.maxBytes = big.size() + 2048;
+
+    // Redacting and copying bodies, each written in one pass and preallocated.
+    for (const bool redact : { false, true })
+        {
+        options.redactPii = redact;
+        std::string outputs[2];
+        for (int pass = 0; pass < 2; ++pass)
+            {
+            options.preallocateOutputs = pass == 1;
+            outputs[pass] = readOutputs(writePass(options, input, "repaddu_prealloc_out", pass, nullptr, "tree\n",
+                { input.root / "CMakeLists.txt" }));
+            }
+        assert(outputs[0] == outputs[1]);
+        assert(outputs[1].find("004_source_part2.md") != std::string::npos);
+        assert((outputs[1].find("<REDACTED:EMAIL>") != std::string::npos) == redact);
+        }
+    }
+
 int main()
     {
     test_frontmatter_enabled();
@@ -202,6 +520,13 @@ int main()
     test_overview_links_disabled();
     test_jsonl_output_writes_dataset_and_escapes_content();
     test_jsonl_dry_run_writes_nothing();
+    test_jsonl_shards_concatenate_to_single_dataset();
+    test_single_pass_splits_parts_and_stages_outputs();
+    test_parallel_preparation_matches_single_thread();
+    test_content_store_reuses_redacted_content();
+    test_streamed_large_file_matches_whole_read();
+    test_copied_bodies_match_held_writes();
+    test_preallocated_outputs_match_single_pass();
     std::cout << "Frontmatter output tests passed." << std::endl;
     return 0;
     }
@@ -0,0 +1,263 @@
+#include "repaddu/app/fs_services.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+    {
+    int g_failures = 0;
+
+    void expectTrue(bool value, const char* message)
+        {
+        if (!value)
+            {
+            std::cerr << "FAIL: " << message << "\n";
+            ++g_failures;
+            }
+        }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+        {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << content;
+        }
+
+    void appendBigEndian32(std::string& out, std::uint32_t value)
+        {
+        out.push_back(static_cast<char>((value >> 24) & 0xff));
+        out.push_back(static_cast<char>((value >> 16) & 0xff));
+        out.push_back(static_cast<char>((value >> 8) & 0xff));
+        out.push_back(static_cast<char>(value & 0xff));
+        }
+
+    void appendBigEndian16(std::string& out, std::uint16_t value)
+        {
+        out.push_back(static_cast<char>((value >> 8) & 0xff));
+        out.push_back(static_cast<char>(value & 0xff));
+        }
+
+    void appendPrefixVarint(std::string& out, std::size_t value)
+        {
+        unsigned char bytes[16];
+        std::size_t position = sizeof(bytes) - 1;
+        bytes[position] = static_cast<unsigned char>(value & 0x7f);
+        while (value >>= 7)
+            {
+            --value;
+            bytes[--position] = static_cast<unsigned char>(0x80 | (value & 0x7f));
+            }
+        out.append(reinterpret_cast<const char*>(bytes + position), sizeof(bytes) - position);
+        }
+
+    struct TestEntry
+        {
+        std::string path;
+        std::uint32_t mode = 0100644;
+        std::uint32_t size = 0;
+        int stage = 0;
+        bool skipWorktree = false;
+        };
+
+    std::string buildIndex(std::uint32_t version, const std::vector<TestEntry>& entries)
+        {
+        std::string out = "DIRC";
+        appendBigEndian32(out, version);
+        appendBigEndian32(out, static_cast<std::uint32_t>(entries.size()));
+
+        std::string previous;
+        for (const TestEntry& entry : entries)
+            {
+            const std::size_t start = out.size();
+            for (int field = 0; field < 6; ++field)
+                {
+                appendBigEndian32(out, 0); // ctime, mtime, dev, ino
+                }
+            appendBigEndian32(out, entry.mode);
+            appendBigEndian32(out, 0); // uid
+            appendBigEndian32(out, 0); // gid
+            appendBigEndian32(out, entry.size);
+            out.append(20, '\x11');
+
+            std::uint16_t flags = static_cast<std::uint16_t>(std::min<std::size_t>(entry.path.size(), 0x0fff));
+            flags = static_cast<std::uint16_t>(flags | (entry.stage << 12));
+            if (entry.skipWorktree)
+                {
+                flags |= 0x4000;
+                }
+            appendBigEndian16(out, flags);
+            if (entry.skipWorktree)
+                {
+                appendBigEndian16(out, 0x4000);
+                }
+
+            if (version == 4)
+                {
+                std::size_t common = 0;
+                while (common < previous.size() && common < entry.path.size() && previous[common] == entry.path[common])
+                    {
+                    ++common;
+                    }
+                appendPrefixVarint(out, previous.size() - common);
+                out.append(entry.path.substr(common));
+                out.push_back('\0');
+                }
+            else
+                {
+                out.append(entry.path);
+                const std::size_t length = out.size() - start;
+                out.append(8 - (length % 8), '\0');
+                }
+            previous = entry.path;
+            }
+
+        out.append("TREE");
+        appendBigEndian32(out, 0);
+        out.append(20, '\0'); // Checksum, not verified.
+        return out;
+        }
+
+    std::vector<std::string> parsedPaths(const std::string& data, bool& ok)
+        {
+        std::vector<repaddu::app::GitIndexEntry> entries;
+        ok = repaddu::app::parseGitIndex(data, entries).code == repaddu::core::ExitCode::success;
+        std::vector<std::string> paths;
+        for (const auto& entry : entries)
+            {
+            paths.push_back(entry.path);
+            }
+        return paths;
+        }
+
+    void testParseVersions()
+        {
+        const std::string longName(300, 'x');
+        const std::vector<TestEntry> entries = {
+            { "CMakeLists.txt", 0100644, 10 },
+            { "src/app/main.cpp", 0100755, 20 },
+            { "src/app/main.h", 0100644, 30 },
+            { "src/" + longName + ".cpp", 0100644, 40 },
+            { "src/zz.cpp", 0100644, 50 }
+        };
+        const std::vector<std::string> expected = {
+            "CMakeLists.txt", "src/app/main.cpp", "src/app/main.h", "src/" + longName + ".cpp", "src/zz.cpp"
+        };
+
+        for (const std::uint32_t version : { 2u, 3u, 4u })
+            {
+            bool ok = false;
+            const std::vector<std::string> paths = parsedPaths(buildIndex(version, entries), ok);
+            expectTrue(ok, "index parses");
+            expectTrue(paths == expected, "paths survive each index version");
+            }
+
+        std::vector<repaddu::app::GitIndexEntry> parsed;
+        repaddu::app::parseGitIndex(buildIndex(4, entries), parsed);
+        expectTrue(parsed.size() == 5 && parsed[1].mode == 0100755 && parsed[1].sizeBytes == 20,
+            "mode and size are decoded");
+
+        bool ok = true;
+        parsedPaths("DIRC", ok);
+        expectTrue(!ok, "truncated index is rejected");
+        std::string badVersion = buildIndex(2, entries);
+        badVersion[7] = 9;
+        parsedPaths(badVersion, ok);
+        expectTrue(!ok, "unknown version is rejected");
+        }
+
+    void testConflictsAndSparse()
+        {
+        const std::vector<TestEntry> entries = {
+            { "a.cpp", 0100644, 1, 1 },
+            { "a.cpp", 0100644, 1, 2 },
+            { "a.cpp", 0100644, 1, 3 },
+            { "b.cpp", 0100644, 1, 0, true },
+            { "c.cpp", 0100644, 1 }
+        };
+        bool ok = false;
+        const std::vector<std::string> paths = parsedPaths(buildIndex(3, entries), ok);
+        expectTrue(ok, "extended index parses");
+        expectTrue(paths == std::vector<std::string>({ "a.cpp", "c.cpp" }),
+            "conflict stages collapse and skip-worktree entries are dropped");
+        }
+
+    bool hasFile(const repaddu::io::TraversalResult& result, const std::string& relative)
+        {
+        return result.files.find(relative).has_value();
+        }
+
+    void testServiceUsesIndex()
+        {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "repaddu_git_index_test";
+        std::filesystem::remove_all(root);
+
+        writeFile(root / "CMakeLists.txt", "project(x)\n");
+        writeFile(root / "src" / "main.cpp", "int main() { return 0; }\n");
+        writeFile(root / "src" / "blob.bin", std::string("\0\1\2\3", 4));
+        writeFile(root / "untracked.cpp", "int u;\n");
+        writeFile(root / ".git" / "index", buildIndex(2, {
+            { ".hidden/tracked.cpp", 0100644, 1 },
+            { "CMakeLists.txt", 0100644, 11 },
+            { "deleted.cpp", 0100644, 5 },
+            { "external", 0160000, 0 },
+            { "src/blob.bin", 0100644, 4 },
+            { "src/main.cpp", 0100644, 1 }
+        }));
+
+        repaddu::core::CliOptions options;
+        options.inputPath = root;
+        options.traversalSource = repaddu::core::TraversalSource::gitIndex;
+
+        auto service = repaddu::app::makeTraversalService(options);
+        repaddu::io::TraversalResult result;
+        expectTrue(service->traverse(options, result).code == repaddu::core::ExitCode::success, "index traversal succeeds");
+        expectTrue(result.files.size() == 3, "only present, visible, regular tracked files are listed");
+        expectTrue(hasFile(result, "src/main.cpp") && hasFile(result, "CMakeLists.txt"), "tracked files are listed");
+        expectTrue(!hasFile(result, "deleted.cpp"), "files missing from the work tree are dropped");
+        expectTrue(!hasFile(result, "untracked.cpp"), "untracked files are skipped by default");
+        expectTrue(result.cmakeLists.size() == 1, "CMakeLists are collected");
+        expectTrue(result.directories.size() == 1 && result.directories.front() == "src", "directories are derived");
+        for (std::size_t index = 0; index < result.files.size(); ++index)
+            {
+            if (result.files.relativePath(index) == "src/main.cpp")
+                {
+                expectTrue(result.files.sizeBytes(index) == 25, "size comes from the work tree");
+                }
+            expectTrue(result.files.binaryState(index) == repaddu::core::BinaryState::unknown, "binary detection is deferred");
+            }
+
+        options.includeUntracked = true;
+        repaddu::io::TraversalResult withUntracked;
+        service->traverse(options, withUntracked);
+        expectTrue(withUntracked.files.size() == 4 && hasFile(withUntracked, "untracked.cpp"),
+            "untracked files are merged once when requested");
+
+        std::filesystem::remove_all(root / ".git");
+        options.includeUntracked = false;
+        repaddu::io::TraversalResult fallback;
+        expectTrue(service->traverse(options, fallback).code == repaddu::core::ExitCode::success
+            && hasFile(fallback, "untracked.cpp"), "missing index falls back to walking");
+
+        std::filesystem::remove_all(root);
+        }
+    }
+
+int main()
+    {
+    testParseVersions();
+    testConflictsAndSparse();
+    testServiceUsesIndex();
+
+    if (g_failures != 0)
+        {
+        std::cerr << g_failures << " failure(s)\n";
+        return 1;
+        }
+    std::cout << "All git index tests passed.\n";
+    return 0;
+    }
@@ -0,0 +1,211 @@
+#include "repaddu/core_types.h"
+#include "repaddu/io_ignore.h"
+#include "repaddu/io_traversal.h"
+#include "repaddu/io_traversal_cache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+    {
+    int g_failures = 0;
+
+    void expectTrue(bool value, const char* message)
+        {
+        if (!value)
+            {
+            std::cerr << "FAIL: " << message << "\n";
+            ++g_failures;
+            }
+        }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+        {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << content;
+        }
+
+    using Verdict = repaddu::io::IgnoreRules::Verdict;
+
+    void testPatternSemantics()
+        {
+        const auto rules = repaddu::io::IgnoreRules::compile(
+            "# comment\n"
+            "*.o\n"
+            "build/\n"
+            "/dist\n"
+            "docs/*.tmp\n"
+            "**/cache\n"
+            "logs/**\n"
+            "a/**/b\n"
+            "file[0-9].txt\n"
+            "!keep.o\n"
+            "\\#literal\n"
+            "trailing   \n");
+
+        expectTrue(rules.match("main.o", false) == Verdict::ignored, "extension glob matches at root");
+        expectTrue(rules.match("src/deep/main.o", false) == Verdict::ignored, "extension glob matches nested");
+        expectTrue(rules.match("keep.o", false) == Verdict::included, "later negation wins");
+        expectTrue(rules.match("main.c", false) == Verdict::none, "unrelated file has no verdict");
+
+        expectTrue(rules.match("build", true) == Verdict::ignored, "directory-only pattern matches directory");
+        expectTrue(rules.match("build", false) == Verdict::none, "directory-only pattern skips files");
+        expectTrue(rules.match("src/build", true) == Verdict::ignored, "unanchored directory matches nested");
+
+        expectTrue(rules.match("dist", true) == Verdict::ignored, "anchored literal matches at root");
+        expectTrue(rules.match("src/dist", true) == Verdict::none, "anchored literal does not match nested");
+
+        expectTrue(rules.match("docs/a.tmp", false) == Verdict::ignored, "anchored glob matches");
+        expectTrue(rules.match("docs/sub/a.tmp", false) == Verdict::none, "star does not cross slash");
+
+        expectTrue(rules.match("cache", true) == Verdict::ignored, "leading double star matches root");
+        expectTrue(rules.match("x/y/cache", true) == Verdict::ignored, "leading double star matches nested");
+        expectTrue(rules.match("logs/x/y.txt", false) == Verdict::ignored, "trailing double star matches contents");
+        expectTrue(rules.match("a/b", false) == Verdict::ignored, "middle double star matches zero dirs");
+        expectTrue(rules.match("a/x/y/b", false) == Verdict::ignored, "middle double star matches many dirs");
+
+        expectTrue(rules.match("file7.txt", false) == Verdict::ignored, "bracket range matches");
+        expectTrue(rules.match("fileA.txt", false) == Verdict::none, "bracket range rejects");
+        expectTrue(rules.match("#literal", false) == Verdict::ignored, "escaped hash is a pattern");
+        expectTrue(rules.match("trailing", false) == Verdict::ignored, "trailing spaces are trimmed");
+        }
+
+    void testLevelPriority()
+        {
+        using repaddu::io::extendIgnoreLevel;
+        using repaddu::io::isIgnored;
+
+        auto root = extendIgnoreLevel(nullptr, "", { "*.log\n", "" });
+        auto sub = extendIgnoreLevel(root, "sub", { "!important.log\n", "" });
+        auto local = extendIgnoreLevel(sub, "sub/local", { "*.txt\n", "!notes.txt\n" });
+
+        expectTrue(isIgnored(root.get(), "a.log", false), "root rule applies");
+        expectTrue(isIgnored(sub.get(), "sub/a.log", false), "parent rule applies below");
+        expectTrue(!isIgnored(sub.get(), "sub/important.log", false), "deeper negation overrides parent");
+        expectTrue(isIgnored(local.get(), "sub/local/a.txt", false), "gitignore rule applies");
+        expectTrue(!isIgnored(local.get(), "sub/local/notes.txt", false), "repadduignore overrides gitignore");
+        expectTrue(extendIgnoreLevel(root, "empty", { "", "# only comments\n" }) == root,
+            "empty ignore files reuse the parent level");
+        }
+
+    bool hasFile(const repaddu::io::TraversalResult& result, const std::string& relative)
+        {
+        return result.files.find(relative).has_value();
+        }
+
+    bool hasDirectory(const repaddu::io::TraversalResult& result, const std::string& relative)
+        {
+        return std::any_of(result.directories.begin(), result.directories.end(),
+            [&](const std::filesystem::path& path)
+            {
+            return path.generic_string() == relative;
+            });
+        }
+
+    void expectPruned(const repaddu::io::TraversalResult& result, const char* label)
+        {
+        const std::string prefix = std::string(label) + ": ";
+        auto check = [&](bool value, const std::string& what)
+            {
+            expectTrue(value, (prefix + what).c_str());
+            };
+        check(hasFile(result, "main.cpp"), "keeps main.cpp");
+        check(!hasFile(result, "debug.log"), "drops root *.log");
+        check(hasFile(result, "keep.log"), "keeps negated keep.log");
+        check(!hasDirectory(result, "build"), "prunes build/");
+        check(!hasFile(result, "build/out.cpp"), "drops files under build/");
+        check(hasFile(result, "src/build.cpp"), "keeps file named like a directory-only pattern");
+        check(!hasFile(result, "src/generated.cpp"), "applies nested .gitignore");
+        check(hasFile(result, "src/lib/generated.cpp"), "keeps anchored pattern out of subdirectories");
+        check(!hasFile(result, "src/lib/notes.md"), "applies nested .repadduignore");
+        check(!hasFile(result, "excluded.txt"), "applies .git/info/exclude");
+        }
+
+    void testTraversalPruning()
+        {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "repaddu_ignore_test";
+        std::filesystem::remove_all(root);
+
+        writeFile(root / ".gitignore", "*.log\n!keep.log\nbuild/\n");
+        writeFile(root / ".git" / "info" / "exclude", "excluded.txt\n");
+        writeFile(root / "main.cpp", "int main() {}\n");
+        writeFile(root / "debug.log", "log\n");
+        writeFile(root / "keep.log", "log\n");
+        writeFile(root / "excluded.txt", "x\n");
+        writeFile(root / "build" / "out.cpp", "int x;\n");
+        writeFile(root / "src" / ".gitignore", "/generated.cpp\n");
+        writeFile(root / "src" / "build.cpp", "int y;\n");
+        writeFile(root / "src" / "generated.cpp", "int z;\n");
+        writeFile(root / "src" / "lib" / "generated.cpp", "int w;\n");
+        writeFile(root / "src" / "lib" / ".repadduignore", "*.md\n");
+        writeFile(root / "src" / "lib" / "notes.md", "# notes\n");
+
+        repaddu::core::CliOptions options;
+        options.inputPath = root;
+
+        for (const bool parallel : { false, true })
+            {
+            for (const auto backend : { repaddu::core::TraversalBackend::standard, repaddu::core::TraversalBackend::native })
+                {
+                options.parallelTraversal = parallel;
+                options.traversalBackend = backend;
+                repaddu::io::TraversalResult result;
+                const auto status = repaddu::io::traverseRepository(options, result);
+                expectTrue(status.code == repaddu::core::ExitCode::success, "traversal succeeds");
+                expectPruned(result, parallel ? "parallel" : "single");
+                }
+            }
+
+        repaddu::io::TraversalSnapshot empty;
+        repaddu::io::TraversalSnapshot snapshot;
+        repaddu::io::TraversalResult incremental;
+        expectTrue(repaddu::io::traverseRepositoryIncremental(options, empty, incremental, snapshot).code
+            == repaddu::core::ExitCode::success, "incremental traversal succeeds");
+        expectPruned(incremental, "incremental");
+
+        // Editing an ignore file must take effect even when the listing is reused.
+        writeFile(root / "src" / ".gitignore", "");
+        repaddu::io::TraversalSnapshot next;
+        expectTrue(repaddu::io::traverseRepositoryIncremental(options, snapshot, incremental, next).code
+            == repaddu::core::ExitCode::success, "second incremental traversal succeeds");
+        expectTrue(hasFile(incremental, "src/generated.cpp"), "incremental: honors edited ignore file");
+
+        options.useIgnoreFiles = false;
+        for (const bool parallel : { false, true })
+            {
+            for (const auto backend : { repaddu::core::TraversalBackend::standard, repaddu::core::TraversalBackend::native })
+                {
+                options.parallelTraversal = parallel;
+                options.traversalBackend = backend;
+                repaddu::io::TraversalResult unfiltered;
+                const auto status = repaddu::io::traverseRepository(options, unfiltered);
+                expectTrue(status.code == repaddu::core::ExitCode::success, "unfiltered traversal succeeds");
+                expectTrue(hasFile(unfiltered, "debug.log") && hasFile(unfiltered, "build/out.cpp")
+                    && hasFile(unfiltered, "src/generated.cpp") && hasFile(unfiltered, "src/lib/notes.md"),
+                    "--no-ignore-files disables filtering in nested directories");
+                }
+            }
+
+        std::filesystem::remove_all(root);
+        }
+    }
+
+int main()
+    {
+    testPatternSemantics();
+    testLevelPriority();
+    testTraversalPruning();
+
+    if (g_failures != 0)
+        {
+        std::cerr << g_failures << " failure(s)\n";
+        return 1;
+        }
+    std::cout << "All ignore tests passed.\n";
+    return 0;
+    }
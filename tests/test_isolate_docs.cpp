@@ -9,12 +9,12 @@
 namespace
     {
     bool hasPath(const std::vector<std::size_t>& indices,
-        const std::vector<repaddu::core::FileEntry>& files,
-        const std::filesystem::path& target)
+        const repaddu::core::FileTable& files,
+        const std::string& target)
         {
         for (std::size_t index : indices)
             {
-            if (files[index].relativePath == target)
+            if (files.relativePath(index) == target)
                 {
                 return true;
                 }
@@ -45,9 +45,9 @@ void test_isolate_docs_with_directory_grouping()
         if (group.name == "documentation")
             {
             hasDocsGroup = true;
-            assert(hasPath(group.fileIndices, traversal.files, std::filesystem::path("docs/readme.txt")));
-            assert(!hasPath(group.fileIndices, traversal.files, std::filesystem::path("CMakeLists.txt")));
-            assert(!hasPath(group.fileIndices, traversal.files, std::filesystem::path("subproj/CMakeLists.txt")));
+            assert(hasPath(group.fileIndices, traversal.files, "docs/readme.txt"));
+            assert(!hasPath(group.fileIndices, traversal.files, "CMakeLists.txt"));
+            assert(!hasPath(group.fileIndices, traversal.files, "subproj/CMakeLists.txt"));
             }
         }
     assert(hasDocsGroup);
@@ -76,12 +76,12 @@ void test_isolate_docs_with_size_grouping()
         if (group.name == "documentation")
             {
             hasDocsGroup = true;
-            assert(hasPath(group.fileIndices, traversal.files, std::filesystem::path("docs/readme.txt")));
+            assert(hasPath(group.fileIndices, traversal.files, "docs/readme.txt"));
             }
         if (group.name == "size")
             {
             hasSizeGroup = true;
-            assert(!hasPath(group.fileIndices, traversal.files, std::filesystem::path("docs/readme.txt")));
+            assert(!hasPath(group.fileIndices, traversal.files, "docs/readme.txt"));
             }
         }
 
@@ -99,7 +99,7 @@ void test_isolate_docs_with_size_grouping()
         if (chunk.category == "documentation")
             {
             hasDocsChunk = true;
-            assert(hasPath(chunk.fileIndices, traversal.files, std::filesystem::path("docs/readme.txt")));
+            assert(hasPath(chunk.fileIndices, traversal.files, "docs/readme.txt"));
             }
         if (chunk.category == "size")
             {
@@ -8,25 +8,32 @@
 
 namespace
     {
-    repaddu::core::FileEntry makeFile(const std::filesystem::path& path,
-        const std::string& extensionLower, bool isBinary = false)
+    struct FileSpec
         {
-        repaddu::core::FileEntry entry;
-        entry.relativePath = path;
-        entry.extensionLower = extensionLower;
-        entry.isBinary = isBinary;
-        return entry;
+        std::string relativePath;
+        bool isBinary = false;
+        };
+
+    repaddu::core::FileTable makeFiles(const std::vector<FileSpec>& specs)
+        {
+        repaddu::core::FileTable files;
+        for (const FileSpec& spec : specs)
+            {
+            const std::size_t index = files.add(spec.relativePath, 0);
+            files.setBinaryState(index, spec.isBinary ? repaddu::core::BinaryState::binary : repaddu::core::BinaryState::text);
+            }
+        return files;
         }
     }
 
 void test_detect_rust_and_cargo()
     {
-    const std::vector<repaddu::core::FileEntry> files =
+    const repaddu::core::FileTable files = makeFiles(
         {
-            makeFile("src/main.rs", ".rs"),
-            makeFile("Cargo.toml", ".toml"),
-            makeFile("Cargo.lock", ".lock")
-        };
+            { "src/main.rs" },
+            { "Cargo.toml" },
+            { "Cargo.lock" }
+        });
 
     const repaddu::core::DetectionResult detected = repaddu::core::detectLanguageAndBuildSystem(files);
     assert(detected.languageId == "rust");
@@ -35,11 +42,11 @@ void test_detect_rust_and_cargo()
 
 void test_detect_cpp_precedence_on_tie()
     {
-    const std::vector<repaddu::core::FileEntry> files =
+    const repaddu::core::FileTable files = makeFiles(
         {
-            makeFile("src/main.c", ".c"),
-            makeFile("src/main.cpp", ".cpp")
-        };
+            { "src/main.c" },
+            { "src/main.cpp" }
+        });
 
     const repaddu::core::DetectionResult detected = repaddu::core::detectLanguageAndBuildSystem(files);
     assert(detected.languageId == "cpp");
@@ -48,11 +55,11 @@ void test_detect_cpp_precedence_on_tie()
 
 void test_detect_none_when_unknown()
     {
-    const std::vector<repaddu::core::FileEntry> files =
+    const repaddu::core::FileTable files = makeFiles(
         {
-            makeFile("notes/todo.txt", ".txt"),
-            makeFile("assets/logo.bin", ".bin", true)
-        };
+            { "notes/todo.txt" },
+            { "assets/logo.bin", true }
+        });
 
     const repaddu::core::DetectionResult detected = repaddu::core::detectLanguageAndBuildSystem(files);
     assert(detected.languageId.empty());
@@ -61,11 +68,11 @@ void test_detect_none_when_unknown()
 
 void test_build_system_precedence()
     {
-    const std::vector<repaddu::core::FileEntry> files =
+    const repaddu::core::FileTable files = makeFiles(
         {
-            makeFile("CMakeLists.txt", ".txt"),
-            makeFile("Cargo.toml", ".toml")
-        };
+            { "CMakeLists.txt" },
+            { "Cargo.toml" }
+        });
 
     const repaddu::core::DetectionResult detected = repaddu::core::detectLanguageAndBuildSystem(files);
     assert(detected.buildSystemId == "cargo");
@@ -73,11 +80,11 @@ void test_build_system_precedence()
 
 void test_detect_npm_build_system()
     {
-    const std::vector<repaddu::core::FileEntry> files =
+    const repaddu::core::FileTable files = makeFiles(
         {
-            makeFile("package.json", ".json"),
-            makeFile("index.js", ".js")
-        };
+            { "package.json" },
+            { "index.js" }
+        });
 
     const repaddu::core::DetectionResult detected = repaddu::core::detectLanguageAndBuildSystem(files);
     assert(detected.buildSystemId == "npm");
@@ -85,11 +92,11 @@ void test_detect_npm_build_system()
 
 void test_detect_npm_build_system_case_insensitive_filename()
     {
-    const std::vector<repaddu::core::FileEntry> files =
+    const repaddu::core::FileTable files = makeFiles(
         {
-            makeFile("Package.JSON", ".json"),
-            makeFile("index.js", ".js")
-        };
+            { "Package.JSON" },
+            { "index.js" }
+        });
 
     const repaddu::core::DetectionResult detected = repaddu::core::detectLanguageAndBuildSystem(files);
     assert(detected.buildSystemId == "npm");
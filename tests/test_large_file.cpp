@@ -1,4 +1,5 @@
 #include "repaddu/grouping_strategies.h"
+#include "repaddu/core_file_table.h"
 #include "repaddu/core_types.h"
 #include <vector>
 #include <string>
@@ -13,19 +14,11 @@ void test_large_file_exclusion()
     // We need to set extensions to empty or something to allow all, or specific
     options.extensions = { ".txt" }; 
 
-    repaddu::core::FileEntry smallFile;
-    smallFile.relativePath = "small.txt";
-    smallFile.extensionLower = ".txt";
-    smallFile.sizeBytes = 500;
-    smallFile.isBinary = false;
-
-    repaddu::core::FileEntry largeFile;
-    largeFile.relativePath = "large.txt";
-    largeFile.extensionLower = ".txt";
-    largeFile.sizeBytes = 2000;
-    largeFile.isBinary = false;
-
-    std::vector<repaddu::core::FileEntry> files = { smallFile, largeFile };
+    repaddu::core::FileTable files;
+    files.add("small.txt", 500);
+    files.add("large.txt", 2000);
+    files.setBinaryState(0, repaddu::core::BinaryState::text);
+    files.setBinaryState(1, repaddu::core::BinaryState::text);
     repaddu::core::RunResult result;
     
     // 1. Test Default (Exclude)
@@ -0,0 +1,165 @@
+#include "repaddu/format/marker_encoder.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <string>
+#include <string_view>
+
+namespace
+    {
+    std::atomic<std::size_t> g_allocations{ 0 };
+
+    struct StringSink
+        {
+        std::string text;
+
+        void write(std::string_view fragment)
+            {
+            text.append(fragment);
+            }
+        };
+
+    // Counts bytes without storing them, like the planning writer.
+    struct CountingSink
+        {
+        std::uintmax_t bytes = 0;
+
+        void write(std::string_view fragment)
+            {
+            bytes += fragment.size();
+            }
+        };
+
+    template <typename Encoder>
+    std::string render(Encoder encoder, const repaddu::format::MarkerFile& file, std::string_view content)
+        {
+        StringSink sink;
+        encoder.writeHeader(sink, file);
+        sink.write(content);
+        encoder.writeFooter(sink, !content.empty() && content.back() != '\n');
+        return sink.text;
+        }
+    }
+
+void* operator new(std::size_t size)
+    {
+    ++g_allocations;
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+        {
+        return memory;
+        }
+    throw std::bad_alloc();
+    }
+
+void operator delete(void* memory) noexcept
+    {
+    std::free(memory);
+    }
+
+void operator delete(void* memory, std::size_t) noexcept
+    {
+    std::free(memory);
+    }
+
+void test_rendered_blocks()
+    {
+    using repaddu::core::MarkerMode;
+    using repaddu::format::MarkerEncoder;
+
+    const repaddu::format::MarkerFile file{ "src", "a.cpp", 12, 3, repaddu::core::FileClass::source };
+    assert(render(MarkerEncoder<MarkerMode::fenced, false>{}, file, "int a;")
+        == "```repaddu-file\npath: src/a.cpp\nbytes: 12\ntokens: 3\nclass: source\n```\nint a;\n```\n");
+    assert(render(MarkerEncoder<MarkerMode::sentinel, false>{}, file, "int a;\n")
+        == "@@@ REPADDU FILE BEGIN path=\"src/a.cpp\" bytes=12 tokens=3 class=source @@@\nint a;\n"
+           "@@@ REPADDU FILE END @@@\n");
+    assert(render(MarkerEncoder<MarkerMode::sentinel, true>{}, file, "")
+        == "@@@ REPADDU FILE BEGIN path=\"src/a.cpp\" bytes=12 tokens=3 class=source @@@\n"
+           "---\npath: src/a.cpp\nbytes: 12\ntokens: 3\nclass: source\n---\n@@@ REPADDU FILE END @@@\n");
+
+    // Only the sentinel attribute escapes quotes.
+    const repaddu::format::MarkerFile quoted{ "", "say \"hi\".txt", 0, 0, repaddu::core::FileClass::other };
+    assert(render(MarkerEncoder<MarkerMode::sentinel, true>{}, quoted, "")
+        == "@@@ REPADDU FILE BEGIN path=\"say \\\"hi\\\".txt\" bytes=0 tokens=0 class=other @@@\n"
+           "---\npath: say \"hi\".txt\nbytes: 0\ntokens: 0\nclass: other\n---\n@@@ REPADDU FILE END @@@\n");
+
+    std::cout << "Rendered marker block tests passed." << std::endl;
+    }
+
+void test_block_bytes_match_rendering()
+    {
+    using repaddu::format::MarkerFile;
+
+    const std::uintmax_t maxValue = std::numeric_limits<std::uintmax_t>::max();
+    const MarkerFile files[] = {
+        { "", "x", 0, 0, repaddu::core::FileClass::other },
+        { "dir/sub", "\"q\".h", 9, 10, repaddu::core::FileClass::header },
+        { "a\"b", "c", maxValue, maxValue, repaddu::core::FileClass::source },
+        { "src", "main.cpp", 99999, 100000, repaddu::core::FileClass::source },
+    };
+    const std::string_view contents[] = { "", "line\n", "no newline" };
+
+    for (const MarkerFile& file : files)
+        {
+        for (std::string_view content : contents)
+            {
+            for (const bool frontmatter : { false, true })
+                {
+                for (const auto mode : { repaddu::core::MarkerMode::fenced, repaddu::core::MarkerMode::sentinel })
+                    {
+                    repaddu::format::visitMarkerEncoder(mode, frontmatter, [&](auto encoder)
+                        {
+                        const bool closeLine = !content.empty() && content.back() != '\n';
+                        assert(encoder.blockBytes(file, content.size(), closeLine)
+                            == render(encoder, file, content).size());
+                        });
+                    }
+                }
+            }
+        }
+
+    std::cout << "Marker block size tests passed." << std::endl;
+    }
+
+void test_encoding_does_not_allocate()
+    {
+    using repaddu::core::MarkerMode;
+
+    const repaddu::format::MarkerFile file{ "include/repaddu/format", "a \"quoted\" header name.h", 123456789,
+        30864197, repaddu::core::FileClass::header };
+    CountingSink sink;
+    std::uintmax_t measured = 0;
+
+    const std::size_t before = g_allocations.load();
+    for (int iteration = 0; iteration < 1000; ++iteration)
+        {
+        for (const bool frontmatter : { false, true })
+            {
+            for (const auto mode : { MarkerMode::fenced, MarkerMode::sentinel })
+                {
+                repaddu::format::visitMarkerEncoder(mode, frontmatter, [&](auto encoder)
+                    {
+                    measured += encoder.blockBytes(file, 42, true);
+                    encoder.writeHeader(sink, file);
+                    sink.write(std::string_view("0123456789012345678901234567890123456789ab"));
+                    encoder.writeFooter(sink, true);
+                    });
+                }
+            }
+        }
+    assert(g_allocations.load() == before);
+    assert(measured == sink.bytes);
+
+    std::cout << "Marker encoding allocation tests passed." << std::endl;
+    }
+
+int main()
+    {
+    test_rendered_blocks();
+    test_block_bytes_match_rendering();
+    test_encoding_does_not_allocate();
+    return 0;
+    }
@@ -89,8 +89,7 @@ void test_extension_filtering()
     assert(groupingResult.code == repaddu::core::ExitCode::success);
     assert(grouped.includedIndices.size() == 1);
 
-    const auto& file = traversal.files[grouped.includedIndices[0]];
-    assert(file.relativePath == std::filesystem::path("rust/src/main.rs"));
+    assert(traversal.files.relativePath(grouped.includedIndices[0]) == "rust/src/main.rs");
     }
 
 void test_build_file_aggregation()
@@ -0,0 +1,146 @@
+#include "repaddu/format/pack_reader.h"
+#include "repaddu/format_writer.h"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+    {
+    std::filesystem::path makeTempDir(const std::string& name)
+        {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::error_code errorCode;
+        std::filesystem::remove_all(path, errorCode);
+        std::filesystem::create_directories(path);
+        return path;
+        }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+        {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << content;
+        }
+
+    std::string readText(const std::filesystem::path& path)
+        {
+        std::ifstream input(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        }
+    }
+
+void test_pack_lookups_return_written_content()
+    {
+    const std::filesystem::path inputRoot = makeTempDir("repaddu_pack_in");
+    std::string big;
+    while (big.size() < 100 * 1024)
+        {
+        big += "int v" + std::to_string(big.size()) + " = 1;\n";
+        }
+    writeFile(inputRoot / "src" / "big.cpp", big);
+    writeFile(inputRoot / "src" / "a.h", "int a();\n");
+    writeFile(inputRoot / "src" / "mail.cpp", "// ops@example.com\n");
+    writeFile(inputRoot / "b.cpp", "");
+    writeFile(inputRoot / "blob.bin", std::string("\0\1\2\3", 4));
+
+    repaddu::core::FileTable files(inputRoot);
+    repaddu::core::OutputChunk first{ "src", "src", {} };
+    repaddu::core::OutputChunk second{ "root", "root", {} };
+    for (const char* relative : { "src/mail.cpp", "src/big.cpp", "src/a.h" })
+        {
+        first.fileIndices.push_back(files.add(relative, std::filesystem::file_size(inputRoot / relative)));
+        }
+    for (const char* relative : { "blob.bin", "b.cpp" })
+        {
+        second.fileIndices.push_back(files.add(relative, std::filesystem::file_size(inputRoot / relative)));
+        }
+    // A file listed by two chunks is stored once.
+    second.fileIndices.push_back(first.fileIndices[2]);
+
+    repaddu::core::CliOptions options;
+    options.inputPath = inputRoot;
+    options.format = repaddu::core::OutputFormat::pack;
+
+    for (const bool redact : { false, true })
+        {
+        options.redactPii = redact;
+        options.outputPath = makeTempDir("repaddu_pack_out");
+        const auto result = repaddu::format::writeOutputs(options, files, { first, second }, "", {}, {});
+        assert(result.code == repaddu::core::ExitCode::success);
+
+        repaddu::format::PackReader reader;
+        assert(reader.open(options.outputPath / "repository.pack").code == repaddu::core::ExitCode::success);
+        assert(reader.size() == 4);
+        for (std::size_t index = 1; index < reader.size(); ++index)
+            {
+            assert(reader.entry(index - 1).path < reader.entry(index).path);
+            }
+
+        const auto bigEntry = reader.find("src/big.cpp");
+        assert(bigEntry && bigEntry->content == big);
+        assert(bigEntry->tokenCount > 0 && bigEntry->fileClass == repaddu::core::FileClass::source);
+        const auto header = reader.find("src/a.h");
+        assert(header && header->content == "int a();\n" && header->fileClass == repaddu::core::FileClass::header);
+        const auto empty = reader.find("b.cpp");
+        assert(empty && empty->content.empty());
+        const auto mail = reader.find("src/mail.cpp");
+        assert(mail && (mail->content.find("<REDACTED:EMAIL>") != std::string_view::npos) == redact);
+
+        assert(!reader.find("blob.bin"));
+        assert(!reader.find("src/a"));
+        assert(!reader.find("src/big.cpp.orig"));
+        assert(!reader.find(""));
+        }
+
+    std::cout << "Pack lookup tests passed." << std::endl;
+    }
+
+void test_pack_reader_rejects_damaged_files()
+    {
+    const std::filesystem::path root = makeTempDir("repaddu_pack_damaged");
+    writeFile(root / "in" / "a.cpp", "int a;\n");
+    writeFile(root / "in" / "b.cpp", "int b;\n");
+
+    repaddu::core::FileTable files(root / "in");
+    repaddu::core::OutputChunk chunk{ "src", "src", {} };
+    chunk.fileIndices.push_back(files.add("a.cpp", 7));
+    chunk.fileIndices.push_back(files.add("b.cpp", 7));
+
+    repaddu::core::CliOptions options;
+    options.inputPath = root / "in";
+    options.outputPath = root / "out";
+    options.format = repaddu::core::OutputFormat::pack;
+    assert(repaddu::format::writeOutputs(options, files, { chunk }, "", {}, {}).code
+        == repaddu::core::ExitCode::success);
+    const std::string pack = readText(options.outputPath / "repository.pack");
+
+    repaddu::format::PackReader reader;
+    writeFile(root / "truncated.pack", pack.substr(0, pack.size() - 1));
+    assert(reader.open(root / "truncated.pack").code == repaddu::core::ExitCode::io_failure);
+    assert(reader.size() == 0 && !reader.find("a.cpp"));
+
+    std::string badMagic = pack;
+    badMagic[0] = 'X';
+    writeFile(root / "magic.pack", badMagic);
+    assert(reader.open(root / "magic.pack").code == repaddu::core::ExitCode::io_failure);
+
+    // Swapping the two paths breaks the sort order lookups rely on.
+    std::string unsorted = pack;
+    const std::size_t paths = 64 + 2 * 40;
+    unsorted[paths] = 'b';
+    unsorted[paths + 5] = 'a';
+    writeFile(root / "unsorted.pack", unsorted);
+    assert(reader.open(root / "unsorted.pack").code == repaddu::core::ExitCode::io_failure);
+
+    std::cout << "Damaged pack tests passed." << std::endl;
+    }
+
+int main()
+    {
+    test_pack_lookups_return_written_content();
+    test_pack_reader_rejects_damaged_files();
+    return 0;
+    }
@@ -0,0 +1,168 @@
+#include "repaddu/format_writer.h"
+
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+    {
+    std::filesystem::path makeTempDir(const std::string& name)
+        {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::error_code errorCode;
+        std::filesystem::remove_all(path, errorCode);
+        std::filesystem::create_directories(path);
+        return path;
+        }
+
+    std::string readText(const std::filesystem::path& path)
+        {
+        std::ifstream input(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        }
+
+    struct TarEntry
+        {
+        std::string name;
+        std::string content;
+        };
+
+    std::uintmax_t parseOctal(const std::string& field)
+        {
+        std::uintmax_t value = 0;
+        for (const char ch : field)
+            {
+            if (ch < '0' || ch > '7')
+                {
+                break;
+                }
+            value = value * 8 + static_cast<std::uintmax_t>(ch - '0');
+            }
+        return value;
+        }
+
+    // Reads a ustar archive, checking every header checksum and the end
+    // marker; returns false on anything malformed.
+    bool parseTar(const std::string& archive, std::vector<TarEntry>& outEntries)
+        {
+        std::size_t offset = 0;
+        while (offset + 512 <= archive.size())
+            {
+            const std::string header = archive.substr(offset, 512);
+            if (header == std::string(512, '\0'))
+                {
+                return offset + 1024 == archive.size() && archive.substr(offset + 512) == std::string(512, '\0');
+                }
+            unsigned int checksum = 0;
+            for (std::size_t index = 0; index < 512; ++index)
+                {
+                checksum += (index >= 148 && index < 156) ? ' ' : static_cast<unsigned char>(header[index]);
+                }
+            if (checksum != parseOctal(header.substr(148, 8)) || header.compare(257, 6, std::string("ustar\0", 6)) != 0
+                || header[156] != '0')
+                {
+                return false;
+                }
+            const std::uintmax_t size = parseOctal(header.substr(124, 12));
+            offset += 512;
+            if (offset + size > archive.size())
+                {
+                return false;
+                }
+            outEntries.push_back({ header.substr(0, header.find('\0')), archive.substr(offset, size) });
+            offset += (size + 511) / 512 * 512;
+            }
+        return false;
+        }
+    }
+
+void test_standard_output_streams_a_tar_of_every_output()
+    {
+#if !defined(_WIN32)
+    const std::filesystem::path inputRoot = makeTempDir("repaddu_tar_in");
+    repaddu::core::FileTable files(inputRoot);
+    repaddu::core::OutputChunk chunk{ "src", "Sources", {} };
+    std::string big;
+    while (big.size() < 80 * 1024)
+        {
+        big += "int v" + std::to_string(big.size()) + ";\n";
+        }
+    std::ofstream(inputRoot / "big.cpp", std::ios::binary) << big;
+    chunk.fileIndices.push_back(files.add("big.cpp", big.size()));
+    for (int index = 0; index < 12; ++index)
+        {
+        const std::string name = "f" + std::to_string(index) + ".cpp";
+        const std::string body = std::string(static_cast<std::size_t>(index * 37), 'x') + "\n";
+        std::ofstream(inputRoot / name, std::ios::binary) << body;
+        chunk.fileIndices.push_back(files.add(name, body.size()));
+        }
+    std::ofstream(inputRoot / "CMakeLists.txt") << "project(t)\n";
+
+    repaddu::core::CliOptions options;
+    options.inputPath = inputRoot;
+    options.maxBytes = big.size() + 1024;
+
+    options.outputPath = makeTempDir("repaddu_tar_dir");
+    assert(repaddu::format::writeOutputs(options, files, { chunk }, "tree\n", { inputRoot / "CMakeLists.txt" }, {}).code
+        == repaddu::core::ExitCode::success);
+
+    // Standard output goes to a file for the length of the call.
+    const std::filesystem::path archivePath = makeTempDir("repaddu_tar_stream") / "out.tar";
+    std::fflush(stdout);
+    std::cout.flush();
+    const int saved = ::dup(STDOUT_FILENO);
+    const int target = ::open(archivePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ::dup2(target, STDOUT_FILENO);
+    ::close(target);
+    repaddu::core::CliOptions streamed = options;
+    streamed.outputPath = "-";
+    const repaddu::core::RunResult result = repaddu::format::writeOutputs(streamed, files, { chunk }, "tree\n",
+        { inputRoot / "CMakeLists.txt" }, {});
+    ::dup2(saved, STDOUT_FILENO);
+    ::close(saved);
+    assert(result.code == repaddu::core::ExitCode::success);
+    assert(!std::filesystem::exists("-"));
+
+    std::vector<TarEntry> entries;
+    assert(parseTar(readText(archivePath), entries));
+    std::vector<std::string> names;
+    for (const auto& entry : std::filesystem::directory_iterator(options.outputPath))
+        {
+        names.push_back(entry.path().filename().string());
+        }
+    assert(entries.size() == names.size() && entries.size() == 5);
+    assert(entries[0].name == "000_overview.md" && entries[3].name == "003_src.md" && entries[4].name == "004_src_part2.md");
+    for (const TarEntry& entry : entries)
+        {
+        assert(entry.content == readText(options.outputPath / entry.name));
+        }
+#endif
+
+    std::cout << "Tar stream tests passed." << std::endl;
+    }
+
+void test_standard_output_requires_markdown()
+    {
+    repaddu::core::FileTable files(std::filesystem::temp_directory_path());
+    repaddu::core::CliOptions options;
+    options.outputPath = "-";
+    options.format = repaddu::core::OutputFormat::jsonl;
+    assert(repaddu::format::writesToStandardOutput(options));
+    assert(repaddu::format::writeOutputs(options, files, {}, "", {}, {}).code == repaddu::core::ExitCode::invalid_usage);
+    }
+
+int main()
+    {
+    test_standard_output_streams_a_tar_of_every_output();
+    test_standard_output_requires_markdown();
+    return 0;
+    }
@@ -1,6 +1,12 @@
+#include "repaddu/analysis_bpe_tokenizer.h"
 #include "repaddu/analysis_tokens.h"
 #include <cassert>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
 
 void test_token_estimation()
     {
@@ -27,8 +33,59 @@ void test_token_estimation()
     std::cout << "Token estimation tests passed." << std::endl;
     }
 
+void test_bpe_pre_tokenizer()
+    {
+    using repaddu::analysis::BpeTokenizer;
+
+    const std::vector<std::string_view> expected = { "Hello", " world", "'s", " ", " ", "123", "456", " foo", "!!\n\n",
+        " ", " bar" };
+    assert(BpeTokenizer::splitPieces("Hello world's  123456 foo!!\n\n  bar") == expected);
+
+    const std::vector<std::string_view> trailing = { "x", "  \n", "\t", "(y", "  " };
+    assert(BpeTokenizer::splitPieces("x  \n\t(y  ") == trailing);
+
+    std::cout << "BPE pre-tokenizer tests passed." << std::endl;
+    }
+
+void test_bpe_token_counts()
+    {
+    using repaddu::analysis::BpeTokenizer;
+    using repaddu::analysis::TokenEstimator;
+
+    const std::filesystem::path vocab = std::filesystem::temp_directory_path() / "repaddu_test_vocab.tiktoken";
+    // a b c " " ab abc bc
+    std::ofstream(vocab) << "YQ== 0\nYg== 1\nYw== 2\nIA== 3\nYWI= 4\nYWJj 5\nYmM= 6\n";
+
+    auto tokenizer = std::make_shared<BpeTokenizer>();
+    assert(tokenizer->load(vocab).code == repaddu::core::ExitCode::success);
+    assert(tokenizer->vocabularySize() == 7);
+
+    assert(tokenizer->countTokens("") == 0);
+    assert(tokenizer->countTokens("abc") == 1);
+    // a b c a b c -> ab c ab c -> abc abc.
+    assert(tokenizer->countTokens("abcabc") == 2);
+    // "abc" | " abcabc" -> " " abc abc | " zz" -> " " z z.
+    assert(tokenizer->countTokens("abc abcabc zz") == 7);
+
+    TokenEstimator::useTokenizer(tokenizer);
+    assert(TokenEstimator::estimateTokens("abcabc") == 2);
+    assert(TokenEstimator::tokenizerId().rfind("bpe-", 0) == 0);
+    TokenEstimator::useTokenizer(nullptr);
+    assert(TokenEstimator::estimateTokens("abcabc") == 2);
+    assert(TokenEstimator::estimateTokens("abcabcabc") == 3);
+    assert(TokenEstimator::tokenizerId() == "chars4-v1");
+
+    std::ofstream(vocab) << "YQ== 0\nnot-a-rank\n";
+    BpeTokenizer broken;
+    assert(broken.load(vocab).code == repaddu::core::ExitCode::invalid_usage);
+
+    std::cout << "BPE token count tests passed." << std::endl;
+    }
+
 int main()
     {
     test_token_estimation();
+    test_bpe_pre_tokenizer();
+    test_bpe_token_counts();
     return 0;
     }
@@ -0,0 +1,174 @@
+#include "repaddu/core_types.h"
+#include "repaddu/io_traversal.h"
+#include "repaddu/io_traversal_cache.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+    {
+    int g_failures = 0;
+
+    void expectTrue(bool value, const char* message)
+        {
+        if (!value)
+            {
+            std::cerr << "FAIL: " << message << "\n";
+            ++g_failures;
+            }
+        }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+        {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << content;
+        }
+
+    // Snapshot entries newer than the racy window are never trusted, so the
+    // fixture is back-dated to make reuse observable.
+    void backdate(const std::filesystem::path& path, std::chrono::hours age)
+        {
+        std::error_code errorCode;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - age, errorCode);
+        }
+
+    void backdateTree(const std::filesystem::path& root)
+        {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root))
+            {
+            if (entry.is_regular_file())
+                {
+                backdate(entry.path(), std::chrono::hours(2));
+                }
+            }
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root))
+            {
+            if (entry.is_directory())
+                {
+                backdate(entry.path(), std::chrono::hours(2));
+                }
+            }
+        backdate(root, std::chrono::hours(2));
+        }
+
+    bool sameTraversal(const repaddu::io::TraversalResult& lhs, const repaddu::io::TraversalResult& rhs)
+        {
+        if (lhs.files.size() != rhs.files.size() || lhs.directories != rhs.directories
+            || lhs.cmakeLists != rhs.cmakeLists || lhs.buildFiles != rhs.buildFiles)
+            {
+            return false;
+            }
+        for (std::size_t index = 0; index < lhs.files.size(); ++index)
+            {
+            if (lhs.files.relativePath(index) != rhs.files.relativePath(index)
+                || lhs.files.sizeBytes(index) != rhs.files.sizeBytes(index)
+                || lhs.files.binaryState(index) != rhs.files.binaryState(index)
+                || lhs.files.fileClass(index) != rhs.files.fileClass(index))
+                {
+                return false;
+                }
+            }
+        return true;
+        }
+
+    void testIncrementalReuse()
+        {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "repaddu_traversal_cache_repo";
+        const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "repaddu_traversal_cache.bin";
+        std::error_code errorCode;
+        std::filesystem::remove_all(root, errorCode);
+        std::filesystem::remove(cachePath, errorCode);
+        std::filesystem::create_directories(root / "src" / "nested", errorCode);
+        std::filesystem::create_directories(root / ".hidden", errorCode);
+        writeFile(root / "CMakeLists.txt", "project(demo)\n");
+        writeFile(root / "src" / "main.cpp", "int main() { return 0; }\n");
+        writeFile(root / "src" / "nested" / "util.h", "#pragma once\n");
+        writeFile(root / "src" / "data.bin", std::string("\x00\x01\x02", 3));
+        writeFile(root / ".hidden" / "secret.cpp", "int hidden;\n");
+        backdateTree(root);
+
+        repaddu::core::CliOptions options;
+        options.inputPath = root;
+        options.traversalCachePath = cachePath;
+
+        repaddu::io::TraversalResult reference;
+        expectTrue(repaddu::io::traverseRepository(options, reference).code == repaddu::core::ExitCode::success,
+            "Reference traversal must succeed");
+
+        repaddu::io::TraversalSnapshot empty;
+        repaddu::io::TraversalSnapshot first;
+        repaddu::io::TraversalResult firstResult;
+        repaddu::io::IncrementalTraversalStats firstStats;
+        expectTrue(repaddu::io::traverseRepositoryIncremental(options, empty, firstResult, first, &firstStats).code
+            == repaddu::core::ExitCode::success, "Cold incremental traversal must succeed");
+        expectTrue(sameTraversal(reference, firstResult), "Cold incremental traversal must match a full traversal");
+        expectTrue(firstStats.directoriesReused == 0, "Cold traversal must list every directory");
+
+        expectTrue(repaddu::io::saveTraversalSnapshot(cachePath, first).code == repaddu::core::ExitCode::success,
+            "Snapshot must be saved");
+        repaddu::io::TraversalSnapshot loaded;
+        expectTrue(repaddu::io::loadTraversalSnapshot(cachePath, loaded).code == repaddu::core::ExitCode::success,
+            "Snapshot must load");
+        expectTrue(loaded.directories.size() == first.directories.size(), "Snapshot must round-trip directories");
+
+        repaddu::io::TraversalSnapshot second;
+        repaddu::io::TraversalResult secondResult;
+        repaddu::io::IncrementalTraversalStats secondStats;
+        repaddu::io::traverseRepositoryIncremental(options, loaded, secondResult, second, &secondStats);
+        expectTrue(sameTraversal(reference, secondResult), "Warm traversal must match a full traversal");
+        expectTrue(secondStats.directoriesListed == 0, "Warm traversal must reuse unchanged directories");
+        expectTrue(secondStats.directoriesReused == first.directories.size(), "Warm traversal must reuse every listing");
+
+        writeFile(root / "src" / "main.cpp", "int main() { return 1; }\n// changed\n");
+        backdate(root / "src" / "main.cpp", std::chrono::hours(1));
+        writeFile(root / "src" / "nested" / "added.cpp", "int added;\n");
+        backdate(root / "src" / "nested" / "added.cpp", std::chrono::hours(1));
+        backdate(root / "src" / "nested", std::chrono::hours(1));
+
+        repaddu::io::TraversalSnapshot third;
+        repaddu::io::TraversalResult thirdResult;
+        repaddu::io::IncrementalTraversalStats thirdStats;
+        repaddu::io::traverseRepositoryIncremental(options, second, thirdResult, third, &thirdStats);
+        repaddu::io::TraversalResult updatedReference;
+        repaddu::io::traverseRepository(options, updatedReference);
+        expectTrue(sameTraversal(updatedReference, thirdResult), "Traversal after edits must match a full traversal");
+        expectTrue(thirdStats.directoriesListed == 1, "Only the directory with a new entry must be re-listed");
+        expectTrue(thirdResult.files.size() == secondResult.files.size() + 1, "An added file must be listed");
+
+        repaddu::core::CliOptions hiddenOptions = options;
+        hiddenOptions.includeHidden = true;
+        repaddu::io::TraversalSnapshot fourth;
+        repaddu::io::TraversalResult fourthResult;
+        repaddu::io::IncrementalTraversalStats fourthStats;
+        repaddu::io::traverseRepositoryIncremental(hiddenOptions, third, fourthResult, fourth, &fourthStats);
+        expectTrue(fourthStats.directoriesReused == 0, "Snapshot must be ignored when filtering options change");
+        expectTrue(fourthResult.files.size() == updatedReference.files.size() + 1,
+            "Hidden files must appear once the snapshot is invalidated");
+
+        std::filesystem::remove_all(root, errorCode);
+        std::filesystem::remove(cachePath, errorCode);
+        }
+
+    void testCorruptSnapshotRejected()
+        {
+        const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "repaddu_traversal_cache_corrupt.bin";
+        writeFile(cachePath, "not a snapshot");
+        repaddu::io::TraversalSnapshot snapshot;
+        expectTrue(repaddu::io::loadTraversalSnapshot(cachePath, snapshot).code != repaddu::core::ExitCode::success,
+            "Corrupt snapshot must be rejected");
+        expectTrue(snapshot.directories.empty(), "Corrupt snapshot must leave the output empty");
+        std::error_code errorCode;
+        std::filesystem::remove(cachePath, errorCode);
+        }
+    }
+
+int main()
+    {
+    testIncrementalReuse();
+    testCorruptSnapshotRejected();
+    return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
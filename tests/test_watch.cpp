@@ -0,0 +1,250 @@
+#include "repaddu/app/app_watch.h"
+#include "repaddu/format_writer.h"
+#include "repaddu/io_traversal.h"
+#include "repaddu/io_watch.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+    {
+    int g_failures = 0;
+
+    void expectTrue(bool value, const char* message)
+        {
+        if (!value)
+            {
+            std::cerr << "FAIL: " << message << "\n";
+            ++g_failures;
+            }
+        }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+        {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << content;
+        }
+
+    std::string readText(const std::filesystem::path& path)
+        {
+        std::ifstream input(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        }
+
+
+    void testOutputCacheSkipsUnchangedParts()
+        {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "repaddu_watch_cache";
+        std::filesystem::remove_all(root);
+        writeFile(root / "in" / "a.cpp", "int a;\n");
+        writeFile(root / "in" / "b.h", "int b();\n");
+
+        repaddu::core::CliOptions options;
+        options.inputPath = root / "in";
+        options.outputPath = root / "out";
+        options.emitCMake = false;
+        options.emitBuildFiles = false;
+
+        repaddu::core::FileTable files(options.inputPath);
+        files.add("a.cpp", std::filesystem::file_size(options.inputPath / "a.cpp"));
+        files.add("b.h", std::filesystem::file_size(options.inputPath / "b.h"));
+        repaddu::core::OutputChunk sources{ "sources", "Sources", { 0 } };
+        repaddu::core::OutputChunk headers{ "headers", "Headers", { 1 } };
+        const std::vector<repaddu::core::OutputChunk> chunks = { sources, headers };
+
+        repaddu::format::OutputCache cache;
+        auto write = [&](const std::vector<repaddu::core::OutputChunk>& currentChunks)
+            {
+            return repaddu::format::writeOutputs(options, files, currentChunks, "tree\n", {}, {}, &cache).code
+                == repaddu::core::ExitCode::success;
+            };
+
+        expectTrue(write(chunks), "first write succeeds");
+        expectTrue(cache.outputsWritten == 4 && cache.outputsSkipped == 0, "first write emits everything");
+
+        expectTrue(write(chunks), "unchanged write succeeds");
+        expectTrue(cache.outputsWritten == 0 && cache.outputsSkipped == 4, "unchanged inputs are not rewritten");
+
+        writeFile(options.inputPath / "a.cpp", "int a = 42;\n");
+        files.setSizeBytes(0, std::filesystem::file_size(files.absolutePath(0)));
+        cache.invalidate("a.cpp");
+        expectTrue(write(chunks), "incremental write succeeds");
+        expectTrue(cache.outputsWritten == 1 && cache.outputsSkipped == 3, "only the affected part is rewritten");
+        expectTrue(readText(options.outputPath / "002_sources.md").find("int a = 42;") != std::string::npos,
+            "rewritten part has the new content");
+
+        expectTrue(write({ sources }), "membership change succeeds");
+        expectTrue(cache.outputsWritten == 1, "overview is rewritten when the part list changes");
+        expectTrue(!std::filesystem::exists(options.outputPath / "003_headers.md"), "dropped parts are deleted");
+
+        std::filesystem::remove_all(root);
+        }
+
+    void testPartsWrittenConcurrently()
+        {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "repaddu_watch_parallel";
+        std::filesystem::remove_all(root);
+
+        repaddu::core::CliOptions options;
+        options.inputPath = root / "in";
+        options.emitCMake = false;
+        options.emitBuildFiles = false;
+
+        repaddu::core::FileTable files(options.inputPath);
+        std::vector<repaddu::core::OutputChunk> chunks;
+        for (int index = 0; index < 24; ++index)
+            {
+            const std::string name = "f" + std::to_string(index) + ".cpp";
+            writeFile(options.inputPath / name, "int f" + std::to_string(index) + ";\n");
+            files.add(name, std::filesystem::file_size(options.inputPath / name));
+            chunks.push_back({ "c" + std::to_string(index), "Chunk " + std::to_string(index),
+                { static_cast<std::size_t>(index) } });
+            }
+
+        auto writeInto = [&](const std::string& directory, bool parallel,
+                             const repaddu::format::ProgressCallback& progress)
+            {
+            repaddu::core::CliOptions runOptions = options;
+            runOptions.outputPath = root / directory;
+            runOptions.parallelTraversal = parallel;
+            repaddu::format::OutputCache cache;
+            return repaddu::format::writeOutputs(runOptions, files, chunks, "tree\n", {}, {}, &cache, progress);
+            };
+
+        std::vector<std::size_t> steps;
+        std::size_t reportedTotal = 0;
+        const repaddu::core::RunResult parallel = writeInto("parallel", true,
+            [&](std::size_t done, std::size_t total, const std::string&)
+            {
+            steps.push_back(done);
+            reportedTotal = total;
+            });
+        expectTrue(parallel.code == repaddu::core::ExitCode::success, "parallel write succeeds");
+        expectTrue(reportedTotal == 26 && steps.size() == 27, "progress covers the overview, tree and every part");
+        for (std::size_t index = 0; index < steps.size(); ++index)
+            {
+            expectTrue(steps[index] == index, "progress steps arrive in order");
+            }
+
+        expectTrue(writeInto("sequential", false, {}).code == repaddu::core::ExitCode::success,
+            "sequential write succeeds");
+        for (const auto& entry : std::filesystem::directory_iterator(root / "parallel"))
+            {
+            expectTrue(readText(entry.path()) == readText(root / "sequential" / entry.path().filename()),
+                "parallel output matches sequential output");
+            }
+
+        // A part that cannot be opened fails the run as it would sequentially.
+        std::filesystem::create_directories(root / "blocked" / "002_c0.md");
+        const repaddu::core::RunResult blocked = writeInto("blocked", true, {});
+        expectTrue(blocked.code == repaddu::core::ExitCode::io_failure, "failed part fails the run");
+
+        std::filesystem::remove_all(root);
+        }
+
+    void testApplyWatchChanges()
+        {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "repaddu_watch_apply";
+        std::filesystem::remove_all(root);
+        writeFile(root / "src" / "main.cpp", "int main() {}\n");
+        writeFile(root / ".gitignore", "*.o\n");
+
+        repaddu::core::CliOptions options;
+        options.inputPath = root;
+        options.outputPath = root / "out";
+
+        repaddu::io::TraversalResult traversal;
+        repaddu::io::traverseRepository(options, traversal);
+        const repaddu::app::WatchFileIndex fileIndices = repaddu::app::indexWatchedFiles(traversal);
+        repaddu::format::OutputCache cache;
+
+        writeFile(root / "src" / "main.cpp", "int main() { return 1; }\n");
+        repaddu::app::WatchUpdate update = repaddu::app::applyWatchChanges(options,
+            { { "src/main.cpp", false, false, false } }, traversal, fileIndices, cache);
+        expectTrue(!update.rescanRequired && update.filesChanged == 1, "rewrite updates the entry in place");
+        expectTrue(!update.regroupRequired, "a size change within limits keeps the grouping");
+        expectTrue(traversal.files.size() == 1 && traversal.files.sizeBytes(0) == 25, "size is refreshed");
+        expectTrue(cache.generations["src/main.cpp"] == 1, "rewritten file is invalidated");
+
+        // Growing past --max-file-size drops the file from its chunk.
+        options.maxFileSize = 30;
+        writeFile(root / "src" / "main.cpp", "int main() { return 1 + 2 + 3; }\n");
+        update = repaddu::app::applyWatchChanges(options, { { "src/main.cpp", false, false, false } }, traversal, fileIndices,
+            cache);
+        expectTrue(!update.rescanRequired && update.regroupRequired, "crossing --max-file-size requests a regroup");
+        options.maxFileSize = repaddu::core::CliOptions().maxFileSize;
+
+        writeFile(root / "src" / "main.o", "obj");
+        update = repaddu::app::applyWatchChanges(options, { { "src/main.o", true, false, false } }, traversal, fileIndices, cache);
+        expectTrue(!update.rescanRequired && update.filesChanged == 0, "ignored new file needs no rescan");
+
+        writeFile(root / "src" / "util.cpp", "int u;\n");
+        update = repaddu::app::applyWatchChanges(options, { { "src/util.cpp", true, false, false } }, traversal, fileIndices, cache);
+        expectTrue(update.rescanRequired, "new file requests a rescan");
+
+        update = repaddu::app::applyWatchChanges(options, { { ".gitignore", false, false, false } }, traversal, fileIndices, cache);
+        expectTrue(update.rescanRequired, "ignore file edit requests a rescan");
+
+        writeFile(root / "out" / "001_tree.md", "x");
+        update = repaddu::app::applyWatchChanges(options, { { "out/001_tree.md", true, false, false } }, traversal, fileIndices, cache);
+        expectTrue(!update.rescanRequired && update.filesChanged == 0, "output directory events are dropped");
+
+        std::filesystem::remove(root / "src" / "main.cpp");
+        update = repaddu::app::applyWatchChanges(options, { { "src/main.cpp", true, false, false } }, traversal, fileIndices, cache);
+        expectTrue(update.rescanRequired, "deleted file requests a rescan");
+
+        std::filesystem::remove_all(root);
+        }
+
+    void testDirectoryWatcher()
+        {
+        if (!repaddu::io::DirectoryWatcher::available())
+            {
+            return;
+            }
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "repaddu_watch_inotify";
+        std::filesystem::remove_all(root);
+        writeFile(root / "sub" / "a.txt", "a\n");
+
+        repaddu::io::DirectoryWatcher watcher;
+        expectTrue(watcher.open(root).code == repaddu::core::ExitCode::success, "watcher opens");
+        expectTrue(watcher.addDirectory("") && watcher.addDirectory("sub"), "directories are watched");
+
+        std::vector<repaddu::io::WatchChange> changes;
+        watcher.waitForChanges(0, 0, changes);
+        expectTrue(changes.empty(), "no events before changes");
+
+        writeFile(root / "sub" / "a.txt", "changed\n");
+        writeFile(root / "sub" / "a.txt", "changed again\n");
+        writeFile(root / "b.txt", "b\n");
+        expectTrue(watcher.waitForChanges(2000, 20, changes).code == repaddu::core::ExitCode::success, "wait succeeds");
+        expectTrue(changes.size() == 2, "events are coalesced per path");
+        if (changes.size() == 2)
+            {
+            expectTrue(changes[0].relativePath == "b.txt" && changes[0].structural, "creation is structural");
+            expectTrue(changes[1].relativePath == "sub/a.txt" && !changes[1].structural, "rewrite is not structural");
+            }
+
+        std::filesystem::remove_all(root);
+        }
+    }
+
+int main()
+    {
+    testOutputCacheSkipsUnchangedParts();
+    testPartsWrittenConcurrently();
+    testApplyWatchChanges();
+    testDirectoryWatcher();
+
+    if (g_failures != 0)
+        {
+        std::cerr << g_failures << " failure(s)\n";
+        return 1;
+        }
+    std::cout << "All watch tests passed.\n";
+    return 0;
+    }